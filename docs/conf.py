@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+#
+# THIS FILE IS AUTOMATICALLY GENERATED BY CMAKE
+# DO NOT EDIT THIS!
+#
+
+# import os
+# import sys
+# sys.path.insert(0, os.path.abspath('.'))
+
+import sphinx_rtd_theme
+
+# needs_sphinx = '1.0'
+
+extensions = []
+templates_path = ['_templates']
+
+# source_suffix = ['.rst', '.md']
+source_suffix = '.rst'
+
+master_doc = 'index'
+
+project = 'nanoem'
+copyright = '2017-2021, hkrn'
+author = 'hkrn'
+
+version = '-128-NOTFOUND'
+release = '-128-NOTFOUND'
+
+language = 'ja'
+exclude_patterns = ['_build', 'Thumbs.db', '.DS_Store', '.venv']
+pygments_style = 'sphinx'
+todo_include_todos = False
+
+html_theme = 'sphinx_rtd_theme'
+html_theme_path = [ sphinx_rtd_theme.get_html_theme_path() ]
+html_static_path = ['_static']
+html_sidebars = {
+    '**': [
+        'about.html',
+        'navigation.html',
+        'relations.html',  # needs 'show_related': True theme option to display
+        'searchbox.html',
+        'donate.html',
+    ]
+}
+
+htmlhelp_basename = 'nanoemdoc'
+
+latex_elements = {
+    # 'papersize': 'letterpaper',
+    # 'pointsize': '10pt',
+    # 'preamble': '',
+    # 'figure_align': 'htbp',
+}
+latex_documents = [
+    (master_doc, 'nanoem.tex', 'nanoem Documentation',
+     'hkrn', 'manual'),
+]
+
+
+man_pages = [
+    (master_doc, 'nanoem', 'nanoem Documentation',
+     [author], 1)
+]
+
+texinfo_documents = [
+    (master_doc, 'nanoem', 'nanoem Documentation',
+     author, 'nanoem', 'One line description of project.',
+     'Miscellaneous'),
+]
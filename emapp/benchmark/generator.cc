@@ -0,0 +1,357 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "generator.h"
+
+#include "emapp/StringUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "nanoem/ext/mutable.h"
+
+namespace nanoem {
+namespace benchmark {
+namespace {
+
+typedef tinystl::vector<const nanoem_model_bone_t *, TinySTLAllocator> BoneList;
+typedef tinystl::vector<const nanoem_model_rigid_body_t *, TinySTLAllocator> RigidBodyList;
+typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> VertexIndexList;
+
+static const nanoem_f32_t kChainInterval = 2.0f;
+static const nanoem_f32_t kBoneLength = 1.0f;
+static const nanoem_f32_t kVertexRadius = 0.25f;
+static const nanoem_f32_t kRigidBodyRadius = 0.2f;
+static const nanoem_f32_t kJointAngularLimit = 0.5f;
+static const int kNumConstraintIterations = 16;
+
+static Vector3
+chainBoneOrigin(const SceneDescription &desc, nanoem_u32_t chainIndex, nanoem_u32_t linkIndex)
+{
+    const nanoem_f32_t x = (nanoem_f32_t(chainIndex) - desc.numChains() * 0.5f) * kChainInterval;
+    return Vector3(x, kBoneLength * (linkIndex + 1), 0);
+}
+
+static int
+boneIndex(const nanoem_model_bone_t *bone)
+{
+    return nanoemModelObjectGetIndex(nanoemModelBoneGetModelObject(bone));
+}
+
+static void
+insertBone(nanoem_mutable_model_t *mutableModel, const nanoem_model_bone_t *parentBone, const String &name,
+    const Vector3 &origin, bool movable, nanoem_unicode_string_factory_t *factory,
+    StringUtils::UnicodeStringScope &scope, BoneList &bones, nanoem_status_t &status)
+{
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    nanoem_mutable_model_bone_t *mutableBone = nanoemMutableModelBoneCreate(originModel, &status);
+    if (StringUtils::tryGetString(factory, name, scope)) {
+        nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        nanoemMutableModelBoneSetName(mutableBone, scope.value(), NANOEM_LANGUAGE_TYPE_ENGLISH, &status);
+    }
+    nanoemMutableModelBoneSetParentBoneObject(mutableBone, parentBone);
+    nanoemMutableModelBoneSetOrigin(mutableBone, glm::value_ptr(Vector4(origin, 1)));
+    nanoemMutableModelBoneSetVisible(mutableBone, true);
+    nanoemMutableModelBoneSetMovable(mutableBone, movable);
+    nanoemMutableModelBoneSetRotateable(mutableBone, true);
+    nanoemMutableModelBoneSetUserHandleable(mutableBone, true);
+    nanoemMutableModelInsertBoneObject(mutableModel, mutableBone, -1, &status);
+    bones.push_back(nanoemMutableModelBoneGetOriginObject(mutableBone));
+    nanoemMutableModelBoneDestroy(mutableBone);
+}
+
+static void
+insertConstraint(nanoem_mutable_model_t *mutableModel, const BoneList &chainBones, const String &name,
+    const Vector3 &origin, nanoem_unicode_string_factory_t *factory, StringUtils::UnicodeStringScope &scope,
+    BoneList &bones, nanoem_status_t &status)
+{
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    insertBone(mutableModel, bones.front(), name, origin, true, factory, scope, bones, status);
+    nanoem_model_bone_t *targetBone = const_cast<nanoem_model_bone_t *>(bones.back());
+    nanoem_mutable_model_bone_t *mutableTargetBone = nanoemMutableModelBoneCreateAsReference(targetBone, &status);
+    nanoem_mutable_model_constraint_t *mutableConstraint = nanoemMutableModelConstraintCreate(originModel, &status);
+    nanoemMutableModelConstraintSetAngleLimit(mutableConstraint, 1.0f);
+    nanoemMutableModelConstraintSetEffectorBoneObject(mutableConstraint, chainBones.back());
+    nanoemMutableModelConstraintSetNumIterations(mutableConstraint, kNumConstraintIterations);
+    nanoemMutableModelConstraintSetTargetBoneObject(mutableConstraint, targetBone);
+    /* links are ordered from the parent of the effector to the root of the chain */
+    for (BoneList::const_iterator it = chainBones.end() - 1, end = chainBones.begin(); it != end;) {
+        --it;
+        nanoem_mutable_model_constraint_joint_t *mutableJoint =
+            nanoemMutableModelConstraintJointCreate(mutableConstraint, &status);
+        nanoemMutableModelConstraintJointSetBoneObject(mutableJoint, *it);
+        nanoemMutableModelConstraintInsertJointObject(mutableConstraint, mutableJoint, -1, &status);
+        nanoemMutableModelConstraintJointDestroy(mutableJoint);
+    }
+    nanoemMutableModelBoneSetConstraintEnabled(mutableTargetBone, true);
+    nanoemMutableModelBoneSetConstraintObject(mutableTargetBone, mutableConstraint);
+    nanoemMutableModelConstraintDestroy(mutableConstraint);
+    nanoemMutableModelBoneDestroy(mutableTargetBone);
+}
+
+static void
+insertAllVertices(nanoem_mutable_model_t *mutableModel, const nanoem_model_bone_t *bone,
+    const nanoem_model_bone_t *parentBone, const Vector3 &origin, nanoem_u32_t numVertices, nanoem_f32_t v,
+    VertexIndexList &indices, nanoem_status_t &status)
+{
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    nanoem_rsize_t offset;
+    nanoemModelGetAllVertexObjects(originModel, &offset);
+    for (nanoem_u32_t i = 0; i < numVertices; i++) {
+        const nanoem_f32_t u = nanoem_f32_t(i) / numVertices, angle = u * glm::two_pi<nanoem_f32_t>();
+        const Vector3 normal(glm::cos(angle), 0, glm::sin(angle));
+        nanoem_mutable_model_vertex_t *mutableVertex = nanoemMutableModelVertexCreate(originModel, &status);
+        nanoemMutableModelVertexSetOrigin(mutableVertex,
+            glm::value_ptr(Vector4(origin + normal * kVertexRadius - Vector3(0, u * kBoneLength, 0), 1)));
+        nanoemMutableModelVertexSetNormal(mutableVertex, glm::value_ptr(Vector4(normal, 0)));
+        nanoemMutableModelVertexSetTexCoord(mutableVertex, glm::value_ptr(Vector4(u, v, 0, 0)));
+        nanoemMutableModelVertexSetType(mutableVertex, NANOEM_MODEL_VERTEX_TYPE_BDEF2);
+        nanoemMutableModelVertexSetBoneObject(mutableVertex, bone, 0);
+        nanoemMutableModelVertexSetBoneObject(mutableVertex, parentBone, 1);
+        nanoemMutableModelVertexSetBoneWeight(mutableVertex, 1.0f - u * 0.5f, 0);
+        nanoemMutableModelVertexSetBoneWeight(mutableVertex, u * 0.5f, 1);
+        nanoemMutableModelVertexSetEdgeSize(mutableVertex, 1.0f);
+        nanoemMutableModelInsertVertexObject(mutableModel, mutableVertex, -1, &status);
+        nanoemMutableModelVertexDestroy(mutableVertex);
+    }
+    for (nanoem_u32_t i = 2; i < numVertices; i++) {
+        const nanoem_u32_t index = nanoem_u32_t(offset) + i;
+        indices.push_back(index - 2);
+        indices.push_back(index - 1);
+        indices.push_back(index);
+    }
+}
+
+static void
+insertAllRigidBodies(nanoem_mutable_model_t *mutableModel, const BoneList &chainBones, nanoem_u32_t chainIndex,
+    nanoem_unicode_string_factory_t *factory, StringUtils::UnicodeStringScope &scope, nanoem_status_t &status)
+{
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    RigidBodyList rigidBodies;
+    String name;
+    for (BoneList::const_iterator it = chainBones.begin(), end = chainBones.end(); it != end; ++it) {
+        const nanoem_model_bone_t *bone = *it;
+        const bool kinematic = it == chainBones.begin();
+        nanoem_mutable_model_rigid_body_t *mutableRigidBody = nanoemMutableModelRigidBodyCreate(originModel, &status);
+        StringUtils::format(name, "R%05d", boneIndex(bone));
+        if (StringUtils::tryGetString(factory, name, scope)) {
+            nanoemMutableModelRigidBodySetName(mutableRigidBody, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+            nanoemMutableModelRigidBodySetName(mutableRigidBody, scope.value(), NANOEM_LANGUAGE_TYPE_ENGLISH, &status);
+        }
+        nanoemMutableModelRigidBodySetBoneObject(mutableRigidBody, bone);
+        nanoemMutableModelRigidBodySetOrigin(mutableRigidBody, nanoemModelBoneGetOrigin(bone));
+        nanoemMutableModelRigidBodySetShapeType(mutableRigidBody, NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_SPHERE);
+        nanoemMutableModelRigidBodySetShapeSize(mutableRigidBody, glm::value_ptr(Vector4(kRigidBodyRadius)));
+        nanoemMutableModelRigidBodySetMass(mutableRigidBody, 1.0f);
+        nanoemMutableModelRigidBodySetLinearDamping(mutableRigidBody, 0.5f);
+        nanoemMutableModelRigidBodySetAngularDamping(mutableRigidBody, 0.5f);
+        nanoemMutableModelRigidBodySetFriction(mutableRigidBody, 0.5f);
+        nanoemMutableModelRigidBodySetTransformType(mutableRigidBody,
+            kinematic ? NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_BONE_TO_SIMULATION
+                      : NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_SIMULATION_TO_BONE);
+        nanoemMutableModelRigidBodySetCollisionGroupId(mutableRigidBody, chainIndex % 16);
+        nanoemMutableModelInsertRigidBodyObject(mutableModel, mutableRigidBody, -1, &status);
+        rigidBodies.push_back(nanoemMutableModelRigidBodyGetOriginObject(mutableRigidBody));
+        nanoemMutableModelRigidBodyDestroy(mutableRigidBody);
+    }
+    for (nanoem_rsize_t i = 1, numRigidBodies = rigidBodies.size(); i < numRigidBodies; i++) {
+        nanoem_mutable_model_joint_t *mutableJoint = nanoemMutableModelJointCreate(originModel, &status);
+        StringUtils::format(name, "J%05d", boneIndex(chainBones[i]));
+        if (StringUtils::tryGetString(factory, name, scope)) {
+            nanoemMutableModelJointSetName(mutableJoint, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+            nanoemMutableModelJointSetName(mutableJoint, scope.value(), NANOEM_LANGUAGE_TYPE_ENGLISH, &status);
+        }
+        nanoemMutableModelJointSetType(mutableJoint, NANOEM_MODEL_JOINT_TYPE_GENERIC_6DOF_SPRING_CONSTRAINT);
+        nanoemMutableModelJointSetRigidBodyAObject(mutableJoint, rigidBodies[i - 1]);
+        nanoemMutableModelJointSetRigidBodyBObject(mutableJoint, rigidBodies[i]);
+        nanoemMutableModelJointSetOrigin(mutableJoint, nanoemModelBoneGetOrigin(chainBones[i]));
+        nanoemMutableModelJointSetAngularLowerLimit(mutableJoint, glm::value_ptr(Vector4(-kJointAngularLimit)));
+        nanoemMutableModelJointSetAngularUpperLimit(mutableJoint, glm::value_ptr(Vector4(kJointAngularLimit)));
+        nanoemMutableModelInsertJointObject(mutableModel, mutableJoint, -1, &status);
+        nanoemMutableModelJointDestroy(mutableJoint);
+    }
+}
+
+} /* namespace anonymous */
+
+SceneDescription::SceneDescription()
+    : m_numModels(1)
+    , m_numBones(64)
+    , m_numBonesPerChain(8)
+    , m_numVerticesPerBone(32)
+    , m_numKeyframes(16)
+    , m_duration(300)
+    , m_constraintEnabled(true)
+    , m_physicsEnabled(true)
+{
+}
+
+nanoem_u32_t
+SceneDescription::numChains() const NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_u32_t numBonesPerChain = glm::max(m_numBonesPerChain, 1u);
+    return (m_numBones + numBonesPerChain - 1) / numBonesPerChain;
+}
+
+bool
+SceneDescription::isConstraintChain(nanoem_u32_t chainIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return m_constraintEnabled && chainIndex % 2 == 0;
+}
+
+bool
+SceneDescription::isPhysicsChain(nanoem_u32_t chainIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return m_physicsEnabled && chainIndex % 2 == 1;
+}
+
+void
+Generator::formatBoneName(nanoem_u32_t index, String &value)
+{
+    StringUtils::format(value, "B%05u", index);
+}
+
+void
+Generator::formatConstraintBoneName(nanoem_u32_t chainIndex, String &value)
+{
+    StringUtils::format(value, "IK%04u", chainIndex);
+}
+
+Generator::Generator(const SceneDescription &desc, nanoem_unicode_string_factory_t *factory)
+    : m_description(desc)
+    , m_factory(factory)
+{
+}
+
+Generator::~Generator() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+Generator::generateModel(nanoem_u32_t index, ByteArray &bytes, nanoem_status_t &status) const
+{
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    nanoem_mutable_model_t *mutableModel = nanoemMutableModelCreate(m_factory, &status);
+    nanoem_model_t *originModel = nanoemMutableModelGetOriginObject(mutableModel);
+    StringUtils::UnicodeStringScope scope(m_factory);
+    String name;
+    nanoemMutableModelSetAdditionalUVSize(mutableModel, 0);
+    nanoemMutableModelSetCodecType(mutableModel, NANOEM_CODEC_TYPE_UTF16);
+    nanoemMutableModelSetFormatType(mutableModel, NANOEM_MODEL_FORMAT_TYPE_PMX_2_0);
+    StringUtils::format(name, "Benchmark%03u", index);
+    if (StringUtils::tryGetString(m_factory, name, scope)) {
+        nanoemMutableModelSetName(mutableModel, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        nanoemMutableModelSetName(mutableModel, scope.value(), NANOEM_LANGUAGE_TYPE_ENGLISH, &status);
+    }
+    BoneList bones;
+    VertexIndexList indices;
+    insertBone(mutableModel, nullptr, "Root", Vector3(0), true, m_factory, scope, bones, status);
+    const nanoem_u32_t numBones = m_description.m_numBones, numBonesPerChain = m_description.m_numBonesPerChain,
+                       numVertices = m_description.m_numVerticesPerBone;
+    for (nanoem_u32_t i = 0, numChains = m_description.numChains(); i < numChains; i++) {
+        const nanoem_u32_t offset = i * numBonesPerChain, numLinks = glm::min(numBones - offset, numBonesPerChain);
+        BoneList chainBones;
+        for (nanoem_u32_t j = 0; j < numLinks; j++) {
+            const nanoem_model_bone_t *parentBone = j > 0 ? chainBones.back() : bones.front();
+            const Vector3 origin(chainBoneOrigin(m_description, i, j));
+            formatBoneName(offset + j, name);
+            insertBone(mutableModel, parentBone, name, origin, j == 0, m_factory, scope, chainBones, status);
+            insertAllVertices(mutableModel, chainBones.back(), parentBone, origin, numVertices,
+                nanoem_f32_t(j) / numLinks, indices, status);
+        }
+        bones.insert(bones.end(), chainBones.begin(), chainBones.end());
+        if (m_description.isConstraintChain(i) && numLinks >= 2) {
+            formatConstraintBoneName(i, name);
+            insertConstraint(mutableModel, chainBones, name, chainBoneOrigin(m_description, i, numLinks - 1),
+                m_factory, scope, bones, status);
+        }
+        else if (m_description.isPhysicsChain(i)) {
+            insertAllRigidBodies(mutableModel, chainBones, i, m_factory, scope, status);
+        }
+    }
+    nanoem_mutable_model_material_t *mutableMaterial = nanoemMutableModelMaterialCreate(originModel, &status);
+    if (StringUtils::tryGetString(m_factory, "Material", scope)) {
+        nanoemMutableModelMaterialSetName(mutableMaterial, scope.value(), NANOEM_LANGUAGE_TYPE_JAPANESE, &status);
+        nanoemMutableModelMaterialSetName(mutableMaterial, scope.value(), NANOEM_LANGUAGE_TYPE_ENGLISH, &status);
+    }
+    nanoemMutableModelMaterialSetAmbientColor(mutableMaterial, glm::value_ptr(Vector4(0.5f, 0.5f, 0.5f, 0)));
+    nanoemMutableModelMaterialSetDiffuseColor(mutableMaterial, glm::value_ptr(Vector4(1, 1, 1, 0)));
+    nanoemMutableModelMaterialSetDiffuseOpacity(mutableMaterial, 1.0f);
+    nanoemMutableModelMaterialSetEdgeOpacity(mutableMaterial, 1.0f);
+    nanoemMutableModelMaterialSetEdgeSize(mutableMaterial, 1.0f);
+    nanoemMutableModelMaterialSetNumVertexIndices(mutableMaterial, indices.size());
+    nanoemMutableModelInsertMaterialObject(mutableModel, mutableMaterial, -1, &status);
+    nanoemMutableModelMaterialDestroy(mutableMaterial);
+    nanoemMutableModelSetVertexIndices(mutableModel, indices.data(), indices.size(), &status);
+    nanoemMutableModelSaveToBuffer(mutableModel, mutableBuffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+    const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+    bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableModelDestroy(mutableModel);
+    nanoemMutableBufferDestroy(mutableBuffer);
+}
+
+void
+Generator::generateMotion(ByteArray &bytes, nanoem_status_t &status) const
+{
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreate(m_factory, &status);
+    nanoem_motion_t *originMotion = nanoemMutableMotionGetOriginObject(mutableMotion);
+    StringUtils::UnicodeStringScope scope(m_factory);
+    String name;
+    if (StringUtils::tryGetString(m_factory, "Benchmark", scope)) {
+        nanoemMutableMotionSetTargetModelName(mutableMotion, scope.value(), &status);
+    }
+    const nanoem_u32_t numBones = m_description.m_numBones, numBonesPerChain = m_description.m_numBonesPerChain,
+                       numKeyframes = glm::max(m_description.m_numKeyframes, 1u);
+    const nanoem_frame_index_t duration = m_description.m_duration;
+    for (nanoem_u32_t i = 0, numChains = m_description.numChains(); i < numChains; i++) {
+        const nanoem_u32_t offset = i * numBonesPerChain, numLinks = glm::min(numBones - offset, numBonesPerChain);
+        const bool hasConstraint = m_description.isConstraintChain(i) && numLinks >= 2,
+                   hasPhysics = !hasConstraint && m_description.isPhysicsChain(i);
+        /* keyframes of dynamic links are skipped since the simulation overrides them */
+        for (nanoem_u32_t j = 0, numKeyframeLinks = hasPhysics ? 1 : numLinks + (hasConstraint ? 1 : 0);
+             j < numKeyframeLinks; j++) {
+            const bool isConstraintBone = j == numLinks;
+            if (isConstraintBone) {
+                formatConstraintBoneName(i, name);
+            }
+            else {
+                formatBoneName(offset + j, name);
+            }
+            if (!StringUtils::tryGetString(m_factory, name, scope)) {
+                continue;
+            }
+            for (nanoem_u32_t k = 0; k < numKeyframes; k++) {
+                const nanoem_frame_index_t frameIndex =
+                    numKeyframes > 1 ? nanoem_frame_index_t(nanoem_u64_t(duration) * k / (numKeyframes - 1)) : 0;
+                const nanoem_f32_t phase = glm::sin(k * 0.7f + (offset + j) * 0.3f);
+                nanoem_mutable_motion_bone_keyframe_t *mutableKeyframe =
+                    nanoemMutableMotionBoneKeyframeCreate(originMotion, &status);
+                if (isConstraintBone) {
+                    const Vector4 translation(phase * 0.5f, glm::cos(phase) * 0.5f, 0, 0);
+                    nanoemMutableMotionBoneKeyframeSetTranslation(mutableKeyframe, glm::value_ptr(translation));
+                }
+                else {
+                    const Quaternion orientation(glm::angleAxis(phase * 0.25f, Vector3(0, 0, 1)));
+                    nanoemMutableMotionBoneKeyframeSetOrientation(mutableKeyframe, glm::value_ptr(orientation));
+                }
+                nanoemMutableMotionAddBoneKeyframe(mutableMotion, mutableKeyframe, scope.value(), frameIndex, &status);
+                nanoemMutableMotionBoneKeyframeDestroy(mutableKeyframe);
+            }
+        }
+    }
+    nanoemMutableMotionSortAllKeyframes(mutableMotion);
+    nanoemMutableMotionSaveToBuffer(mutableMotion, mutableBuffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+    const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+    bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableMotionDestroy(mutableMotion);
+    nanoemMutableBufferDestroy(mutableBuffer);
+}
+
+} /* namespace benchmark */
+} /* namespace nanoem */
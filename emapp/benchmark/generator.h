@@ -0,0 +1,52 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_BENCHMARK_GENERATOR_H_
+#define NANOEM_EMAPP_BENCHMARK_GENERATOR_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+namespace benchmark {
+
+/* bones are laid out as chains under one root bone, even chains are solved by IK and odd chains by physics */
+struct SceneDescription {
+    SceneDescription();
+    nanoem_u32_t numChains() const NANOEM_DECL_NOEXCEPT;
+    bool isConstraintChain(nanoem_u32_t chainIndex) const NANOEM_DECL_NOEXCEPT;
+    bool isPhysicsChain(nanoem_u32_t chainIndex) const NANOEM_DECL_NOEXCEPT;
+
+    nanoem_u32_t m_numModels;
+    nanoem_u32_t m_numBones;
+    nanoem_u32_t m_numBonesPerChain;
+    nanoem_u32_t m_numVerticesPerBone;
+    nanoem_u32_t m_numKeyframes;
+    nanoem_frame_index_t m_duration;
+    bool m_constraintEnabled;
+    bool m_physicsEnabled;
+};
+
+class Generator NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static void formatBoneName(nanoem_u32_t index, String &value);
+    static void formatConstraintBoneName(nanoem_u32_t chainIndex, String &value);
+
+    Generator(const SceneDescription &desc, nanoem_unicode_string_factory_t *factory);
+    ~Generator() NANOEM_DECL_NOEXCEPT;
+
+    void generateModel(nanoem_u32_t index, ByteArray &bytes, nanoem_status_t &status) const;
+    void generateMotion(ByteArray &bytes, nanoem_status_t &status) const;
+
+private:
+    const SceneDescription m_description;
+    nanoem_unicode_string_factory_t *m_factory;
+};
+
+} /* namespace benchmark */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_BENCHMARK_GENERATOR_H_ */
@@ -0,0 +1,334 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "generator.h"
+
+#include "emapp/emapp.h"
+
+#include "emapp/Profiler.h"
+#include "emapp/internal/StubEventPublisher.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/commandline.h"
+#include "bx/timer.h"
+
+#include <algorithm>
+
+using namespace nanoem;
+
+namespace {
+
+typedef tinystl::vector<nanoem_u64_t, TinySTLAllocator> TickList;
+typedef tinystl::vector<Profiler::Event, TinySTLAllocator> EventList;
+
+struct Stage {
+    const char *m_label;
+    const char *m_zoneName;
+};
+/* zones are inclusive so the constraint stage is also counted in the motion stage */
+static const Stage kStages[] = {
+    { "motion", "Project::synchronizeAllMotions" },
+    { "constraint", "Model::solveAllConstraints" },
+    { "physics", "PhysicsEngine::stepSimulation" },
+    { "skinning", "Model::updateStagingVertexBuffer" },
+    { "drawqueue", "Project::drawViewport" },
+    { "flush", "Project::DrawQueue::flush" },
+    { "frame", nullptr },
+};
+static const nanoem_rsize_t kNumStages = BX_COUNTOF(kStages);
+static const nanoem_rsize_t kFrameStageIndex = kNumStages - 1;
+
+struct Statistics {
+    Statistics()
+        : m_numCalls(0)
+    {
+    }
+    nanoem_f64_t
+    percentile(nanoem_f64_t value, nanoem_f64_t scale) const
+    {
+        const nanoem_rsize_t numTicks = m_ticks.size();
+        const nanoem_rsize_t index = numTicks > 0 ? nanoem_rsize_t((numTicks - 1) * value + 0.5) : 0;
+        return numTicks > 0 ? m_ticks[index] * scale : 0;
+    }
+    nanoem_f64_t
+    mean(nanoem_f64_t scale) const
+    {
+        nanoem_f64_t sum = 0;
+        for (TickList::const_iterator it = m_ticks.begin(), end = m_ticks.end(); it != end; ++it) {
+            sum += nanoem_f64_t(*it);
+        }
+        return m_ticks.empty() ? 0 : sum * scale / m_ticks.size();
+    }
+    TickList m_ticks;
+    nanoem_u64_t m_numCalls;
+};
+
+static nanoem_u32_t
+findUInt32Option(const bx::CommandLine &command, const char *name, nanoem_u32_t defaultValue)
+{
+    const char *value = command.findOption(name);
+    return value ? nanoem_u32_t(strtoul(value, nullptr, 10)) : defaultValue;
+}
+
+static bool
+loadFile(const char *path, IFileManager::DialogType type, Project *project, IFileManager *fileManager)
+{
+    Error error;
+    bool succeeded = true;
+    if (path) {
+        succeeded = fileManager->loadFromFile(URI::createFromFilePath(path), type, project, error);
+        if (!succeeded || error.hasReason()) {
+            fprintf(stderr, "Cannot load %s: %s\n", path, error.reasonConstString());
+            succeeded = false;
+        }
+    }
+    return succeeded;
+}
+
+static bool
+generateScene(const benchmark::SceneDescription &desc, Project *project)
+{
+    benchmark::Generator generator(desc, project->unicodeStringFactory());
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    ByteArray motionBytes, modelBytes;
+    generator.generateMotion(motionBytes, status);
+    for (nanoem_u32_t i = 0; i < desc.m_numModels && status == NANOEM_STATUS_SUCCESS; i++) {
+        Error error;
+        generator.generateModel(i, modelBytes, status);
+        Model *model = project->createModel();
+        if (status == NANOEM_STATUS_SUCCESS && model->load(modelBytes, error)) {
+            model->setupAllBindings();
+            model->createAllImages();
+            model->upload();
+            Progress progress(project, 0);
+            model->loadAllImages(progress, error);
+            model->setVisible(true);
+            project->addModel(model);
+            Motion *motion = project->createMotion();
+            if (motion->load(motionBytes, 0, error)) {
+                project->destroyMotion(project->addModelMotion(motion, model));
+            }
+            else {
+                project->destroyMotion(motion);
+            }
+        }
+        else {
+            project->destroyModel(model);
+        }
+        if (error.hasReason()) {
+            fprintf(stderr, "Cannot generate the model %u: %s\n", i, error.reasonConstString());
+            return false;
+        }
+    }
+    if (status != NANOEM_STATUS_SUCCESS) {
+        const char *message = Error::convertStatusToMessage(status, project->translator());
+        fprintf(stderr, "Cannot generate the scene: %s\n", message);
+    }
+    return status == NANOEM_STATUS_SUCCESS;
+}
+
+static void
+collectAllEvents(const Profiler *profiler, EventList &events, Statistics *statistics)
+{
+    nanoem_u64_t ticks[kNumStages] = {};
+    for (nanoem_u32_t i = 0, numThreads = profiler->numThreads(); i < numThreads; i++) {
+        const nanoem_rsize_t numEvents = profiler->copyAllEvents(i, events.data(), events.size());
+        for (nanoem_rsize_t j = 0; j < numEvents; j++) {
+            const Profiler::Event &event = events[j];
+            for (nanoem_rsize_t k = 0; k < kFrameStageIndex; k++) {
+                if (StringUtils::equals(event.m_name, kStages[k].m_zoneName)) {
+                    ticks[k] += event.m_end - event.m_begin;
+                    statistics[k].m_numCalls++;
+                    break;
+                }
+            }
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < kFrameStageIndex; i++) {
+        statistics[i].m_ticks.push_back(ticks[i]);
+    }
+}
+
+static void
+printAllStatistics(const Statistics *statistics, nanoem_rsize_t numFrames, nanoem_f64_t scale)
+{
+    printf("%-12s %-36s %10s %10s %10s %10s %8s\n", "stage", "zone", "mean(ms)", "p50(ms)", "p95(ms)", "max(ms)",
+        "calls");
+    for (nanoem_rsize_t i = 0; i < kNumStages; i++) {
+        const Stage &stage = kStages[i];
+        const Statistics &s = statistics[i];
+        printf("%-12s %-36s %10.3f %10.3f %10.3f %10.3f %8.1f\n", stage.m_label,
+            stage.m_zoneName ? stage.m_zoneName : "-", s.mean(scale), s.percentile(0.5, scale),
+            s.percentile(0.95, scale), s.percentile(1.0, scale),
+            numFrames > 0 ? nanoem_f64_t(s.m_numCalls) / numFrames : 0.0);
+    }
+}
+
+static void
+saveAllStatistics(const char *path, const benchmark::SceneDescription &desc, const Project *project,
+    const Statistics *statistics, nanoem_rsize_t numFrames, nanoem_u64_t numDroppedEvents, nanoem_f64_t scale)
+{
+    JSON_Value *root = json_value_init_object();
+    JSON_Object *object = json_object(root);
+    json_object_dotset_number(object, "scene.models", nanoem_f64_t(project->allModels()->size()));
+    json_object_dotset_number(object, "scene.generated.models", desc.m_numModels);
+    json_object_dotset_number(object, "scene.generated.bones", desc.m_numBones);
+    json_object_dotset_number(object, "scene.generated.keyframes", desc.m_numKeyframes);
+    json_object_dotset_number(object, "frames", nanoem_f64_t(numFrames));
+    json_object_dotset_number(object, "droppedEvents", nanoem_f64_t(numDroppedEvents));
+    JSON_Value *stages = json_value_init_array();
+    for (nanoem_rsize_t i = 0; i < kNumStages; i++) {
+        const Stage &stage = kStages[i];
+        const Statistics &s = statistics[i];
+        JSON_Value *item = json_value_init_object();
+        JSON_Object *itemObject = json_object(item);
+        json_object_set_string(itemObject, "name", stage.m_label);
+        if (stage.m_zoneName) {
+            json_object_set_string(itemObject, "zone", stage.m_zoneName);
+        }
+        json_object_set_number(itemObject, "mean", s.mean(scale));
+        json_object_set_number(itemObject, "min", s.percentile(0.0, scale));
+        json_object_set_number(itemObject, "p50", s.percentile(0.5, scale));
+        json_object_set_number(itemObject, "p95", s.percentile(0.95, scale));
+        json_object_set_number(itemObject, "max", s.percentile(1.0, scale));
+        json_object_set_number(itemObject, "calls", nanoem_f64_t(s.m_numCalls));
+        json_array_append_value(json_array(stages), item);
+    }
+    json_object_set_value(object, "stages", stages);
+    json_object_set_string(object, "unit", "ms");
+    if (json_serialize_to_file_pretty(root, path) != JSONSuccess) {
+        fprintf(stderr, "Cannot write %s\n", path);
+    }
+    json_value_free(root);
+}
+
+static int
+run(const bx::CommandLine &command, Project *project, IFileManager *fileManager)
+{
+    benchmark::SceneDescription desc;
+    const char *projectPath = command.findOption("project"), *modelPath = command.findOption("model"),
+               *motionPath = command.findOption("motion");
+    const bool hasAnyAsset = projectPath || modelPath;
+    desc.m_numModels = findUInt32Option(command, "models", hasAnyAsset ? 0 : 1);
+    desc.m_numBones = findUInt32Option(command, "bones", desc.m_numBones);
+    desc.m_numBonesPerChain = glm::max(findUInt32Option(command, "chain", desc.m_numBonesPerChain), 1u);
+    desc.m_numVerticesPerBone = findUInt32Option(command, "vertices", desc.m_numVerticesPerBone);
+    desc.m_numKeyframes = findUInt32Option(command, "keyframes", desc.m_numKeyframes);
+    desc.m_duration = findUInt32Option(command, "duration", desc.m_duration);
+    desc.m_constraintEnabled = !command.hasArg("no-constraint");
+    desc.m_physicsEnabled = !command.hasArg("no-physics");
+    if (!loadFile(projectPath, IFileManager::kDialogTypeOpenProject, project, fileManager) ||
+        !loadFile(modelPath, IFileManager::kDialogTypeLoadModelFile, project, fileManager) ||
+        !loadFile(motionPath, IFileManager::kDialogTypeOpenModelMotionFile, project, fileManager) ||
+        !generateScene(desc, project)) {
+        return 1;
+    }
+    project->setPhysicsSimulationMode(desc.m_physicsEnabled ? PhysicsEngine::kSimulationModeEnableTracing
+                                                            : PhysicsEngine::kSimulationModeDisable);
+    project->restart();
+    const nanoem_frame_index_t from = findUInt32Option(command, "from", 0),
+                               to = findUInt32Option(command, "to", glm::max(project->duration(), desc.m_duration));
+    const nanoem_u32_t numIterations = findUInt32Option(command, "iterations", 1),
+                       numWarmupIterations = findUInt32Option(command, "warmup", 1);
+    Profiler *profiler = Profiler::sharedInstance();
+    Statistics statistics[kNumStages];
+    EventList events(Profiler::kMaxNumEvents);
+    nanoem_u64_t numDroppedEvents = 0;
+    nanoem_rsize_t numFrames = 0;
+    profiler->setEnabled(true);
+    for (nanoem_u32_t i = 0; i < numWarmupIterations + numIterations; i++) {
+        const bool measuring = i >= numWarmupIterations;
+        for (nanoem_frame_index_t frameIndex = from; frameIndex <= to; frameIndex++) {
+            profiler->reset();
+            const nanoem_u64_t begin = bx::getHPCounter();
+            project->seek(frameIndex, true);
+            project->update();
+            project->drawShadowMap();
+            project->drawViewport();
+            project->flushAllCommandBuffers();
+            const nanoem_u64_t end = bx::getHPCounter();
+            if (measuring) {
+                collectAllEvents(profiler, events, statistics);
+                statistics[kFrameStageIndex].m_ticks.push_back(end - begin);
+                statistics[kFrameStageIndex].m_numCalls++;
+                numDroppedEvents += profiler->numDroppedEvents();
+                numFrames++;
+            }
+        }
+    }
+    profiler->setEnabled(false);
+    for (nanoem_rsize_t i = 0; i < kNumStages; i++) {
+        TickList &ticks = statistics[i].m_ticks;
+        std::sort(ticks.begin(), ticks.end());
+    }
+    const nanoem_f64_t scale = 1000.0 / nanoem_f64_t(bx::getHPFrequency());
+    printf("models=%d frames=%u-%u iterations=%u\n", int(project->allModels()->size()), from, to, numIterations);
+    printAllStatistics(statistics, numFrames, scale);
+    if (numDroppedEvents > 0) {
+        printf("%llu profiler events are dropped\n", static_cast<unsigned long long>(numDroppedEvents));
+    }
+    if (const char *jsonPath = command.findOption("json")) {
+        saveAllStatistics(jsonPath, desc, project, statistics, numFrames, numDroppedEvents, scale);
+    }
+    return 0;
+}
+
+} /* namespace anonymous */
+
+int
+main(int argc, char *argv[])
+{
+    bx::CommandLine command(argc, argv);
+    if (command.hasArg('h', "help")) {
+        printf("usage: nanoem_benchmark [--project path] [--model path] [--motion path] [--models N] [--bones M]\n"
+               "                        [--keyframes K] [--chain L] [--vertices V] [--duration D] [--no-constraint]\n"
+               "                        [--no-physics] [--from F] [--to T] [--iterations I] [--warmup W]\n"
+               "                        [--physics-plugin path] [--sokol path] [--json path]\n");
+        return 0;
+    }
+    Allocator::initialize();
+    ThreadedApplicationService::setup();
+    int result = 1;
+    void *dllHandle = sg::openSharedLibrary(command.findOption("sokol", NANOEM_BENCHMARK_SOKOL_PATH));
+    if (dllHandle) {
+        sg_desc desc = {};
+        desc.buffer_pool_size = 1024u;
+        desc.image_pool_size = 4096u;
+        desc.shader_pool_size = 1024u;
+        desc.pipeline_pool_size = 1024u;
+        desc.pass_pool_size = 512u;
+        sg::setup(&desc);
+        JSON_Value *root = json_value_init_object();
+        json_object_dotset_string(json_object(root), "plugin.effect.path", "");
+        {
+            const Vector2UI16 windowSize(960, 480);
+            ThreadedApplicationService service(root);
+            internal::StubEventPublisher publisher;
+            service.setEventPublisher(&publisher);
+            service.initialize(1.0f, 1.0f);
+            Project *project = service.createProject(
+                windowSize, SG_PIXELFORMAT_RGBA8, 1.0f, 1.0f, command.findOption("physics-plugin"));
+            project->setUniformedViewportImageSizeEnabled(false);
+            project->setViewportPixelFormat(SG_PIXELFORMAT_BGRA8);
+            project->resizeUniformedViewportLayout(Vector4UI16(0, 0, windowSize));
+            project->resizeUniformedViewportImage(windowSize);
+            project->resizeWindowSize(windowSize);
+            project->resetAllPasses();
+            result = run(command, project, service.fileManager());
+            service.destroyProject(project);
+            service.destroy();
+        }
+        json_value_free(root);
+        sg::shutdown();
+        sg::closeSharedLibrary(dllHandle);
+    }
+    else {
+        fprintf(stderr, "Cannot load the sokol dummy backend\n");
+    }
+    ThreadedApplicationService::terminate();
+    Allocator::destroy();
+    return result;
+}
@@ -187,6 +187,33 @@ sgx_update_buffer(sg_buffer buf, const void *data_ptr, int data_size)
     sg_update_buffer(buf, &range);
 }
 
+/* overwrites the part of the currently active slot without rotating slots, returns false if not supported */
+SGX_API_DECL bool APIENTRY
+sgx_update_buffer_range(sg_buffer buf, int offset, const void *data_ptr, int data_size)
+{
+    bool result = false;
+#if defined(SOKOL_GLCORE33) || defined(SOKOL_GLES2) || defined(SOKOL_GLES3)
+    _sg_buffer_t *ptr = _sg_lookup_buffer(&_sg.pools, buf.id);
+    if (ptr && ptr->cmn.usage != SG_USAGE_IMMUTABLE && offset >= 0 && data_size > 0 &&
+        offset + data_size <= ptr->cmn.size) {
+        GLenum target = _sg_gl_buffer_target(ptr->cmn.type);
+        GLuint id = ptr->gl.buf[ptr->cmn.active_slot];
+        _sg_gl_cache_store_buffer_binding(target);
+        _sg_gl_cache_bind_buffer(target, id);
+        glBufferSubData(target, (GLintptr) offset, (GLsizeiptr) data_size, data_ptr);
+        _sg_gl_cache_restore_buffer_binding(target);
+        _SG_GL_CHECK_ERROR();
+        result = true;
+    }
+#else
+    _SOKOL_UNUSED(buf);
+    _SOKOL_UNUSED(offset);
+    _SOKOL_UNUSED(data_ptr);
+    _SOKOL_UNUSED(data_size);
+#endif /* SOKOL_GLCORE33 || SOKOL_GLES2 || SOKOL_GLES3 */
+    return result;
+}
+
 SGX_API_DECL void APIENTRY
 sgx_update_image(sg_image img, const sg_image_data *data)
 {
@@ -30,6 +30,8 @@ public:
     static const int kGFXPassPoolSizeDefaultValue;
     static const int kGFXPipelinePoolSizeDefaultValue;
     static const int kGFXUniformBufferSizeDefaultValue;
+    static const int kRedoLogSyncIntervalDefaultValue;
+    static const int kPhysicsSimulationMaxSubStepsDefaultValue;
 
     ApplicationPreference(BaseApplicationService *application);
     ~ApplicationPreference();
@@ -39,6 +41,8 @@ public:
     void setRendererBackend(const char *value);
     const char *extraFontPath() const NANOEM_DECL_NOEXCEPT;
     void setExtraFontPath(const char *value);
+    const char *profilerTracePath() const NANOEM_DECL_NOEXCEPT;
+    void setProfilerTracePath(const char *value);
     HighDPIViewportModeType highDPIViewportMode() const NANOEM_DECL_NOEXCEPT;
     void setHighDPIViewportMode(HighDPIViewportModeType value);
     sg_pixel_format defaultColorPixelFormat() const NANOEM_DECL_NOEXCEPT;
@@ -59,6 +63,12 @@ public:
     void setGFXUniformBufferSize(int value);
     int undoSoftLimit() const NANOEM_DECL_NOEXCEPT;
     void setUndoSoftLimit(int value);
+    int redoLogSyncInterval() const NANOEM_DECL_NOEXCEPT;
+    void setRedoLogSyncInterval(int value);
+    int physicsSimulationMaxSubSteps() const NANOEM_DECL_NOEXCEPT;
+    void setPhysicsSimulationMaxSubSteps(int value);
+    bool isRedoLogCompressionEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setRedoLogCompressionEnabled(bool value);
     bool isModelEditingEnabled() const NANOEM_DECL_NOEXCEPT;
     void setModelEditingEnabled(bool value);
     bool isAnalyticsEnabled() const NANOEM_DECL_NOEXCEPT;
@@ -67,6 +77,18 @@ public:
     void setResettingAnalyticsUUIDRequired(bool value);
     bool isSkinDeformAcceleratorEnabled() const NANOEM_DECL_NOEXCEPT;
     void setSkinDeformAcceleratorEnabled(bool value);
+    bool isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setCompactVertexFormatEnabled(bool value);
+    bool isParallelMotionSynchronizationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelMotionSynchronizationEnabled(bool value);
+    bool isParallelModelLoadingEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelModelLoadingEnabled(bool value);
+    bool isParallelPhysicsSimulationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelPhysicsSimulationEnabled(bool value);
+    bool isPhysicsWorldPerModelEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setPhysicsWorldPerModelEnabled(bool value);
+    bool isBakedPoseCacheEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setBakedPoseCacheEnabled(bool value);
     bool isCrashReportEnabled() const NANOEM_DECL_NOEXCEPT;
     void setCrashReportEnabled(bool value);
     bool isEffectEnabled() const NANOEM_DECL_NOEXCEPT;
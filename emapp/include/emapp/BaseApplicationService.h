@@ -420,6 +420,7 @@ private:
     void sendQueryEventMessage(Nanoem__Application__Event *event, const Nanoem__Application__Command *command);
     void sendSaveAfterConfirmEventMessage();
     void sendDiscardAfterConfirmEventMessage();
+    void saveProfilerTrace();
 
     const JSON_Value *m_applicationConfiguration;
     DefaultFileManager *m_defaultFileManager;
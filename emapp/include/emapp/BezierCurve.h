@@ -28,6 +28,8 @@ public:
     Vector2U8 c1() const NANOEM_DECL_NOEXCEPT;
 
     static nanoem_u64_t toHash(const nanoem_u8_t *parameters, nanoem_frame_index_t interval) NANOEM_DECL_NOEXCEPT;
+    static nanoem_f32_t solve(const nanoem_u8_t *parameters, nanoem_f32_t value) NANOEM_DECL_NOEXCEPT;
+    static Vector4 solve(const nanoem_u8_t *const *parameters, const Vector4 &value) NANOEM_DECL_NOEXCEPT;
 
 private:
     typedef tinystl::vector<Vector2, nanoem::TinySTLAllocator> PointList;
@@ -44,7 +46,6 @@ private:
     static void splitBezierCurve(const PointList &points, nanoem_f32_t t, PointList &left, PointList &right);
     static const Vector2 kP0;
     static const Vector2 kP1;
-    PointList m_parameters;
     Vector2U8 m_c0;
     Vector2U8 m_c1;
     nanoem_frame_index_t m_interval;
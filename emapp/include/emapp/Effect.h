@@ -335,8 +335,8 @@ private:
         const IDrawable *drawable) const;
     effect::Technique *internalFindTechnique(const String &passType, nanoem_rsize_t numMaterials,
         nanoem_rsize_t materialIndex, const nanodxm_material_t *material, Accessory *accessory);
-    effect::Technique *internalFindTechnique(
-        const String &passType, nanoem_rsize_t numMaterials, const nanoem_model_material_t *material);
+    effect::Technique *internalFindTechnique(const String &passType, nanoem_rsize_t numMaterials,
+        const nanoem_model_material_t *material, const Model *model);
     ImageResourceParameter createImageResourceParameter(const effect::TypedSemanticParameter &parameter) const;
     ImageResourceParameter createImageResourceParameter(
         const effect::TypedSemanticParameter &parameter, const URI &fileURI, const String &filename) const;
@@ -44,6 +44,8 @@ public:
     }
     virtual bool open(const URI &fileURI, Error &error) = 0;
     virtual bool close(Error &error) = 0;
+    /* waits until all written data reaches to the storage device */
+    virtual bool flush(Error &error) = 0;
     virtual URI fileURI() const = 0;
 };
 
@@ -111,6 +113,30 @@ private:
     nanoem_i64_t m_offset;
 };
 
+class MappedFileReader NANOEM_DECL_SEALED : public IFileReader, private NonCopyable {
+public:
+    MappedFileReader(const ITranslator *translator);
+    ~MappedFileReader() NANOEM_DECL_NOEXCEPT;
+
+    bool open(const URI &fileURI, Error &error) NANOEM_DECL_OVERRIDE;
+    bool close(Error &error) NANOEM_DECL_OVERRIDE;
+    nanoem_i32_t read(void *data, nanoem_i32_t size, Error &error) NANOEM_DECL_OVERRIDE;
+    nanoem_rsize_t size() NANOEM_DECL_OVERRIDE;
+    nanoem_i64_t seek(nanoem_i64_t offset, SeekType whence, Error &error) NANOEM_DECL_OVERRIDE;
+    URI fileURI() const NANOEM_DECL_OVERRIDE;
+
+    const nanoem_u8_t *bytes() const NANOEM_DECL_NOEXCEPT;
+    bool isMapped() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    IFileReader *m_reader;
+    URI m_fileURI;
+    ByteArray m_fallbackBytes;
+    void *m_address;
+    nanoem_rsize_t m_size;
+    nanoem_i64_t m_offset;
+};
+
 class MemoryWriter NANOEM_DECL_SEALED : public ISeekableWriter, private NonCopyable {
 public:
     MemoryWriter(ByteArray *bytes);
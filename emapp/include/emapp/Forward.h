@@ -1153,6 +1153,8 @@ typedef void(APIENTRY *PFN_sgx_shutdown)(void);
 extern PFN_sgx_shutdown shutdown;
 typedef void(APIENTRY *PFN_sgx_update_buffer)(sg_buffer buf, const void *data_ptr, int data_size);
 extern PFN_sgx_update_buffer update_buffer;
+typedef bool(APIENTRY *PFN_sgx_update_buffer_range)(sg_buffer buf, int offset, const void *data_ptr, int data_size);
+extern PFN_sgx_update_buffer_range update_buffer_range;
 typedef void(APIENTRY *PFN_sgx_update_image)(sg_image img, const sg_image_data *data);
 extern PFN_sgx_update_image update_image;
 typedef void(APIENTRY *PFN_sg_dealloc_buffer)(sg_buffer buf_id);
@@ -52,7 +52,10 @@ namespace model {
 struct BindPose;
 class IGizmo;
 class IVertexWeightPainter;
+class BoneTransformSchedule;
+class DirtyVertexTracker;
 class ISkinDeformer;
+class SkinningBatch;
 } /* namespace model */
 
 class Model NANOEM_DECL_SEALED : public IDrawable, private NonCopyable {
@@ -95,6 +98,8 @@ public:
     };
     typedef void (*UserDataDestructor)(void *userData, const Model *model);
     typedef tinystl::pair<void *, UserDataDestructor> UserData;
+    typedef tinystl::vector<model::Bone::Pose, TinySTLAllocator> BonePoseList;
+    typedef tinystl::vector<nanoem_f32_t, TinySTLAllocator> MorphWeightList;
     BX_ALIGN_DECL_16(struct)
     VertexUnit
     {
@@ -130,6 +135,17 @@ public:
         static void performSkinningByType(const model::Vertex *vertex, bx::simd128_t *p, bx::simd128_t *n)
             NANOEM_DECL_NOEXCEPT;
     };
+    /* opt-in GPU vertex layout that drops data only used by the skin deformer, followed by used UVA channels */
+    struct CompactVertexUnit {
+        nanoem_f32_t m_position[3];
+        nanoem_u32_t m_zero; /* bound as additional UV channels not used by the model */
+        nanoem_i16_t m_normal[4];
+        nanoem_f32_t m_texcoord[2];
+        nanoem_f32_t m_edge[3];
+        nanoem_f32_t m_info[4];
+        static nanoem_rsize_t size(nanoem_rsize_t numUVAs) NANOEM_DECL_NOEXCEPT;
+        static void pack(const VertexUnit &unit, nanoem_rsize_t numUVAs, nanoem_u8_t *ptr) NANOEM_DECL_NOEXCEPT;
+    };
     struct NewModelDescription {
         String m_name[NANOEM_LANGUAGE_TYPE_MAX_ENUM];
         String m_comment[NANOEM_LANGUAGE_TYPE_MAX_ENUM];
@@ -162,8 +178,6 @@ public:
     static StringSet loadableExtensionsSet();
     static bool isLoadableExtension(const String &extension);
     static bool isLoadableExtension(const URI &fileURI);
-    static void setStandardPipelineDescription(sg_pipeline_desc &desc);
-    static void setEdgePipelineDescription(sg_pipeline_desc &desc);
     static void generateNewModelData(const NewModelDescription &desc, nanoem_unicode_string_factory_t *factory,
         ByteArray &bytes, nanoem_status_t &status);
 
@@ -203,6 +217,12 @@ public:
     void destroy();
     void synchronizeMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
         PhysicsEngine::SimulationTimingType timing);
+    void synchronizeModelMotion(
+        const Motion *motion, nanoem_frame_index_t frameIndex, PhysicsEngine::SimulationTimingType timing);
+    void synchronizeTransformMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
+        PhysicsEngine::SimulationTimingType timing);
+    void synchronizeRigidBodyMotion(
+        const Motion *motion, nanoem_frame_index_t frameIndex, PhysicsEngine::SimulationTimingType timing);
     void synchronizeAllRigidBodiesTransformFeedbackFromSimulation(PhysicsEngine::RigidBodyFollowBoneType followType);
     void synchronizeAllRigidBodiesTransformFeedbackToSimulation();
     void rebuildAllVertexBuffers(bool enableSkinFactory);
@@ -211,9 +231,16 @@ public:
     void performAllBonesTransform();
     void resetAllMorphDeformStates();
     void deformAllMorphs(bool checkDirty);
+    void saveBakedPose(BonePoseList &bonePoses, MorphWeightList &morphWeights) const;
+    bool restoreBakedPose(const BonePoseList &bonePoses, const MorphWeightList &morphWeights);
     bool isStagingVertexBufferDirty() const NANOEM_DECL_NOEXCEPT;
     void markStagingVertexBufferDirty();
     void updateStagingVertexBuffer();
+    nanoem_rsize_t uploadedVertexBufferBytes() const NANOEM_DECL_NOEXCEPT;
+    void setStandardPipelineDescription(sg_pipeline_desc &desc) const;
+    void setEdgePipelineDescription(sg_pipeline_desc &desc) const;
+    nanoem_rsize_t vertexUnitSize() const NANOEM_DECL_NOEXCEPT;
+    bool isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT;
     void resetLanguage();
     void registerUpdateActiveBoneTransformCommand(const Vector3 &translation, const Quaternion &orientation);
     void registerResetBoneSetTransformCommand(
@@ -448,11 +475,16 @@ private:
         const IDrawable::DrawType m_drawType;
         const nanoem_f32_t m_edgeSizeScaleFactor;
         model::Material::BoneIndexHashMap *m_boneIndices;
+        const model::DirtyVertexTracker *m_dirtyVertexTracker;
         nanoem_u8_t *m_output;
         nanoem_model_material_t *const *m_materials;
         nanoem_model_vertex_t *const *m_vertices;
         nanoem_rsize_t m_numVertices;
     };
+    struct ParallelBoneTransformTaskData {
+        const Model *m_model;
+        const nanoem_model_bone_t *const *m_bones;
+    };
     struct DrawArrayBuffer {
         DrawArrayBuffer();
         ~DrawArrayBuffer() NANOEM_DECL_NOEXCEPT;
@@ -490,11 +522,18 @@ private:
         BoneBoundRigidBodyMap;
     typedef tinystl::unordered_map<const nanoem_model_bone_t *, const nanoem_model_constraint_t *, TinySTLAllocator>
         ResolveConstraintJointParentMap;
-    typedef void (*DispatchParallelTasksIterator)(void *, size_t);
+    typedef void (*DispatchParallelTasksIterator)(void *, nanoem_rsize_t, nanoem_rsize_t);
 
     static int compareBoneVertexList(const void *a, const void *b);
-    static void handlePerformSkinningVertexTransform(void *opaque, size_t index);
-    static void setCommonPipelineDescription(sg_pipeline_desc &desc);
+    static void performSkinningVertexTransform(const ParallelSkinningTaskData *s, nanoem_rsize_t index);
+    static void handlePerformSkinningVertexTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static void handlePerformSkinningBatchTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static void handlePerformSkinningFallbackVertexTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static void handlePackCompactVertexBuffer(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static void handleApplyAllBonesTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static void handleDispatchParallelLoadingTasks(void *userData, DispatchParallelTasksIterator iterator, void *opaque,
+        nanoem_rsize_t iterations, nanoem_rsize_t grainSize);
+    void setCommonPipelineDescription(sg_pipeline_desc &desc) const;
 
     const IEffect *activeEffect(const model::Material *material) const NANOEM_DECL_NOEXCEPT;
     IEffect *activeEffect(model::Material *material);
@@ -508,26 +547,31 @@ private:
     void splitBonesPerMaterial(model::Material::BoneIndexHashMap &boneIndexHash) const;
     void bindConstraint(nanoem_model_constraint_t *constraintPtr);
     void applyAllBonesTransform(PhysicsEngine::SimulationTimingType timing);
+    void internalApplyAllBonesTransform(PhysicsEngine::SimulationTimingType timing);
+    bool isBoneTransformSchedulable() const NANOEM_DECL_NOEXCEPT;
     void internalClear();
     void internalSetOutsideParent(const nanoem_model_bone_t *key, const StringPair &value);
     void initializeAllStagingVertexBuffers();
     void initializeStagingIndexBuffer();
     void initializeVertexBufferByteArray();
     void createAllStagingVertexBuffers();
-    void internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVertices);
+    void internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVertices, bool trackDirtyVertices);
+    void performAllSkinningVertexTransforms(nanoem_u8_t *ptr, nanoem_rsize_t numVertices, bool trackDirtyVertices);
+    nanoem_rsize_t uploadStagingVertexBuffer(sg_buffer buffer);
+    void packCompactVertexBuffer(nanoem_rsize_t begin, nanoem_rsize_t end);
     void clearAllLoadingImageItems();
     void setAllPhysicsObjectsEnabled(bool value);
     void predeformMorph(const nanoem_model_morph_t *morphPtr);
     void deformMorph(const nanoem_model_morph_t *morphPtr, bool checkDirty);
-    void solveConstraint(
-        const nanoem_model_constraint_t *constraintPtr, int numIterations, nanoem_unicode_string_factory_t *factory);
+    void solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIterations);
     void synchronizeBoneMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
         PhysicsEngine::SimulationTimingType timing);
     void synchronizeMorphMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount);
     void synchronizeAllConstraintStates(const nanoem_motion_model_keyframe_t *keyframe);
     void synchronizeAllOutsideParents(const nanoem_motion_model_keyframe_t *keyframe);
     void synchronizeAllRigidBodyKinematics(const Motion *motion, nanoem_frame_index_t frameIndex);
-    void dispatchParallelTasks(DispatchParallelTasksIterator iterator, void *opaque, size_t iterations);
+    void dispatchParallelTasks(
+        DispatchParallelTasksIterator iterator, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grainSize);
     bool saveAllAttachments(
         const String &prefix, const FileEntityMap &allAttachments, Archiver &archiver, Error &error);
     bool getVertexIndexBuffer(const model::Material *material, IPass::Buffer &buffer) const NANOEM_DECL_NOEXCEPT;
@@ -560,6 +604,9 @@ private:
     IModelObjectSelection *m_selection;
     internal::LineDrawer *m_drawer;
     model::ISkinDeformer *m_skinDeformer;
+    model::SkinningBatch *m_skinningBatch;
+    model::BoneTransformSchedule *m_boneTransformSchedule;
+    model::DirtyVertexTracker *m_dirtyVertexTracker;
     model::IGizmo *m_gizmo;
     model::IVertexWeightPainter *m_vertexWeightPainter;
     OffscreenPassiveRenderTargetEffectMap m_offscreenPassiveRenderTargetEffects;
@@ -577,6 +624,7 @@ private:
     const nanoem_model_material_t *m_activeMaterialPtr;
     const nanoem_model_bone_t *m_hoveredBonePtr;
     ByteArray m_vertexBufferData;
+    ByteArray m_compactVertexBufferData;
     VertexIndexList m_faceStates;
     tinystl::pair<const nanoem_model_bone_t *, const nanoem_model_bone_t *> m_activeBonePairPtr;
     tinystl::pair<IEffect *, IEffect *> m_activeEffectPtrPair;
@@ -614,9 +662,10 @@ private:
     nanoem_u32_t m_states;
     nanoem_f32_t m_edgeSizeScaleFactor;
     nanoem_f32_t m_opacity;
-    void *m_dispatchParallelTaskQueue;
     mutable int m_countVertexSkinningNeeded;
     int m_stageVertexBufferIndex;
+    nanoem_rsize_t m_uploadedVertexBufferBytes;
+    nanoem_rsize_t m_numCompactVertexUVAs;
 };
 
 } /* namespace nanoem */
@@ -186,12 +186,16 @@ public:
         nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_bone_keyframe_t *findBoneKeyframe(
         const nanoem_unicode_string_t *name, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    const nanoem_motion_bone_keyframe_t *findBoneKeyframe(
+        nanoem_motion_track_handle_t handle, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_camera_keyframe_t *findCameraKeyframe(
         nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_light_keyframe_t *findLightKeyframe(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_model_keyframe_t *findModelKeyframe(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_morph_keyframe_t *findMorphKeyframe(
         const nanoem_unicode_string_t *name, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    const nanoem_motion_morph_keyframe_t *findMorphKeyframe(
+        nanoem_motion_track_handle_t handle, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     const nanoem_motion_self_shadow_keyframe_t *findSelfShadowKeyframe(
         nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
     nanoem_rsize_t countAllKeyframes() const NANOEM_DECL_NOEXCEPT;
@@ -212,6 +216,7 @@ public:
     URI fileURI() const;
     void setFileURI(const URI &value);
     nanoem_u16_t handle() const NANOEM_DECL_NOEXCEPT;
+    nanoem_u64_t trackRevision() const NANOEM_DECL_NOEXCEPT;
     bool isDirty() const NANOEM_DECL_NOEXCEPT;
     void setDirty(bool value);
 
@@ -227,12 +232,12 @@ public:
         const nanoem_motion_model_keyframe_t *next, nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
     static nanoem_f32_t coefficient(const nanoem_motion_morph_keyframe_t *prev,
         const nanoem_motion_morph_keyframe_t *next, nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
-    nanoem_f32_t bezierCurve(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
-        nanoem_motion_bone_keyframe_interpolation_type_t index, nanoem_f32_t value) const;
+    static nanoem_f32_t bezierCurve(const nanoem_motion_bone_keyframe_t *prev,
+        const nanoem_motion_bone_keyframe_t *next, nanoem_motion_bone_keyframe_interpolation_type_t index,
+        nanoem_f32_t value) NANOEM_DECL_NOEXCEPT;
+    static Vector4 bezierCurves(const nanoem_motion_bone_keyframe_t *next, nanoem_f32_t value) NANOEM_DECL_NOEXCEPT;
 
 private:
-    typedef tinystl::unordered_map<const nanoem_motion_bone_keyframe_t *, BezierCurve *, TinySTLAllocator>
-        KeyframeBezierCurveMap;
     static nanoem_f32_t coefficient(nanoem_frame_index_t prevFrameIndex, nanoem_frame_index_t nextFrameIndex,
         nanoem_frame_index_t frameIndex) NANOEM_DECL_NOEXCEPT;
     static void copyAccessoryOutsideParent(const nanoem_motion_accessory_keyframe_t *keyframe,
@@ -244,16 +249,16 @@ private:
     void internalWriteLoadCommandMessage(nanoem_u32_t type, nanoem_u16_t handle, const URI &fileURI, Error &error);
     bool internalSave(nanoem_mutable_motion_t *mutableMotion, IWriter *bytes, Error &error) const;
     void internalMergeAllKeyframes(const Motion *source, bool _override, bool reverse);
+    void renewTrackEpoch() NANOEM_DECL_NOEXCEPT;
 
     Project *m_project;
     IMotionKeyframeSelection *m_selection;
     nanoem_motion_t *m_opaque;
-    mutable BezierCurve::Map m_bezierCurvesData;
-    mutable KeyframeBezierCurveMap m_keyframeBezierCurves;
     StringMap m_annotations;
     URI m_fileURI;
     nanoem_motion_format_type_t m_formatType;
     nanoem_u16_t m_handle;
+    nanoem_u32_t m_trackEpoch;
     bool m_dirty;
 };
 
@@ -69,6 +69,13 @@ public:
     const nanoem_physics_world_t *worldOpaque() const NANOEM_DECL_NOEXCEPT;
     nanoem_physics_world_t *worldOpaque();
 
+    /* an island is a separate world of the model that is stepped and configured along with its parent */
+    PhysicsEngine *createIsland(const nanoem_model_t *model, nanoem_status_t &status);
+    void destroyIsland(const nanoem_model_t *model) NANOEM_DECL_NOEXCEPT;
+    const PhysicsEngine *findIsland(const nanoem_model_t *model) const NANOEM_DECL_NOEXCEPT;
+    PhysicsEngine *findIsland(const nanoem_model_t *model) NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t countAllIslands() const NANOEM_DECL_NOEXCEPT;
+
     nanoem_physics_rigid_body_t *createRigidBody(const nanoem_model_rigid_body_t *value, nanoem_status_t &status);
     nanoem_physics_motion_state_t *motionState(const nanoem_physics_rigid_body_t *value);
     void getWorldTransform(const nanoem_physics_rigid_body_t *body, nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT;
@@ -139,6 +146,19 @@ public:
     void setActive(bool value);
     bool isGroundEnabled() const NANOEM_DECL_NOEXCEPT;
     void setGroundEnabled(bool value);
+    bool isParallelSimulationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelSimulationEnabled(bool value);
+    int maxSubSteps() const NANOEM_DECL_NOEXCEPT;
+    void setMaxSubSteps(int value);
+    bool isInterpolationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setInterpolationEnabled(bool value);
+    /* both counters are of the last step and the largest one is taken among the world and its islands */
+    int numSteps() const NANOEM_DECL_NOEXCEPT;
+    int numDroppedSteps() const NANOEM_DECL_NOEXCEPT;
+    /* states of the world and its islands are saved and restored together */
+    nanoem_rsize_t stateSize() const NANOEM_DECL_NOEXCEPT;
+    void saveState(ByteArray &bytes, nanoem_status_t &status) const;
+    void restoreState(const ByteArray &bytes, nanoem_status_t &status);
 
 private:
     struct PrivateContext;
@@ -0,0 +1,79 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_PROFILER_H_
+#define NANOEM_EMAPP_PROFILER_H_
+
+#include "emapp/Forward.h"
+
+#include "bx/macros.h"
+#include "bx/thread.h"
+
+namespace nanoem {
+
+class Profiler NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_u32_t kMaxNumThreads = 32;
+    static const nanoem_u32_t kMaxNumEvents = 4096;
+
+    struct Event {
+        const char *m_name;
+        nanoem_u64_t m_begin;
+        nanoem_u64_t m_end;
+    };
+    class Scope NANOEM_DECL_SEALED : private NonCopyable {
+    public:
+        explicit Scope(const char *name);
+        Scope(Profiler *profiler, const char *name);
+        ~Scope() NANOEM_DECL_NOEXCEPT;
+
+    private:
+        Profiler *m_profiler;
+        const char *m_name;
+        nanoem_u64_t m_begin;
+    };
+
+    static Profiler *sharedInstance();
+
+    Profiler();
+    ~Profiler() NANOEM_DECL_NOEXCEPT;
+
+    void record(const char *name, nanoem_u64_t begin, nanoem_u64_t end) NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t copyAllEvents(nanoem_u32_t threadIndex, Event *events, nanoem_rsize_t capacity) const;
+    void save(ByteArray &bytes) const;
+    void reset() NANOEM_DECL_NOEXCEPT;
+
+    nanoem_u32_t numThreads() const NANOEM_DECL_NOEXCEPT;
+    nanoem_u64_t numDroppedEvents() const NANOEM_DECL_NOEXCEPT;
+    bool isEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setEnabled(bool value);
+
+private:
+    /* each ring is written only by its owner thread and read by the exporter without any lock */
+    struct Ring {
+        Event m_events[kMaxNumEvents];
+        volatile nanoem_u32_t m_next;
+        volatile nanoem_u32_t m_head;
+        volatile nanoem_u32_t m_tail;
+        nanoem_u8_t m_padding[52];
+    };
+    Ring *currentRing() NANOEM_DECL_NOEXCEPT;
+
+    /* fixed size storage is used since the shared instance may outlive the allocator */
+    Ring m_rings[kMaxNumThreads];
+    bx::TlsData m_ringIndex;
+    volatile nanoem_u32_t m_numRings;
+    volatile nanoem_u32_t m_numDroppedThreadEvents;
+    nanoem_u64_t m_origin;
+    volatile bool m_enabled;
+};
+
+} /* namespace nanoem */
+
+#define NANOEM_PROFILER_SCOPE(name) nanoem::Profiler::Scope BX_CONCATENATE(__nanoem_profiler_scope_, __LINE__)(name)
+
+#endif /* NANOEM_EMAPP_PROFILER_H_ */
@@ -80,6 +80,11 @@ namespace internal {
 class BlitPass;
 class ClearPass;
 class DebugDrawer;
+namespace project {
+class BakedPoseCache;
+class PhysicsCheckpointCache;
+class RedoLogWriter;
+} /* namespace project */
 } /* namespace internal */
 
 class Project NANOEM_DECL_SEALED : private NonCopyable {
@@ -335,6 +340,7 @@ public:
     void writeRedoMessage();
     void writeRedoMessage(const Nanoem__Application__Command *command, Error &error);
     void setWritingRedoMessageDisabled(bool value);
+    void flushRedoMessages();
     Vector4UI16 queryDevicePixelRectangle(RectangleType type, const Vector2UI16 &offset) const NANOEM_DECL_NOEXCEPT;
     Vector4UI16 queryLogicalPixelRectangle(RectangleType type, const Vector2UI16 &offset) const NANOEM_DECL_NOEXCEPT;
     bool intersectsTransformHandle(const Vector2SI32 &position, RectangleType &type) const NANOEM_DECL_NOEXCEPT;
@@ -541,6 +547,9 @@ public:
     undo_stack_t *activeUndoStack() NANOEM_DECL_NOEXCEPT;
     const undo_stack_t *undoStack() const NANOEM_DECL_NOEXCEPT;
     undo_stack_t *undoStack() NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t undoMemoryUsage() const NANOEM_DECL_NOEXCEPT;
+    void increaseUndoMemoryUsage(nanoem_rsize_t value);
+    void decreaseUndoMemoryUsage(nanoem_rsize_t value);
     URI fileURI() const;
     void setFileURI(const URI &value);
     FileUtils::TransientPath transientPath() const;
@@ -553,6 +562,10 @@ public:
     void clearAllIndicesOfMaterialToAttachEffect(nanoem_u16_t handle);
     URI redoFileURI() const;
     void setRedoFileURI(const URI &value);
+    nanoem_u32_t redoLogSyncInterval() const NANOEM_DECL_NOEXCEPT;
+    void setRedoLogSyncInterval(nanoem_u32_t value);
+    bool isRedoLogCompressionEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setRedoLogCompressionEnabled(bool value);
     Vector4SI32 backgroundVideoRect() const NANOEM_DECL_NOEXCEPT;
     void setBackgroundVideoRect(const Vector4SI32 &value);
     Vector2SI32 deviceScaleMovingCursorPosition() const NANOEM_DECL_NOEXCEPT;
@@ -597,6 +610,7 @@ public:
     void setCameraKeyframeInterpolationType(nanoem_motion_camera_keyframe_interpolation_type_t value);
     IDrawable::DrawType drawType() const NANOEM_DECL_NOEXCEPT;
     void setDrawType(IDrawable::DrawType value);
+    nanoem_rsize_t uploadedVertexBufferBytes() const NANOEM_DECL_NOEXCEPT;
     sg_pass registerRenderPass(const sg_pass_desc &desc, const PixelFormat &format);
     sg_pass registerOffscreenRenderPass(const Effect *ownerEffect, const effect::OffscreenRenderTargetOption &option);
     void overrideOffscreenRenderPass(const sg_pass_desc &desc, const PixelFormat &format);
@@ -702,6 +716,26 @@ public:
     void setEffectPluginEnabled(bool value);
     bool isCompiledEffectCacheEnabled() const NANOEM_DECL_NOEXCEPT;
     void setCompiledEffectCacheEnabled(bool value);
+    bool isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setCompactVertexFormatEnabled(bool value);
+    bool isParallelMotionSynchronizationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelMotionSynchronizationEnabled(bool value);
+    bool isParallelModelLoadingEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelModelLoadingEnabled(bool value);
+    bool isParallelPhysicsSimulationEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setParallelPhysicsSimulationEnabled(bool value);
+    bool isPhysicsWorldPerModelEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setPhysicsWorldPerModelEnabled(bool value);
+    int physicsSimulationMaxSubSteps() const NANOEM_DECL_NOEXCEPT;
+    void setPhysicsSimulationMaxSubSteps(int value);
+    bool isPhysicsCheckpointCacheEnabled() const NANOEM_DECL_NOEXCEPT;
+    const internal::project::PhysicsCheckpointCache *physicsCheckpointCache() const NANOEM_DECL_NOEXCEPT;
+    void clearAllPhysicsCheckpoints();
+    bool isBakedPoseCacheEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setBakedPoseCacheEnabled(bool value);
+    const internal::project::BakedPoseCache *bakedPoseCache() const NANOEM_DECL_NOEXCEPT;
+    void clearBakedPoses(const Model *model);
+    void clearAllBakedPoses();
     bool isViewportCaptured() const NANOEM_DECL_NOEXCEPT;
     void setViewportCaptured(bool value);
     bool isViewportHovered() const NANOEM_DECL_NOEXCEPT;
@@ -841,11 +875,20 @@ private:
     void internalSeek(nanoem_frame_index_t frameIndex);
     void internalSeek(nanoem_frame_index_t frameIndex, nanoem_f32_t amount, nanoem_f32_t delta);
     void destroyDetachedEffect(Effect *effect);
+    void synchronizeAllModelMotionsInParallel(
+        nanoem_frame_index_t frameIndex, nanoem_f32_t amount, PhysicsEngine::SimulationTimingType timing);
     void synchronizeCamera(nanoem_frame_index_t frameIndex, nanoem_f32_t amount);
     void synchronizeLight(nanoem_frame_index_t frameIndex, nanoem_f32_t amount);
     void synchronizeSelfShadow(nanoem_frame_index_t frameIndex);
     void markAllModelsDirty();
     void internalPerformPhysicsSimulation(nanoem_f32_t delta);
+    bool restorePhysicsCheckpoint(nanoem_frame_index_t frameIndex, nanoem_f32_t &delta);
+    void savePhysicsCheckpoint(
+        nanoem_frame_index_t frameIndex, nanoem_frame_index_t lastFrameIndex, nanoem_f32_t amount, bool restored);
+    bool restoreAllBakedPoses(
+        nanoem_frame_index_t frameIndex, nanoem_frame_index_t lastFrameIndex, nanoem_f32_t amount);
+    void saveAllBakedPoses(nanoem_frame_index_t frameIndex, nanoem_f32_t amount);
+    void synchronizeAllStageMotions(nanoem_frame_index_t frameIndex, nanoem_f32_t amount);
     void removeDrawable(IDrawable *drawable);
     void internalResizeUniformedViewportImage(const Vector2UI16 &value);
     void internalResetAllRenderTargets(const Vector2UI16 &size);
@@ -861,6 +904,7 @@ private:
     void clearViewportPrimaryPass();
     void drawBackgroundVideo();
     void drawGrid();
+    void drawPhysicsDebugGeometries(const PhysicsEngine *engine);
     void drawViewport(IEffect::ScriptOrderType order, IDrawable::DrawType type);
     void blitRenderPass(sg::PassBlock::IDrawQueue *drawQueue, sg_pass destRenderPass, sg_pass sourceRenderPass,
         internal::BlitPass *blitter);
@@ -919,6 +963,9 @@ private:
     internal::BlitPass *m_sharedImageBlitter;
     internal::ClearPass *m_renderPassCleaner;
     internal::DebugDrawer *m_sharedDebugDrawer;
+    internal::project::RedoLogWriter *m_redoLogWriter;
+    internal::project::PhysicsCheckpointCache *m_physicsCheckpointCache;
+    internal::project::BakedPoseCache *m_bakedPoseCache;
     tinystl::pair<sg_pixel_format, sg_pixel_format> m_viewportPixelFormat;
     model::BindPose m_lastBindPose;
     model::RigidBody::VisualizationClause m_rigidBodyVisualizationClause;
@@ -987,6 +1034,8 @@ private:
     tinystl::pair<nanoem_u32_t, nanoem_u32_t> m_sampleLevel;
     nanoem_u64_t m_stateFlags;
     nanoem_u64_t m_confirmSeekFlags;
+    nanoem_rsize_t m_uploadedVertexBufferBytes;
+    nanoem_rsize_t m_undoMemoryUsage;
     nanoem_u32_t m_lastPhysicsDebugFlags;
     nanoem_u32_t m_coordinationSystem;
     nanoem_u32_t m_cursorModifiers;
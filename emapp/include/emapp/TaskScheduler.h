@@ -0,0 +1,66 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_TASKSCHEDULER_H_
+#define NANOEM_EMAPP_TASKSCHEDULER_H_
+
+#include "emapp/Forward.h"
+
+#include "bx/semaphore.h"
+#include "bx/thread.h"
+
+namespace nanoem {
+
+class TaskScheduler NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    typedef void (*RangeIterator)(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    static const nanoem_rsize_t kDefaultGrainSize;
+    static const nanoem_u32_t kMaxNumWorkers = 31;
+
+    static TaskScheduler *sharedInstance();
+    static nanoem_u32_t countAllHardwareThreads() NANOEM_DECL_NOEXCEPT;
+
+    explicit TaskScheduler(nanoem_u32_t numWorkers);
+    ~TaskScheduler() NANOEM_DECL_NOEXCEPT;
+
+    void parallelFor(RangeIterator iterator, void *opaque, nanoem_rsize_t iterations);
+    void parallelFor(RangeIterator iterator, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grainSize);
+
+    nanoem_u32_t numWorkers() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Worker {
+        TaskScheduler *m_parent;
+        bx::Thread m_thread;
+        nanoem_u32_t m_sliceIndex;
+    };
+    /* each slice is owned by one thread and padded to avoid false sharing between counters */
+    struct Slice {
+        volatile nanoem_u32_t m_next;
+        nanoem_u32_t m_end;
+        nanoem_u8_t m_padding[56];
+    };
+    static nanoem_i32_t execute(bx::Thread *thread, void *userData);
+
+    void run(nanoem_u32_t sliceIndex);
+
+    /* fixed size storage is used since the shared instance may outlive the allocator */
+    Worker m_workers[kMaxNumWorkers];
+    Slice m_slices[kMaxNumWorkers + 1];
+    nanoem_u32_t m_numWorkers;
+    bx::Semaphore m_wakeup;
+    bx::Semaphore m_done;
+    RangeIterator m_iterator;
+    void *m_opaque;
+    nanoem_u32_t m_grainSize;
+    volatile nanoem_u32_t m_busy;
+    volatile bool m_running;
+};
+
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_TASKSCHEDULER_H_ */
@@ -27,6 +27,8 @@ public:
     virtual void read(const void *messagePtr) = 0;
     virtual void write(void *messagePtr) = 0;
     virtual void release(void *messagePtr) = 0;
+    /* bytes owned by the command to be accounted as the undo stack memory usage of the project */
+    virtual nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
 
 protected:
     struct LZ4Data {
@@ -36,6 +38,7 @@ protected:
         void deflate(const nanoem_u8_t *data, size_t size);
         bool inflate(ByteArray &output) const;
         bool inflate(ProtobufCBinaryData *binary) const;
+        nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
     };
     BaseUndoCommand(Project *project);
 
@@ -45,6 +48,7 @@ protected:
     static void writeCommandMessage(void *opaque, nanoem_u32_t type, void *messagePtr);
 
 private:
+    static void invalidateAllCaches(Project *project);
     static void onUndo(const undo_command_t *command);
     static void onRedo(const undo_command_t *command);
     static int onPersistUndo(const undo_command_t *command);
@@ -52,6 +56,7 @@ private:
     static void onDestroy(const undo_command_t *command);
 
     Project *m_project;
+    nanoem_rsize_t m_memoryUsage;
 };
 
 } /* namespace command */
@@ -24,6 +24,7 @@ public:
     void undo(Error &error);
     void redo(Error &error);
     const char *name() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
 
 private:
     void execute(const LZ4Data &input, Error &error);
@@ -24,9 +24,12 @@ public:
     void undo(Error &error);
     void redo(Error &error);
     const char *name() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
 
 private:
     void execute(const LZ4Data &input, Error &error);
+    void execute(const LZ4Data &from, const LZ4Data &to, Error &error);
+    bool createDelta(const ByteArray &last);
     MotionSnapshotCommand(Project *project);
     MotionSnapshotCommand(Motion *motion, const Model *model, const ByteArray &snapshot, nanoem_u32_t types);
 
@@ -35,9 +38,14 @@ private:
     void release(void *messagePtr);
 
     Motion *m_motion;
+    const Model *m_model;
     Motion::SelectionState *m_state;
+    /* either whole motions or only changed keyframes of them are kept, first is current and second is last */
     tinystl::pair<LZ4Data, LZ4Data> m_snapshot;
+    tinystl::pair<LZ4Data, LZ4Data> m_delta;
     nanoem_u32_t m_types;
+    nanoem_motion_format_type_t m_deltaFormat;
+    bool m_deltaEnabled;
 };
 
 } /* namespace command */
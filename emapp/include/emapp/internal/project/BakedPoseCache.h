@@ -0,0 +1,71 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_PROJECT_BAKEDPOSECACHE_H_
+#define NANOEM_EMAPP_INTERNAL_PROJECT_BAKEDPOSECACHE_H_
+
+#include "emapp/Model.h"
+
+namespace nanoem {
+namespace internal {
+namespace project {
+
+/*
+ * Keeps final bone transforms and morph weights of each model per frame to skip evaluating motions on seeking.
+ * Poses are evicted from the least recently used one when the memory budget is exceeded.
+ */
+class BakedPoseCache NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_rsize_t kDefaultMemoryBudget;
+
+    BakedPoseCache();
+    ~BakedPoseCache() NANOEM_DECL_NOEXCEPT;
+
+    void save(const Model *model, nanoem_frame_index_t frameIndex);
+    bool restore(Model *model, nanoem_frame_index_t frameIndex);
+    bool contains(const Model *model, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    void invalidate(const Model *model);
+    void clear();
+
+    nanoem_rsize_t memoryBudget() const NANOEM_DECL_NOEXCEPT;
+    void setMemoryBudget(nanoem_rsize_t value);
+    nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t countAllPoses() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Pose {
+        Model::BonePoseList m_bonePoses;
+        Model::MorphWeightList m_morphWeights;
+        const Model *m_model;
+        nanoem_frame_index_t m_frameIndex;
+        Pose *m_previous;
+        Pose *m_next;
+    };
+    typedef tinystl::unordered_map<nanoem_frame_index_t, Pose *, TinySTLAllocator> FramePoseMap;
+    typedef tinystl::unordered_map<const Model *, FramePoseMap, TinySTLAllocator> ModelPoseMap;
+
+    static nanoem_rsize_t sizeOf(const Pose *pose) NANOEM_DECL_NOEXCEPT;
+    Pose *findPose(const Model *model, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    void link(Pose *pose) NANOEM_DECL_NOEXCEPT;
+    void unlink(Pose *pose) NANOEM_DECL_NOEXCEPT;
+    void destroyPose(Pose *pose);
+    void evictAllExceededPoses();
+
+    ModelPoseMap m_poses;
+    /* poses are linked from the most recently used one to be evicted from the last */
+    Pose *m_first;
+    Pose *m_last;
+    nanoem_rsize_t m_numPoses;
+    nanoem_rsize_t m_memoryUsage;
+    nanoem_rsize_t m_memoryBudget;
+};
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_PROJECT_BAKEDPOSECACHE_H_ */
@@ -0,0 +1,77 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_PROJECT_PHYSICSCHECKPOINTCACHE_H_
+#define NANOEM_EMAPP_INTERNAL_PROJECT_PHYSICSCHECKPOINTCACHE_H_
+
+#include "emapp/Forward.h"
+
+namespace nanoem {
+
+class PhysicsEngine;
+
+namespace internal {
+namespace project {
+
+/*
+ * Keeps compressed physics states taken while the simulation runs continuously from the first frame.
+ * At most one checkpoint is kept per interval and the oldest ones are evicted when the memory budget is exceeded.
+ * Seeking forward from a continuous state replays at most the max number of frames instead of stepping once.
+ */
+class PhysicsCheckpointCache NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_frame_index_t kDefaultInterval;
+    static const nanoem_rsize_t kDefaultMemoryBudget;
+    static const nanoem_frame_index_t kDefaultMaxNumReplayFrames;
+
+    PhysicsCheckpointCache();
+    ~PhysicsCheckpointCache() NANOEM_DECL_NOEXCEPT;
+
+    bool save(nanoem_frame_index_t frameIndex, const PhysicsEngine *engine);
+    bool restore(nanoem_frame_index_t frameIndex, PhysicsEngine *engine);
+    bool findNearest(nanoem_frame_index_t frameIndex, nanoem_frame_index_t &found) const NANOEM_DECL_NOEXCEPT;
+    bool containsInterval(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    void clear();
+
+    bool isContinuous(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    void setContinuous(nanoem_frame_index_t frameIndex);
+    void resetContinuous();
+    nanoem_frame_index_t interval() const NANOEM_DECL_NOEXCEPT;
+    void setInterval(nanoem_frame_index_t value);
+    nanoem_rsize_t memoryBudget() const NANOEM_DECL_NOEXCEPT;
+    void setMemoryBudget(nanoem_rsize_t value);
+    nanoem_frame_index_t maxNumReplayFrames() const NANOEM_DECL_NOEXCEPT;
+    void setMaxNumReplayFrames(nanoem_frame_index_t value);
+    nanoem_rsize_t memoryUsage() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t countAllCheckpoints() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    struct Checkpoint {
+        ByteArray m_deflatedBytes;
+        nanoem_rsize_t m_inflatedSize;
+        nanoem_frame_index_t m_frameIndex;
+    };
+    typedef tinystl::vector<Checkpoint *, TinySTLAllocator> CheckpointList;
+
+    const Checkpoint *findCheckpoint(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT;
+    void evictAllExceededCheckpoints();
+
+    /* checkpoints are ordered from the oldest one to be evicted first */
+    CheckpointList m_checkpoints;
+    ByteArray m_buffer;
+    nanoem_rsize_t m_memoryUsage;
+    nanoem_rsize_t m_memoryBudget;
+    nanoem_frame_index_t m_interval;
+    nanoem_frame_index_t m_continuousFrameIndex;
+    nanoem_frame_index_t m_maxNumReplayFrames;
+};
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_PROJECT_PHYSICSCHECKPOINTCACHE_H_ */
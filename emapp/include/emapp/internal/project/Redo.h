@@ -23,6 +23,13 @@ namespace project {
 class Redo NANOEM_DECL_SEALED : private NonCopyable {
 public:
     static const nanoem_u32_t kFileMagic;
+    /* every record of redo files written before raw records were introduced is LZ4 compressed */
+    static const nanoem_u32_t kLegacyFileMagic;
+    /* set to the size field of records stored without LZ4 compression, only valid with kFileMagic */
+    static const nanoem_u32_t kUncompressedRecordFlag;
+
+    static void writeRecord(IWriter *writer, nanoem_u32_t sequence, nanoem_u16_t type, const ByteArray &bytes,
+        bool compressionEnabled, ByteArray &buffer, Error &error);
 
     Redo(Project *project);
     ~Redo() NANOEM_DECL_NOEXCEPT;
@@ -33,8 +40,11 @@ public:
 
 private:
     static bool isAccepted(nanoem_u32_t value) NANOEM_DECL_NOEXCEPT;
-    static void getCountOffset(ISeekableReader *reader, nanoem_u32_t &count, nanoem_u32_t &offset, Error &error);
-    void inflateChunk(const ByteArray &input, ByteArray &output);
+    static bool isAcceptedFileMagic(nanoem_u32_t value) NANOEM_DECL_NOEXCEPT;
+    static nanoem_u32_t uncompressedRecordFlag(nanoem_u32_t fileMagic) NANOEM_DECL_NOEXCEPT;
+    static void getCountOffset(ISeekableReader *reader, nanoem_u32_t rawRecordFlag, nanoem_u32_t &count,
+        nanoem_u32_t &offset, Error &error);
+    void inflateChunk(const ByteArray &input, bool raw, ByteArray &output);
     void sendCommandMessage(int commandStreamSocket, const ByteArray &inflated, nanoem_u16_t commandType,
         IWriter *writer, nanoem_u32_t sequence);
     void waitEventMessage(int commandStreamSocket, int eventStreamSocket, bool *cancelled);
@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#pragma once
+#ifndef NANOEM_EMAPP_INTERNAL_PROJECT_REDOLOGWRITER_H_
+#define NANOEM_EMAPP_INTERNAL_PROJECT_REDOLOGWRITER_H_
+
+#include "emapp/Error.h"
+
+#include "bx/semaphore.h"
+#include "bx/thread.h"
+
+struct Nanoem__Application__Command;
+
+namespace nanoem {
+
+class IFileWriter;
+class URI;
+
+namespace internal {
+namespace project {
+
+/*
+ * Appends redo records from one producer thread to the redo file on a background thread.
+ * Records are written in the order of enqueue and the file is synced at most once per sync interval.
+ */
+class RedoLogWriter NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_u32_t kDefaultSyncInterval;
+    static const nanoem_u32_t kMaxNumRecords = 256;
+
+    RedoLogWriter();
+    ~RedoLogWriter() NANOEM_DECL_NOEXCEPT;
+
+    bool open(const URI &fileURI, Error &error);
+    void enqueue(nanoem_u32_t sequence, const Nanoem__Application__Command *command);
+    void flush();
+    void close(Error &error);
+    bool isOpened() const NANOEM_DECL_NOEXCEPT;
+
+    nanoem_u32_t syncInterval() const NANOEM_DECL_NOEXCEPT;
+    void setSyncInterval(nanoem_u32_t value);
+    bool isCompressionEnabled() const NANOEM_DECL_NOEXCEPT;
+    void setCompressionEnabled(bool value);
+
+private:
+    struct Record {
+        ByteArray m_bytes;
+        nanoem_u32_t m_sequence;
+        nanoem_u16_t m_type;
+    };
+    static nanoem_i32_t execute(bx::Thread *thread, void *userData);
+
+    void run();
+    void writeAllRecords(ByteArray &buffer);
+    void waitFor(const volatile nanoem_u32_t &counter, nanoem_u32_t value);
+    void notifyProducer();
+
+    Record m_records[kMaxNumRecords];
+    IFileWriter *m_writer;
+    bx::Thread m_thread;
+    bx::Semaphore m_wakeup;
+    bx::Semaphore m_drained;
+    Error m_error;
+    /* head is only advanced by the producer and tail is only advanced by the writer thread */
+    volatile nanoem_u32_t m_head;
+    volatile nanoem_u32_t m_tail;
+    volatile nanoem_u32_t m_synced;
+    volatile nanoem_u32_t m_flushRequested;
+    volatile nanoem_u32_t m_producerWaiting;
+    volatile nanoem_u32_t m_syncInterval;
+    volatile bool m_compressionEnabled;
+    volatile bool m_running;
+};
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_INTERNAL_PROJECT_REDOLOGWRITER_H_ */
@@ -43,6 +43,25 @@ public:
 
     typedef tinystl::pair<int, int> IndexPair;
     typedef tinystl::vector<IndexPair, TinySTLAllocator> IndexSet;
+    /*
+     * snapshot of all transforms evaluated from the motion to be restored without evaluating them again.
+     * normal and skinning transforms are derived from the world transform so they are not saved
+     */
+    struct Pose {
+        Matrix4x4 m_worldTransform;
+        Matrix4x4 m_localTransform;
+        Quaternion m_localOrientation;
+        Quaternion m_localInherentOrientation;
+        Quaternion m_localMorphOrientation;
+        Quaternion m_localUserOrientation;
+        Quaternion m_constraintJointOrientation;
+        Vector3 m_localTranslation;
+        Vector3 m_localInherentTranslation;
+        Vector3 m_localMorphTranslation;
+        Vector3 m_localUserTranslation;
+        Vector4U8 m_bezierControlPoints[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+        bool m_enableLinearInterpolation[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+    };
     ~Bone() NANOEM_DECL_NOEXCEPT;
 
     void bind(nanoem_model_bone_t *bone);
@@ -63,6 +82,8 @@ public:
     void updateLocalTransform(const nanoem_model_bone_t *bone) NANOEM_DECL_NOEXCEPT;
     void updateSkinningTransform(const nanoem_model_bone_t *bone, const Matrix4x4 value) NANOEM_DECL_NOEXCEPT;
     void updateSkinningTransform(const nanoem_model_bone_t *bone, const bx::float4x4_t *value) NANOEM_DECL_NOEXCEPT;
+    void savePose(Pose &pose) const NANOEM_DECL_NOEXCEPT;
+    void restorePose(const nanoem_model_bone_t *bone, const Pose &pose) NANOEM_DECL_NOEXCEPT;
     String name() const;
     String canonicalName() const;
     const char *nameConstString() const NANOEM_DECL_NOEXCEPT;
@@ -138,14 +159,14 @@ private:
     };
     static void destroy(void *opaque, nanoem_model_object_t *object) NANOEM_DECL_NOEXCEPT;
     static void synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone,
-        const nanoem_model_rigid_body_t *rigidBodyPtr, nanoem_frame_index_t frameIndex, FrameTransform &transform);
+        const nanoem_model_rigid_body_t *rigidBodyPtr, nanoem_motion_track_handle_t handle, nanoem_rsize_t *cursor,
+        nanoem_frame_index_t frameIndex, FrameTransform &transform);
     static void createConstraintUnitAxes(const Vector3 &radians, const Vector3 &lowerLimit, const Vector3 &upperLimit,
         Quaternion &x, Quaternion &y, Quaternion &z) NANOEM_DECL_NOEXCEPT;
-    static void constrainOrientation(
-        const nanoem_model_constraint_joint_t *joint, Quaternion &orientation) NANOEM_DECL_NOEXCEPT;
     static Vector3 toVector3(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT;
     static Quaternion toQuaternion(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT;
 
+    nanoem_motion_track_handle_t resolveMotionTrackHandle(const Motion *motion, const nanoem_model_bone_t *bone);
     void solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIterations);
     void solveConstraint(const nanoem_model_bone_t *bone);
     Bone(const PlaceHolder &holder) NANOEM_DECL_NOEXCEPT;
@@ -163,6 +184,11 @@ private:
     Vector3 m_localMorphTranslation;
     Vector3 m_localUserTranslation;
     Vector4U8 m_bezierControlPoints[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM];
+    const Motion *m_boundMotion;
+    const nanoem_unicode_string_t *m_boundName;
+    nanoem_u64_t m_boundMotionRevision;
+    nanoem_motion_track_handle_t m_motionTrackHandle;
+    nanoem_rsize_t m_motionTrackCursor;
     nanoem_u32_t m_states;
 };
 
@@ -0,0 +1,58 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_MODEL_BONETRANSFORMSCHEDULE_H_
+#define NANOEM_EMAPP_MODEL_BONETRANSFORMSCHEDULE_H_
+
+#include "emapp/PhysicsEngine.h"
+
+namespace nanoem {
+
+class Model;
+
+namespace model {
+
+class BoneTransformSchedule NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    struct Level {
+        nanoem_u32_t m_offset;
+        nanoem_u32_t m_numBones;
+        bool m_barrier;
+    };
+
+    BoneTransformSchedule();
+    ~BoneTransformSchedule() NANOEM_DECL_NOEXCEPT;
+
+    void build(const Model *model);
+    void clear();
+    void invalidate() NANOEM_DECL_NOEXCEPT;
+    bool isValid() const NANOEM_DECL_NOEXCEPT;
+
+    nanoem_rsize_t numLevels(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT;
+    const Level &level(PhysicsEngine::SimulationTimingType timing, nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numBones(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT;
+    const nanoem_model_bone_t *const *allBones(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT;
+
+private:
+    typedef tinystl::vector<const nanoem_model_bone_t *, TinySTLAllocator> BoneList;
+    typedef tinystl::vector<Level, TinySTLAllocator> LevelList;
+    /* bones of the same level are packed contiguously in transform order and levels are sorted ascending */
+    struct Plan {
+        BoneList m_bones;
+        LevelList m_levels;
+    };
+
+    void buildPlan(const Model *model, PhysicsEngine::SimulationTimingType timing);
+
+    Plan m_plans[PhysicsEngine::kSimulationTimingMaxEnum];
+    bool m_valid;
+};
+
+} /* namespace model */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_MODEL_BONETRANSFORMSCHEDULE_H_ */
@@ -37,9 +37,20 @@ public:
         Vector3 m_axis;
         nanoem_f32_t m_angle;
     };
+    /* per joint metadata compiled at binding to solve without string conversion and hash lookup */
+    struct CompiledJoint {
+        const nanoem_model_constraint_joint_t *m_joint;
+        const nanoem_model_bone_t *m_bonePtr;
+        Vector3 m_upperLimit;
+        Vector3 m_lowerLimit;
+        Vector3 m_limitedAxis;
+        nanoem_f32_t m_angleLimit;
+        bool m_hasAngleLimit;
+        bool m_hasLimitedAxis;
+        bool m_hasUnitXConstraint;
+    };
+    typedef tinystl::vector<CompiledJoint, TinySTLAllocator> CompiledJointList;
     typedef tinystl::vector<Joint, TinySTLAllocator> JointIteration;
-    typedef tinystl::unordered_map<const nanoem_model_constraint_joint_t *, JointIteration, TinySTLAllocator>
-        JointIterationResult;
 
     ~Constraint() NANOEM_DECL_NOEXCEPT;
 
@@ -58,12 +69,16 @@ public:
     void bind(nanoem_model_constraint_t *constraintPtr);
     void resetLanguage(const nanoem_model_constraint_t *constraintPtr, nanoem_unicode_string_factory_t *factory,
         nanoem_language_type_t language);
-    void initialize(const nanoem_model_constraint_t *constraintPtr);
+    void initialize(const nanoem_model_constraint_t *constraintPtr, nanoem_unicode_string_factory_t *factory);
+    void invalidate() NANOEM_DECL_NOEXCEPT;
 
-    const JointIterationResult *jointIterationResult() const NANOEM_DECL_NOEXCEPT;
-    const JointIterationResult *effectorIterationResult() const NANOEM_DECL_NOEXCEPT;
-    Joint *jointIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset);
-    Joint *effectorIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset);
+    const CompiledJointList &compiledJoints();
+    nanoem_rsize_t numIterations() const NANOEM_DECL_NOEXCEPT;
+    const Joint *jointIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) const NANOEM_DECL_NOEXCEPT;
+    Joint *jointIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) NANOEM_DECL_NOEXCEPT;
+    const Joint *effectorIterationResult(
+        nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) const NANOEM_DECL_NOEXCEPT;
+    Joint *effectorIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) NANOEM_DECL_NOEXCEPT;
     String name() const;
     String canonicalName() const;
     const char *nameConstString() const NANOEM_DECL_NOEXCEPT;
@@ -77,8 +92,14 @@ private:
     static void destroy(void *opaque, nanoem_model_object_t *constraint) NANOEM_DECL_NOEXCEPT;
     Constraint(const PlaceHolder &holder) NANOEM_DECL_NOEXCEPT;
 
-    JointIterationResult m_jointIterationResult;
-    JointIterationResult m_effectorIterationResult;
+    void compile();
+
+    const nanoem_model_constraint_t *m_opaque;
+    nanoem_unicode_string_factory_t *m_factory;
+    CompiledJointList m_compiledJoints;
+    JointIteration m_jointIterationResults;
+    JointIteration m_effectorIterationResults;
+    nanoem_rsize_t m_numIterations;
     String m_name;
     String m_canonicalName;
     nanoem_u32_t m_states;
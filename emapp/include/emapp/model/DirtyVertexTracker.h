@@ -0,0 +1,70 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_MODEL_DIRTYVERTEXTRACKER_H_
+#define NANOEM_EMAPP_MODEL_DIRTYVERTEXTRACKER_H_
+
+#include "emapp/Forward.h"
+
+#include "bx/float4x4_t.h"
+
+namespace nanoem {
+
+class Model;
+
+namespace model {
+
+class Bone;
+
+class DirtyVertexTracker NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    typedef tinystl::pair<nanoem_u32_t, nanoem_u32_t> Range;
+    typedef tinystl::vector<Range, TinySTLAllocator> RangeList;
+    static const nanoem_u32_t kMaxNumStagingBuffers = 2;
+    static const nanoem_u32_t kMaxRangeGap = 16;
+
+    DirtyVertexTracker();
+    ~DirtyVertexTracker() NANOEM_DECL_NOEXCEPT;
+
+    void build(const Model *model);
+    void clear();
+    void invalidate() NANOEM_DECL_NOEXCEPT;
+    void update(nanoem_model_vertex_t *const *vertices, nanoem_f32_t edgeSizeScaleFactor) NANOEM_DECL_NOEXCEPT;
+    const RangeList &collectRanges(nanoem_u32_t bufferIndex);
+
+    bool isDirty(nanoem_rsize_t vertexIndex) const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numVertices() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numDirtyVertices() const NANOEM_DECL_NOEXCEPT;
+
+private:
+    enum VertexFlag {
+        kVertexFlagDirty = 1 << 0,
+        kVertexFlagPendingBuffer0 = 1 << 1,
+        kVertexFlagPendingBuffer1 = 1 << 2,
+        kVertexFlagPendingAllBuffers = kVertexFlagPendingBuffer0 | kVertexFlagPendingBuffer1,
+        kVertexFlagDeformed = 1 << 3,
+    };
+    typedef tinystl::vector<const Bone *, TinySTLAllocator> BoneList;
+    typedef tinystl::vector<bx::float4x4_t, TinySTLAllocator> TransformList;
+    typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> IndexList;
+    typedef tinystl::vector<nanoem_u8_t, TinySTLAllocator> FlagList;
+
+    BoneList m_bones;
+    TransformList m_lastSkinningTransforms;
+    FlagList m_changedBoneFlags;
+    IndexList m_vertexBoneIndices;
+    FlagList m_vertexFlags;
+    RangeList m_ranges;
+    nanoem_rsize_t m_numDirtyVertices;
+    nanoem_f32_t m_lastEdgeSizeScaleFactor;
+    bool m_invalidated;
+};
+
+} /* namespace model */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_MODEL_DIRTYVERTEXTRACKER_H_ */
@@ -56,11 +56,18 @@ private:
     };
     static void destroy(void *opaque, nanoem_model_object_t *morph) NANOEM_DECL_NOEXCEPT;
     static void synchronizeWeight(const Motion *motion, nanoem_frame_index_t frameIndex,
-        const nanoem_unicode_string_t *name, nanoem_f32_t &weight);
+        nanoem_motion_track_handle_t handle, nanoem_rsize_t *cursor, nanoem_f32_t &weight);
     Morph(const PlaceHolder &holder) NANOEM_DECL_NOEXCEPT;
 
+    nanoem_motion_track_handle_t resolveMotionTrackHandle(const Motion *motion, const nanoem_unicode_string_t *name);
+
     String m_name;
     String m_canonicalName;
+    const Motion *m_boundMotion;
+    const nanoem_unicode_string_t *m_boundName;
+    nanoem_u64_t m_boundMotionRevision;
+    nanoem_motion_track_handle_t m_motionTrackHandle;
+    nanoem_rsize_t m_motionTrackCursor;
     nanoem_f32_t m_weight;
     bool m_dirty;
 };
@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#pragma once
+#ifndef NANOEM_EMAPP_MODEL_SKINNINGBATCH_H_
+#define NANOEM_EMAPP_MODEL_SKINNINGBATCH_H_
+
+#include "emapp/Forward.h"
+
+#include "bx/float4x4_t.h"
+
+namespace nanoem {
+
+class Model;
+
+namespace model {
+
+class Bone;
+
+class SkinningBatch NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    static const nanoem_rsize_t kNumLanes = 8;
+
+    SkinningBatch();
+    ~SkinningBatch() NANOEM_DECL_NOEXCEPT;
+
+    void build(const Model *model);
+    void clear();
+    void updateBonePalette() NANOEM_DECL_NOEXCEPT;
+    void execute(nanoem_rsize_t blockIndex, nanoem_f32_t edgeSizeScaleFactor,
+        nanoem_model_vertex_t *const *vertices, nanoem_u8_t *output) const NANOEM_DECL_NOEXCEPT;
+
+    nanoem_rsize_t numBlocks() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numBlockVertices(nanoem_rsize_t blockIndex) const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t blockVertexIndex(nanoem_rsize_t blockIndex, nanoem_rsize_t laneIndex) const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t numFallbackVertices() const NANOEM_DECL_NOEXCEPT;
+    nanoem_rsize_t fallbackVertexIndex(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT;
+
+private:
+    /* vertices of the same type are packed into 8 lanes of structure of arrays */
+    BX_ALIGN_DECL_16(struct) Block
+    {
+        bx::simd128_t m_origin[3][2];
+        bx::simd128_t m_normal[3][2];
+        bx::simd128_t m_weights[4][2];
+        nanoem_u32_t m_paletteIndices[4][kNumLanes];
+        nanoem_u32_t m_vertexIndices[kNumLanes];
+        nanoem_u32_t m_numVertices;
+        nanoem_u32_t m_numInfluences;
+    };
+    BX_ALIGN_DECL_16(struct) PaletteEntry
+    {
+        bx::float4x4_t m_skinningTransform;
+        bx::float4x4_t m_normalTransform;
+    };
+    typedef tinystl::vector<Block, TinySTLAllocator> BlockList;
+    typedef tinystl::vector<PaletteEntry, TinySTLAllocator> PaletteEntryList;
+    typedef tinystl::vector<const Bone *, TinySTLAllocator> BoneList;
+    typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> IndexList;
+
+    BlockList m_blocks;
+    PaletteEntryList m_palette;
+    BoneList m_paletteBones;
+    IndexList m_fallbackVertexIndices;
+};
+
+} /* namespace model */
+} /* namespace nanoem */
+
+#endif /* NANOEM_EMAPP_MODEL_SKINNINGBATCH_H_ */
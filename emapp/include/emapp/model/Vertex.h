@@ -48,6 +48,7 @@ public:
     void setSkinningEnabled(bool value);
     bool isEditingMasked() const NANOEM_DECL_NOEXCEPT;
     void setEditingMasked(bool value);
+    bool isDeformed() const NANOEM_DECL_NOEXCEPT;
 
     void deform(const nanoem_model_morph_vertex_t *morph, nanoem_f32_t weight) NANOEM_DECL_NOEXCEPT;
     void deform(const nanoem_model_morph_uv_t *morph, int index, nanoem_f32_t weight) NANOEM_DECL_NOEXCEPT;
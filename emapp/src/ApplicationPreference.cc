@@ -17,14 +17,24 @@ namespace {
 static const char kPreferenceKeyPrefix[] = "application.preference";
 static const char kRendererBackend[] = "renderer.backend";
 static const char kFontPath[] = "font.path";
+static const char kProfilerTracePath[] = "profiler.trace.path";
 static const char kDefaultColorPixelFormat[] = "renderer.colorPixelFormat";
 static const char kModelEditingEnabled[] = "editing.model.enabled";
 static const char kAnalyticsEnabled[] = "analytics.enabled";
 static const char kResettingAnalyticsUUIDRequired[] = "analytics.reset";
 static const char kPreferredEditingFPS[] = "editing.motion.fps";
 static const char kSkinDeformAcceleratorEnabled[] = "renderer.sda.enabled";
+static const char kCompactVertexFormatEnabled[] = "renderer.vertex.compact";
+static const char kParallelMotionSynchronizationEnabled[] = "editing.motion.parallel";
+static const char kParallelModelLoadingEnabled[] = "editing.model.parallel";
+static const char kParallelPhysicsSimulationEnabled[] = "physics.simulation.parallel";
+static const char kPhysicsWorldPerModelEnabled[] = "physics.world.per-model";
+static const char kPhysicsSimulationMaxSubSteps[] = "physics.simulation.substeps";
+static const char kBakedPoseCacheEnabled[] = "editing.pose.cache";
 static const char kCrashReporterEnabled[] = "crashReporter.enabled";
 static const char kUndoSoftLimit[] = "undo.limit";
+static const char kRedoLogSyncInterval[] = "redo.sync.interval";
+static const char kRedoLogCompressionEnabled[] = "redo.compression.enabled";
 static const char kEffectEnabled[] = "effect.enabled";
 static const char kEffectCacheEnabled[] = "effect.cached";
 static const char kHighDPIViewportMode[] = "viewport.highDPI";
@@ -45,6 +55,8 @@ const int ApplicationPreference::kGFXShaderPoolSizeDefaultValue = 0x2000;
 const int ApplicationPreference::kGFXPassPoolSizeDefaultValue = 0x2000;
 const int ApplicationPreference::kGFXPipelinePoolSizeDefaultValue = 0x4000;
 const int ApplicationPreference::kGFXUniformBufferSizeDefaultValue = 0x800000;
+const int ApplicationPreference::kRedoLogSyncIntervalDefaultValue = 1000;
+const int ApplicationPreference::kPhysicsSimulationMaxSubStepsDefaultValue = 120;
 
 ApplicationPreference::ApplicationPreference(BaseApplicationService *application)
     : m_application(application)
@@ -99,6 +111,18 @@ ApplicationPreference::setExtraFontPath(const char *value)
     writeString(kFontPath, value);
 }
 
+const char *
+ApplicationPreference::profilerTracePath() const NANOEM_DECL_NOEXCEPT
+{
+    return readString(kProfilerTracePath, nullptr);
+}
+
+void
+ApplicationPreference::setProfilerTracePath(const char *value)
+{
+    writeString(kProfilerTracePath, value);
+}
+
 ApplicationPreference::HighDPIViewportModeType
 ApplicationPreference::highDPIViewportMode() const NANOEM_DECL_NOEXCEPT
 {
@@ -238,6 +262,42 @@ ApplicationPreference::setUndoSoftLimit(int value)
     writeInt(kUndoSoftLimit, value);
 }
 
+int
+ApplicationPreference::redoLogSyncInterval() const NANOEM_DECL_NOEXCEPT
+{
+    return glm::clamp(readInt(kRedoLogSyncInterval, kRedoLogSyncIntervalDefaultValue), 0, 60000);
+}
+
+void
+ApplicationPreference::setRedoLogSyncInterval(int value)
+{
+    writeInt(kRedoLogSyncInterval, value);
+}
+
+int
+ApplicationPreference::physicsSimulationMaxSubSteps() const NANOEM_DECL_NOEXCEPT
+{
+    return glm::clamp(readInt(kPhysicsSimulationMaxSubSteps, kPhysicsSimulationMaxSubStepsDefaultValue), 1, 0xffff);
+}
+
+void
+ApplicationPreference::setPhysicsSimulationMaxSubSteps(int value)
+{
+    writeInt(kPhysicsSimulationMaxSubSteps, value);
+}
+
+bool
+ApplicationPreference::isRedoLogCompressionEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kRedoLogCompressionEnabled, true);
+}
+
+void
+ApplicationPreference::setRedoLogCompressionEnabled(bool value)
+{
+    writeBool(kRedoLogCompressionEnabled, value);
+}
+
 bool
 ApplicationPreference::isModelEditingEnabled() const NANOEM_DECL_NOEXCEPT
 {
@@ -286,6 +346,78 @@ ApplicationPreference::setSkinDeformAcceleratorEnabled(bool value)
     writeBool(kSkinDeformAcceleratorEnabled, value);
 }
 
+bool
+ApplicationPreference::isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kCompactVertexFormatEnabled, false);
+}
+
+void
+ApplicationPreference::setCompactVertexFormatEnabled(bool value)
+{
+    writeBool(kCompactVertexFormatEnabled, value);
+}
+
+bool
+ApplicationPreference::isParallelMotionSynchronizationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kParallelMotionSynchronizationEnabled, false);
+}
+
+void
+ApplicationPreference::setParallelMotionSynchronizationEnabled(bool value)
+{
+    writeBool(kParallelMotionSynchronizationEnabled, value);
+}
+
+bool
+ApplicationPreference::isParallelModelLoadingEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kParallelModelLoadingEnabled, false);
+}
+
+void
+ApplicationPreference::setParallelModelLoadingEnabled(bool value)
+{
+    writeBool(kParallelModelLoadingEnabled, value);
+}
+
+bool
+ApplicationPreference::isParallelPhysicsSimulationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kParallelPhysicsSimulationEnabled, false);
+}
+
+void
+ApplicationPreference::setParallelPhysicsSimulationEnabled(bool value)
+{
+    writeBool(kParallelPhysicsSimulationEnabled, value);
+}
+
+bool
+ApplicationPreference::isPhysicsWorldPerModelEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kPhysicsWorldPerModelEnabled, false);
+}
+
+void
+ApplicationPreference::setPhysicsWorldPerModelEnabled(bool value)
+{
+    writeBool(kPhysicsWorldPerModelEnabled, value);
+}
+
+bool
+ApplicationPreference::isBakedPoseCacheEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return readBool(kBakedPoseCacheEnabled, false);
+}
+
+void
+ApplicationPreference::setBakedPoseCacheEnabled(bool value)
+{
+    writeBool(kBakedPoseCacheEnabled, value);
+}
+
 bool
 ApplicationPreference::isCrashReportEnabled() const NANOEM_DECL_NOEXCEPT
 {
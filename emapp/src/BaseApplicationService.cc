@@ -36,6 +36,7 @@
 #include "emapp/ModalDialogFactory.h"
 #include "emapp/Model.h"
 #include "emapp/ModelProgramBundle.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/Project.h"
 #include "emapp/ResourceBundle.h"
@@ -1738,6 +1739,23 @@ BaseApplicationService::createProject(const Vector2UI16 &logicalPixelWindowSize,
     }
     project->setEffectPluginEnabled(preference.isEffectEnabled());
     project->setCompiledEffectCacheEnabled(preference.isEffectCacheEnabled());
+    project->setCompactVertexFormatEnabled(preference.isCompactVertexFormatEnabled());
+    project->setParallelMotionSynchronizationEnabled(preference.isParallelMotionSynchronizationEnabled());
+    project->setParallelModelLoadingEnabled(preference.isParallelModelLoadingEnabled());
+    project->setParallelPhysicsSimulationEnabled(preference.isParallelPhysicsSimulationEnabled());
+    project->setPhysicsWorldPerModelEnabled(preference.isPhysicsWorldPerModelEnabled());
+    project->setPhysicsSimulationMaxSubSteps(preference.physicsSimulationMaxSubSteps());
+    project->setBakedPoseCacheEnabled(preference.isBakedPoseCacheEnabled());
+    project->setRedoLogSyncInterval(nanoem_u32_t(preference.redoLogSyncInterval()));
+    project->setRedoLogCompressionEnabled(preference.isRedoLogCompressionEnabled());
+    if (const char *tracePath = preference.profilerTracePath()) {
+        /* zones are recorded from the first project and written to the trace path when the project is destroyed */
+        Profiler *profiler = Profiler::sharedInstance();
+        if (*tracePath && !profiler->isEnabled()) {
+            profiler->reset();
+            profiler->setEnabled(true);
+        }
+    }
     const Vector2UI16 devicePixelWindowSize(Vector2(logicalPixelWindowSize) * project->windowDevicePixelRatio());
     m_window->resizeDevicePixelWindowSize(devicePixelWindowSize);
     if (g_sentryAvailable) {
@@ -1758,6 +1776,7 @@ BaseApplicationService::destroyProject(Project *project)
     if (nanoem_likely(project)) {
         m_window->reset(project);
         project->stop();
+        saveProfilerTrace();
         if (project->hasTransientPath()) {
             FileUtils::TransientPath path(project->transientPath());
             FileUtils::deleteTransientFile(path);
@@ -5777,4 +5796,24 @@ BaseApplicationService::sendDiscardAfterConfirmEventMessage()
     sendQueryEventMessage(&event, nullptr);
 }
 
+void
+BaseApplicationService::saveProfilerTrace()
+{
+    ApplicationPreference preference(this);
+    Profiler *profiler = Profiler::sharedInstance();
+    const char *tracePath = preference.profilerTracePath();
+    if (profiler->isEnabled() && tracePath && *tracePath) {
+        ByteArray bytes;
+        Error error;
+        FileWriterScope scope;
+        profiler->setEnabled(false);
+        profiler->save(bytes);
+        if (scope.open(URI::createFromFilePath(tracePath), error)) {
+            FileUtils::write(scope.writer(), bytes, error);
+            scope.commit(error);
+        }
+        profiler->reset();
+    }
+}
+
 } /* namespace nanoem */
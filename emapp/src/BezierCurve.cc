@@ -8,7 +8,15 @@
 
 #include "emapp/private/CommonInclude.h"
 
+#include "bx/simd_t.h"
+
 namespace nanoem {
+namespace {
+
+static const int kMaxNumSolverIterations = 16;
+static const nanoem_f32_t kSolverEpsilon = 1e-6f;
+
+} /* namespace anonymous */
 
 const Vector2 BezierCurve::kP0 = Vector2(0);
 const Vector2 BezierCurve::kP1 = Vector2(127);
@@ -18,18 +26,6 @@ BezierCurve::BezierCurve(const Vector2U8 &c0, const Vector2U8 &c1, nanoem_frame_
     , m_c1(c1)
     , m_interval(interval)
 {
-    interval = glm::max(interval, nanoem_frame_index_t(16));
-    m_parameters.resize(interval + 1);
-    const Vector2 c0f(c0), c1f(c1);
-    const nanoem_f32_t intervalFloat = nanoem_f32_t(interval);
-    for (nanoem_frame_index_t i = 0; i <= interval; i++) {
-        const nanoem_f32_t t = i / intervalFloat;
-        const nanoem_f32_t it = 1.0f - t;
-        const Vector2 &v = ((kP0 * glm::pow(it, 3.0f)) + (c0f * t * glm::pow(it, 2.0f) * 3.0f) +
-                               (c1f * it * glm::pow(t, 2.0f) * 3.0f) + (kP1 * glm::pow(t, 3.0f))) /
-            kP1;
-        m_parameters[i] = v;
-    }
 }
 
 BezierCurve::~BezierCurve() NANOEM_DECL_NOEXCEPT
@@ -39,21 +35,14 @@ BezierCurve::~BezierCurve() NANOEM_DECL_NOEXCEPT
 nanoem_f32_t
 BezierCurve::value(nanoem_f32_t value) const NANOEM_DECL_NOEXCEPT
 {
-    const nanoem_frame_index_t interval(length());
-    Vector2 nearest(kP1);
-    for (nanoem_frame_index_t i = 0; i < interval; i++) {
-        const Vector2 v(m_parameters[i]);
-        if (glm::abs(nearest.x - value) > glm::abs(v.x - value)) {
-            nearest = v;
-        }
-    }
-    return nearest.y;
+    const nanoem_u8_t parameters[] = { m_c0.x, m_c0.y, m_c1.x, m_c1.y };
+    return solve(parameters, value);
 }
 
 nanoem_frame_index_t
 BezierCurve::length() const NANOEM_DECL_NOEXCEPT
 {
-    return nanoem_frame_index_t(m_parameters.size());
+    return m_interval;
 }
 
 BezierCurve::Pair
@@ -102,6 +91,93 @@ BezierCurve::toHash(const nanoem_u8_t *parameters, nanoem_frame_index_t interval
     return hash.value;
 }
 
+nanoem_f32_t
+BezierCurve::solve(const nanoem_u8_t *parameters, nanoem_f32_t value) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_f32_t c0x = parameters[0] / kP1.x, c0y = parameters[1] / kP1.y, c1x = parameters[2] / kP1.x,
+                       c1y = parameters[3] / kP1.y, x = glm::clamp(value, 0.0f, 1.0f);
+    nanoem_f32_t lower = 0.0f, upper = 1.0f, t = x, it;
+    /*
+     * x(t) is monotonic because both x of control points are within [0, 1], so Newton-Raphson is used
+     * and falls back to bisection when the step leaves the bracket
+     */
+    for (int i = 0; i < kMaxNumSolverIterations; i++) {
+        it = 1.0f - t;
+        const nanoem_f32_t fx = 3.0f * it * it * t * c0x + 3.0f * it * t * t * c1x + t * t * t - x;
+        if (glm::abs(fx) < kSolverEpsilon) {
+            break;
+        }
+        else if (fx < 0) {
+            lower = t;
+        }
+        else {
+            upper = t;
+        }
+        const nanoem_f32_t dx = 3.0f * it * it * c0x + 6.0f * it * t * (c1x - c0x) + 3.0f * t * t * (1.0f - c1x);
+        const nanoem_f32_t nt = dx > kSolverEpsilon ? t - fx / dx : -1.0f;
+        t = nt > lower && nt < upper ? nt : (lower + upper) * 0.5f;
+    }
+    it = 1.0f - t;
+    return 3.0f * it * it * t * c0y + 3.0f * it * t * t * c1y + t * t * t;
+}
+
+Vector4
+BezierCurve::solve(const nanoem_u8_t *const *parameters, const Vector4 &value) NANOEM_DECL_NOEXCEPT
+{
+    const bx::simd128_t zero = bx::simd_zero(), one = bx::simd_splat(1.0f), three = bx::simd_splat(3.0f),
+                        six = bx::simd_splat(6.0f), half = bx::simd_splat(0.5f),
+                        epsilon = bx::simd_splat(kSolverEpsilon), scale = bx::simd_splat(1.0f / kP1.x);
+    const bx::simd128_t c0x = bx::simd_mul(bx::simd_ld(nanoem_f32_t(parameters[0][0]), nanoem_f32_t(parameters[1][0]),
+                                               nanoem_f32_t(parameters[2][0]), nanoem_f32_t(parameters[3][0])),
+                            scale),
+                        c0y = bx::simd_mul(bx::simd_ld(nanoem_f32_t(parameters[0][1]), nanoem_f32_t(parameters[1][1]),
+                                               nanoem_f32_t(parameters[2][1]), nanoem_f32_t(parameters[3][1])),
+                            scale),
+                        c1x = bx::simd_mul(bx::simd_ld(nanoem_f32_t(parameters[0][2]), nanoem_f32_t(parameters[1][2]),
+                                               nanoem_f32_t(parameters[2][2]), nanoem_f32_t(parameters[3][2])),
+                            scale),
+                        c1y = bx::simd_mul(bx::simd_ld(nanoem_f32_t(parameters[0][3]), nanoem_f32_t(parameters[1][3]),
+                                               nanoem_f32_t(parameters[2][3]), nanoem_f32_t(parameters[3][3])),
+                            scale);
+    const bx::simd128_t x = bx::simd_clamp(bx::simd_ld(value.x, value.y, value.z, value.w), zero, one);
+    bx::simd128_t lower = zero, upper = one, t = x, it;
+    /* same as the scalar version above but solves all of four channels at once */
+    for (int i = 0; i < kMaxNumSolverIterations; i++) {
+        it = bx::simd_sub(one, t);
+        const bx::simd128_t itt = bx::simd_mul(it, t);
+        const bx::simd128_t fx = bx::simd_sub(
+            bx::simd_add(bx::simd_mul(three, bx::simd_add(bx::simd_mul(bx::simd_mul(itt, it), c0x),
+                                                  bx::simd_mul(bx::simd_mul(itt, t), c1x))),
+                bx::simd_mul(bx::simd_mul(t, t), t)),
+            x);
+        const bx::simd128_t converged = bx::simd_cmplt(bx::simd_abs(fx), epsilon);
+        if (bx::simd_test_all_xyzw(converged)) {
+            break;
+        }
+        const bx::simd128_t negative = bx::simd_cmplt(fx, zero);
+        lower = bx::simd_selb(negative, t, lower);
+        upper = bx::simd_selb(negative, upper, t);
+        const bx::simd128_t dx = bx::simd_add(
+            bx::simd_add(bx::simd_mul(three, bx::simd_mul(bx::simd_mul(it, it), c0x)),
+                bx::simd_mul(six, bx::simd_mul(itt, bx::simd_sub(c1x, c0x)))),
+            bx::simd_mul(three, bx::simd_mul(bx::simd_mul(t, t), bx::simd_sub(one, c1x))));
+        const bx::simd128_t steppable = bx::simd_cmpgt(dx, epsilon);
+        const bx::simd128_t nt = bx::simd_sub(t, bx::simd_div(fx, bx::simd_selb(steppable, dx, one)));
+        const bx::simd128_t acceptable =
+            bx::simd_and(steppable, bx::simd_and(bx::simd_cmpgt(nt, lower), bx::simd_cmplt(nt, upper)));
+        const bx::simd128_t next =
+            bx::simd_selb(acceptable, nt, bx::simd_mul(bx::simd_add(lower, upper), half));
+        t = bx::simd_selb(converged, t, next);
+    }
+    it = bx::simd_sub(one, t);
+    const bx::simd128_t itt = bx::simd_mul(it, t);
+    const bx::simd128_t y =
+        bx::simd_add(bx::simd_mul(three, bx::simd_add(bx::simd_mul(bx::simd_mul(itt, it), c0y),
+                                             bx::simd_mul(bx::simd_mul(itt, t), c1y))),
+            bx::simd_mul(bx::simd_mul(t, t), t));
+    return Vector4(bx::simd_x(y), bx::simd_y(y), bx::simd_z(y), bx::simd_w(y));
+}
+
 void
 BezierCurve::splitBezierCurve(const PointList &points, nanoem_f32_t t, PointList &left, PointList &right)
 {
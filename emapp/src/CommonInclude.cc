@@ -101,6 +101,7 @@ extern void APIENTRY sgx_setup(const sg_desc *desc);
 extern void APIENTRY sgx_shutdown(void);
 extern void APIENTRY sgx_unmap_buffer(sg_buffer buffer, void *address);
 extern void APIENTRY sgx_update_buffer(sg_buffer buf, const void *data_ptr, int data_size);
+extern bool APIENTRY sgx_update_buffer_range(sg_buffer buf, int offset, const void *data_ptr, int data_size);
 extern void APIENTRY sgx_update_image(sg_image img, const sg_image_content *data);
 extern void *APIENTRY sgx_map_buffer(sg_buffer buffer);
 #endif
@@ -246,6 +247,7 @@ PFN_sg_uninit_pipeline uninit_pipeline = nullptr;
 PFN_sg_uninit_pass uninit_pass = nullptr;
 PFN_sgx_unmap_buffer unmap_buffer = nullptr;
 PFN_sgx_update_buffer update_buffer = nullptr;
+PFN_sgx_update_buffer_range update_buffer_range = nullptr;
 PFN_sgx_update_image update_image = nullptr;
 
 void *
@@ -345,6 +347,7 @@ openSharedLibrary(const char *dllPath)
     uninit_pass = sgx_uninit_pass;
     unmap_buffer = sgx_unmap_buffer;
     update_buffer = sgx_update_buffer;
+    update_buffer_range = sgx_update_buffer_range;
     update_image = sgx_update_image;
 #else
     void *handle = bx::dlopen(dllPath);
@@ -449,6 +452,8 @@ openSharedLibrary(const char *dllPath)
         uninit_pass = reinterpret_cast<PFN_sg_uninit_pass>(bx::dlsym(handle, "sgx_uninit_pass"));
         unmap_buffer = reinterpret_cast<PFN_sgx_unmap_buffer>(bx::dlsym(handle, "sgx_unmap_buffer"));
         update_buffer = reinterpret_cast<PFN_sgx_update_buffer>(bx::dlsym(handle, "sgx_update_buffer"));
+        update_buffer_range =
+            reinterpret_cast<PFN_sgx_update_buffer_range>(bx::dlsym(handle, "sgx_update_buffer_range"));
         update_image = reinterpret_cast<PFN_sgx_update_image>(bx::dlsym(handle, "sgx_update_image"));
     }
 #endif
@@ -1015,15 +1015,11 @@ DefaultFileManager::loadModel(const URI &fileURI, Model *model, Error &error)
 {
     nanoem_parameter_assert(!fileURI.isEmpty(), "must NOT be empty");
     nanoem_parameter_assert(model, "must NOT be nullptr");
-    FileReaderScope scope(&m_translator);
+    MappedFileReader reader(&m_translator);
     bool succeeded = false;
-    if (scope.open(fileURI, error)) {
-        ByteArray bytes;
-        FileUtils::read(scope, bytes, error);
-        if (!error.hasReason() && model->load(bytes, error)) {
-            model->setFileURI(fileURI);
-            succeeded = true;
-        }
+    if (reader.open(fileURI, error) && model->load(reader.bytes(), reader.size(), error)) {
+        model->setFileURI(fileURI);
+        succeeded = true;
     }
     return succeeded;
 }
@@ -1153,13 +1149,9 @@ DefaultFileManager::loadModelMotion(const URI &fileURI, Project *project, Error
             project->destroyMotion(lastMotionPtr);
         }
         else if (model::BindPose::isLoadableExtension(fileURI)) {
-            FileReaderScope scope(&m_translator);
-            if (scope.open(fileURI, error)) {
-                ByteArray bytes;
-                FileUtils::read(scope, bytes, error);
-                if (!error.hasReason()) {
-                    succeeded = model->loadPose(bytes, error);
-                }
+            MappedFileReader reader(&m_translator);
+            if (reader.open(fileURI, error)) {
+                succeeded = model->loadPose(reader.bytes(), reader.size(), error);
             }
         }
     }
@@ -1176,17 +1168,13 @@ DefaultFileManager::loadMotion(const URI &fileURI, Motion *motion, nanoem_frame_
 {
     nanoem_parameter_assert(!fileURI.isEmpty(), "must NOT be empty");
     nanoem_parameter_assert(motion, "must not be nullptr");
-    FileReaderScope scope(&m_translator);
+    MappedFileReader reader(&m_translator);
     bool succeeded = false;
-    if (scope.open(fileURI, error)) {
-        ByteArray bytes;
-        FileUtils::read(scope, bytes, error);
-        if (!error.hasReason()) {
-            motion->setFormat(fileURI);
-            succeeded = motion->load(bytes, offset, error);
-            if (succeeded) {
-                motion->setFileURI(fileURI);
-            }
+    if (reader.open(fileURI, error)) {
+        motion->setFormat(fileURI);
+        succeeded = motion->load(reader.bytes(), reader.size(), offset, error);
+        if (succeeded) {
+            motion->setFileURI(fileURI);
         }
     }
     return succeeded;
@@ -1455,7 +1455,7 @@ Effect::findTechnique(const String &passType, const nanoem_model_material_t *mat
             const String candidateTypes[] = { passType,
                 passType == kPassTypeObjectSelfShadow ? kPassTypeObject : String(), String() };
             for (size_t i = 0; i < BX_COUNTOF(candidateTypes); i++) {
-                foundTechnique = internalFindTechnique(candidateTypes[i], numMaterials, materialPtr);
+                foundTechnique = internalFindTechnique(candidateTypes[i], numMaterials, materialPtr, model);
                 if (foundTechnique) {
                     break;
                 }
@@ -4473,8 +4473,8 @@ Effect::internalFindTechnique(const String &passType, nanoem_rsize_t numMaterial
 }
 
 effect::Technique *
-Effect::internalFindTechnique(
-    const String &passType, nanoem_rsize_t numMaterials, const nanoem_model_material_t *material)
+Effect::internalFindTechnique(const String &passType, nanoem_rsize_t numMaterials,
+    const nanoem_model_material_t *material, const Model *model)
 {
     TechniqueListMap::const_iterator it = m_techniqueByPassTypes.find(passType);
     effect::Technique *foundTechnique = nullptr;
@@ -4491,11 +4491,11 @@ Effect::internalFindTechnique(
                 sg_pipeline_desc &desc = technique->mutablePipelineDescription();
                 const bool isEdge = passType == kPassTypeEdge;
                 if (isEdge) {
-                    Model::setEdgePipelineDescription(desc);
+                    model->setEdgePipelineDescription(desc);
                     desc.cull_mode = SG_CULLMODE_FRONT;
                 }
                 else {
-                    Model::setStandardPipelineDescription(desc);
+                    model->setStandardPipelineDescription(desc);
                     desc.cull_mode =
                         nanoemModelMaterialIsCullingDisabled(material) ? SG_CULLMODE_NONE : SG_CULLMODE_BACK;
                 }
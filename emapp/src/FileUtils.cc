@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
@@ -162,6 +163,7 @@ public:
 
     bool open(const URI &fileURI, bool append, Error &error) NANOEM_DECL_OVERRIDE;
     bool close(Error &error) NANOEM_DECL_OVERRIDE;
+    bool flush(Error &error) NANOEM_DECL_OVERRIDE;
     nanoem_i64_t seek(nanoem_i64_t offset, SeekType whence, Error &error) NANOEM_DECL_OVERRIDE;
     nanoem_i32_t write(const void *data, nanoem_i32_t size, Error &error) NANOEM_DECL_OVERRIDE;
     bool commit(Error &error) NANOEM_DECL_OVERRIDE;
@@ -228,6 +230,17 @@ Win32FileWriter::close(Error &error)
     return result;
 }
 
+bool
+Win32FileWriter::flush(Error &error)
+{
+    bool result = true;
+    if (m_file != INVALID_HANDLE_VALUE && !FlushFileBuffers(m_file)) {
+        setErrorMessage(error);
+        result = false;
+    }
+    return result;
+}
+
 nanoem_i64_t
 Win32FileWriter::seek(nanoem_i64_t offset, SeekType whence, Error &error)
 {
@@ -441,6 +454,7 @@ public:
     nanoem_i32_t write(const void *data, nanoem_i32_t size, Error &error) NANOEM_DECL_OVERRIDE;
     nanoem_i64_t seek(nanoem_i64_t offset, SeekType whence, Error &error) NANOEM_DECL_OVERRIDE;
     bool close(Error &error) NANOEM_DECL_OVERRIDE;
+    bool flush(Error &error) NANOEM_DECL_OVERRIDE;
     bool commit(Error &error) NANOEM_DECL_OVERRIDE;
     bool rollback(Error &error) NANOEM_DECL_OVERRIDE;
     URI fileURI() const NANOEM_DECL_OVERRIDE;
@@ -546,6 +560,17 @@ PosixFileWriter::close(Error &error)
     return succeeded;
 }
 
+bool
+PosixFileWriter::flush(Error &error)
+{
+    bool succeeded = true;
+    if (m_fd != -1 && ::fsync(m_fd) == -1) {
+        assignError(error);
+        succeeded = false;
+    }
+    return succeeded;
+}
+
 bool
 PosixFileWriter::commit(Error &error)
 {
@@ -725,6 +750,124 @@ MemoryReader::seek(nanoem_i64_t offset, SeekType whence, Error & /*error */)
     return ret;
 }
 
+MappedFileReader::MappedFileReader(const ITranslator *translator)
+    : m_reader(FileUtils::createFileReader(translator))
+    , m_address(nullptr)
+    , m_size(0)
+    , m_offset(0)
+{
+}
+
+MappedFileReader::~MappedFileReader() NANOEM_DECL_NOEXCEPT
+{
+    Error error;
+    close(error);
+    FileUtils::destroyFileReader(m_reader);
+    m_reader = nullptr;
+}
+
+bool
+MappedFileReader::open(const URI &fileURI, Error &error)
+{
+    /* the platform reader is opened first to report the same errors as FileReaderScope does */
+    bool succeeded = m_reader->open(fileURI, error);
+    if (succeeded) {
+        m_fileURI = fileURI;
+        m_offset = 0;
+#if !BX_PLATFORM_WINDOWS
+        int fd = ::open(fileURI.absolutePathConstString(), O_RDONLY);
+        struct stat st;
+        if (fd != -1 && ::fstat(fd, &st) != -1 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *address = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                ::posix_madvise(address, st.st_size, POSIX_MADV_SEQUENTIAL);
+                m_address = address;
+                m_size = st.st_size;
+            }
+        }
+        if (fd != -1) {
+            ::close(fd);
+        }
+#endif /* BX_PLATFORM_WINDOWS */
+        if (!m_address) {
+            FileUtils::read(m_reader, m_fallbackBytes, error);
+            m_size = m_fallbackBytes.size();
+            succeeded = !error.hasReason();
+        }
+        m_reader->close(error);
+    }
+    return succeeded;
+}
+
+bool
+MappedFileReader::close(Error & /* error */)
+{
+#if !BX_PLATFORM_WINDOWS
+    if (m_address) {
+        ::munmap(m_address, m_size);
+    }
+#endif /* BX_PLATFORM_WINDOWS */
+    m_address = nullptr;
+    m_fallbackBytes.clear();
+    m_fallbackBytes.shrink_to_fit();
+    m_size = 0;
+    m_offset = 0;
+    return true;
+}
+
+nanoem_i32_t
+MappedFileReader::read(void *data, nanoem_i32_t size, Error & /* error */)
+{
+    nanoem_rsize_t rest = m_size - nanoem_rsize_t(m_offset), actual = glm::min(static_cast<nanoem_rsize_t>(size), rest);
+    if (actual > 0) {
+        memcpy(data, bytes() + m_offset, actual);
+        m_offset += actual;
+    }
+    return Inline::saturateInt32(actual);
+}
+
+nanoem_rsize_t
+MappedFileReader::size()
+{
+    return m_size;
+}
+
+nanoem_i64_t
+MappedFileReader::seek(nanoem_i64_t offset, SeekType whence, Error & /* error */)
+{
+    switch (whence) {
+    case kSeekTypeBegin:
+        m_offset = offset;
+        break;
+    case kSeekTypeCurrent:
+        m_offset = m_offset + offset;
+        break;
+    case kSeekTypeEnd:
+        m_offset = static_cast<nanoem_i64_t>(m_size) + offset;
+        break;
+    }
+    m_offset = glm::clamp(m_offset, nanoem_i64_t(0), static_cast<nanoem_i64_t>(m_size));
+    return m_offset;
+}
+
+URI
+MappedFileReader::fileURI() const
+{
+    return m_fileURI;
+}
+
+const nanoem_u8_t *
+MappedFileReader::bytes() const NANOEM_DECL_NOEXCEPT
+{
+    return m_address ? static_cast<const nanoem_u8_t *>(m_address) : m_fallbackBytes.data();
+}
+
+bool
+MappedFileReader::isMapped() const NANOEM_DECL_NOEXCEPT
+{
+    return m_address != nullptr;
+}
+
 MemoryWriter::MemoryWriter(ByteArray *bytes)
     : m_bytesPtr(bytes)
     , m_offset(0)
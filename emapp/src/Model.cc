@@ -24,9 +24,11 @@
 #include "emapp/PerspectiveCamera.h"
 #include "emapp/PhysicsEngine.h"
 #include "emapp/Progress.h"
+#include "emapp/Profiler.h"
 #include "emapp/Project.h"
 #include "emapp/ResourceBundle.h"
 #include "emapp/StringUtils.h"
+#include "emapp/TaskScheduler.h"
 #include "emapp/UUID.h"
 #include "emapp/command/TransformBoneCommand.h"
 #include "emapp/command/TransformMorphCommand.h"
@@ -34,6 +36,8 @@
 #include "emapp/internal/LineDrawer.h"
 #include "emapp/internal/ModelObjectSelection.h"
 #include "emapp/model/BindPose.h"
+#include "emapp/model/BoneTransformSchedule.h"
+#include "emapp/model/DirtyVertexTracker.h"
 #include "emapp/model/Exporter.h"
 #include "emapp/model/IGizmo.h"
 #include "emapp/model/ISkinDeformer.h"
@@ -42,6 +46,7 @@
 #include "emapp/model/Joint.h"
 #include "emapp/model/Label.h"
 #include "emapp/model/RigidBody.h"
+#include "emapp/model/SkinningBatch.h"
 #include "emapp/model/SoftBody.h"
 #include "emapp/model/Vertex.h"
 #include "emapp/private/CommonInclude.h"
@@ -59,19 +64,18 @@
 #define PAR_SHAPES_T uint32_t
 #include "par/par_shapes.h"
 
-#if defined(NANOEM_ENABLE_TBB)
-#include "tbb/tbb.h"
-#endif /* NANOEM_ENABLE_TBB */
-#if defined(__APPLE__)
-#include <dispatch/dispatch.h>
-#endif /* __APPLE__ */
-
 namespace nanoem {
 namespace {
 
 static const nanoem_f32_t kDrawBoneConnectionThickness = 1.0f;
 static const nanoem_f32_t kDrawVertexNormalScaleFactor = 0.1f;
 static const int kMaxBoneUniforms = 55;
+static const nanoem_rsize_t kParallelSkinningVertexGrainSize = 1024;
+static const nanoem_rsize_t kParallelBoneTransformGrainSize = 16;
+/* levels smaller than this are applied on the calling thread since waking workers costs more */
+static const nanoem_rsize_t kParallelBoneTransformMinimumLevelSize = 64;
+static const nanoem_rsize_t kMaxNumPartialVertexBufferUploads = 64;
+static const nanoem_rsize_t kMaxNumCompactVertexUVAs = 4;
 
 enum PrivateStateFlags {
     kPrivateStateVisible = 1 << 1,
@@ -97,6 +101,7 @@ enum PrivateStateFlags {
     kPrivateStateShowAllVertexWeights = 1 << 21,
     kPrivateStateBlendingVertexWeightsEnabled = 1 << 22,
     kPrivateStateShowAllVertexNormals = 1 << 23,
+    kPrivateStateCompactVertexFormat = 1 << 24,
     kPrivateStateReserved = 1 << 31,
 };
 static const nanoem_u32_t kPrivateStateInitialValue = kPrivateStatePhysicsSimulation | kPrivateStateEnableGroundShadow;
@@ -476,6 +481,29 @@ Model::VertexUnit::performSkinningByType(
     }
 }
 
+nanoem_rsize_t
+Model::CompactVertexUnit::size(nanoem_rsize_t numUVAs) NANOEM_DECL_NOEXCEPT
+{
+    return sizeof(CompactVertexUnit) + sizeof(bx::simd128_t) * numUVAs;
+}
+
+void
+Model::CompactVertexUnit::pack(const VertexUnit &unit, nanoem_rsize_t numUVAs, nanoem_u8_t *ptr) NANOEM_DECL_NOEXCEPT
+{
+    CompactVertexUnit *dest = reinterpret_cast<CompactVertexUnit *>(ptr);
+    nanoem_f32_t normal[4];
+    memcpy(dest->m_position, &unit.m_position, sizeof(dest->m_position));
+    dest->m_zero = 0;
+    memcpy(normal, &unit.m_normal, sizeof(normal));
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(normal); i++) {
+        dest->m_normal[i] = nanoem_i16_t(glm::round(glm::clamp(normal[i], -1.0f, 1.0f) * 32767.0f));
+    }
+    memcpy(dest->m_texcoord, &unit.m_texcoord, sizeof(dest->m_texcoord));
+    memcpy(dest->m_edge, &unit.m_edge, sizeof(dest->m_edge));
+    memcpy(dest->m_info, &unit.m_info, sizeof(dest->m_info));
+    memcpy(ptr + sizeof(*dest), unit.m_uva, sizeof(unit.m_uva[0]) * numUVAs);
+}
+
 Model::ImportDescription::ImportDescription(const URI &fileURI)
     : m_fileURI(fileURI)
     , m_transform(1)
@@ -532,6 +560,7 @@ Model::ParallelSkinningTaskData::ParallelSkinningTaskData(
     , m_drawType(type)
     , m_edgeSizeScaleFactor(edgeSizeFactor)
     , m_boneIndices(0)
+    , m_dirtyVertexTracker(nullptr)
     , m_output(0)
     , m_materials(nullptr)
     , m_vertices(nullptr)
@@ -759,24 +788,6 @@ Model::isLoadableExtension(const URI &fileURI)
     return isLoadableExtension(fileURI.pathExtension());
 }
 
-void
-Model::setStandardPipelineDescription(sg_pipeline_desc &desc)
-{
-    setCommonPipelineDescription(desc);
-    sg_layout_desc &ld = desc.layout;
-    ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_position), SG_VERTEXFORMAT_FLOAT3 };
-    ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
-}
-
-void
-Model::setEdgePipelineDescription(sg_pipeline_desc &desc)
-{
-    setCommonPipelineDescription(desc);
-    sg_layout_desc &ld = desc.layout;
-    ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_edge), SG_VERTEXFORMAT_FLOAT3 };
-    ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
-}
-
 void
 Model::generateNewModelData(const NewModelDescription &desc, nanoem_unicode_string_factory_t *factory, ByteArray &bytes,
     nanoem_status_t &status)
@@ -860,6 +871,9 @@ Model::Model(Project *project, nanoem_u16_t handle)
     , m_selection(nullptr)
     , m_drawer(nullptr)
     , m_skinDeformer(nullptr)
+    , m_skinningBatch(nullptr)
+    , m_boneTransformSchedule(nullptr)
+    , m_dirtyVertexTracker(nullptr)
     , m_gizmo(nullptr)
     , m_vertexWeightPainter(nullptr)
     , m_opaque(nullptr)
@@ -879,9 +893,10 @@ Model::Model(Project *project, nanoem_u16_t handle)
     , m_states(kPrivateStateInitialValue)
     , m_edgeSizeScaleFactor(1.0f)
     , m_opacity(1.0f)
-    , m_dispatchParallelTaskQueue(nullptr)
     , m_countVertexSkinningNeeded(0)
     , m_stageVertexBufferIndex(0)
+    , m_uploadedVertexBufferBytes(0)
+    , m_numCompactVertexUVAs(0)
 {
     nanoem_assert(m_project, "must not be nullptr");
     Inline::clearZeroMemory(m_activeMorphPtr);
@@ -889,6 +904,9 @@ Model::Model(Project *project, nanoem_u16_t handle)
     m_activeEffectPtrPair.first = m_project->sharedResourceRepository()->modelProgramBundle();
     m_activeEffectPtrPair.second = nullptr;
     m_selection = nanoem_new(internal::ModelObjectSelection(this));
+    m_skinningBatch = nanoem_new(model::SkinningBatch);
+    m_boneTransformSchedule = nanoem_new(model::BoneTransformSchedule);
+    m_dirtyVertexTracker = nanoem_new(model::DirtyVertexTracker);
     undo_stack_t *projectUndoStack = m_project->undoStack();
     m_undoStack = undoStackCreateWithSoftLimit(undoStackGetSoftLimit(projectUndoStack));
     m_editingUndoStack = undoStackCreateWithSoftLimit(undoStackGetSoftLimit(projectUndoStack));
@@ -908,6 +926,9 @@ Model::~Model() NANOEM_DECL_NOEXCEPT
     nanoem_delete_safe(m_camera);
     nanoem_delete_safe(m_drawer);
     nanoem_delete_safe(m_skinDeformer);
+    nanoem_delete_safe(m_skinningBatch);
+    nanoem_delete_safe(m_boneTransformSchedule);
+    nanoem_delete_safe(m_dirtyVertexTracker);
     nanoem_delete_safe(m_gizmo);
     nanoem_delete_safe(m_vertexWeightPainter);
     nanoem_delete_safe(m_selection);
@@ -917,6 +938,7 @@ Model::~Model() NANOEM_DECL_NOEXCEPT
     undoStackDestroy(m_editingUndoStack);
     m_editingUndoStack = nullptr;
     nanoemModelDestroy(m_opaque);
+    m_project->physicsEngine()->destroyIsland(m_opaque);
     m_activeBonePairPtr.first = m_activeBonePairPtr.second = nullptr;
     m_activeEffectPtrPair.first = nullptr;
     m_activeEffectPtrPair.second = nullptr;
@@ -934,7 +956,11 @@ Model::load(const nanoem_u8_t *bytes, size_t length, Error &error)
     nanoem_parameter_assert(bytes, "must not be nullptr");
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
     nanoem_buffer_t *buffer = nanoemBufferCreate(bytes, length, &status);
+    if (m_project->isParallelModelLoadingEnabled()) {
+        nanoemModelSetParallelDispatcher(m_opaque, handleDispatchParallelLoadingTasks, this);
+    }
     nanoemModelLoadFromBuffer(m_opaque, buffer, &status);
+    nanoemModelSetParallelDispatcher(m_opaque, nullptr, nullptr);
     nanoemBufferDestroy(buffer);
     bool succeeded = status == NANOEM_STATUS_SUCCESS;
     if (succeeded) {
@@ -1331,6 +1357,10 @@ Model::setupAllBindings()
         label->resetLanguage(labelPtr, factory, language);
     }
     PhysicsEngine *physics = m_project->physicsEngine();
+    if (m_project->isPhysicsWorldPerModelEnabled()) {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        physics->createIsland(m_opaque, status);
+    }
     nanoem_model_rigid_body_t *const *rigidBodies = nanoemModelGetAllRigidBodyObjects(m_opaque, &numObjects);
     for (nanoem_rsize_t i = 0; i < numObjects; i++) {
         nanoem_model_rigid_body_t *rigidBodyPtr = rigidBodies[i];
@@ -1374,19 +1404,6 @@ Model::upload()
     initializeAllStagingVertexBuffers();
     initializeStagingIndexBuffer();
     setActiveEffect(m_project->sharedResourceRepository()->modelProgramBundle());
-#if defined(__APPLE__)
-#ifdef NDEBUG
-#define GCD_LABEL(a) nullptr
-#else
-#define GCD_LABEL(a) a
-#endif /* NDEBUG */
-    if (dispatch_queue_t queue = static_cast<dispatch_queue_t>(m_dispatchParallelTaskQueue)) {
-        dispatch_release(queue);
-    }
-    m_dispatchParallelTaskQueue =
-        dispatch_queue_create(GCD_LABEL("com.github.nanoem.gcd.model"), DISPATCH_QUEUE_CONCURRENT);
-#undef GCD_LABEL
-#endif /* __APPLE__ */
     EnumUtils::setEnabled(kPrivateStateUploaded, m_states, true);
     setDirty(true);
     SG_POP_GROUP();
@@ -1618,9 +1635,11 @@ Model::clear()
     m_constraintEffectorBones.clear();
     m_boneBoundRigidBodies.clear();
     m_parentBoneTree.clear();
+    m_boneTransformSchedule->clear();
     m_boundingBox.reset();
     m_name = m_comment = m_canonicalName = String();
     nanoemModelDestroy(m_opaque);
+    m_project->physicsEngine()->destroyIsland(m_opaque);
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
     m_opaque = nanoemModelCreate(m_project->unicodeStringFactory(), &status);
 }
@@ -1636,12 +1655,6 @@ Model::destroy()
     if (UserDataDestructor destructor = m_userData.second) {
         destructor(m_userData.first, this);
     }
-#if defined(__APPLE__)
-    if (dispatch_queue_t queue = static_cast<dispatch_queue_t>(m_dispatchParallelTaskQueue)) {
-        m_dispatchParallelTaskQueue = 0;
-        dispatch_release(queue);
-    }
-#endif /* __APPLE__ */
     internalClear();
     SG_POP_GROUP();
 }
@@ -1649,9 +1662,18 @@ Model::destroy()
 void
 Model::synchronizeMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
     PhysicsEngine::SimulationTimingType timing)
+{
+    NANOEM_PROFILER_SCOPE("Model::synchronizeMotion");
+    synchronizeModelMotion(motion, frameIndex, timing);
+    synchronizeTransformMotion(motion, frameIndex, amount, timing);
+    synchronizeRigidBodyMotion(motion, frameIndex, timing);
+}
+
+void
+Model::synchronizeModelMotion(
+    const Motion *motion, nanoem_frame_index_t frameIndex, PhysicsEngine::SimulationTimingType timing)
 {
     const nanoem_motion_model_keyframe_t *keyframe = nullptr;
-    bool visible = true;
     if (motion && timing == PhysicsEngine::kSimulationTimingBefore) {
         keyframe = motion->findModelKeyframe(frameIndex);
         if (keyframe) {
@@ -1686,30 +1708,38 @@ Model::synchronizeMotion(const Motion *motion, nanoem_frame_index_t frameIndex,
             }
         }
         if (keyframe) {
-            visible = nanoemMotionModelKeyframeIsVisible(keyframe) != 0;
             setPhysicsSimulationEnabled(nanoemMotionModelKeyframeIsPhysicsSimulationEnabled(keyframe) != 0);
-            setVisible(visible);
+            setVisible(nanoemMotionModelKeyframeIsVisible(keyframe) != 0);
             synchronizeAllConstraintStates(keyframe);
             synchronizeAllOutsideParents(keyframe);
         }
-        else {
-            visible = isVisible();
-        }
     }
-    if (motion && visible) {
-        if (timing == PhysicsEngine::kSimulationTimingBefore) {
-            m_boundingBox.reset();
-            resetAllMaterials();
-            resetAllBoneLocalTransform();
-            synchronizeMorphMotion(motion, frameIndex, amount);
-            synchronizeBoneMotion(motion, frameIndex, amount, timing);
-            solveAllConstraints();
-            synchronizeAllRigidBodyKinematics(motion, frameIndex);
-            synchronizeAllRigidBodiesTransformFeedbackToSimulation();
-        }
-        else if (timing == PhysicsEngine::kSimulationTimingAfter) {
-            synchronizeBoneMotion(motion, frameIndex, amount, timing);
-        }
+}
+
+void
+Model::synchronizeTransformMotion(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_f32_t amount,
+    PhysicsEngine::SimulationTimingType timing)
+{
+    if (motion && timing == PhysicsEngine::kSimulationTimingBefore && isVisible()) {
+        m_boundingBox.reset();
+        resetAllMaterials();
+        resetAllBoneLocalTransform();
+        synchronizeMorphMotion(motion, frameIndex, amount);
+        synchronizeBoneMotion(motion, frameIndex, amount, timing);
+        solveAllConstraints();
+    }
+    else if (motion && timing == PhysicsEngine::kSimulationTimingAfter) {
+        synchronizeBoneMotion(motion, frameIndex, amount, timing);
+    }
+}
+
+void
+Model::synchronizeRigidBodyMotion(
+    const Motion *motion, nanoem_frame_index_t frameIndex, PhysicsEngine::SimulationTimingType timing)
+{
+    if (motion && timing == PhysicsEngine::kSimulationTimingBefore && isVisible()) {
+        synchronizeAllRigidBodyKinematics(motion, frameIndex);
+        synchronizeAllRigidBodiesTransformFeedbackToSimulation();
     }
 }
 
@@ -1799,7 +1829,8 @@ Model::performAllBonesTransform()
     PhysicsEngine *engine = m_project->physicsEngine();
     if (engine->simulationMode() == PhysicsEngine::kSimulationModeEnableAnytime) {
         synchronizeAllRigidBodiesTransformFeedbackToSimulation();
-        engine->stepSimulation(m_project->physicsSimulationTimeStep());
+        /* only the island of the model is stepped if it exists since other models are not synchronized here */
+        engine->findIsland(m_opaque)->stepSimulation(m_project->physicsSimulationTimeStep());
         synchronizeAllRigidBodiesTransformFeedbackFromSimulation(PhysicsEngine::kRigidBodyFollowBoneSkip);
     }
     applyAllBonesTransform(PhysicsEngine::kSimulationTimingAfter);
@@ -1906,6 +1937,62 @@ Model::deformAllMorphs(bool checkDirty)
     }
 }
 
+void
+Model::saveBakedPose(BonePoseList &bonePoses, MorphWeightList &morphWeights) const
+{
+    nanoem_rsize_t numBones, numMorphs;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
+    nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(m_opaque, &numMorphs);
+    bonePoses.resize(numBones);
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        if (const model::Bone *bone = model::Bone::cast(bones[i])) {
+            bone->savePose(bonePoses[i]);
+        }
+    }
+    morphWeights.resize(numMorphs);
+    for (nanoem_rsize_t i = 0; i < numMorphs; i++) {
+        const model::Morph *morph = model::Morph::cast(morphs[i]);
+        morphWeights[i] = morph ? morph->weight() : 0.0f;
+    }
+}
+
+bool
+Model::restoreBakedPose(const BonePoseList &bonePoses, const MorphWeightList &morphWeights)
+{
+    nanoem_rsize_t numBones, numMorphs;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(m_opaque, &numBones);
+    nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(m_opaque, &numMorphs);
+    bool restored = false;
+    if (bonePoses.size() == numBones && morphWeights.size() == numMorphs) {
+        m_boundingBox.reset();
+        resetAllMaterials();
+        if (!EnumUtils::isEnabled(kPrivateStateDirtyMorph, m_states)) {
+            resetAllMorphs();
+            for (nanoem_rsize_t i = 0; i < numMorphs; i++) {
+                if (model::Morph *morph = model::Morph::cast(morphs[i])) {
+                    morph->setWeight(morphWeights[i]);
+                }
+            }
+            /* vertex and material morphs are deformed again as only their weights are saved */
+            deformAllMorphs(true);
+            for (nanoem_rsize_t i = 0; i < numMorphs; i++) {
+                if (model::Morph *morph = model::Morph::cast(morphs[i])) {
+                    morph->setDirty(false);
+                }
+            }
+            EnumUtils::setEnabled(kPrivateStateDirtyMorph, m_states, true);
+        }
+        /* bone morphs are already applied to the saved poses so they must be restored after deforming morphs */
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            if (model::Bone *bone = model::Bone::cast(bones[i])) {
+                bone->restorePose(bones[i], bonePoses[i]);
+            }
+        }
+        restored = true;
+    }
+    return restored;
+}
+
 bool
 Model::isStagingVertexBufferDirty() const NANOEM_DECL_NOEXCEPT
 {
@@ -1921,6 +2008,8 @@ Model::markStagingVertexBufferDirty()
 void
 Model::updateStagingVertexBuffer()
 {
+    NANOEM_PROFILER_SCOPE("Model::updateStagingVertexBuffer");
+    m_uploadedVertexBufferBytes = 0;
     if (EnumUtils::isEnabled(kPrivateStateDirtyStagingBuffer, m_states)) {
         sg_buffer stagingVertexBuffer = m_vertexBuffers[m_stageVertexBufferIndex];
         if (sg::is_valid(stagingVertexBuffer)) {
@@ -1928,14 +2017,24 @@ Model::updateStagingVertexBuffer()
             if (m_skinDeformer) {
                 m_skinDeformer->execute(m_stageVertexBufferIndex);
             }
-            else if (nanoem_u8_t *ptr = static_cast<nanoem_u8_t *>(sg::map_buffer(stagingVertexBuffer))) {
-                internalUpdateStagingVertexBuffer(ptr, m_vertexBufferData.size() / sizeof(VertexUnit));
-                sg::unmap_buffer(stagingVertexBuffer, ptr);
-            }
-            else if (!m_vertexBufferData.empty()) {
-                const size_t size = m_vertexBufferData.size();
-                internalUpdateStagingVertexBuffer(m_vertexBufferData.data(), size / sizeof(VertexUnit));
-                sg::update_buffer(stagingVertexBuffer, m_vertexBufferData.data(), Inline::saturateInt32(size));
+            else {
+                /* compact vertices are packed from vertex buffer data so the buffer is mapped only without them */
+                nanoem_u8_t *ptr = !isCompactVertexFormatEnabled()
+                    ? static_cast<nanoem_u8_t *>(sg::map_buffer(stagingVertexBuffer))
+                    : nullptr;
+                if (ptr) {
+                    /* mapped memory is not guaranteed to keep previous contents so all vertices are transformed */
+                    const size_t size = m_vertexBufferData.size();
+                    internalUpdateStagingVertexBuffer(ptr, size / sizeof(VertexUnit), false);
+                    sg::unmap_buffer(stagingVertexBuffer, ptr);
+                    m_uploadedVertexBufferBytes = size;
+                }
+                else if (!m_vertexBufferData.empty()) {
+                    /* vertex buffer data is the source of partial uploads when the buffer cannot be mapped */
+                    const size_t size = m_vertexBufferData.size();
+                    internalUpdateStagingVertexBuffer(m_vertexBufferData.data(), size / sizeof(VertexUnit), true);
+                    m_uploadedVertexBufferBytes = uploadStagingVertexBuffer(stagingVertexBuffer);
+                }
             }
             m_stageVertexBufferIndex = 1 - m_stageVertexBufferIndex;
             SG_POP_GROUP();
@@ -1944,6 +2043,54 @@ Model::updateStagingVertexBuffer()
     }
 }
 
+nanoem_rsize_t
+Model::uploadedVertexBufferBytes() const NANOEM_DECL_NOEXCEPT
+{
+    return m_uploadedVertexBufferBytes;
+}
+
+void
+Model::setStandardPipelineDescription(sg_pipeline_desc &desc) const
+{
+    setCommonPipelineDescription(desc);
+    sg_layout_desc &ld = desc.layout;
+    if (isCompactVertexFormatEnabled()) {
+        ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(CompactVertexUnit, m_position), SG_VERTEXFORMAT_FLOAT3 };
+        ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(CompactVertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
+    }
+    else {
+        ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_position), SG_VERTEXFORMAT_FLOAT3 };
+        ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
+    }
+}
+
+void
+Model::setEdgePipelineDescription(sg_pipeline_desc &desc) const
+{
+    setCommonPipelineDescription(desc);
+    sg_layout_desc &ld = desc.layout;
+    if (isCompactVertexFormatEnabled()) {
+        ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(CompactVertexUnit, m_edge), SG_VERTEXFORMAT_FLOAT3 };
+        ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(CompactVertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
+    }
+    else {
+        ld.attrs[0] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_edge), SG_VERTEXFORMAT_FLOAT3 };
+        ld.attrs[7] = sg_vertex_attr_desc { 0, offsetof(VertexUnit, m_info), SG_VERTEXFORMAT_FLOAT4 };
+    }
+}
+
+nanoem_rsize_t
+Model::vertexUnitSize() const NANOEM_DECL_NOEXCEPT
+{
+    return isCompactVertexFormatEnabled() ? CompactVertexUnit::size(m_numCompactVertexUVAs) : sizeof(VertexUnit);
+}
+
+bool
+Model::isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kPrivateStateCompactVertexFormat, m_states);
+}
+
 void
 Model::registerUpdateActiveBoneTransformCommand(const Vector3 &translation, const Quaternion &orientation)
 {
@@ -2112,6 +2259,7 @@ void
 Model::addBoneReference(nanoem_model_bone_t *value)
 {
     if (value) {
+        m_boneTransformSchedule->invalidate();
         if (nanoem_model_constraint_t *constraintPtr = nanoemModelBoneGetConstraintObjectMutable(value)) {
             bindConstraint(constraintPtr);
         }
@@ -2168,6 +2316,7 @@ Model::removeBoneReference(const String &value)
     if (it != m_bones.end()) {
         const nanoem_model_bone_t *bonePtr = it->second;
         m_bones.erase(it);
+        m_boneTransformSchedule->invalidate();
         if (const nanoem_model_constraint_t *constraintPtr = nanoemModelBoneGetConstraintObject(bonePtr)) {
             nanoem_rsize_t numJoints;
             nanoem_model_constraint_joint_t *const *joints =
@@ -2258,15 +2407,15 @@ Model::pushUndo(undo_command_t *command)
 void
 Model::solveAllConstraints()
 {
+    NANOEM_PROFILER_SCOPE("Model::solveAllConstraints");
     nanoem_rsize_t numConstraints;
-    nanoem_unicode_string_factory_t *factory = m_project->unicodeStringFactory();
     nanoem_model_constraint_t *const *constraints = nanoemModelGetAllConstraintObjects(m_opaque, &numConstraints);
     for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
         const nanoem_model_constraint_t *constraintPtr = constraints[i];
         if (const model::Constraint *constraint = model::Constraint::cast(constraintPtr)) {
             if (constraint->isEnabled()) {
                 const int numIterations = nanoemModelConstraintGetNumIterations(constraintPtr);
-                solveConstraint(constraintPtr, numIterations, factory);
+                solveConstraint(constraintPtr, numIterations);
             }
             else {
                 nanoem_rsize_t numJoints;
@@ -2833,9 +2982,8 @@ Model::compareBoneVertexList(const void *a, const void *b)
 }
 
 void
-Model::handlePerformSkinningVertexTransform(void *opaque, size_t index)
+Model::performSkinningVertexTransform(const ParallelSkinningTaskData *s, nanoem_rsize_t index)
 {
-    const ParallelSkinningTaskData *s = static_cast<const ParallelSkinningTaskData *>(opaque);
     model::Vertex *vertex = model::Vertex::cast(s->m_vertices[index]);
     VertexUnit &p = reinterpret_cast<VertexUnit *>(s->m_output)[index];
     switch (s->m_drawType) {
@@ -2853,9 +3001,97 @@ Model::handlePerformSkinningVertexTransform(void *opaque, size_t index)
 }
 
 void
-Model::setCommonPipelineDescription(sg_pipeline_desc &desc)
+Model::handlePerformSkinningVertexTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const ParallelSkinningTaskData *s = static_cast<const ParallelSkinningTaskData *>(opaque);
+    const model::DirtyVertexTracker *tracker = s->m_dirtyVertexTracker;
+    for (nanoem_rsize_t i = begin; i < end; i++) {
+        if (!tracker || tracker->isDirty(i)) {
+            performSkinningVertexTransform(s, i);
+        }
+    }
+}
+
+void
+Model::handlePerformSkinningBatchTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const ParallelSkinningTaskData *s = static_cast<const ParallelSkinningTaskData *>(opaque);
+    const model::SkinningBatch *batch = s->m_model->m_skinningBatch;
+    const model::DirtyVertexTracker *tracker = s->m_dirtyVertexTracker;
+    for (nanoem_rsize_t i = begin; i < end; i++) {
+        bool dirty = !tracker;
+        for (nanoem_rsize_t j = 0, numVertices = batch->numBlockVertices(i); !dirty && j < numVertices; j++) {
+            dirty = tracker->isDirty(batch->blockVertexIndex(i, j));
+        }
+        if (dirty) {
+            batch->execute(i, s->m_edgeSizeScaleFactor, s->m_vertices, s->m_output);
+        }
+    }
+}
+
+void
+Model::handlePerformSkinningFallbackVertexTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const ParallelSkinningTaskData *s = static_cast<const ParallelSkinningTaskData *>(opaque);
+    const model::SkinningBatch *batch = s->m_model->m_skinningBatch;
+    const model::DirtyVertexTracker *tracker = s->m_dirtyVertexTracker;
+    for (nanoem_rsize_t i = begin; i < end; i++) {
+        const nanoem_rsize_t index = batch->fallbackVertexIndex(i);
+        if (!tracker || tracker->isDirty(index)) {
+            performSkinningVertexTransform(s, index);
+        }
+    }
+}
+
+void
+Model::handlePackCompactVertexBuffer(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    Model *self = static_cast<Model *>(opaque);
+    self->packCompactVertexBuffer(begin, end);
+}
+
+void
+Model::handleApplyAllBonesTransform(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const ParallelBoneTransformTaskData *s = static_cast<const ParallelBoneTransformTaskData *>(opaque);
+    for (nanoem_rsize_t i = begin; i < end; i++) {
+        const nanoem_model_bone_t *bonePtr = s->m_bones[i];
+        if (model::Bone *bone = model::Bone::cast(bonePtr)) {
+            bone->applyAllLocalTransform(bonePtr, s->m_model);
+            bone->applyOutsideParentTransform(bonePtr, s->m_model);
+        }
+    }
+}
+
+void
+Model::handleDispatchParallelLoadingTasks(void *userData, DispatchParallelTasksIterator iterator, void *opaque,
+    nanoem_rsize_t iterations, nanoem_rsize_t grainSize)
+{
+    Model *self = static_cast<Model *>(userData);
+    self->dispatchParallelTasks(iterator, opaque, iterations, grainSize);
+}
+
+void
+Model::setCommonPipelineDescription(sg_pipeline_desc &desc) const
 {
     sg_layout_desc &ld = desc.layout;
+    if (isCompactVertexFormatEnabled()) {
+        ld.buffers[0].stride = Inline::saturateInt32(vertexUnitSize());
+        ld.attrs[1] = sg_vertex_attr_desc { 0, Inline::saturateInt32(offsetof(CompactVertexUnit, m_normal)),
+            SG_VERTEXFORMAT_SHORT4N };
+        ld.attrs[2] = sg_vertex_attr_desc { 0, Inline::saturateInt32(offsetof(CompactVertexUnit, m_texcoord)),
+            SG_VERTEXFORMAT_FLOAT2 };
+        /* UVA attributes not used by the model read the zero field instead of allocating them per vertex */
+        for (nanoem_rsize_t i = 0; i < kMaxNumCompactVertexUVAs; i++) {
+            ld.attrs[i + 3] = i < m_numCompactVertexUVAs
+                ? sg_vertex_attr_desc { 0, Inline::saturateInt32(CompactVertexUnit::size(i)), SG_VERTEXFORMAT_FLOAT4 }
+                : sg_vertex_attr_desc { 0, Inline::saturateInt32(offsetof(CompactVertexUnit, m_zero)),
+                      SG_VERTEXFORMAT_UBYTE4N };
+        }
+        desc.index_type = SG_INDEXTYPE_UINT32;
+        Project::setStandardDepthStencilState(desc.depth, desc.stencil);
+        return;
+    }
     ld.buffers[0].stride = sizeof(VertexUnit);
     ld.attrs[1] =
         sg_vertex_attr_desc { 0, Inline::saturateInt32(offsetof(VertexUnit, m_normal)), SG_VERTEXFORMAT_FLOAT3 };
@@ -3133,7 +3369,7 @@ Model::bindConstraint(nanoem_model_constraint_t *constraintPtr)
     model::Constraint *constriant = model::Constraint::create();
     constriant->bind(constraintPtr);
     constriant->resetLanguage(constraintPtr, m_project->unicodeStringFactory(), m_project->castLanguage());
-    constriant->initialize(constraintPtr);
+    constriant->initialize(constraintPtr, m_project->unicodeStringFactory());
     nanoem_rsize_t numJoints;
     nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
     const nanoem_model_constraint_t *constraintConstPtr = constraintPtr;
@@ -3148,21 +3384,77 @@ Model::bindConstraint(nanoem_model_constraint_t *constraintPtr)
 void
 Model::applyAllBonesTransform(PhysicsEngine::SimulationTimingType timing)
 {
-    nanoem_rsize_t numObjects;
-    nanoem_model_bone_t *const *bones = nanoemModelGetAllOrderedBoneObjects(m_opaque, &numObjects);
     if (timing == PhysicsEngine::kSimulationTimingBefore) {
         m_boundingBox.reset();
     }
-    for (nanoem_rsize_t i = 0; i < numObjects; i++) {
-        const nanoem_model_bone_t *bonePtr = bones[i];
-        if ((nanoemModelBoneIsAffectedByPhysicsSimulation(bonePtr) != 0) == timing) {
-            if (model::Bone *bone = model::Bone::cast(bonePtr)) {
-                bone->applyAllLocalTransform(bonePtr, this);
-                bone->applyOutsideParentTransform(bonePtr, this);
+    internalApplyAllBonesTransform(timing);
+}
+
+void
+Model::internalApplyAllBonesTransform(PhysicsEngine::SimulationTimingType timing)
+{
+    if (isBoneTransformSchedulable()) {
+        if (!m_boneTransformSchedule->isValid()) {
+            m_boneTransformSchedule->build(this);
+        }
+        ParallelBoneTransformTaskData s;
+        s.m_model = this;
+        s.m_bones = m_boneTransformSchedule->allBones(timing);
+        for (nanoem_rsize_t i = 0, numLevels = m_boneTransformSchedule->numLevels(timing); i < numLevels; i++) {
+            const model::BoneTransformSchedule::Level &level = m_boneTransformSchedule->level(timing, i);
+            const nanoem_rsize_t offset = level.m_offset, numBones = level.m_numBones;
+            if (level.m_barrier || numBones < kParallelBoneTransformMinimumLevelSize) {
+                handleApplyAllBonesTransform(&s, offset, offset + numBones);
+            }
+            else {
+                ParallelBoneTransformTaskData ls(s);
+                ls.m_bones += offset;
+                dispatchParallelTasks(
+                    &Model::handleApplyAllBonesTransform, &ls, numBones, kParallelBoneTransformGrainSize);
+            }
+        }
+        const nanoem_model_bone_t *const *bones = s.m_bones;
+        for (nanoem_rsize_t i = 0, numBones = m_boneTransformSchedule->numBones(timing); i < numBones; i++) {
+            if (const model::Bone *bone = model::Bone::cast(bones[i])) {
                 m_boundingBox.set(bone->worldTransformOrigin());
             }
         }
     }
+    else {
+        nanoem_rsize_t numObjects;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllOrderedBoneObjects(m_opaque, &numObjects);
+        for (nanoem_rsize_t i = 0; i < numObjects; i++) {
+            const nanoem_model_bone_t *bonePtr = bones[i];
+            if ((nanoemModelBoneIsAffectedByPhysicsSimulation(bonePtr) != 0) == timing) {
+                if (model::Bone *bone = model::Bone::cast(bonePtr)) {
+                    bone->applyAllLocalTransform(bonePtr, this);
+                    bone->applyOutsideParentTransform(bonePtr, this);
+                    m_boundingBox.set(bone->worldTransformOrigin());
+                }
+            }
+        }
+    }
+}
+
+bool
+Model::isBoneTransformSchedulable() const NANOEM_DECL_NOEXCEPT
+{
+    /* bones may be reparented directly while editing model so the schedule is rebuilt after editing */
+    bool schedulable = !m_project->isModelEditingEnabled();
+    if (schedulable) {
+        for (model::Bone::OutsideParentMap::const_iterator it = m_outsideParents.begin(), end = m_outsideParents.end();
+             it != end; ++it) {
+            /* an outside parent refers a bone of this model cannot be tracked by the schedule */
+            if (m_project->findModelByName(it->second.first) == this) {
+                schedulable = false;
+                break;
+            }
+        }
+    }
+    else {
+        m_boneTransformSchedule->invalidate();
+    }
+    return schedulable;
 }
 
 void
@@ -3283,6 +3575,9 @@ Model::initializeAllStagingVertexBuffers()
                 }
                 m_vertexBuffers[1] = skinDeformer->create(desc, 1);
                 m_skinDeformer = skinDeformer;
+                /* skin deformer requires weights and indices of the standard layout */
+                EnumUtils::setEnabled(kPrivateStateCompactVertexFormat, m_states, false);
+                m_compactVertexBufferData.clear();
             }
         }
         if (!m_skinDeformer) {
@@ -3339,7 +3634,22 @@ Model::initializeVertexBufferByteArray()
     ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
     m_vertexBufferData.resize(sizeof(Model::VertexUnit) * glm::max(s.m_numVertices, nanoem_rsize_t(1)));
     s.m_output = m_vertexBufferData.data();
-    dispatchParallelTasks(&Model::handlePerformSkinningVertexTransform, &s, s.m_numVertices);
+    dispatchParallelTasks(
+        &Model::handlePerformSkinningVertexTransform, &s, s.m_numVertices, kParallelSkinningVertexGrainSize);
+    m_skinningBatch->build(this);
+    m_dirtyVertexTracker->build(this);
+    const bool compact = m_project->isCompactVertexFormatEnabled();
+    EnumUtils::setEnabled(kPrivateStateCompactVertexFormat, m_states, compact);
+    if (compact) {
+        m_numCompactVertexUVAs = glm::min(nanoemModelGetAdditionalUVSize(m_opaque), kMaxNumCompactVertexUVAs);
+        m_compactVertexBufferData.resize(vertexUnitSize() * glm::max(s.m_numVertices, nanoem_rsize_t(1)));
+        dispatchParallelTasks(
+            &Model::handlePackCompactVertexBuffer, this, s.m_numVertices, kParallelSkinningVertexGrainSize);
+    }
+    else {
+        m_numCompactVertexUVAs = 0;
+        m_compactVertexBufferData.clear();
+    }
 }
 
 void
@@ -3349,7 +3659,7 @@ Model::createAllStagingVertexBuffers()
     sg_buffer_desc desc;
     Inline::clearZeroMemory(desc);
     desc.usage = SG_USAGE_STREAM;
-    desc.size = m_vertexBufferData.size();
+    desc.size = isCompactVertexFormatEnabled() ? m_compactVertexBufferData.size() : m_vertexBufferData.size();
     if (Inline::isDebugLabelEnabled()) {
         StringUtils::format(label, sizeof(label), "Models/%s/VertexBuffer/Even", canonicalNameConstString());
         desc.label = label;
@@ -3368,21 +3678,21 @@ Model::createAllStagingVertexBuffers()
 }
 
 void
-Model::internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVertices)
+Model::internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVertices, bool trackDirtyVertices)
 {
     nanoem_rsize_t numSoftBodies;
     nanoem_model_soft_body_t *const *softBodies = nanoemModelGetAllSoftBodyObjects(m_opaque, &numSoftBodies);
     if (softBodies && numSoftBodies > 0) {
         VertexUnit *vertexUnits = reinterpret_cast<VertexUnit *>(ptr);
+        /* soft bodies write vertices directly so tracking dirty vertices is not possible */
+        m_dirtyVertexTracker->invalidate();
         for (nanoem_rsize_t i = 0; i < numSoftBodies; i++) {
             const nanoem_model_soft_body_t *softBodyPtr = softBodies[i];
             if (model::SoftBody *softBody = model::SoftBody::cast(softBodyPtr)) {
                 softBody->synchronizeTransformFeedbackFromSimulation(vertexUnits, numVertices);
             }
         }
-        ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
-        s.m_output = ptr;
-        dispatchParallelTasks(&Model::handlePerformSkinningVertexTransform, &s, numVertices);
+        performAllSkinningVertexTransforms(ptr, numVertices, false);
         for (nanoem_rsize_t i = 0; i < numSoftBodies; i++) {
             const nanoem_model_soft_body_t *softBodyPtr = softBodies[i];
             if (model::SoftBody *softBody = model::SoftBody::cast(softBodyPtr)) {
@@ -3391,9 +3701,92 @@ Model::internalUpdateStagingVertexBuffer(nanoem_u8_t *ptr, nanoem_rsize_t numVer
         }
     }
     else {
-        ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
-        s.m_output = ptr;
-        dispatchParallelTasks(&Model::handlePerformSkinningVertexTransform, &s, numVertices);
+        performAllSkinningVertexTransforms(ptr, numVertices, trackDirtyVertices);
+    }
+}
+
+nanoem_rsize_t
+Model::uploadStagingVertexBuffer(sg_buffer buffer)
+{
+    const model::DirtyVertexTracker::RangeList &ranges = m_dirtyVertexTracker->collectRanges(m_stageVertexBufferIndex);
+    const bool compact = isCompactVertexFormatEnabled();
+    const ByteArray &bytes = compact ? m_compactVertexBufferData : m_vertexBufferData;
+    const nanoem_rsize_t size = bytes.size(), unitSize = vertexUnitSize();
+    nanoem_rsize_t numDirtyBytes = 0;
+    for (model::DirtyVertexTracker::RangeList::const_iterator it = ranges.begin(), end = ranges.end(); it != end;
+         ++it) {
+        numDirtyBytes += (it->second - it->first) * unitSize;
+    }
+    /* partial upload is worth only when the most of the buffer is not changed */
+    bool partial = sg::update_buffer_range != nullptr && numDirtyBytes < size / 2 &&
+        ranges.size() <= kMaxNumPartialVertexBufferUploads;
+    for (model::DirtyVertexTracker::RangeList::const_iterator it = ranges.begin(), end = ranges.end();
+         partial && it != end; ++it) {
+        const nanoem_rsize_t offset = it->first * unitSize;
+        if (compact) {
+            packCompactVertexBuffer(it->first, it->second);
+        }
+        partial = sg::update_buffer_range(buffer, Inline::saturateInt32(offset), bytes.data() + offset,
+            Inline::saturateInt32((it->second - it->first) * unitSize));
+    }
+    if (!partial) {
+        if (compact) {
+            dispatchParallelTasks(&Model::handlePackCompactVertexBuffer, this,
+                m_vertexBufferData.size() / sizeof(VertexUnit), kParallelSkinningVertexGrainSize);
+        }
+        sg::update_buffer(buffer, bytes.data(), Inline::saturateInt32(size));
+        numDirtyBytes = size;
+    }
+    return numDirtyBytes;
+}
+
+void
+Model::packCompactVertexBuffer(nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const VertexUnit *units = reinterpret_cast<const VertexUnit *>(m_vertexBufferData.data());
+    const nanoem_rsize_t unitSize = vertexUnitSize();
+    nanoem_u8_t *ptr = m_compactVertexBufferData.data();
+    for (nanoem_rsize_t i = begin; i < end; i++) {
+        CompactVertexUnit::pack(units[i], m_numCompactVertexUVAs, ptr + i * unitSize);
+    }
+}
+
+void
+Model::performAllSkinningVertexTransforms(nanoem_u8_t *ptr, nanoem_rsize_t numVertices, bool trackDirtyVertices)
+{
+    ParallelSkinningTaskData s(this, m_project->drawType(), edgeSize());
+    bool batchable;
+    s.m_output = ptr;
+    switch (s.m_drawType) {
+    case IDrawable::kDrawTypeColor:
+    case IDrawable::kDrawTypeEdge:
+    case IDrawable::kDrawTypeGroundShadow:
+    case IDrawable::kDrawTypeShadowMap:
+    case IDrawable::kDrawTypeScriptExternalColor:
+        /* vertices may be modified directly while editing model so the batch built at loading is not used */
+        batchable = !m_project->isModelEditingEnabled() && numVertices == s.m_numVertices;
+        break;
+    default:
+        batchable = false;
+        break;
+    }
+    if (trackDirtyVertices && batchable && m_dirtyVertexTracker->numVertices() == numVertices) {
+        m_dirtyVertexTracker->update(s.m_vertices, s.m_edgeSizeScaleFactor);
+        s.m_dirtyVertexTracker = m_dirtyVertexTracker;
+    }
+    else {
+        m_dirtyVertexTracker->invalidate();
+    }
+    if (batchable) {
+        m_skinningBatch->updateBonePalette();
+        dispatchParallelTasks(&Model::handlePerformSkinningBatchTransform, &s, m_skinningBatch->numBlocks(),
+            kParallelSkinningVertexGrainSize / model::SkinningBatch::kNumLanes);
+        dispatchParallelTasks(&Model::handlePerformSkinningFallbackVertexTransform, &s,
+            m_skinningBatch->numFallbackVertices(), kParallelSkinningVertexGrainSize);
+    }
+    else {
+        dispatchParallelTasks(
+            &Model::handlePerformSkinningVertexTransform, &s, numVertices, kParallelSkinningVertexGrainSize);
     }
 }
 
@@ -3655,37 +4048,33 @@ Model::deformMorph(const nanoem_model_morph_t *morphPtr, bool checkDirty)
 }
 
 void
-Model::solveConstraint(
-    const nanoem_model_constraint_t *constraintPtr, int numIterations, nanoem_unicode_string_factory_t *factory)
+Model::solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIterations)
 {
     nanoem_parameter_assert(constraintPtr, "must not be nullptr");
-    nanoem_parameter_assert(factory, "must not be nullptr");
-    nanoem_rsize_t numJoints;
-    nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
     const nanoem_model_bone_t *targetBonePtr = nanoemModelConstraintGetTargetBoneObject(constraintPtr);
     const nanoem_model_bone_t *effectorBonePtr = nanoemModelConstraintGetEffectorBoneObject(constraintPtr);
-    nanoem_f32_t angleLimit = nanoemModelConstraintGetAngleLimit(constraintPtr);
     const model::Bone *targetBone = model::Bone::cast(targetBonePtr);
     model::Bone *effectorBone = model::Bone::cast(effectorBonePtr);
     model::Constraint *constraint = model::Constraint::cast(constraintPtr);
+    const model::Constraint::CompiledJointList &joints = constraint->compiledJoints();
+    const nanoem_rsize_t numJoints = joints.size();
+    numIterations = glm::min(numIterations, Inline::saturateInt32(constraint->numIterations()));
     const Vector4 effectorBonePosition(effectorBone->worldTransformOrigin(), 1),
         targetBonePosition(targetBone->worldTransformOrigin(), 1);
     for (int i = 0; i < numIterations; i++) {
         const bool firstIteration = i == 0;
         for (nanoem_rsize_t j = 0; j < numJoints; j++) {
-            const nanoem_model_constraint_joint_t *joint = joints[j];
-            const nanoem_model_bone_t *jointBonePtr = nanoemModelConstraintJointGetBoneObject(joint);
-            model::Bone *jointBone = model::Bone::cast(jointBonePtr);
-            model::Constraint::Joint *jointResult = constraint->jointIterationResult(joint, i);
+            const model::Constraint::CompiledJoint &joint = joints[j];
+            model::Bone *jointBone = model::Bone::cast(joint.m_bonePtr);
+            model::Constraint::Joint *jointResult = constraint->jointIterationResult(j, i);
             if (!model::Constraint::solveAxisAngle(
                     jointBone->worldTransform(), effectorBonePosition, targetBonePosition, jointResult)) {
-                nanoem_f32_t newAngleLimit = angleLimit * (j + 1);
-                const bool hasUnitXConstraint = model::Constraint::hasUnitXConstraint(jointBonePtr, factory);
+                const bool hasUnitXConstraint = joint.m_hasUnitXConstraint;
                 if (firstIteration && hasUnitXConstraint) {
                     jointResult->setAxis(Constants::kUnitX);
                 }
                 const Quaternion orientation(
-                    glm::angleAxis(glm::min(jointResult->m_angle, newAngleLimit), jointResult->m_axis));
+                    glm::angleAxis(glm::min(jointResult->m_angle, joint.m_angleLimit), jointResult->m_axis));
                 Quaternion mixedOrientation;
                 if (firstIteration) {
                     mixedOrientation = orientation * jointBone->localOrientation();
@@ -3700,15 +4089,14 @@ Model::solveConstraint(
                 }
                 jointBone->setConstraintJointOrientation(mixedOrientation);
                 for (int k = Inline::saturateInt32(j); k >= 0; k--) {
-                    const nanoem_model_constraint_joint_t *upperJoint = joints[k];
-                    const nanoem_model_bone_t *upperJointBonePtr = nanoemModelConstraintJointGetBoneObject(upperJoint);
+                    const nanoem_model_bone_t *upperJointBonePtr = joints[k].m_bonePtr;
                     model::Bone *upperJointBone = model::Bone::cast(upperJointBonePtr);
                     upperJointBone->updateLocalTransform(upperJointBonePtr, upperJointBone->localTranslation(),
                         upperJointBone->constraintJointOrientation());
                 }
                 jointResult->setTransform(jointBone->worldTransform());
                 effectorBone->updateLocalTransform(effectorBonePtr);
-                model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(joint, i);
+                model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(j, i);
                 effectorResult->setTransform(effectorBone->worldTransform());
             }
         }
@@ -3734,16 +4122,7 @@ Model::synchronizeBoneMotion(const Motion *motion, nanoem_frame_index_t frameInd
             }
         }
     }
-    for (nanoem_rsize_t i = 0; i < numBones; i++) {
-        const nanoem_model_bone_t *bonePtr = bones[i];
-        if ((nanoemModelBoneIsAffectedByPhysicsSimulation(bonePtr) != 0) == timing) {
-            if (model::Bone *bone = model::Bone::cast(bonePtr)) {
-                bone->applyAllLocalTransform(bonePtr, this);
-                bone->applyOutsideParentTransform(bonePtr, this);
-                m_boundingBox.set(bone->worldTransformOrigin());
-            }
-        }
-    }
+    internalApplyAllBonesTransform(timing);
 }
 
 void
@@ -3849,41 +4228,10 @@ Model::synchronizeAllRigidBodyKinematics(const Motion *motion, nanoem_frame_inde
 }
 
 void
-Model::dispatchParallelTasks(DispatchParallelTasksIterator iterator, void *opaque, size_t iterations)
+Model::dispatchParallelTasks(
+    DispatchParallelTasksIterator iterator, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grainSize)
 {
-#if defined(NANOEM_ENABLE_TBB)
-    struct ParallelExecutor {
-        typedef void (*DispatchParallelTasksIterator)(void *, size_t);
-        ParallelExecutor(DispatchParallelTasksIterator iterator, void *opaque)
-            : m_iterator(iterator)
-            , m_opaque(opaque)
-        {
-        }
-        void
-        operator()(const tbb::blocked_range<size_t> &range) const
-        {
-            for (size_t it = range.begin(), end = range.end(); it != end; ++it) {
-                m_iterator(m_opaque, it);
-            }
-        }
-        DispatchParallelTasksIterator m_iterator;
-        void *m_opaque;
-    } executor(iterator, opaque);
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, iterations), executor);
-#elif defined(__APPLE__)
-    dispatch_queue_t queue = static_cast<dispatch_queue_t>(m_dispatchParallelTaskQueue);
-    dispatch_apply_f(iterations, queue, opaque, iterator);
-#else /* NANOEM_ENABLE_TBB */
-#if defined(NANOEM_ENABLE_OPENMP)
-    const int numIterations = Inline::saturatedInt(iterations);
-#pragma omp parallel for
-    for (int i = 0; i < numIterations; i++) {
-#else
-    for (size_t i = 0; i < iterations; i++) {
-#endif /* NANOEM_ENABLE_OPENMP */
-        iterator(opaque, i);
-    }
-#endif /* NANOEM_ENABLE_TBB */
+    TaskScheduler::sharedInstance()->parallelFor(iterator, opaque, iterations, grainSize);
 }
 
 bool
@@ -4740,25 +5088,23 @@ void
 Model::drawConstraintsHeatMap(IPrimitive2D *primitive, const nanoem_model_constraint_t *constraintPtr)
 {
     nanoem_parameter_assert(constraintPtr, "must not be nullptr");
-    nanoem_rsize_t numJoints;
     const ICamera *camera = m_project->activeCamera();
     nanoem_f32_t radius = m_project->deviceScaleCircleRadius();
-    const nanoem_rsize_t numIterations = nanoem_rsize_t(nanoemModelConstraintGetNumIterations(constraintPtr));
     model::Constraint *constraint = model::Constraint::cast(constraintPtr);
-    nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
+    const nanoem_rsize_t numJoints = constraint->compiledJoints().size();
+    const nanoem_rsize_t numIterations = constraint->numIterations();
     nanoem_f32_t extent = radius * 2;
     for (nanoem_rsize_t j = 0; j < numJoints; j++) {
-        const nanoem_model_constraint_joint_t *joint = joints[j];
         for (nanoem_rsize_t k = 0; k < numIterations; k++) {
             {
-                const model::Constraint::Joint *jointResult = constraint->jointIterationResult(joint, k);
+                const model::Constraint::Joint *jointResult = constraint->jointIterationResult(j, k);
                 const Vector2 jointCoord(camera->toDeviceScreenCoordinateInViewport(jointResult->m_translation));
                 const Vector3 jointJet(Color::jet((k + 1) / nanoem_f32_t(numIterations)));
                 primitive->fillCircle(
                     Vector4(jointCoord.x - radius, jointCoord.y - radius, extent, extent), Vector4(jointJet, 1.0f));
             }
             {
-                const model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(joint, k);
+                const model::Constraint::Joint *effectorResult = constraint->effectorIterationResult(j, k);
                 const Vector2 &effectorCoord =
                     camera->toDeviceScreenCoordinateInViewport(effectorResult->m_translation);
                 const Vector3 effectorJet(Color::jet((k + 1) / nanoem_f32_t(numIterations)));
@@ -394,6 +394,8 @@ ModelProgramBundle::CommonPass::execute(const IDrawable * /* drawable */, const
     hash.add(isAddBlend);
     hash.add(isDepthEnabled);
     hash.add(isOffscreenRenderPassActive);
+    /* stride differs between the standard and the compact vertex layout */
+    hash.add(model->vertexUnitSize());
     format.addHash(hash);
     nanoem_u32_t key = hash.end();
     PipelineMap::const_iterator it = m_pipelines.find(key);
@@ -405,10 +407,10 @@ ModelProgramBundle::CommonPass::execute(const IDrawable * /* drawable */, const
         sg_pipeline_desc desc;
         Inline::clearZeroMemory(desc);
         if (m_parentTechnique->techniqueType() == kTechniqueTypeEdge) {
-            Model::setEdgePipelineDescription(desc);
+            model->setEdgePipelineDescription(desc);
         }
         else {
-            Model::setStandardPipelineDescription(desc);
+            model->setStandardPipelineDescription(desc);
         }
         desc.shader = m_parentTechnique->shader();
         desc.primitive_type = m_primitiveType;
@@ -23,6 +23,7 @@
 #include "emapp/model/Morph.h"
 #include "emapp/private/CommonInclude.h"
 
+#include "bx/cpu.h"
 #include "bx/handlealloc.h"
 #include "protoc/application.pb-c.h"
 #include "sokol/sokol_time.h"
@@ -37,6 +38,8 @@
 namespace nanoem {
 namespace {
 
+static nanoem_u32_t s_lastTrackEpoch = 0;
+
 struct Merger {
     static void transformBoneKeyframeReversed(nanoem_mutable_motion_bone_keyframe_t *keyframe);
 
@@ -1098,21 +1101,18 @@ Motion::Motion(Project *project, nanoem_u16_t handle)
     , m_opaque(nullptr)
     , m_formatType(NANOEM_MOTION_FORMAT_TYPE_NMD)
     , m_handle(handle)
+    , m_trackEpoch(0)
     , m_dirty(false)
 {
     nanoem_assert(m_project, "must not be nullptr");
     m_opaque = nanoemMotionCreate(m_project->unicodeStringFactory(), nullptr);
+    renewTrackEpoch();
     m_selection = nanoem_new(internal::MotionKeyframeSelection(this));
 }
 
 Motion::~Motion() NANOEM_DECL_NOEXCEPT
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
     nanoem_delete_safe(m_selection);
-    m_bezierCurvesData.clear();
     nanoemMotionDestroy(m_opaque);
     m_opaque = nullptr;
 }
@@ -1412,16 +1412,11 @@ Motion::overrideAllKeyframes(const Motion *source, bool reverse)
 void
 Motion::clearAllKeyframes()
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
-    m_bezierCurvesData.clear();
-    m_keyframeBezierCurves.clear();
     m_selection->clearAllKeyframes(NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL);
     nanoemMotionDestroy(m_opaque);
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
     m_opaque = nanoemMotionCreate(m_project->unicodeStringFactory(), &status);
+    renewTrackEpoch();
     m_dirty = false;
 }
 
@@ -1853,6 +1848,13 @@ Motion::findBoneKeyframe(
     return nanoemMotionFindBoneKeyframeObject(m_opaque, name, frameIndex);
 }
 
+const nanoem_motion_bone_keyframe_t *
+Motion::findBoneKeyframe(
+    nanoem_motion_track_handle_t handle, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindBoneKeyframeObjectByHandle(m_opaque, handle, frameIndex);
+}
+
 const nanoem_motion_camera_keyframe_t *
 Motion::findCameraKeyframe(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
 {
@@ -1878,6 +1880,13 @@ Motion::findMorphKeyframe(
     return nanoemMotionFindMorphKeyframeObject(m_opaque, name, frameIndex);
 }
 
+const nanoem_motion_morph_keyframe_t *
+Motion::findMorphKeyframe(
+    nanoem_motion_track_handle_t handle, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return nanoemMotionFindMorphKeyframeObjectByHandle(m_opaque, handle, frameIndex);
+}
+
 const nanoem_motion_self_shadow_keyframe_t *
 Motion::findSelfShadowKeyframe(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
 {
@@ -2006,6 +2015,13 @@ Motion::handle() const NANOEM_DECL_NOEXCEPT
     return m_handle;
 }
 
+nanoem_u64_t
+Motion::trackRevision() const NANOEM_DECL_NOEXCEPT
+{
+    /* the epoch is renewed whenever the opaque motion is recreated and tracks of it are only appended */
+    return (nanoem_u64_t(m_trackEpoch) << 32) | nanoemMotionGetLocalTrackRevision(m_opaque);
+}
+
 bool
 Motion::isDirty() const NANOEM_DECL_NOEXCEPT
 {
@@ -2085,33 +2101,22 @@ Motion::coefficient(const nanoem_motion_morph_keyframe_t *prev, const nanoem_mot
 }
 
 nanoem_f32_t
-Motion::bezierCurve(const nanoem_motion_bone_keyframe_t *prev, const nanoem_motion_bone_keyframe_t *next,
-    nanoem_motion_bone_keyframe_interpolation_type_t index, nanoem_f32_t value) const
+Motion::bezierCurve(const nanoem_motion_bone_keyframe_t * /* prev */, const nanoem_motion_bone_keyframe_t *next,
+    nanoem_motion_bone_keyframe_interpolation_type_t index, nanoem_f32_t value) NANOEM_DECL_NOEXCEPT
 {
-    const nanoem_u8_t *parameters = nanoemMotionBoneKeyframeGetInterpolation(next, index);
-    BezierCurve *curve;
-    KeyframeBezierCurveMap::const_iterator it = m_keyframeBezierCurves.find(next);
-    if (it != m_keyframeBezierCurves.end()) {
-        curve = it->second;
-    }
-    else {
-        const nanoem_frame_index_t interval =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next)) -
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev));
-        const nanoem_u64_t hash = BezierCurve::toHash(parameters, interval);
-        BezierCurve::Map::const_iterator it2 = m_bezierCurvesData.find(hash);
-        if (it2 != m_bezierCurvesData.end()) {
-            curve = it2->second;
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-        else {
-            const Vector2 c0(parameters[0], parameters[1]), c1(parameters[2], parameters[3]);
-            curve = nanoem_new(BezierCurve(c0, c1, interval));
-            m_bezierCurvesData.insert(tinystl::make_pair(hash, curve));
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-    }
-    return curve->value(value);
+    return BezierCurve::solve(nanoemMotionBoneKeyframeGetInterpolation(next, index), value);
+}
+
+Vector4
+Motion::bezierCurves(const nanoem_motion_bone_keyframe_t *next, nanoem_f32_t value) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_u8_t *parameters[] = {
+        nanoemMotionBoneKeyframeGetInterpolation(next, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_TRANSLATION_X),
+        nanoemMotionBoneKeyframeGetInterpolation(next, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_TRANSLATION_Y),
+        nanoemMotionBoneKeyframeGetInterpolation(next, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_TRANSLATION_Z),
+        nanoemMotionBoneKeyframeGetInterpolation(next, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION),
+    };
+    return BezierCurve::solve(parameters, Vector4(value));
 }
 
 nanoem_f32_t
@@ -2271,4 +2276,10 @@ Motion::internalMergeAllKeyframes(const Motion *source, bool _override, bool rev
     setDirty(true);
 }
 
+void
+Motion::renewTrackEpoch() NANOEM_DECL_NOEXCEPT
+{
+    m_trackEpoch = bx::atomicFetchAndAdd<nanoem_u32_t>(&s_lastTrackEpoch, 1) + 1;
+}
+
 } /* namespace nanoem */
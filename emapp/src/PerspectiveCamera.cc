@@ -68,11 +68,6 @@ PerspectiveCamera::PerspectiveCamera(Project *project)
 
 PerspectiveCamera::~PerspectiveCamera() NANOEM_DECL_NOEXCEPT
 {
-    for (BezierCurve::Map::const_iterator it = m_bezierCurvesData.begin(), end = m_bezierCurvesData.end(); it != end;
-         ++it) {
-        nanoem_delete(it->second);
-    }
-    m_bezierCurvesData.clear();
     undoStackDestroy(m_undoStack);
     m_undoStack = nullptr;
 }
@@ -604,33 +599,11 @@ PerspectiveCamera::setDirty(bool value)
 }
 
 nanoem_f32_t
-PerspectiveCamera::bezierCurve(const nanoem_motion_camera_keyframe_t *prev, const nanoem_motion_camera_keyframe_t *next,
-    nanoem_motion_camera_keyframe_interpolation_type_t index, nanoem_f32_t value) const
-{
-    const nanoem_u8_t *parameters = nanoemMotionCameraKeyframeGetInterpolation(next, index);
-    BezierCurve *curve;
-    KeyframeBezierCurveMap::const_iterator it = m_keyframeBezierCurves.find(next);
-    if (it != m_keyframeBezierCurves.end()) {
-        curve = it->second;
-    }
-    else {
-        const nanoem_frame_index_t interval =
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next)) -
-            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev));
-        const nanoem_u64_t hash = BezierCurve::toHash(parameters, interval);
-        BezierCurve::Map::const_iterator it2 = m_bezierCurvesData.find(hash);
-        if (it2 != m_bezierCurvesData.end()) {
-            curve = it2->second;
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-        else {
-            const Vector2 c0(parameters[0], parameters[1]), c1(parameters[2], parameters[3]);
-            curve = nanoem_new(BezierCurve(c0, c1, interval));
-            m_bezierCurvesData.insert(tinystl::make_pair(hash, curve));
-            m_keyframeBezierCurves.insert(tinystl::make_pair(next, curve));
-        }
-    }
-    return curve->value(value);
+PerspectiveCamera::bezierCurve(const nanoem_motion_camera_keyframe_t * /* prev */,
+    const nanoem_motion_camera_keyframe_t *next, nanoem_motion_camera_keyframe_interpolation_type_t index,
+    nanoem_f32_t value) NANOEM_DECL_NOEXCEPT
+{
+    return BezierCurve::solve(nanoemMotionCameraKeyframeGetInterpolation(next, index), value);
 }
 
 } /* namespace nanoem */
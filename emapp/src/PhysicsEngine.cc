@@ -8,6 +8,8 @@
 
 #include "bx/os.h"
 #include "emapp/Constants.h"
+#include "emapp/Profiler.h"
+#include "emapp/TaskScheduler.h"
 #include "emapp/private/CommonInclude.h"
 
 #ifndef DLL
@@ -17,6 +19,10 @@
 namespace nanoem {
 
 struct PhysicsEngine::PrivateContext {
+    typedef void (*ParallelForTask)(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+    typedef void (*ParallelFor)(void *userData, ParallelForTask task, void *opaque, nanoem_rsize_t iterations);
+    typedef tinystl::pair<const nanoem_model_t *, PhysicsEngine *> IslandPair;
+    typedef tinystl::vector<IslandPair, TinySTLAllocator> IslandList;
     typedef nanoem_bool_t(APIENTRY *PFN_nanoemPhysicsWorldIsAvailable)(void *opaque);
     typedef nanoem_physics_world_t *(APIENTRY *PFN_nanoemPhysicsWorldCreate)(void *opaque, nanoem_status_t *status);
     typedef void(APIENTRY *PFN_nanoemPhysicsWorldAddRigidBody)(
@@ -41,6 +47,24 @@ struct PhysicsEngine::PrivateContext {
         nanoem_physics_world_t *world, nanoem_f32_t value);
     typedef nanoem_bool_t(APIENTRY *PFN_nanoemPhysicsWorldIsGroundEnabled)(const nanoem_physics_world_t *world);
     typedef void(APIENTRY *PFN_nanoemPhysicsWorldSetGroundEnabled)(nanoem_physics_world_t *world, nanoem_bool_t value);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldSetParallelForCallback)(
+        nanoem_physics_world_t *world, ParallelFor callback, void *userData);
+    typedef nanoem_bool_t(APIENTRY *PFN_nanoemPhysicsWorldIsParallelSimulationEnabled)(
+        const nanoem_physics_world_t *world);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldSetParallelSimulationEnabled)(
+        nanoem_physics_world_t *world, nanoem_bool_t value);
+    typedef int(APIENTRY *PFN_nanoemPhysicsWorldGetMaxSubSteps)(const nanoem_physics_world_t *world);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldSetMaxSubSteps)(nanoem_physics_world_t *world, int value);
+    typedef nanoem_bool_t(APIENTRY *PFN_nanoemPhysicsWorldIsInterpolationEnabled)(const nanoem_physics_world_t *world);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldSetInterpolationEnabled)(
+        nanoem_physics_world_t *world, nanoem_bool_t value);
+    typedef int(APIENTRY *PFN_nanoemPhysicsWorldGetNumSteps)(const nanoem_physics_world_t *world);
+    typedef int(APIENTRY *PFN_nanoemPhysicsWorldGetNumDroppedSteps)(const nanoem_physics_world_t *world);
+    typedef nanoem_rsize_t(APIENTRY *PFN_nanoemPhysicsWorldGetStateSize)(const nanoem_physics_world_t *world);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldSaveState)(
+        const nanoem_physics_world_t *world, nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status);
+    typedef void(APIENTRY *PFN_nanoemPhysicsWorldRestoreState)(
+        nanoem_physics_world_t *world, const nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status);
     typedef void(APIENTRY *PFN_nanoemPhysicsWorldDestroy)(nanoem_physics_world_t *world);
     typedef nanoem_physics_rigid_body_t *(APIENTRY *PFN_nanoemPhysicsRigidBodyCreate)(
         const nanoem_model_rigid_body_t *value, void *opaque, nanoem_status_t *status);
@@ -126,6 +150,8 @@ struct PhysicsEngine::PrivateContext {
         , m_acceleration(9.8f)
         , m_noiseValue(0)
         , m_noiseEnabled(false)
+        , m_parallelSimulationEnabled(false)
+        , m_stepDelta(0)
         , worldIsAvailable(nullptr)
         , worldCreate(nullptr)
         , worldAddRigidBody(nullptr)
@@ -144,6 +170,18 @@ struct PhysicsEngine::PrivateContext {
         , worldSetDeactivationTimeThreshold(nullptr)
         , worldIsGroundEnabled(nullptr)
         , worldSetGroundEnabled(nullptr)
+        , worldSetParallelForCallback(nullptr)
+        , worldIsParallelSimulationEnabled(nullptr)
+        , worldSetParallelSimulationEnabled(nullptr)
+        , worldGetMaxSubSteps(nullptr)
+        , worldSetMaxSubSteps(nullptr)
+        , worldIsInterpolationEnabled(nullptr)
+        , worldSetInterpolationEnabled(nullptr)
+        , worldGetNumSteps(nullptr)
+        , worldGetNumDroppedSteps(nullptr)
+        , worldGetStateSize(nullptr)
+        , worldSaveState(nullptr)
+        , worldRestoreState(nullptr)
         , worldDestroy(nullptr)
         , rigidBodyCreate(nullptr)
         , rigidBodyGetMotionState(nullptr)
@@ -221,6 +259,20 @@ struct PhysicsEngine::PrivateContext {
                 opaque, "nanoemPhysicsWorldSetDeactivationTimeThreshold", worldSetDeactivationTimeThreshold, valid);
             resolveSymbol(opaque, "nanoemPhysicsWorldIsGroundEnabled", worldIsGroundEnabled, valid);
             resolveSymbol(opaque, "nanoemPhysicsWorldSetGroundEnabled", worldSetGroundEnabled, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldSetParallelForCallback", worldSetParallelForCallback, valid);
+            resolveSymbol(
+                opaque, "nanoemPhysicsWorldIsParallelSimulationEnabled", worldIsParallelSimulationEnabled, valid);
+            resolveSymbol(
+                opaque, "nanoemPhysicsWorldSetParallelSimulationEnabled", worldSetParallelSimulationEnabled, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldGetMaxSubSteps", worldGetMaxSubSteps, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldSetMaxSubSteps", worldSetMaxSubSteps, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldIsInterpolationEnabled", worldIsInterpolationEnabled, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldSetInterpolationEnabled", worldSetInterpolationEnabled, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldGetNumSteps", worldGetNumSteps, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldGetNumDroppedSteps", worldGetNumDroppedSteps, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldGetStateSize", worldGetStateSize, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldSaveState", worldSaveState, valid);
+            resolveSymbol(opaque, "nanoemPhysicsWorldRestoreState", worldRestoreState, valid);
             resolveSymbol(opaque, "nanoemPhysicsMotionStateGetWorldTransform", motionStateGetWorldTransform, valid);
             resolveSymbol(opaque, "nanoemPhysicsMotionStateSetWorldTransform", motionStateSetWorldTransform, valid);
             resolveSymbol(opaque, "nanoemPhysicsRigidBodyCreate", rigidBodyCreate, valid);
@@ -282,6 +334,18 @@ struct PhysicsEngine::PrivateContext {
         worldSetDeactivationTimeThreshold = nanoemPhysicsWorldSetDeactivationTimeThreshold;
         worldIsGroundEnabled = nanoemPhysicsWorldIsGroundEnabled;
         worldSetGroundEnabled = nanoemPhysicsWorldSetGroundEnabled;
+        worldSetParallelForCallback = nanoemPhysicsWorldSetParallelForCallback;
+        worldIsParallelSimulationEnabled = nanoemPhysicsWorldIsParallelSimulationEnabled;
+        worldSetParallelSimulationEnabled = nanoemPhysicsWorldSetParallelSimulationEnabled;
+        worldGetMaxSubSteps = nanoemPhysicsWorldGetMaxSubSteps;
+        worldSetMaxSubSteps = nanoemPhysicsWorldSetMaxSubSteps;
+        worldIsInterpolationEnabled = nanoemPhysicsWorldIsInterpolationEnabled;
+        worldSetInterpolationEnabled = nanoemPhysicsWorldSetInterpolationEnabled;
+        worldGetNumSteps = nanoemPhysicsWorldGetNumSteps;
+        worldGetNumDroppedSteps = nanoemPhysicsWorldGetNumDroppedSteps;
+        worldGetStateSize = nanoemPhysicsWorldGetStateSize;
+        worldSaveState = nanoemPhysicsWorldSaveState;
+        worldRestoreState = nanoemPhysicsWorldRestoreState;
         motionStateGetInitialWorldTransform = nanoemPhysicsMotionStateGetInitialWorldTransform;
         motionStateGetCurrentWorldTransform = nanoemPhysicsMotionStateGetCurrentWorldTransform;
         motionStateSetCurrentWorldTransform = nanoemPhysicsMotionStateSetCurrentWorldTransform;
@@ -330,12 +394,41 @@ struct PhysicsEngine::PrivateContext {
 #endif
     }
 
+    static bool
+    isInterpolationEnabled(PhysicsEngine::SimulationModeType value) NANOEM_DECL_NOEXCEPT
+    {
+        /* realtime modes blend fixed steps to be smooth and tracing keeps exact steps to be reproducible */
+        return value == PhysicsEngine::kSimulationModeEnableAnytime ||
+            value == PhysicsEngine::kSimulationModeEnablePlaying;
+    }
+
+    static void
+    parallelFor(void *userData, ParallelForTask task, void *opaque, nanoem_rsize_t iterations)
+    {
+        /* each iteration is already a batch of simulation islands so it is not split further */
+        TaskScheduler *scheduler = static_cast<TaskScheduler *>(userData);
+        scheduler->parallelFor(task, opaque, iterations, 1);
+    }
+    static void
+    stepAllWorlds(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        PrivateContext *self = static_cast<PrivateContext *>(opaque);
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            /* the first iteration is the shared world and the rest are islands of each model */
+            PrivateContext *context = i > 0 ? self->m_islands[i - 1].second->m_context : self;
+            context->worldStepSimulation(context->m_opaque, self->m_stepDelta);
+        }
+    }
+
     nanoem_physics_world_t *m_opaque;
     PhysicsEngine::SimulationModeType m_mode;
     Vector3 m_direction;
     nanoem_f32_t m_acceleration;
     nanoem_f32_t m_noiseValue;
     bool m_noiseEnabled;
+    bool m_parallelSimulationEnabled;
+    IslandList m_islands;
+    nanoem_f32_t m_stepDelta;
 
     PFN_nanoemPhysicsWorldIsAvailable worldIsAvailable;
     PFN_nanoemPhysicsWorldCreate worldCreate;
@@ -355,6 +448,18 @@ struct PhysicsEngine::PrivateContext {
     PFN_nanoemPhysicsWorldSetDeactivationTimeThreshold worldSetDeactivationTimeThreshold;
     PFN_nanoemPhysicsWorldIsGroundEnabled worldIsGroundEnabled;
     PFN_nanoemPhysicsWorldSetGroundEnabled worldSetGroundEnabled;
+    PFN_nanoemPhysicsWorldSetParallelForCallback worldSetParallelForCallback;
+    PFN_nanoemPhysicsWorldIsParallelSimulationEnabled worldIsParallelSimulationEnabled;
+    PFN_nanoemPhysicsWorldSetParallelSimulationEnabled worldSetParallelSimulationEnabled;
+    PFN_nanoemPhysicsWorldGetMaxSubSteps worldGetMaxSubSteps;
+    PFN_nanoemPhysicsWorldSetMaxSubSteps worldSetMaxSubSteps;
+    PFN_nanoemPhysicsWorldIsInterpolationEnabled worldIsInterpolationEnabled;
+    PFN_nanoemPhysicsWorldSetInterpolationEnabled worldSetInterpolationEnabled;
+    PFN_nanoemPhysicsWorldGetNumSteps worldGetNumSteps;
+    PFN_nanoemPhysicsWorldGetNumDroppedSteps worldGetNumDroppedSteps;
+    PFN_nanoemPhysicsWorldGetStateSize worldGetStateSize;
+    PFN_nanoemPhysicsWorldSaveState worldSaveState;
+    PFN_nanoemPhysicsWorldRestoreState worldRestoreState;
     PFN_nanoemPhysicsWorldDestroy worldDestroy;
     PFN_nanoemPhysicsRigidBodyCreate rigidBodyCreate;
     PFN_nanoemPhysicsRigidBodyGetMotionState rigidBodyGetMotionState;
@@ -429,11 +534,24 @@ void
 PhysicsEngine::create(nanoem_status_t &status)
 {
     m_context->m_opaque = m_context->worldCreate(nullptr, &status);
+    m_context->worldSetParallelForCallback(
+        m_context->m_opaque, PrivateContext::parallelFor, TaskScheduler::sharedInstance());
+    /* the multi-threaded solver is opt-in and follows the value chosen before the world is created */
+    m_context->worldSetParallelSimulationEnabled(m_context->m_opaque, m_context->m_parallelSimulationEnabled);
+    m_context->worldSetInterpolationEnabled(
+        m_context->m_opaque, PrivateContext::isInterpolationEnabled(m_context->m_mode));
 }
 
 void
 PhysicsEngine::destroy() NANOEM_DECL_NOEXCEPT
 {
+    PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        PhysicsEngine *island = it->second;
+        island->destroy();
+        nanoem_delete(island);
+    }
+    islands.clear();
     m_context->worldDestroy(m_context->m_opaque);
     m_context->m_opaque = nullptr;
 }
@@ -442,12 +560,24 @@ void
 PhysicsEngine::reset() NANOEM_DECL_NOEXCEPT
 {
     m_context->worldReset(m_context->m_opaque);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->reset();
+    }
 }
 
 void
 PhysicsEngine::stepSimulation(nanoem_f32_t delta)
 {
-    m_context->worldStepSimulation(m_context->m_opaque, delta);
+    NANOEM_PROFILER_SCOPE("PhysicsEngine::stepSimulation");
+    if (m_context->m_islands.empty()) {
+        m_context->worldStepSimulation(m_context->m_opaque, delta);
+    }
+    else {
+        m_context->m_stepDelta = delta;
+        TaskScheduler::sharedInstance()->parallelFor(
+            PrivateContext::stepAllWorlds, m_context, m_context->m_islands.size() + 1, 1);
+    }
 }
 
 PhysicsEngine::SimulationModeType
@@ -461,6 +591,7 @@ PhysicsEngine::setSimulationMode(SimulationModeType value)
 {
     if (m_context->m_mode != value) {
         setActive(value > PhysicsEngine::kSimulationModeDisable);
+        setInterpolationEnabled(PrivateContext::isInterpolationEnabled(value));
         m_context->m_mode = value;
     }
 }
@@ -477,6 +608,84 @@ PhysicsEngine::worldOpaque()
     return m_context->m_opaque;
 }
 
+PhysicsEngine *
+PhysicsEngine::createIsland(const nanoem_model_t *model, nanoem_status_t &status)
+{
+    PhysicsEngine *island = findIsland(model);
+    if (island == this) {
+        island = nanoem_new(PhysicsEngine);
+        /* an island shares resolved functions and settings with its parent but owns a separate world */
+        *island->m_context = *m_context;
+        island->m_context->m_islands.clear();
+        island->create(status);
+        if (status == NANOEM_STATUS_SUCCESS) {
+            island->setGravity(gravity());
+            island->setDebugGeometryFlags(debugGeometryFlags());
+            island->setActive(isActive());
+            island->setGroundEnabled(isGroundEnabled());
+            island->setParallelSimulationEnabled(isParallelSimulationEnabled());
+            island->setMaxSubSteps(maxSubSteps());
+            island->setInterpolationEnabled(isInterpolationEnabled());
+            m_context->m_islands.push_back(tinystl::make_pair(model, island));
+        }
+        else {
+            island->destroy();
+            nanoem_delete_safe(island);
+            island = this;
+        }
+    }
+    return island;
+}
+
+void
+PhysicsEngine::destroyIsland(const nanoem_model_t *model) NANOEM_DECL_NOEXCEPT
+{
+    PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        if (it->first == model) {
+            PhysicsEngine *island = it->second;
+            island->destroy();
+            nanoem_delete(island);
+            islands.erase(it);
+            break;
+        }
+    }
+}
+
+const PhysicsEngine *
+PhysicsEngine::findIsland(const nanoem_model_t *model) const NANOEM_DECL_NOEXCEPT
+{
+    const PhysicsEngine *engine = this;
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        if (it->first == model) {
+            engine = it->second;
+            break;
+        }
+    }
+    return engine;
+}
+
+PhysicsEngine *
+PhysicsEngine::findIsland(const nanoem_model_t *model) NANOEM_DECL_NOEXCEPT
+{
+    PhysicsEngine *engine = this;
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        if (it->first == model) {
+            engine = it->second;
+            break;
+        }
+    }
+    return engine;
+}
+
+nanoem_rsize_t
+PhysicsEngine::countAllIslands() const NANOEM_DECL_NOEXCEPT
+{
+    return m_context->m_islands.size();
+}
+
 nanoem_physics_rigid_body_t *
 PhysicsEngine::createRigidBody(const nanoem_model_rigid_body_t *value, nanoem_status_t &status)
 {
@@ -729,6 +938,10 @@ void
 PhysicsEngine::setGravity(const nanoem_f32_t *value)
 {
     m_context->worldSetGravity(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setGravity(value);
+    }
 }
 
 nanoem_u32_t
@@ -741,6 +954,10 @@ void
 PhysicsEngine::setDebugGeometryFlags(nanoem_u32_t value)
 {
     m_context->worldSetDebugGeomtryFlags(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setDebugGeometryFlags(value);
+    }
 }
 
 bool
@@ -753,6 +970,10 @@ void
 PhysicsEngine::setActive(bool value)
 {
     m_context->worldSetActive(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setActive(value);
+    }
 }
 
 void
@@ -841,6 +1062,143 @@ void
 PhysicsEngine::setGroundEnabled(bool value)
 {
     m_context->worldSetGroundEnabled(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setGroundEnabled(value);
+    }
+}
+
+bool
+PhysicsEngine::isParallelSimulationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return !!m_context->worldIsParallelSimulationEnabled(m_context->m_opaque);
+}
+
+void
+PhysicsEngine::setParallelSimulationEnabled(bool value)
+{
+    m_context->m_parallelSimulationEnabled = value;
+    m_context->worldSetParallelSimulationEnabled(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setParallelSimulationEnabled(value);
+    }
+}
+
+int
+PhysicsEngine::maxSubSteps() const NANOEM_DECL_NOEXCEPT
+{
+    return m_context->worldGetMaxSubSteps(m_context->m_opaque);
+}
+
+void
+PhysicsEngine::setMaxSubSteps(int value)
+{
+    m_context->worldSetMaxSubSteps(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setMaxSubSteps(value);
+    }
+}
+
+bool
+PhysicsEngine::isInterpolationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return !!m_context->worldIsInterpolationEnabled(m_context->m_opaque);
+}
+
+void
+PhysicsEngine::setInterpolationEnabled(bool value)
+{
+    m_context->worldSetInterpolationEnabled(m_context->m_opaque, value);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        it->second->setInterpolationEnabled(value);
+    }
+}
+
+int
+PhysicsEngine::numSteps() const NANOEM_DECL_NOEXCEPT
+{
+    int value = m_context->worldGetNumSteps(m_context->m_opaque);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        value = glm::max(value, it->second->numSteps());
+    }
+    return value;
+}
+
+int
+PhysicsEngine::numDroppedSteps() const NANOEM_DECL_NOEXCEPT
+{
+    int value = m_context->worldGetNumDroppedSteps(m_context->m_opaque);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        value = glm::max(value, it->second->numDroppedSteps());
+    }
+    return value;
+}
+
+nanoem_rsize_t
+PhysicsEngine::stateSize() const NANOEM_DECL_NOEXCEPT
+{
+    nanoem_rsize_t size = m_context->worldGetStateSize(m_context->m_opaque);
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end(); it != end; ++it) {
+        size += it->second->stateSize();
+    }
+    return size;
+}
+
+void
+PhysicsEngine::saveState(ByteArray &bytes, nanoem_status_t &status) const
+{
+    bytes.resize(stateSize());
+    nanoem_u8_t *ptr = bytes.data();
+    nanoem_rsize_t size = m_context->worldGetStateSize(m_context->m_opaque);
+    status = NANOEM_STATUS_SUCCESS;
+    if (size > 0) {
+        m_context->worldSaveState(m_context->m_opaque, ptr, size, &status);
+        ptr += size;
+    }
+    const PrivateContext::IslandList &islands = m_context->m_islands;
+    for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end();
+         it != end && status == NANOEM_STATUS_SUCCESS; ++it) {
+        const PhysicsEngine *island = it->second;
+        size = island->m_context->worldGetStateSize(island->m_context->m_opaque);
+        if (size > 0) {
+            island->m_context->worldSaveState(island->m_context->m_opaque, ptr, size, &status);
+            ptr += size;
+        }
+    }
+}
+
+void
+PhysicsEngine::restoreState(const ByteArray &bytes, nanoem_status_t &status)
+{
+    /* the world and its islands are stored in order so each part is taken by its current size */
+    if (bytes.size() == stateSize()) {
+        const nanoem_u8_t *ptr = bytes.data();
+        nanoem_rsize_t size = m_context->worldGetStateSize(m_context->m_opaque);
+        status = NANOEM_STATUS_SUCCESS;
+        if (size > 0) {
+            m_context->worldRestoreState(m_context->m_opaque, ptr, size, &status);
+            ptr += size;
+        }
+        const PrivateContext::IslandList &islands = m_context->m_islands;
+        for (PrivateContext::IslandList::const_iterator it = islands.begin(), end = islands.end();
+             it != end && status == NANOEM_STATUS_SUCCESS; ++it) {
+            PhysicsEngine *island = it->second;
+            size = island->m_context->worldGetStateSize(island->m_context->m_opaque);
+            if (size > 0) {
+                island->m_context->worldRestoreState(island->m_context->m_opaque, ptr, size, &status);
+                ptr += size;
+            }
+        }
+    }
+    else {
+        status = NANOEM_STATUS_ERROR_BUFFER_END;
+    }
 }
 
 } /* namespace nanoem */
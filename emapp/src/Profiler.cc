@@ -0,0 +1,237 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/Profiler.h"
+
+#include "emapp/StringUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/cpu.h"
+#include "bx/timer.h"
+
+namespace nanoem {
+namespace {
+
+BX_STATIC_ASSERT((Profiler::kMaxNumEvents & (Profiler::kMaxNumEvents - 1)) == 0);
+
+static void
+appendBytes(const char *value, ByteArray &bytes)
+{
+    const nanoem_u8_t *ptr = reinterpret_cast<const nanoem_u8_t *>(value);
+    bytes.insert(bytes.end(), ptr, ptr + StringUtils::length(value));
+}
+
+static void
+appendEscapedString(const char *value, ByteArray &bytes)
+{
+    bytes.push_back('"');
+    for (const char *ptr = value; *ptr; ptr++) {
+        const nanoem_u8_t c = static_cast<nanoem_u8_t>(*ptr);
+        if (c == '"' || c == '\\') {
+            bytes.push_back('\\');
+            bytes.push_back(c);
+        }
+        else if (c < 0x20) {
+            char buffer[8];
+            StringUtils::format(buffer, sizeof(buffer), "\\u%04x", c);
+            appendBytes(buffer, bytes);
+        }
+        else {
+            bytes.push_back(c);
+        }
+    }
+    bytes.push_back('"');
+}
+
+} /* namespace anonymous */
+
+Profiler::Scope::Scope(const char *name)
+    : m_profiler(sharedInstance())
+    , m_name(name)
+    , m_begin(0)
+{
+    if (m_profiler->isEnabled()) {
+        m_begin = bx::getHPCounter();
+    }
+}
+
+Profiler::Scope::Scope(Profiler *profiler, const char *name)
+    : m_profiler(profiler)
+    , m_name(name)
+    , m_begin(0)
+{
+    if (m_profiler->isEnabled()) {
+        m_begin = bx::getHPCounter();
+    }
+}
+
+Profiler::Scope::~Scope() NANOEM_DECL_NOEXCEPT
+{
+    /* the zone is dropped when the profiler is enabled in the middle of it */
+    if (m_begin != 0 && m_profiler->isEnabled()) {
+        m_profiler->record(m_name, m_begin, bx::getHPCounter());
+    }
+}
+
+Profiler *
+Profiler::sharedInstance()
+{
+    static Profiler s_instance;
+    return &s_instance;
+}
+
+Profiler::Profiler()
+    : m_numRings(0)
+    , m_numDroppedThreadEvents(0)
+    , m_origin(bx::getHPCounter())
+    , m_enabled(false)
+{
+    /* events are left uninitialized so untouched pages of the rings are never committed */
+    for (nanoem_u32_t i = 0; i < kMaxNumThreads; i++) {
+        Ring &ring = m_rings[i];
+        ring.m_next = ring.m_head = ring.m_tail = 0;
+    }
+}
+
+Profiler::~Profiler() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+Profiler::record(const char *name, nanoem_u64_t begin, nanoem_u64_t end) NANOEM_DECL_NOEXCEPT
+{
+    if (Ring *ring = currentRing()) {
+        const nanoem_u32_t head = ring->m_head;
+        /* the slot is reserved first so readers can tell it may be overwritten */
+        ring->m_next = head + 1;
+        bx::memoryBarrier();
+        Event &event = ring->m_events[head & (kMaxNumEvents - 1)];
+        event.m_name = name;
+        event.m_begin = begin;
+        event.m_end = end;
+        bx::memoryBarrier();
+        ring->m_head = head + 1;
+    }
+    else {
+        bx::atomicFetchAndAdd<nanoem_u32_t>(&m_numDroppedThreadEvents, 1);
+    }
+}
+
+nanoem_rsize_t
+Profiler::copyAllEvents(nanoem_u32_t threadIndex, Event *events, nanoem_rsize_t capacity) const
+{
+    if (threadIndex >= numThreads()) {
+        return 0;
+    }
+    const Ring &ring = m_rings[threadIndex];
+    const nanoem_u32_t head = ring.m_head, tail = ring.m_tail;
+    bx::memoryBarrier();
+    const nanoem_u32_t numAvailableEvents = glm::min(head - tail, kMaxNumEvents),
+                       numEvents = nanoem_u32_t(glm::min(nanoem_rsize_t(numAvailableEvents), capacity)),
+                       start = head - numEvents;
+    for (nanoem_u32_t i = 0; i < numEvents; i++) {
+        events[i] = ring.m_events[(start + i) & (kMaxNumEvents - 1)];
+    }
+    bx::memoryBarrier();
+    /* the owner thread may have wrapped around while copying so events in the reserved slots are discarded */
+    const nanoem_u32_t numWritten = ring.m_next - start, numOverwritten = numWritten > kMaxNumEvents
+        ? glm::min(numWritten - kMaxNumEvents, numEvents)
+        : 0;
+    if (numOverwritten > 0) {
+        memmove(events, events + numOverwritten, (numEvents - numOverwritten) * sizeof(*events));
+    }
+    return numEvents - numOverwritten;
+}
+
+void
+Profiler::save(ByteArray &bytes) const
+{
+    typedef tinystl::vector<Event, TinySTLAllocator> EventList;
+    const nanoem_f64_t scale = 1000000.0 / nanoem_f64_t(bx::getHPFrequency());
+    const nanoem_u64_t origin = m_origin;
+    EventList events(kMaxNumEvents);
+    char buffer[128];
+    bool first = true;
+    bytes.clear();
+    appendBytes("{\"traceEvents\":[", bytes);
+    for (nanoem_u32_t i = 0, numThreads = this->numThreads(); i < numThreads; i++) {
+        StringUtils::format(buffer, sizeof(buffer),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread%u\"}}",
+            first ? "" : ",", i, i);
+        appendBytes(buffer, bytes);
+        first = false;
+        const nanoem_rsize_t numEvents = copyAllEvents(i, events.data(), events.size());
+        for (nanoem_rsize_t j = 0; j < numEvents; j++) {
+            const Event &event = events[j];
+            if (event.m_begin >= origin && event.m_end >= event.m_begin) {
+                appendBytes(",{\"name\":", bytes);
+                appendEscapedString(event.m_name, bytes);
+                StringUtils::format(buffer, sizeof(buffer),
+                    ",\"cat\":\"emapp\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", i,
+                    (event.m_begin - origin) * scale, (event.m_end - event.m_begin) * scale);
+                appendBytes(buffer, bytes);
+            }
+        }
+    }
+    appendBytes("],\"displayTimeUnit\":\"ms\"}", bytes);
+}
+
+void
+Profiler::reset() NANOEM_DECL_NOEXCEPT
+{
+    /* only tails are moved since heads are owned by the recording threads */
+    for (nanoem_u32_t i = 0, numThreads = this->numThreads(); i < numThreads; i++) {
+        Ring &ring = m_rings[i];
+        ring.m_tail = ring.m_head;
+    }
+    m_numDroppedThreadEvents = 0;
+    m_origin = bx::getHPCounter();
+}
+
+nanoem_u32_t
+Profiler::numThreads() const NANOEM_DECL_NOEXCEPT
+{
+    return glm::min(m_numRings, kMaxNumThreads);
+}
+
+nanoem_u64_t
+Profiler::numDroppedEvents() const NANOEM_DECL_NOEXCEPT
+{
+    nanoem_u64_t value = m_numDroppedThreadEvents;
+    for (nanoem_u32_t i = 0, numThreads = this->numThreads(); i < numThreads; i++) {
+        const Ring &ring = m_rings[i];
+        const nanoem_u32_t numEvents = ring.m_head - ring.m_tail;
+        value += numEvents > kMaxNumEvents ? numEvents - kMaxNumEvents : 0;
+    }
+    return value;
+}
+
+bool
+Profiler::isEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_enabled;
+}
+
+void
+Profiler::setEnabled(bool value)
+{
+    m_enabled = value;
+}
+
+Profiler::Ring *
+Profiler::currentRing() NANOEM_DECL_NOEXCEPT
+{
+    /* ring index is stored with one offset to distinguish from unassigned threads */
+    uintptr_t index = reinterpret_cast<uintptr_t>(m_ringIndex.get());
+    if (index == 0) {
+        const nanoem_u32_t value = bx::atomicFetchAndAdd<nanoem_u32_t>(&m_numRings, 1);
+        index = value < kMaxNumThreads ? value + 1 : kMaxNumThreads + 1;
+        m_ringIndex.set(reinterpret_cast<void *>(index));
+    }
+    return index <= kMaxNumThreads ? &m_rings[index - 1] : nullptr;
+}
+
+} /* namespace nanoem */
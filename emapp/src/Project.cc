@@ -34,9 +34,11 @@
 #include "emapp/PhysicsEngine.h"
 #include "emapp/PixelFormat.h"
 #include "emapp/PluginFactory.h"
+#include "emapp/Profiler.h"
 #include "emapp/Progress.h"
 #include "emapp/ShadowCamera.h"
 #include "emapp/StringUtils.h"
+#include "emapp/TaskScheduler.h"
 #include "emapp/UUID.h"
 #include "emapp/command/BatchUndoCommandListCommand.h"
 #include "emapp/command/MotionSnapshotCommand.h"
@@ -45,10 +47,13 @@
 #include "emapp/internal/ClearPass.h"
 #include "emapp/internal/DebugDrawer.h"
 #include "emapp/internal/project/Archive.h"
+#include "emapp/internal/project/BakedPoseCache.h"
 #include "emapp/internal/project/JSON.h"
 #include "emapp/internal/project/Native.h"
 #include "emapp/internal/project/PMM.h"
 #include "emapp/internal/project/Redo.h"
+#include "emapp/internal/project/PhysicsCheckpointCache.h"
+#include "emapp/internal/project/RedoLogWriter.h"
 #include "emapp/internal/project/Track.h"
 #include "emapp/model/Morph.h"
 #include "emapp/private/CommonInclude.h"
@@ -102,6 +107,11 @@ static const nanoem_u64_t kEnableImageMipmap = 1ull << 28;
 static const nanoem_u64_t kEnablePowerSaving = 1ull << 29;
 static const nanoem_u64_t kEnableModelEditing = 1ull << 30;
 static const nanoem_u64_t kViewportWindowDetached = 1ull << 31;
+static const nanoem_u64_t kEnableCompactVertexFormat = 1ull << 32;
+static const nanoem_u64_t kEnableParallelMotionSynchronization = 1ull << 33;
+static const nanoem_u64_t kEnableParallelModelLoading = 1ull << 34;
+static const nanoem_u64_t kEnablePhysicsWorldPerModel = 1ull << 35;
+static const nanoem_u64_t kEnableBakedPoseCache = 1ull << 36;
 
 static const nanoem_u64_t kPrivateStateInitialValue = kDisplayTransformHandle | kDisplayUserInterface |
     kEnableMotionMerge | kEnableUniformedViewportImageSize | kEnableFPSCounter | kEnablePerformanceMonitor |
@@ -282,6 +292,24 @@ compareOffscreenRenderTargetOption(const void *left, const void *right)
     return result;
 }
 
+struct ParallelModelMotionSynchronizer {
+    typedef tinystl::pair<Model *, const Motion *> Item;
+    typedef tinystl::vector<Item, TinySTLAllocator> ItemList;
+    static void
+    handle(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        const ParallelModelMotionSynchronizer *self = static_cast<const ParallelModelMotionSynchronizer *>(opaque);
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            const Item &item = self->m_items[i];
+            item.first->synchronizeTransformMotion(item.second, self->m_frameIndex, self->m_amount, self->m_timing);
+        }
+    }
+    const Item *m_items;
+    nanoem_frame_index_t m_frameIndex;
+    nanoem_f32_t m_amount;
+    PhysicsEngine::SimulationTimingType m_timing;
+};
+
 static const Vector2UI16 kDefaultViewportImageSize = Vector2UI16(640, 360);
 static const nanoem_u32_t kTimeBasedAudioSourceDefaultSampleRate = 1440;
 
@@ -599,6 +627,7 @@ Project::DrawQueue::size() const NANOEM_DECL_NOEXCEPT
 void
 Project::DrawQueue::flush(Project *project)
 {
+    NANOEM_PROFILER_SCOPE("Project::DrawQueue::flush");
     bx::HashMurmur2A hasher;
     for (PassCommandBufferList::const_iterator it = m_commandBuffers.begin(), end = m_commandBuffers.end(); it != end;
          ++it) {
@@ -1220,6 +1249,9 @@ Project::Project(const Injector &injector)
     , m_sharedImageBlitter(nullptr)
     , m_renderPassCleaner(nullptr)
     , m_sharedDebugDrawer(nullptr)
+    , m_redoLogWriter(nullptr)
+    , m_physicsCheckpointCache(nullptr)
+    , m_bakedPoseCache(nullptr)
     , m_viewportPixelFormat(injector.m_pixelFormat, injector.m_pixelFormat)
     , m_drawType(IDrawable::kDrawTypeColor)
     , m_editingMode(kEditingModeNone)
@@ -1255,6 +1287,8 @@ Project::Project(const Injector &injector)
     , m_sampleLevel(0, 0)
     , m_stateFlags(kPrivateStateInitialValue)
     , m_confirmSeekFlags(0)
+    , m_uploadedVertexBufferBytes(0)
+    , m_undoMemoryUsage(0)
     , m_lastPhysicsDebugFlags(0)
     , m_coordinationSystem(GLM_LEFT_HANDED)
     , m_actualFPS(0)
@@ -1279,6 +1313,9 @@ Project::Project(const Injector &injector)
     m_drawQueue->m_project = this;
     m_batchDrawQueue = nanoem_new(BatchDrawQueue(m_drawQueue));
     m_serialDrawQueue = nanoem_new(SerialDrawQueue(m_drawQueue));
+    m_redoLogWriter = nanoem_new(internal::project::RedoLogWriter);
+    m_physicsCheckpointCache = nanoem_new(internal::project::PhysicsCheckpointCache);
+    m_bakedPoseCache = nanoem_new(internal::project::BakedPoseCache);
     m_undoStack = undoStackCreateWithSoftLimit(glm::clamp(injector.m_preferredUndoCount, 64, undoStackGetHardLimit()));
     nanoem_assert(m_audioPlayer, "must not be nullptr");
     nanoem_assert(m_backgroundVideoRenderer, "must not be nullptr");
@@ -1328,6 +1365,9 @@ Project::~Project() NANOEM_DECL_NOEXCEPT
     nanoem_delete_safe(m_light);
     nanoem_delete_safe(m_physicsEngine);
     nanoem_delete_safe(m_sharedDebugDrawer);
+    nanoem_delete_safe(m_redoLogWriter);
+    nanoem_delete_safe(m_physicsCheckpointCache);
+    nanoem_delete_safe(m_bakedPoseCache);
     nanoem_delete_safe(m_sharedImageLoader);
     nanoem_delete_safe(m_renderPassBlitter);
     nanoem_delete_safe(m_sharedImageBlitter);
@@ -2100,6 +2140,8 @@ Project::addModelMotion(Motion *motion, Model *model)
     }
     motion->initialize(model);
     undoStackClear(model->undoStack());
+    clearAllPhysicsCheckpoints();
+    clearBakedPoses(model);
     m_drawable2MotionPtrs.insert(tinystl::make_pair(static_cast<IDrawable *>(model), motion));
     m_allMotions.push_back(motion);
     setBaseDuration(duration());
@@ -2117,6 +2159,8 @@ Project::removeModel(Model *model)
     }
     removeDrawable(model);
     ListUtils::removeItem(model, m_transformModelOrderList);
+    clearAllPhysicsCheckpoints();
+    clearBakedPoses(model);
     IEventPublisher *publisher = eventPublisher();
     if (ListUtils::removeItem(model, m_allModelPtrs)) {
         MotionHashMap::iterator it2 = m_drawable2MotionPtrs.find(model);
@@ -2427,6 +2471,7 @@ Project::writeRedoMessage()
     command.save_point = &base;
     Error ignorable;
     writeRedoMessage(&command, ignorable);
+    flushRedoMessages();
     handleIndex = 0;
     for (AccessoryList::const_iterator it = m_allAccessoryPtrs.begin(), end = m_allAccessoryPtrs.end(); it != end;
          ++it) {
@@ -2458,13 +2503,9 @@ Project::writeRedoMessage(const Nanoem__Application__Command *command, Error &er
 #if defined(NANOEM_ENABLE_NANOMSG)
     if (!EnumUtils::isEnabled(kLoadingRedoFile, m_stateFlags)) {
         const URI &fileURI = redoFileURI();
-        if (!fileURI.isEmpty()) {
-            FileWriterScope scope;
-            if (scope.open(fileURI, true, error)) {
-                internal::project::Redo redo(this);
-                nanoem_u32_t sequence = m_actionSequence++;
-                redo.save(scope.writer(), sequence, command, error);
-            }
+        /* the redo file is kept opened and records are appended on the writer thread */
+        if (!fileURI.isEmpty() && (m_redoLogWriter->isOpened() || m_redoLogWriter->open(fileURI, error))) {
+            m_redoLogWriter->enqueue(m_actionSequence++, command);
         }
     }
 #else
@@ -2475,9 +2516,21 @@ Project::writeRedoMessage(const Nanoem__Application__Command *command, Error &er
 void
 Project::setWritingRedoMessageDisabled(bool value)
 {
+    if (value) {
+        /* close the redo file since it may be rewritten while loading */
+        Error error;
+        m_redoLogWriter->close(error);
+        error.notify(eventPublisher());
+    }
     EnumUtils::setEnabled(kLoadingRedoFile, m_stateFlags, value);
 }
 
+void
+Project::flushRedoMessages()
+{
+    m_redoLogWriter->flush();
+}
+
 Vector4UI16
 Project::queryDevicePixelRectangle(Project::RectangleType type, const Vector2UI16 &offset) const NANOEM_DECL_NOEXCEPT
 {
@@ -2528,10 +2581,14 @@ Project::play()
 {
     const bool playable = !isModelEditingEnabled();
     if (playable) {
-        const nanoem_frame_index_t durationAt = duration(), localFrameIndexAt = currentLocalFrameIndex();
+        const nanoem_frame_index_t durationAt = duration(), localFrameIndexAt = currentLocalFrameIndex(),
+                                   frameIndexFrom = playingSegment().frameIndexFrom();
         preparePlaying();
-        synchronizeAllMotions(playingSegment().frameIndexFrom(), 0, PhysicsEngine::kSimulationTimingBefore);
+        synchronizeAllMotions(frameIndexFrom, 0, PhysicsEngine::kSimulationTimingBefore);
         resetPhysicsSimulation();
+        if (frameIndexFrom == 0 && localFrameIndexAt == 0) {
+            m_physicsCheckpointCache->setContinuous(0);
+        }
         m_audioPlayer->play();
         eventPublisher()->publishPlayEvent(durationAt, localFrameIndexAt);
     }
@@ -2549,6 +2606,7 @@ Project::stop()
     synchronizeAllMotions(0, 0, PhysicsEngine::kSimulationTimingAfter);
     markAllModelsDirty();
     m_localFrameIndex = tinystl::make_pair(0u, 0u);
+    m_physicsCheckpointCache->setContinuous(0);
     m_backgroundVideoRenderer->seek(0);
     eventPublisher()->publishStopEvent(lastDuration, lastLocalFrameIndex);
 }
@@ -2606,6 +2664,13 @@ Project::restart(nanoem_frame_index_t frameIndex)
     internalPerformPhysicsSimulation(physicsSimulationTimeStep());
     synchronizeAllMotions(frameIndex, 0, PhysicsEngine::kSimulationTimingAfter);
     markAllModelsDirty();
+    /* restarting at the first frame is the same as playing from the beginning */
+    if (frameIndex == 0) {
+        m_physicsCheckpointCache->setContinuous(0);
+    }
+    else {
+        m_physicsCheckpointCache->resetContinuous();
+    }
 }
 
 void
@@ -2647,6 +2712,7 @@ Project::seek(nanoem_frame_index_t frameIndex, nanoem_f32_t amount, bool forceSe
 void
 Project::update()
 {
+    NANOEM_PROFILER_SCOPE("Project::update");
     SG_PUSH_GROUP("Project::update");
     if (isPlaying() && continuesPlaying()) {
         m_audioPlayer->update();
@@ -2666,6 +2732,8 @@ Project::update()
             Model *model = *it;
             model->synchronizeAllRigidBodiesTransformFeedbackToSimulation();
         }
+        /* the simulation advances without seeking so the state no longer matches the current frame */
+        m_physicsCheckpointCache->resetContinuous();
         m_physicsEngine->stepSimulation(physicsSimulationTimeStep());
         for (ModelList::const_iterator it = m_allModelPtrs.begin(), end = m_allModelPtrs.end(); it != end; ++it) {
             Model *model = *it;
@@ -2678,9 +2746,11 @@ Project::update()
     if (m_skinDeformerFactory) {
         m_skinDeformerFactory->begin();
     }
+    m_uploadedVertexBufferBytes = 0;
     for (ModelList::const_iterator it = m_allModelPtrs.begin(), end = m_allModelPtrs.end(); it != end; ++it) {
         Model *model = *it;
         model->updateStagingVertexBuffer();
+        m_uploadedVertexBufferBytes += model->uploadedVertexBufferBytes();
     }
     for (LoadedEffectSet::const_iterator it = m_loadedEffectSet.begin(), end = m_loadedEffectSet.end(); it != end;
          ++it) {
@@ -2770,6 +2840,7 @@ void
 Project::resetPhysicsSimulation()
 {
     m_physicsEngine->reset();
+    m_physicsCheckpointCache->resetContinuous();
     for (ModelList::const_iterator it = m_allModelPtrs.begin(), end = m_allModelPtrs.end(); it != end; ++it) {
         Model *model = *it;
         model->initializeAllRigidBodiesTransformFeedback();
@@ -2797,6 +2868,7 @@ Project::resetAllModelEdges()
 void
 Project::performPhysicsSimulationOnce()
 {
+    m_physicsCheckpointCache->resetContinuous();
     internalPerformPhysicsSimulation(physicsSimulationTimeStep());
 }
 
@@ -2804,24 +2876,106 @@ void
 Project::synchronizeAllMotions(
     nanoem_frame_index_t frameIndex, nanoem_f32_t amount, PhysicsEngine::SimulationTimingType timing)
 {
+    NANOEM_PROFILER_SCOPE("Project::synchronizeAllMotions");
+    if (isParallelMotionSynchronizationEnabled()) {
+        synchronizeAllModelMotionsInParallel(frameIndex, amount, timing);
+    }
+    else {
+        for (ModelList::const_iterator it = m_transformModelOrderList.begin(), end = m_transformModelOrderList.end();
+             it != end; ++it) {
+            Model *model = *it;
+            if (Motion *motion = resolveMotion(model)) {
+                model->synchronizeMotion(motion, frameIndex, amount, timing);
+            }
+        }
+    }
+    if (timing == PhysicsEngine::kSimulationTimingAfter) {
+        synchronizeAllStageMotions(frameIndex, amount);
+    }
+}
+
+void
+Project::synchronizeAllStageMotions(nanoem_frame_index_t frameIndex, nanoem_f32_t amount)
+{
+    for (AccessoryList::const_iterator it = m_allAccessoryPtrs.begin(), end = m_allAccessoryPtrs.end(); it != end;
+         ++it) {
+        Accessory *accessory = *it;
+        if (Motion *motion = resolveMotion(accessory)) {
+            accessory->synchronizeMotion(motion, frameIndex);
+        }
+    }
+    synchronizeCamera(frameIndex, amount);
+    synchronizeLight(frameIndex, amount);
+    synchronizeSelfShadow(frameIndex);
+}
+
+void
+Project::synchronizeAllModelMotionsInParallel(
+    nanoem_frame_index_t frameIndex, nanoem_f32_t amount, PhysicsEngine::SimulationTimingType timing)
+{
+    typedef tinystl::pair<nanoem_rsize_t, nanoem_rsize_t> Edge;
+    typedef tinystl::vector<Edge, TinySTLAllocator> EdgeList;
+    typedef tinystl::vector<nanoem_rsize_t, TinySTLAllocator> LevelList;
+    ParallelModelMotionSynchronizer::ItemList items, batch;
+    /* model keyframes toggle visibility, effects and physics so they are applied serially */
     for (ModelList::const_iterator it = m_transformModelOrderList.begin(), end = m_transformModelOrderList.end();
          it != end; ++it) {
         Model *model = *it;
-        if (Motion *motion = resolveMotion(model)) {
-            model->synchronizeMotion(motion, frameIndex, amount, timing);
+        if (const Motion *motion = resolveMotion(model)) {
+            model->synchronizeModelMotion(motion, frameIndex, timing);
+            items.push_back(tinystl::make_pair(model, motion));
         }
     }
-    if (timing == PhysicsEngine::kSimulationTimingAfter) {
-        for (AccessoryList::const_iterator it = m_allAccessoryPtrs.begin(), end = m_allAccessoryPtrs.end(); it != end;
-             ++it) {
-            Accessory *accessory = *it;
-            if (Motion *motion = resolveMotion(accessory)) {
-                accessory->synchronizeMotion(motion, frameIndex);
+    const nanoem_rsize_t numItems = items.size();
+    EdgeList edges;
+    for (nanoem_rsize_t i = 0; i < numItems; i++) {
+        const model::Bone::OutsideParentMap outsideParents(items[i].first->allOutsideParents());
+        for (model::Bone::OutsideParentMap::const_iterator it = outsideParents.begin(), end = outsideParents.end();
+             it != end; ++it) {
+            const Model *parentModel = findModelByName(it->second.first);
+            for (nanoem_rsize_t j = 0; parentModel && j < numItems; j++) {
+                /*
+                 * the serial order reads the new transform of a preceding parent and the old one of a succeeding
+                 * parent, so both cases are ordered by the transform order to keep the same result
+                 */
+                if (j != i && items[j].first == parentModel) {
+                    edges.push_back(j < i ? tinystl::make_pair(j, i) : tinystl::make_pair(i, j));
+                }
+            }
+        }
+    }
+    /* every edge points to a later model so levels are resolved in one pass of the transform order */
+    LevelList levels(numItems);
+    nanoem_rsize_t maxLevel = 0;
+    for (nanoem_rsize_t i = 0; i < numItems; i++) {
+        nanoem_rsize_t level = 0;
+        for (EdgeList::const_iterator it = edges.begin(), end = edges.end(); it != end; ++it) {
+            if (it->second == i) {
+                level = glm::max(level, levels[it->first] + 1);
+            }
+        }
+        levels[i] = level;
+        maxLevel = glm::max(maxLevel, level);
+    }
+    ParallelModelMotionSynchronizer synchronizer;
+    synchronizer.m_frameIndex = frameIndex;
+    synchronizer.m_amount = amount;
+    synchronizer.m_timing = timing;
+    for (nanoem_rsize_t level = 0; numItems > 0 && level <= maxLevel; level++) {
+        batch.clear();
+        for (nanoem_rsize_t i = 0; i < numItems; i++) {
+            if (levels[i] == level) {
+                batch.push_back(items[i]);
             }
         }
-        synchronizeCamera(frameIndex, amount);
-        synchronizeLight(frameIndex, amount);
-        synchronizeSelfShadow(frameIndex);
+        synchronizer.m_items = batch.data();
+        TaskScheduler::sharedInstance()->parallelFor(
+            ParallelModelMotionSynchronizer::handle, &synchronizer, batch.size(), 1);
+    }
+    /* rigid bodies share the physics world so they are also synchronized serially */
+    for (ParallelModelMotionSynchronizer::ItemList::const_iterator it = items.begin(), end = items.end(); it != end;
+         ++it) {
+        it->first->synchronizeRigidBodyMotion(it->second, frameIndex, timing);
     }
 }
 
@@ -2942,6 +3096,7 @@ Project::drawShadowMap()
 void
 Project::drawViewport()
 {
+    NANOEM_PROFILER_SCOPE("Project::drawViewport");
     if (nanoem_likely(sg::is_valid(m_viewportPrimaryPass.m_handle))) {
         SG_PUSH_GROUP("Project::drawViewport");
         const bool isDrawingColorType = m_drawType == IDrawable::kDrawTypeColor;
@@ -2964,12 +3119,13 @@ Project::drawViewport()
             }
             drawViewport(IEffect::kScriptOrderTypePostProcess, IDrawable::kDrawTypeColor);
             if (m_physicsEngine->debugGeometryFlags() != 0) {
-                int numObjects;
-                nanoem_physics_debug_geometry_t *const *geometries = m_physicsEngine->debugGeometryObjects(&numObjects);
-                for (int i = 0; i < numObjects; i++) {
-                    const nanoem_physics_debug_geometry_t *geometry = geometries[i];
-                    dd::line(m_physicsEngine->geometryFromPosition(geometry),
-                        m_physicsEngine->geometryToPosition(geometry), m_physicsEngine->geometryColor(geometry));
+                drawPhysicsDebugGeometries(m_physicsEngine);
+                for (ModelList::const_iterator it = m_allModelPtrs.begin(), end = m_allModelPtrs.end(); it != end;
+                     ++it) {
+                    const PhysicsEngine *island = m_physicsEngine->findIsland((*it)->data());
+                    if (island != m_physicsEngine) {
+                        drawPhysicsDebugGeometries(island);
+                    }
                 }
             }
             dd::flush();
@@ -4639,6 +4795,24 @@ Project::undoStack() NANOEM_DECL_NOEXCEPT
     return m_undoStack;
 }
 
+nanoem_rsize_t
+Project::undoMemoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_undoMemoryUsage;
+}
+
+void
+Project::increaseUndoMemoryUsage(nanoem_rsize_t value)
+{
+    m_undoMemoryUsage += value;
+}
+
+void
+Project::decreaseUndoMemoryUsage(nanoem_rsize_t value)
+{
+    m_undoMemoryUsage -= glm::min(m_undoMemoryUsage, value);
+}
+
 URI
 Project::fileURI() const
 {
@@ -4715,9 +4889,38 @@ Project::redoFileURI() const
 void
 Project::setRedoFileURI(const URI &value)
 {
+    if (!m_redoFileURI.equalsTo(value)) {
+        Error error;
+        m_redoLogWriter->close(error);
+        error.notify(eventPublisher());
+    }
     m_redoFileURI = value;
 }
 
+nanoem_u32_t
+Project::redoLogSyncInterval() const NANOEM_DECL_NOEXCEPT
+{
+    return m_redoLogWriter->syncInterval();
+}
+
+void
+Project::setRedoLogSyncInterval(nanoem_u32_t value)
+{
+    m_redoLogWriter->setSyncInterval(value);
+}
+
+bool
+Project::isRedoLogCompressionEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_redoLogWriter->isCompressionEnabled();
+}
+
+void
+Project::setRedoLogCompressionEnabled(bool value)
+{
+    m_redoLogWriter->setCompressionEnabled(value);
+}
+
 Vector4SI32
 Project::backgroundVideoRect() const NANOEM_DECL_NOEXCEPT
 {
@@ -5012,6 +5215,12 @@ Project::setDrawType(IDrawable::DrawType value)
         : IDrawable::kDrawTypeColor;
 }
 
+nanoem_rsize_t
+Project::uploadedVertexBufferBytes() const NANOEM_DECL_NOEXCEPT
+{
+    return m_uploadedVertexBufferBytes;
+}
+
 sg_pass
 Project::registerRenderPass(const sg_pass_desc &desc, const PixelFormat &format)
 {
@@ -5480,6 +5689,8 @@ Project::setPhysicsSimulationMode(PhysicsEngine::SimulationModeType value)
     if (m_physicsEngine->simulationMode() != value) {
         m_physicsEngine->setDebugGeometryFlags(value ? m_lastPhysicsDebugFlags : 0);
         m_physicsEngine->setSimulationMode(value);
+        clearAllPhysicsCheckpoints();
+        clearAllBakedPoses();
         resetPhysicsSimulation();
         restart(currentLocalFrameIndex());
         eventPublisher()->publishSetPhysicsSimulationModeEvent(static_cast<nanoem_u32_t>(value));
@@ -5612,7 +5823,11 @@ Project::timeStepFactor() const NANOEM_DECL_NOEXCEPT
 void
 Project::setTimeStepFactor(nanoem_f32_t value)
 {
-    m_timeStepFactor = value;
+    if (m_timeStepFactor != value) {
+        m_timeStepFactor = value;
+        clearAllPhysicsCheckpoints();
+        clearAllBakedPoses();
+    }
 }
 
 nanoem_f32_t
@@ -5657,6 +5872,8 @@ Project::setPreferredMotionFPS(nanoem_u32_t value, bool unlimited)
     if (m_preferredMotionFPS != value || unlimited != isDisplaySyncDisabled()) {
         m_preferredMotionFPS = glm::min(value, kTimeBasedAudioSourceDefaultSampleRate);
         EnumUtils::setEnabled(kDisableDisplaySync, m_stateFlags, unlimited);
+        clearAllPhysicsCheckpoints();
+        clearAllBakedPoses();
         eventPublisher()->publishSetPreferredMotionFPSEvent(value, unlimited);
     }
 }
@@ -5959,6 +6176,149 @@ Project::setCompiledEffectCacheEnabled(bool value)
     }
 }
 
+bool
+Project::isCompactVertexFormatEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kEnableCompactVertexFormat, m_stateFlags);
+}
+
+void
+Project::setCompactVertexFormatEnabled(bool value)
+{
+    /* applied to models created after changing */
+    EnumUtils::setEnabled(kEnableCompactVertexFormat, m_stateFlags, value);
+}
+
+bool
+Project::isParallelMotionSynchronizationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kEnableParallelMotionSynchronization, m_stateFlags);
+}
+
+void
+Project::setParallelMotionSynchronizationEnabled(bool value)
+{
+    EnumUtils::setEnabled(kEnableParallelMotionSynchronization, m_stateFlags, value);
+}
+
+bool
+Project::isParallelModelLoadingEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kEnableParallelModelLoading, m_stateFlags);
+}
+
+void
+Project::setParallelModelLoadingEnabled(bool value)
+{
+    EnumUtils::setEnabled(kEnableParallelModelLoading, m_stateFlags, value);
+}
+
+bool
+Project::isParallelPhysicsSimulationEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_physicsEngine->isParallelSimulationEnabled();
+}
+
+void
+Project::setParallelPhysicsSimulationEnabled(bool value)
+{
+    m_physicsEngine->setParallelSimulationEnabled(value);
+}
+
+bool
+Project::isPhysicsWorldPerModelEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kEnablePhysicsWorldPerModel, m_stateFlags);
+}
+
+void
+Project::setPhysicsWorldPerModelEnabled(bool value)
+{
+    EnumUtils::setEnabled(kEnablePhysicsWorldPerModel, m_stateFlags, value);
+}
+
+int
+Project::physicsSimulationMaxSubSteps() const NANOEM_DECL_NOEXCEPT
+{
+    return m_physicsEngine->maxSubSteps();
+}
+
+void
+Project::setPhysicsSimulationMaxSubSteps(int value)
+{
+    m_physicsEngine->setMaxSubSteps(value);
+}
+
+bool
+Project::isPhysicsCheckpointCacheEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    /* only tracing reproduces the same simulation on seeking and changing the mode clears all checkpoints */
+    return m_physicsEngine->simulationMode() == PhysicsEngine::kSimulationModeEnableTracing;
+}
+
+const internal::project::PhysicsCheckpointCache *
+Project::physicsCheckpointCache() const NANOEM_DECL_NOEXCEPT
+{
+    return m_physicsCheckpointCache;
+}
+
+void
+Project::clearAllPhysicsCheckpoints()
+{
+    if (m_physicsCheckpointCache) {
+        m_physicsCheckpointCache->clear();
+    }
+}
+
+bool
+Project::isBakedPoseCacheEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kEnableBakedPoseCache, m_stateFlags);
+}
+
+void
+Project::setBakedPoseCacheEnabled(bool value)
+{
+    if (isBakedPoseCacheEnabled() != value) {
+        EnumUtils::setEnabled(kEnableBakedPoseCache, m_stateFlags, value);
+        clearAllBakedPoses();
+    }
+}
+
+const internal::project::BakedPoseCache *
+Project::bakedPoseCache() const NANOEM_DECL_NOEXCEPT
+{
+    return m_bakedPoseCache;
+}
+
+void
+Project::clearBakedPoses(const Model *model)
+{
+    if (m_bakedPoseCache) {
+        /* other models depend on the model through the shared physics world or outside parents */
+        bool dependent = isPhysicsSimulationEnabled();
+        for (ModelList::const_iterator it = m_allModelPtrs.begin(), end = m_allModelPtrs.end();
+             !dependent && it != end; ++it) {
+            const Model *otherModel = *it;
+            dependent = otherModel != model && !otherModel->allOutsideParents().empty();
+        }
+        if (dependent) {
+            m_bakedPoseCache->clear();
+        }
+        else {
+            m_bakedPoseCache->invalidate(model);
+        }
+    }
+}
+
+void
+Project::clearAllBakedPoses()
+{
+    if (m_bakedPoseCache) {
+        m_bakedPoseCache->clear();
+    }
+}
+
 bool
 Project::isViewportCaptured() const NANOEM_DECL_NOEXCEPT
 {
@@ -6675,12 +7035,23 @@ Project::internalSeek(nanoem_frame_index_t frameIndex, nanoem_f32_t amount, nano
         }
         resetTransformPerformedAt();
     }
-    if (frameIndex < currentLocalFrameIndex()) {
-        restart(frameIndex);
+    const nanoem_frame_index_t lastFrameIndex = currentLocalFrameIndex();
+    if (restoreAllBakedPoses(frameIndex, lastFrameIndex, amount)) {
+        synchronizeAllStageMotions(frameIndex, amount);
+        /* the physics world is not stepped so it is no longer continuous from the first frame */
+        m_physicsCheckpointCache->resetContinuous();
+    }
+    else {
+        const bool restored = restorePhysicsCheckpoint(frameIndex, delta);
+        if (!restored && frameIndex < lastFrameIndex) {
+            restart(frameIndex);
+        }
+        synchronizeAllMotions(frameIndex, amount, PhysicsEngine::kSimulationTimingBefore);
+        internalPerformPhysicsSimulation(delta);
+        synchronizeAllMotions(frameIndex, amount, PhysicsEngine::kSimulationTimingAfter);
+        savePhysicsCheckpoint(frameIndex, lastFrameIndex, amount, restored);
+        saveAllBakedPoses(frameIndex, amount);
     }
-    synchronizeAllMotions(frameIndex, amount, PhysicsEngine::kSimulationTimingBefore);
-    internalPerformPhysicsSimulation(delta);
-    synchronizeAllMotions(frameIndex, amount, PhysicsEngine::kSimulationTimingAfter);
     markAllModelsDirty();
     ILight *light = globalLight();
     ICamera *camera = globalCamera();
@@ -6785,6 +7156,115 @@ Project::internalPerformPhysicsSimulation(nanoem_f32_t delta)
     }
 }
 
+bool
+Project::restorePhysicsCheckpoint(nanoem_frame_index_t frameIndex, nanoem_f32_t &delta)
+{
+    const nanoem_frame_index_t lastFrameIndex = currentLocalFrameIndex();
+    nanoem_frame_index_t checkpointFrameIndex = 0, replayFrameIndex = 0;
+    bool restored = false;
+    if (isPhysicsCheckpointCacheEnabled() && isPhysicsSimulationEnabled() && frameIndex != lastFrameIndex) {
+        const bool found = m_physicsCheckpointCache->findNearest(frameIndex, checkpointFrameIndex);
+        if (frameIndex > lastFrameIndex && (!found || checkpointFrameIndex <= lastFrameIndex) &&
+            m_physicsCheckpointCache->isContinuous(lastFrameIndex)) {
+            /* the current state is nearer than any checkpoints and playing already steps by the elapsed time */
+            if (!isPlaying() && frameIndex - lastFrameIndex <= m_physicsCheckpointCache->maxNumReplayFrames()) {
+                replayFrameIndex = lastFrameIndex;
+                restored = true;
+            }
+        }
+        else if (found && m_physicsCheckpointCache->restore(checkpointFrameIndex, m_physicsEngine)) {
+            replayFrameIndex = checkpointFrameIndex;
+            restored = true;
+        }
+    }
+    if (restored) {
+        /* the time step per frame is the same as seeking to the next frame */
+        const nanoem_f32_t timeStep = (preferredMotionFPS() / baseFPS()) * physicsSimulationTimeStep();
+        for (nanoem_frame_index_t i = replayFrameIndex + 1; i < frameIndex; i++) {
+            synchronizeAllMotions(i, 0, PhysicsEngine::kSimulationTimingBefore);
+            internalPerformPhysicsSimulation(timeStep);
+        }
+        delta = frameIndex > replayFrameIndex ? timeStep : 0;
+    }
+    return restored;
+}
+
+void
+Project::savePhysicsCheckpoint(
+    nanoem_frame_index_t frameIndex, nanoem_frame_index_t lastFrameIndex, nanoem_f32_t amount, bool restored)
+{
+    bool continuous = false;
+    if (isPhysicsCheckpointCacheEnabled() && isPhysicsSimulationEnabled()) {
+        if (restored) {
+            continuous = true;
+        }
+        else if (frameIndex < lastFrameIndex) {
+            continuous = frameIndex == 0;
+        }
+        else {
+            /* seeking forward steps once by the whole duration so only playing and the next frame keep continuity */
+            const bool advanced = frameIndex - lastFrameIndex <= 1 || isPlaying();
+            continuous = advanced && m_physicsEngine->numDroppedSteps() == 0 &&
+                m_physicsCheckpointCache->isContinuous(lastFrameIndex);
+        }
+    }
+    if (continuous) {
+        m_physicsCheckpointCache->setContinuous(frameIndex);
+        if (amount == 0) {
+            m_physicsCheckpointCache->save(frameIndex, m_physicsEngine);
+        }
+    }
+    else {
+        m_physicsCheckpointCache->resetContinuous();
+    }
+}
+
+bool
+Project::restoreAllBakedPoses(
+    nanoem_frame_index_t frameIndex, nanoem_frame_index_t lastFrameIndex, nanoem_f32_t amount)
+{
+    /* seeking the same frame is to reflect edits and playing needs exact physics so both evaluate motions */
+    bool restored = isBakedPoseCacheEnabled() && amount == 0 && frameIndex != lastFrameIndex && !isPlaying();
+    if (restored) {
+        for (ModelList::const_iterator it = m_transformModelOrderList.begin(), end = m_transformModelOrderList.end();
+             it != end; ++it) {
+            Model *model = *it;
+            if (const Motion *motion = resolveMotion(model)) {
+                /* model keyframes toggle visibility so they are applied first to find which models need poses */
+                model->synchronizeModelMotion(motion, frameIndex, PhysicsEngine::kSimulationTimingBefore);
+                if (model->isVisible() && !m_bakedPoseCache->contains(model, frameIndex)) {
+                    restored = false;
+                }
+            }
+        }
+    }
+    /* poses are restored only when all models have them to keep models and the physics world coherent */
+    for (ModelList::const_iterator it = m_transformModelOrderList.begin(), end = m_transformModelOrderList.end();
+         restored && it != end; ++it) {
+        Model *model = *it;
+        if (resolveMotion(model) && model->isVisible()) {
+            restored = m_bakedPoseCache->restore(model, frameIndex);
+        }
+    }
+    return restored;
+}
+
+void
+Project::saveAllBakedPoses(nanoem_frame_index_t frameIndex, nanoem_f32_t amount)
+{
+    /* poses affected by physics are baked only from the simulation continued from the first frame */
+    const bool reproducible = !isPhysicsSimulationEnabled() || m_physicsCheckpointCache->isContinuous(frameIndex);
+    if (isBakedPoseCacheEnabled() && amount == 0 && !isPlaying() && reproducible) {
+        for (ModelList::const_iterator it = m_transformModelOrderList.begin(), end = m_transformModelOrderList.end();
+             it != end; ++it) {
+            const Model *model = *it;
+            if (resolveMotion(model) && model->isVisible()) {
+                m_bakedPoseCache->save(model, frameIndex);
+            }
+        }
+    }
+}
+
 void
 Project::removeDrawable(IDrawable *drawable)
 {
@@ -7052,6 +7532,18 @@ Project::drawBackgroundVideo()
     }
 }
 
+void
+Project::drawPhysicsDebugGeometries(const PhysicsEngine *engine)
+{
+    int numObjects;
+    nanoem_physics_debug_geometry_t *const *geometries = engine->debugGeometryObjects(&numObjects);
+    for (int i = 0; i < numObjects; i++) {
+        const nanoem_physics_debug_geometry_t *geometry = geometries[i];
+        dd::line(engine->geometryFromPosition(geometry), engine->geometryToPosition(geometry),
+            engine->geometryColor(geometry));
+    }
+}
+
 void
 Project::drawGrid()
 {
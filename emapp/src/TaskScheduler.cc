@@ -0,0 +1,163 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/TaskScheduler.h"
+
+#include "emapp/StringUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/cpu.h"
+
+#if BX_PLATFORM_WINDOWS
+#include <windows.h>
+#elif !BX_PLATFORM_EMSCRIPTEN
+#include <unistd.h>
+#endif /* BX_PLATFORM_WINDOWS */
+
+namespace nanoem {
+
+const nanoem_rsize_t TaskScheduler::kDefaultGrainSize = 2048;
+
+TaskScheduler *
+TaskScheduler::sharedInstance()
+{
+    /* the calling thread also takes a part of each task so one hardware thread is kept for it */
+    static TaskScheduler s_instance(countAllHardwareThreads() - 1);
+    return &s_instance;
+}
+
+nanoem_u32_t
+TaskScheduler::countAllHardwareThreads() NANOEM_DECL_NOEXCEPT
+{
+    nanoem_u32_t count = 1;
+#if BX_PLATFORM_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    count = info.dwNumberOfProcessors;
+#elif !BX_PLATFORM_EMSCRIPTEN
+    long value = sysconf(_SC_NPROCESSORS_ONLN);
+    count = value > 0 ? nanoem_u32_t(value) : 1;
+#endif /* BX_PLATFORM_WINDOWS */
+    return glm::clamp(count, nanoem_u32_t(1), kMaxNumWorkers + 1);
+}
+
+TaskScheduler::TaskScheduler(nanoem_u32_t numWorkers)
+    : m_numWorkers(glm::min(numWorkers, kMaxNumWorkers))
+    , m_iterator(nullptr)
+    , m_opaque(nullptr)
+    , m_grainSize(0)
+    , m_busy(0)
+    , m_running(true)
+{
+    Inline::clearZeroMemory(m_slices);
+    for (nanoem_u32_t i = 0; i < m_numWorkers; i++) {
+        char name[16];
+        Worker &worker = m_workers[i];
+        worker.m_parent = this;
+        /* slice 0 is reserved for the calling thread */
+        worker.m_sliceIndex = i + 1;
+        StringUtils::format(name, sizeof(name), "TaskWorker%d", i);
+        worker.m_thread.init(execute, &worker, 0, name);
+    }
+}
+
+TaskScheduler::~TaskScheduler() NANOEM_DECL_NOEXCEPT
+{
+    m_running = false;
+    m_wakeup.post(m_numWorkers);
+    for (nanoem_u32_t i = 0; i < m_numWorkers; i++) {
+        bx::Thread &thread = m_workers[i].m_thread;
+        if (thread.isRunning()) {
+            thread.shutdown();
+        }
+    }
+}
+
+void
+TaskScheduler::parallelFor(RangeIterator iterator, void *opaque, nanoem_rsize_t iterations)
+{
+    parallelFor(iterator, opaque, iterations, kDefaultGrainSize);
+}
+
+void
+TaskScheduler::parallelFor(RangeIterator iterator, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grainSize)
+{
+    grainSize = glm::max(grainSize, nanoem_rsize_t(1));
+    if (iterations == 0) {
+        /* do nothing */
+    }
+    /* small task, nested call from the iterator or concurrent call from another thread runs on the caller */
+    else if (m_numWorkers == 0 || iterations <= grainSize ||
+        bx::atomicCompareAndSwap<nanoem_u32_t>(&m_busy, 0, 1) != 0) {
+        iterator(opaque, 0, iterations);
+    }
+    else {
+        nanoem_assert(iterations < 0x7fffffff, "must be less than INT32_MAX");
+        const nanoem_u32_t numChunks = nanoem_u32_t((iterations + grainSize - 1) / grainSize),
+                           numWakingWorkers = glm::min(numChunks - 1, m_numWorkers),
+                           numSlices = m_numWorkers + 1;
+        for (nanoem_u32_t i = 0; i < numSlices; i++) {
+            Slice &slice = m_slices[i];
+            slice.m_next = nanoem_u32_t((iterations * i) / numSlices);
+            slice.m_end = nanoem_u32_t((iterations * (i + 1)) / numSlices);
+        }
+        m_iterator = iterator;
+        m_opaque = opaque;
+        m_grainSize = nanoem_u32_t(grainSize);
+        m_wakeup.post(numWakingWorkers);
+        run(0);
+        for (nanoem_u32_t i = 0; i < numWakingWorkers; i++) {
+            m_done.wait();
+        }
+        m_iterator = nullptr;
+        m_opaque = nullptr;
+        bx::atomicCompareAndSwap<nanoem_u32_t>(&m_busy, 1, 0);
+    }
+}
+
+nanoem_u32_t
+TaskScheduler::numWorkers() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numWorkers;
+}
+
+nanoem_i32_t
+TaskScheduler::execute(bx::Thread * /* thread */, void *userData)
+{
+    Worker *worker = static_cast<Worker *>(userData);
+    TaskScheduler *self = worker->m_parent;
+    while (true) {
+        self->m_wakeup.wait();
+        if (!self->m_running) {
+            break;
+        }
+        self->run(worker->m_sliceIndex);
+        self->m_done.post();
+    }
+    return 0;
+}
+
+void
+TaskScheduler::run(nanoem_u32_t sliceIndex)
+{
+    const nanoem_u32_t numSlices = m_numWorkers + 1, grainSize = m_grainSize;
+    const RangeIterator iterator = m_iterator;
+    void *opaque = m_opaque;
+    /* consume own slice first and then steal remaining chunks from other slices */
+    for (nanoem_u32_t i = 0; i < numSlices; i++) {
+        Slice &slice = m_slices[(sliceIndex + i) % numSlices];
+        const nanoem_u32_t end = slice.m_end;
+        while (true) {
+            const nanoem_u32_t begin = bx::atomicFetchAndAdd<nanoem_u32_t>(&slice.m_next, grainSize);
+            if (begin >= end) {
+                break;
+            }
+            iterator(opaque, begin, glm::min(begin + grainSize, end));
+        }
+    }
+}
+
+} /* namespace nanoem */
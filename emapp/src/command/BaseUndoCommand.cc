@@ -62,11 +62,24 @@ BaseUndoCommand::LZ4Data::inflate(ProtobufCBinaryData *binary) const
     return result;
 }
 
+nanoem_rsize_t
+BaseUndoCommand::LZ4Data::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_deflatedBytes.capacity();
+}
+
 BaseUndoCommand::BaseUndoCommand(Project *project)
     : m_project(project)
+    , m_memoryUsage(0)
 {
 }
 
+nanoem_rsize_t
+BaseUndoCommand::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return 0;
+}
+
 const Project *
 BaseUndoCommand::currentProject() const NANOEM_DECL_NOEXCEPT
 {
@@ -92,6 +105,8 @@ BaseUndoCommand::createCommand(bool enablePersistence)
         undoCommandSetOnPersistRedoCallback(command, BaseUndoCommand::onPersistRedo);
     }
     undoCommandSetOpaqueData(command, this);
+    m_memoryUsage = memoryUsage();
+    m_project->increaseUndoMemoryUsage(m_memoryUsage);
     return command;
 }
 
@@ -113,12 +128,27 @@ BaseUndoCommand::writeCommandMessage(void *opaque, nanoem_u32_t type, void *mess
     action->type_case = static_cast<Nanoem__Application__Command__TypeCase>(type);
 }
 
+void
+BaseUndoCommand::invalidateAllCaches(Project *project)
+{
+    /* any edit may change the simulation so checkpoints taken before are no longer valid */
+    project->clearAllPhysicsCheckpoints();
+    /* commands are pushed to the undo stack of the active model so only its poses are affected */
+    if (const Model *model = project->activeModel()) {
+        project->clearBakedPoses(model);
+    }
+    else {
+        project->clearAllBakedPoses();
+    }
+}
+
 void
 BaseUndoCommand::onUndo(const undo_command_t *command)
 {
     Error error;
     IUndoCommand *commandPtr = static_cast<IUndoCommand *>(undoCommandGetOpaqueData(command));
     commandPtr->undo(error);
+    invalidateAllCaches(commandPtr->currentProject());
     if (error.hasReason()) {
         error.notify(commandPtr->currentProject()->eventPublisher());
     }
@@ -130,6 +160,7 @@ BaseUndoCommand::onRedo(const undo_command_t *command)
     Error error;
     IUndoCommand *commandPtr = static_cast<IUndoCommand *>(undoCommandGetOpaqueData(command));
     commandPtr->redo(error);
+    invalidateAllCaches(commandPtr->currentProject());
     if (error.hasReason()) {
         error.notify(commandPtr->currentProject()->eventPublisher());
     }
@@ -174,7 +205,8 @@ BaseUndoCommand::onPersistRedo(const undo_command_t *command)
 void
 BaseUndoCommand::onDestroy(const undo_command_t *command)
 {
-    IUndoCommand *commandPtr = static_cast<IUndoCommand *>(undoCommandGetOpaqueData(command));
+    BaseUndoCommand *commandPtr = static_cast<BaseUndoCommand *>(undoCommandGetOpaqueData(command));
+    commandPtr->m_project->decreaseUndoMemoryUsage(commandPtr->m_memoryUsage);
     nanoem_delete(commandPtr);
 }
 
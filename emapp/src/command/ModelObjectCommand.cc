@@ -143,6 +143,11 @@ ScopedMutableConstraint::ScopedMutableConstraint(nanoem_model_constraint_t *cons
 
 ScopedMutableConstraint::~ScopedMutableConstraint() NANOEM_DECL_NOEXCEPT
 {
+    /* compiled joints must be rebuilt since angle limit, iterations or joints might be changed */
+    if (model::Constraint *constraint =
+            model::Constraint::cast(nanoemMutableModelConstraintGetOriginObject(m_constraint))) {
+        constraint->invalidate();
+    }
     nanoemMutableModelConstraintDestroy(m_constraint);
     m_constraint = nullptr;
 }
@@ -83,6 +83,12 @@ ModelSnapshotCommand::name() const NANOEM_DECL_NOEXCEPT
     return "ModelSnapshotCommand";
 }
 
+nanoem_rsize_t
+ModelSnapshotCommand::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_snapshot.first.memoryUsage() + m_snapshot.second.memoryUsage();
+}
+
 void
 ModelSnapshotCommand::execute(const LZ4Data &input, Error &error)
 {
@@ -11,10 +11,663 @@
 #include "emapp/Accessory.h"
 #include "emapp/EnumUtils.h"
 #include "emapp/Error.h"
+#include "emapp/IMotionKeyframeSelection.h"
 #include "emapp/private/CommonInclude.h"
 
+#ifdef NANOEM_ENABLE_NMD
+#include "nanoem/ext/motion.h"
+#endif
+
 namespace nanoem {
 namespace command {
+namespace {
+
+typedef tinystl::vector<nanoem_motion_accessory_keyframe_t *, TinySTLAllocator> AccessoryKeyframeList;
+typedef tinystl::vector<nanoem_motion_bone_keyframe_t *, TinySTLAllocator> BoneKeyframeList;
+typedef tinystl::vector<nanoem_motion_camera_keyframe_t *, TinySTLAllocator> CameraKeyframeList;
+typedef tinystl::vector<nanoem_motion_light_keyframe_t *, TinySTLAllocator> LightKeyframeList;
+typedef tinystl::vector<nanoem_motion_model_keyframe_t *, TinySTLAllocator> ModelKeyframeList;
+typedef tinystl::vector<nanoem_motion_morph_keyframe_t *, TinySTLAllocator> MorphKeyframeList;
+typedef tinystl::vector<nanoem_motion_self_shadow_keyframe_t *, TinySTLAllocator> SelfShadowKeyframeList;
+
+static bool
+equalsString(nanoem_unicode_string_factory_t *factory, const nanoem_unicode_string_t *left,
+    const nanoem_unicode_string_t *right)
+{
+    return left && right ? nanoemUnicodeStringFactoryCompareString(factory, left, right) == 0 : left == right;
+}
+
+static bool
+equalsVector3(const nanoem_f32_t *left, const nanoem_f32_t *right) NANOEM_DECL_NOEXCEPT
+{
+    return memcmp(left, right, sizeof(*left) * 3) == 0;
+}
+
+static bool
+equalsVector4(const nanoem_f32_t *left, const nanoem_f32_t *right) NANOEM_DECL_NOEXCEPT
+{
+    return memcmp(left, right, sizeof(*left) * 4) == 0;
+}
+
+static bool
+equalsOutsideParent(nanoem_unicode_string_factory_t *factory, const nanoem_motion_outside_parent_t *left,
+    const nanoem_motion_outside_parent_t *right)
+{
+    return left && right
+        ? equalsString(factory, nanoemMotionOutsideParentGetTargetObjectName(left),
+              nanoemMotionOutsideParentGetTargetObjectName(right)) &&
+            equalsString(factory, nanoemMotionOutsideParentGetTargetBoneName(left),
+                nanoemMotionOutsideParentGetTargetBoneName(right)) &&
+            equalsString(factory, nanoemMotionOutsideParentGetSubjectBoneName(left),
+                nanoemMotionOutsideParentGetSubjectBoneName(right))
+        : left == right;
+}
+
+static bool
+equalsAllOutsideParents(nanoem_unicode_string_factory_t *factory, nanoem_motion_outside_parent_t *const *left,
+    nanoem_rsize_t numLeft, nanoem_motion_outside_parent_t *const *right, nanoem_rsize_t numRight)
+{
+    bool result = numLeft == numRight;
+    for (nanoem_rsize_t i = 0; result && i < numLeft; i++) {
+        result = equalsOutsideParent(factory, left[i], right[i]);
+    }
+    return result;
+}
+
+static bool
+equalsAllEffectParameters(nanoem_unicode_string_factory_t *factory, nanoem_motion_effect_parameter_t *const *left,
+    nanoem_rsize_t numLeft, nanoem_motion_effect_parameter_t *const *right, nanoem_rsize_t numRight)
+{
+    bool result = numLeft == numRight;
+    for (nanoem_rsize_t i = 0; result && i < numLeft; i++) {
+        const nanoem_motion_effect_parameter_t *l = left[i], *r = right[i];
+        const nanoem_motion_effect_parameter_type_t type = nanoemMotionEffectParameterGetType(l);
+        result = type == nanoemMotionEffectParameterGetType(r) &&
+            equalsString(factory, nanoemMotionEffectParameterGetName(l), nanoemMotionEffectParameterGetName(r));
+        if (result) {
+            /* bool and int parameters are stored as int that has same size of float */
+            const nanoem_rsize_t size =
+                sizeof(nanoem_f32_t) * (type == NANOEM_MOTION_EFFECT_PARAMETER_TYPE_VECTOR4 ? 4 : 1);
+            result = memcmp(nanoemMotionEffectParameterGetValue(l), nanoemMotionEffectParameterGetValue(r), size) == 0;
+        }
+    }
+    return result;
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t *factory, const nanoem_motion_accessory_keyframe_t *left,
+    const nanoem_motion_accessory_keyframe_t *right)
+{
+    nanoem_rsize_t numLeft, numRight;
+    nanoem_motion_effect_parameter_t *const *leftParameters =
+        nanoemMotionAccessoryKeyframeGetAllEffectParameterObjects(left, &numLeft);
+    nanoem_motion_effect_parameter_t *const *rightParameters =
+        nanoemMotionAccessoryKeyframeGetAllEffectParameterObjects(right, &numRight);
+    return equalsVector3(nanoemMotionAccessoryKeyframeGetTranslation(left),
+               nanoemMotionAccessoryKeyframeGetTranslation(right)) &&
+        equalsVector4(
+            nanoemMotionAccessoryKeyframeGetOrientation(left), nanoemMotionAccessoryKeyframeGetOrientation(right)) &&
+        nanoemMotionAccessoryKeyframeGetScaleFactor(left) == nanoemMotionAccessoryKeyframeGetScaleFactor(right) &&
+        nanoemMotionAccessoryKeyframeGetOpacity(left) == nanoemMotionAccessoryKeyframeGetOpacity(right) &&
+        nanoemMotionAccessoryKeyframeIsVisible(left) == nanoemMotionAccessoryKeyframeIsVisible(right) &&
+        nanoemMotionAccessoryKeyframeIsAddBlendEnabled(left) == nanoemMotionAccessoryKeyframeIsAddBlendEnabled(right) &&
+        nanoemMotionAccessoryKeyframeIsShadowEnabled(left) == nanoemMotionAccessoryKeyframeIsShadowEnabled(right) &&
+        equalsOutsideParent(factory, nanoemMotionAccessoryKeyframeGetOutsideParent(left),
+            nanoemMotionAccessoryKeyframeGetOutsideParent(right)) &&
+        equalsAllEffectParameters(factory, leftParameters, numLeft, rightParameters, numRight);
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t * /* factory */, const nanoem_motion_bone_keyframe_t *left,
+    const nanoem_motion_bone_keyframe_t *right)
+{
+    bool result =
+        equalsVector3(nanoemMotionBoneKeyframeGetTranslation(left), nanoemMotionBoneKeyframeGetTranslation(right)) &&
+        equalsVector4(nanoemMotionBoneKeyframeGetOrientation(left), nanoemMotionBoneKeyframeGetOrientation(right)) &&
+        nanoemMotionBoneKeyframeGetStageIndex(left) == nanoemMotionBoneKeyframeGetStageIndex(right) &&
+        nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(left) ==
+            nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(right);
+    for (int i = NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+         result && i < NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+        const nanoem_motion_bone_keyframe_interpolation_type_t type =
+            nanoem_motion_bone_keyframe_interpolation_type_t(i);
+        result = memcmp(nanoemMotionBoneKeyframeGetInterpolation(left, type),
+                     nanoemMotionBoneKeyframeGetInterpolation(right, type), 4) == 0;
+    }
+    return result;
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t *factory, const nanoem_motion_camera_keyframe_t *left,
+    const nanoem_motion_camera_keyframe_t *right)
+{
+    bool result =
+        equalsVector3(nanoemMotionCameraKeyframeGetLookAt(left), nanoemMotionCameraKeyframeGetLookAt(right)) &&
+        equalsVector3(nanoemMotionCameraKeyframeGetAngle(left), nanoemMotionCameraKeyframeGetAngle(right)) &&
+        nanoemMotionCameraKeyframeGetDistance(left) == nanoemMotionCameraKeyframeGetDistance(right) &&
+        nanoemMotionCameraKeyframeGetFov(left) == nanoemMotionCameraKeyframeGetFov(right) &&
+        nanoemMotionCameraKeyframeIsPerspectiveView(left) == nanoemMotionCameraKeyframeIsPerspectiveView(right) &&
+        nanoemMotionCameraKeyframeGetStageIndex(left) == nanoemMotionCameraKeyframeGetStageIndex(right) &&
+        equalsOutsideParent(factory, nanoemMotionCameraKeyframeGetOutsideParent(left),
+            nanoemMotionCameraKeyframeGetOutsideParent(right));
+    for (int i = NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+         result && i < NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+        const nanoem_motion_camera_keyframe_interpolation_type_t type =
+            nanoem_motion_camera_keyframe_interpolation_type_t(i);
+        result = memcmp(nanoemMotionCameraKeyframeGetInterpolation(left, type),
+                     nanoemMotionCameraKeyframeGetInterpolation(right, type), 4) == 0;
+    }
+    return result;
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t * /* factory */, const nanoem_motion_light_keyframe_t *left,
+    const nanoem_motion_light_keyframe_t *right)
+{
+    return equalsVector3(nanoemMotionLightKeyframeGetColor(left), nanoemMotionLightKeyframeGetColor(right)) &&
+        equalsVector3(nanoemMotionLightKeyframeGetDirection(left), nanoemMotionLightKeyframeGetDirection(right));
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t *factory, const nanoem_motion_model_keyframe_t *left,
+    const nanoem_motion_model_keyframe_t *right)
+{
+    bool result = nanoemMotionModelKeyframeIsVisible(left) == nanoemMotionModelKeyframeIsVisible(right) &&
+        nanoemMotionModelKeyframeGetEdgeScaleFactor(left) == nanoemMotionModelKeyframeGetEdgeScaleFactor(right) &&
+        equalsVector4(nanoemMotionModelKeyframeGetEdgeColor(left), nanoemMotionModelKeyframeGetEdgeColor(right)) &&
+        nanoemMotionModelKeyframeIsAddBlendEnabled(left) == nanoemMotionModelKeyframeIsAddBlendEnabled(right) &&
+        nanoemMotionModelKeyframeIsPhysicsSimulationEnabled(left) ==
+            nanoemMotionModelKeyframeIsPhysicsSimulationEnabled(right);
+    nanoem_rsize_t numLeft, numRight;
+    if (result) {
+        nanoem_motion_model_keyframe_constraint_state_t *const *leftStates =
+            nanoemMotionModelKeyframeGetAllConstraintStateObjects(left, &numLeft);
+        nanoem_motion_model_keyframe_constraint_state_t *const *rightStates =
+            nanoemMotionModelKeyframeGetAllConstraintStateObjects(right, &numRight);
+        result = numLeft == numRight;
+        for (nanoem_rsize_t i = 0; result && i < numLeft; i++) {
+            result = nanoemMotionModelKeyframeConstraintStateIsEnabled(leftStates[i]) ==
+                    nanoemMotionModelKeyframeConstraintStateIsEnabled(rightStates[i]) &&
+                equalsString(factory, nanoemMotionModelKeyframeConstraintStateGetBoneName(leftStates[i]),
+                    nanoemMotionModelKeyframeConstraintStateGetBoneName(rightStates[i]));
+        }
+    }
+    if (result) {
+        nanoem_motion_outside_parent_t *const *leftParents =
+            nanoemMotionModelKeyframeGetAllOutsideParentObjects(left, &numLeft);
+        nanoem_motion_outside_parent_t *const *rightParents =
+            nanoemMotionModelKeyframeGetAllOutsideParentObjects(right, &numRight);
+        result = equalsAllOutsideParents(factory, leftParents, numLeft, rightParents, numRight);
+    }
+    if (result) {
+        nanoem_motion_effect_parameter_t *const *leftParameters =
+            nanoemMotionModelKeyframeGetAllEffectParameterObjects(left, &numLeft);
+        nanoem_motion_effect_parameter_t *const *rightParameters =
+            nanoemMotionModelKeyframeGetAllEffectParameterObjects(right, &numRight);
+        result = equalsAllEffectParameters(factory, leftParameters, numLeft, rightParameters, numRight);
+    }
+    return result;
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t * /* factory */, const nanoem_motion_morph_keyframe_t *left,
+    const nanoem_motion_morph_keyframe_t *right)
+{
+    return nanoemMotionMorphKeyframeGetWeight(left) == nanoemMotionMorphKeyframeGetWeight(right);
+}
+
+static bool
+equalsKeyframe(nanoem_unicode_string_factory_t * /* factory */, const nanoem_motion_self_shadow_keyframe_t *left,
+    const nanoem_motion_self_shadow_keyframe_t *right)
+{
+    return nanoemMotionSelfShadowKeyframeGetDistance(left) == nanoemMotionSelfShadowKeyframeGetDistance(right) &&
+        nanoemMotionSelfShadowKeyframeGetMode(left) == nanoemMotionSelfShadowKeyframeGetMode(right);
+}
+
+static nanoem_rsize_t
+countAllKeyframes(const nanoem_motion_t *motion) NANOEM_DECL_NOEXCEPT
+{
+    nanoem_rsize_t numKeyframes, numTotalKeyframes = 0;
+    nanoemMotionGetAllAccessoryKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllBoneKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllCameraKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllLightKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllModelKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllMorphKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    nanoemMotionGetAllSelfShadowKeyframeObjects(motion, &numKeyframes);
+    numTotalKeyframes += numKeyframes;
+    return numTotalKeyframes;
+}
+
+static bool
+loadMotion(const ByteArray &bytes, nanoem_motion_format_type_t format, nanoem_motion_t *motion,
+    nanoem_status_t &status)
+{
+    nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), bytes.size(), &status);
+    switch (format) {
+#ifdef NANOEM_ENABLE_NMD
+    case NANOEM_MOTION_FORMAT_TYPE_NMD: {
+        nanoemMotionLoadFromBufferNMD(motion, buffer, 0, &status);
+        break;
+    }
+#endif
+    case NANOEM_MOTION_FORMAT_TYPE_VMD: {
+        nanoemMotionLoadFromBuffer(motion, buffer, 0, &status);
+        break;
+    }
+    default:
+        status = NANOEM_STATUS_ERROR_INVALID_SIGNATURE;
+        break;
+    }
+    nanoemBufferDestroy(buffer);
+    return status == NANOEM_STATUS_SUCCESS;
+}
+
+static bool
+loadMotion(const BaseUndoCommand::LZ4Data &data, nanoem_motion_format_type_t format, nanoem_motion_t *motion,
+    nanoem_status_t &status)
+{
+    ByteArray bytes;
+    return data.inflate(bytes) && loadMotion(bytes, format, motion, status);
+}
+
+static bool
+saveMotion(
+    nanoem_mutable_motion_t *motion, nanoem_motion_format_type_t format, ByteArray &bytes, nanoem_status_t &status)
+{
+    nanoem_mutable_buffer_t *mutableBuffer = nanoemMutableBufferCreate(&status);
+    switch (format) {
+#ifdef NANOEM_ENABLE_NMD
+    case NANOEM_MOTION_FORMAT_TYPE_NMD: {
+        nanoemMutableMotionSaveToBufferNMD(motion, mutableBuffer, &status);
+        break;
+    }
+#endif
+    case NANOEM_MOTION_FORMAT_TYPE_VMD: {
+        nanoemMutableMotionSaveToBuffer(motion, mutableBuffer, &status);
+        break;
+    }
+    default:
+        status = NANOEM_STATUS_ERROR_INVALID_SIGNATURE;
+        break;
+    }
+    if (status == NANOEM_STATUS_SUCCESS) {
+        nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutableBuffer, &status);
+        const nanoem_u8_t *dataPtr = nanoemBufferGetDataPtr(buffer);
+        bytes.assign(dataPtr, dataPtr + nanoemBufferGetLength(buffer));
+        nanoemBufferDestroy(buffer);
+    }
+    nanoemMutableBufferDestroy(mutableBuffer);
+    return status == NANOEM_STATUS_SUCCESS;
+}
+
+/* removes keyframes in the motion located at same track and frame index of each keyframe in source */
+static void
+removeAllKeyframes(const nanoem_motion_t *source, IMotionKeyframeSelection *selection,
+    nanoem_mutable_motion_t *motion, nanoem_status_t &status)
+{
+    nanoem_motion_t *origin = nanoemMutableMotionGetOriginObject(motion);
+    nanoem_rsize_t numKeyframes;
+    nanoem_motion_accessory_keyframe_t *const *accessoryKeyframes =
+        nanoemMotionGetAllAccessoryKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_frame_index_t frameIndex = nanoemMotionKeyframeObjectGetFrameIndex(
+            nanoemMotionAccessoryKeyframeGetKeyframeObject(accessoryKeyframes[i]));
+        if (const nanoem_motion_accessory_keyframe_t *keyframe =
+                nanoemMotionFindAccessoryKeyframeObject(origin, frameIndex)) {
+            nanoem_mutable_motion_accessory_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionAccessoryKeyframeCreateByFound(origin, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveAccessoryKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionAccessoryKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_bone_keyframe_t *const *boneKeyframes = nanoemMotionGetAllBoneKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_unicode_string_t *name = nanoemMotionBoneKeyframeGetName(boneKeyframes[i]);
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(boneKeyframes[i]));
+        if (const nanoem_motion_bone_keyframe_t *keyframe =
+                nanoemMotionFindBoneKeyframeObject(origin, name, frameIndex)) {
+            nanoem_mutable_motion_bone_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionBoneKeyframeCreateByFound(origin, name, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveBoneKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionBoneKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_camera_keyframe_t *const *cameraKeyframes =
+        nanoemMotionGetAllCameraKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(cameraKeyframes[i]));
+        if (const nanoem_motion_camera_keyframe_t *keyframe =
+                nanoemMotionFindCameraKeyframeObject(origin, frameIndex)) {
+            nanoem_mutable_motion_camera_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionCameraKeyframeCreateByFound(origin, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveCameraKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionCameraKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_light_keyframe_t *const *lightKeyframes =
+        nanoemMotionGetAllLightKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(lightKeyframes[i]));
+        if (const nanoem_motion_light_keyframe_t *keyframe = nanoemMotionFindLightKeyframeObject(origin, frameIndex)) {
+            nanoem_mutable_motion_light_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionLightKeyframeCreateByFound(origin, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveLightKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionLightKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_model_keyframe_t *const *modelKeyframes =
+        nanoemMotionGetAllModelKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(modelKeyframes[i]));
+        if (const nanoem_motion_model_keyframe_t *keyframe = nanoemMotionFindModelKeyframeObject(origin, frameIndex)) {
+            nanoem_mutable_motion_model_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionModelKeyframeCreateByFound(origin, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveModelKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionModelKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_morph_keyframe_t *const *morphKeyframes =
+        nanoemMotionGetAllMorphKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_unicode_string_t *name = nanoemMotionMorphKeyframeGetName(morphKeyframes[i]);
+        const nanoem_frame_index_t frameIndex =
+            nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(morphKeyframes[i]));
+        if (const nanoem_motion_morph_keyframe_t *keyframe =
+                nanoemMotionFindMorphKeyframeObject(origin, name, frameIndex)) {
+            nanoem_mutable_motion_morph_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionMorphKeyframeCreateByFound(origin, name, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveMorphKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionMorphKeyframeDestroy(mutableKeyframe);
+        }
+    }
+    nanoem_motion_self_shadow_keyframe_t *const *selfShadowKeyframes =
+        nanoemMotionGetAllSelfShadowKeyframeObjects(source, &numKeyframes);
+    for (nanoem_rsize_t i = 0; i < numKeyframes && status == NANOEM_STATUS_SUCCESS; i++) {
+        const nanoem_frame_index_t frameIndex = nanoemMotionKeyframeObjectGetFrameIndex(
+            nanoemMotionSelfShadowKeyframeGetKeyframeObject(selfShadowKeyframes[i]));
+        if (const nanoem_motion_self_shadow_keyframe_t *keyframe =
+                nanoemMotionFindSelfShadowKeyframeObject(origin, frameIndex)) {
+            nanoem_mutable_motion_self_shadow_keyframe_t *mutableKeyframe =
+                nanoemMutableMotionSelfShadowKeyframeCreateByFound(origin, frameIndex, &status);
+            if (selection) {
+                selection->remove(keyframe);
+            }
+            nanoemMutableMotionRemoveSelfShadowKeyframe(motion, mutableKeyframe, &status);
+            nanoemMutableMotionSelfShadowKeyframeDestroy(mutableKeyframe);
+        }
+    }
+}
+
+/* keyframe types without any keyframe are skipped to avoid sorting all keyframes of the motion for nothing */
+static void
+copyAllKeyframes(
+    const nanoem_motion_t *source, const Model *model, nanoem_mutable_motion_t *motion, nanoem_status_t &status)
+{
+    nanoem_rsize_t numKeyframes;
+    nanoemMotionGetAllAccessoryKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllAccessoryKeyframes(source, motion, 0, status);
+    }
+    nanoemMotionGetAllBoneKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllBoneKeyframes(source, model, motion, 0, status);
+    }
+    nanoemMotionGetAllCameraKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllCameraKeyframes(source, motion, 0, status);
+    }
+    nanoemMotionGetAllLightKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllLightKeyframes(source, motion, 0, status);
+    }
+    nanoemMotionGetAllModelKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllModelKeyframes(source, motion, 0, status);
+        nanoemMutableMotionSortAllKeyframes(motion);
+    }
+    nanoemMotionGetAllMorphKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllMorphKeyframes(source, model, motion, 0, status);
+    }
+    nanoemMotionGetAllSelfShadowKeyframeObjects(source, &numKeyframes);
+    if (numKeyframes > 0 && status == NANOEM_STATUS_SUCCESS) {
+        Motion::copyAllSelfShadowKeyframes(source, motion, 0, status);
+    }
+}
+
+/* collects keyframes of both motions that are inserted, removed or modified at each track and frame index */
+class KeyframeDelta NANOEM_DECL_SEALED : private NonCopyable {
+public:
+    KeyframeDelta(nanoem_unicode_string_factory_t *factory)
+        : m_factory(factory)
+    {
+    }
+    ~KeyframeDelta() NANOEM_DECL_NOEXCEPT
+    {
+    }
+
+    void
+    compare(const nanoem_motion_t *current, const nanoem_motion_t *last)
+    {
+        compareAllAccessoryKeyframes(current, last, m_accessoryKeyframes.first);
+        compareAllAccessoryKeyframes(last, current, m_accessoryKeyframes.second);
+        compareAllBoneKeyframes(current, last, m_boneKeyframes.first);
+        compareAllBoneKeyframes(last, current, m_boneKeyframes.second);
+        compareAllCameraKeyframes(current, last, m_cameraKeyframes.first);
+        compareAllCameraKeyframes(last, current, m_cameraKeyframes.second);
+        compareAllLightKeyframes(current, last, m_lightKeyframes.first);
+        compareAllLightKeyframes(last, current, m_lightKeyframes.second);
+        compareAllModelKeyframes(current, last, m_modelKeyframes.first);
+        compareAllModelKeyframes(last, current, m_modelKeyframes.second);
+        compareAllMorphKeyframes(current, last, m_morphKeyframes.first);
+        compareAllMorphKeyframes(last, current, m_morphKeyframes.second);
+        compareAllSelfShadowKeyframes(current, last, m_selfShadowKeyframes.first);
+        compareAllSelfShadowKeyframes(last, current, m_selfShadowKeyframes.second);
+    }
+    nanoem_rsize_t
+    numChangedKeyframes() const NANOEM_DECL_NOEXCEPT
+    {
+        return m_accessoryKeyframes.first.size() + m_accessoryKeyframes.second.size() +
+            m_boneKeyframes.first.size() + m_boneKeyframes.second.size() + m_cameraKeyframes.first.size() +
+            m_cameraKeyframes.second.size() + m_lightKeyframes.first.size() + m_lightKeyframes.second.size() +
+            m_modelKeyframes.first.size() + m_modelKeyframes.second.size() + m_morphKeyframes.first.size() +
+            m_morphKeyframes.second.size() + m_selfShadowKeyframes.first.size() + m_selfShadowKeyframes.second.size();
+    }
+    bool
+    save(bool current, const Model *model, nanoem_motion_format_type_t format, ByteArray &bytes,
+        nanoem_status_t &status) const
+    {
+        nanoem_mutable_motion_t *motion = nanoemMutableMotionCreate(m_factory, &status);
+        const AccessoryKeyframeList &accessoryKeyframes =
+            current ? m_accessoryKeyframes.first : m_accessoryKeyframes.second;
+        Motion::copyAllAccessoryKeyframes(accessoryKeyframes.data(), accessoryKeyframes.size(), motion, 0, status);
+        const BoneKeyframeList &boneKeyframes = current ? m_boneKeyframes.first : m_boneKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllBoneKeyframes(boneKeyframes.data(), boneKeyframes.size(), model, motion, 0, status);
+        }
+        const CameraKeyframeList &cameraKeyframes = current ? m_cameraKeyframes.first : m_cameraKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllCameraKeyframes(cameraKeyframes.data(), cameraKeyframes.size(), motion, 0, status);
+        }
+        const LightKeyframeList &lightKeyframes = current ? m_lightKeyframes.first : m_lightKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllLightKeyframes(lightKeyframes.data(), lightKeyframes.size(), motion, 0, status);
+        }
+        const ModelKeyframeList &modelKeyframes = current ? m_modelKeyframes.first : m_modelKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllModelKeyframes(modelKeyframes.data(), modelKeyframes.size(), motion, 0, status);
+        }
+        const MorphKeyframeList &morphKeyframes = current ? m_morphKeyframes.first : m_morphKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllMorphKeyframes(morphKeyframes.data(), morphKeyframes.size(), model, motion, 0, status);
+        }
+        const SelfShadowKeyframeList &selfShadowKeyframes =
+            current ? m_selfShadowKeyframes.first : m_selfShadowKeyframes.second;
+        if (status == NANOEM_STATUS_SUCCESS) {
+            Motion::copyAllSelfShadowKeyframes(
+                selfShadowKeyframes.data(), selfShadowKeyframes.size(), motion, 0, status);
+        }
+        bool succeeded = status == NANOEM_STATUS_SUCCESS && saveMotion(motion, format, bytes, status);
+        nanoemMutableMotionDestroy(motion);
+        return succeeded;
+    }
+
+private:
+    void
+    compareAllAccessoryKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, AccessoryKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_accessory_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllAccessoryKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_accessory_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_accessory_keyframe_t *destKeyframe = nanoemMotionFindAccessoryKeyframeObject(dest,
+                nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllBoneKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, BoneKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_bone_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllBoneKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_bone_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_bone_keyframe_t *destKeyframe =
+                nanoemMotionFindBoneKeyframeObject(dest, nanoemMotionBoneKeyframeGetName(keyframe),
+                    nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllCameraKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, CameraKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_camera_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllCameraKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_camera_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_camera_keyframe_t *destKeyframe = nanoemMotionFindCameraKeyframeObject(
+                dest, nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllLightKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, LightKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_light_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllLightKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_light_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_light_keyframe_t *destKeyframe = nanoemMotionFindLightKeyframeObject(
+                dest, nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionLightKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllModelKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, ModelKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_model_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllModelKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_model_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_model_keyframe_t *destKeyframe = nanoemMotionFindModelKeyframeObject(
+                dest, nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionModelKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllMorphKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, MorphKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_morph_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllMorphKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_morph_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_morph_keyframe_t *destKeyframe =
+                nanoemMotionFindMorphKeyframeObject(dest, nanoemMotionMorphKeyframeGetName(keyframe),
+                    nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionMorphKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+    void
+    compareAllSelfShadowKeyframes(
+        const nanoem_motion_t *source, const nanoem_motion_t *dest, SelfShadowKeyframeList &keyframes) const
+    {
+        nanoem_rsize_t numKeyframes;
+        nanoem_motion_self_shadow_keyframe_t *const *sourceKeyframes =
+            nanoemMotionGetAllSelfShadowKeyframeObjects(source, &numKeyframes);
+        for (nanoem_rsize_t i = 0; i < numKeyframes; i++) {
+            nanoem_motion_self_shadow_keyframe_t *keyframe = sourceKeyframes[i];
+            const nanoem_motion_self_shadow_keyframe_t *destKeyframe = nanoemMotionFindSelfShadowKeyframeObject(dest,
+                nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionSelfShadowKeyframeGetKeyframeObject(keyframe)));
+            if (!destKeyframe || !equalsKeyframe(m_factory, keyframe, destKeyframe)) {
+                keyframes.push_back(keyframe);
+            }
+        }
+    }
+
+    nanoem_unicode_string_factory_t *m_factory;
+    tinystl::pair<AccessoryKeyframeList, AccessoryKeyframeList> m_accessoryKeyframes;
+    tinystl::pair<BoneKeyframeList, BoneKeyframeList> m_boneKeyframes;
+    tinystl::pair<CameraKeyframeList, CameraKeyframeList> m_cameraKeyframes;
+    tinystl::pair<LightKeyframeList, LightKeyframeList> m_lightKeyframes;
+    tinystl::pair<ModelKeyframeList, ModelKeyframeList> m_modelKeyframes;
+    tinystl::pair<MorphKeyframeList, MorphKeyframeList> m_morphKeyframes;
+    tinystl::pair<SelfShadowKeyframeList, SelfShadowKeyframeList> m_selfShadowKeyframes;
+};
+
+} /* namespace anonymous */
 
 MotionSnapshotCommand::~MotionSnapshotCommand() NANOEM_DECL_NOEXCEPT
 {
@@ -38,13 +691,23 @@ MotionSnapshotCommand::create(Motion *motion, const Model *model, const ByteArra
 void
 MotionSnapshotCommand::undo(Error &error)
 {
-    execute(m_snapshot.second, error);
+    if (m_deltaEnabled) {
+        execute(m_delta.first, m_delta.second, error);
+    }
+    else {
+        execute(m_snapshot.second, error);
+    }
 }
 
 void
 MotionSnapshotCommand::redo(Error &error)
 {
-    execute(m_snapshot.first, error);
+    if (m_deltaEnabled) {
+        execute(m_delta.second, m_delta.first, error);
+    }
+    else {
+        execute(m_snapshot.first, error);
+    }
 }
 
 void
@@ -53,8 +716,17 @@ MotionSnapshotCommand::read(const void *messagePtr)
     if (const Nanoem__Application__RedoSaveMotionSnapshotCommand *command =
             static_cast<const Nanoem__Application__Command *>(messagePtr)->redo_save_motion_snapshot) {
         Project *project = currentProject();
-        m_snapshot.first.deflate(command->current_motion.data, command->current_motion.len);
-        m_snapshot.second.deflate(command->last_motion.data, command->last_motion.len);
+        /* both motions contain only changed keyframes when the delta format is present */
+        m_deltaEnabled = command->has_delta_format != 0;
+        if (m_deltaEnabled) {
+            m_delta.first.deflate(command->current_motion.data, command->current_motion.len);
+            m_delta.second.deflate(command->last_motion.data, command->last_motion.len);
+            m_deltaFormat = static_cast<nanoem_motion_format_type_t>(command->delta_format);
+        }
+        else {
+            m_snapshot.first.deflate(command->current_motion.data, command->current_motion.len);
+            m_snapshot.second.deflate(command->last_motion.data, command->last_motion.len);
+        }
         if (command->has_handle) {
             nanoem_u16_t handle = command->handle;
             if (Accessory *accessory = project->resolveRedoAccessory(handle)) {
@@ -62,6 +734,7 @@ MotionSnapshotCommand::read(const void *messagePtr)
             }
             else if (Model *model = project->resolveRedoModel(handle)) {
                 m_motion = project->resolveMotion(model);
+                m_model = model;
             }
         }
         m_types = command->types;
@@ -85,8 +758,16 @@ MotionSnapshotCommand::write(void *messagePtr)
     Nanoem__Application__RedoSaveMotionSnapshotCommand *command =
         nanoem_new(Nanoem__Application__RedoSaveMotionSnapshotCommand);
     nanoem__application__redo_save_motion_snapshot_command__init(command);
-    m_snapshot.first.inflate(&command->current_motion);
-    m_snapshot.second.inflate(&command->last_motion);
+    if (m_deltaEnabled) {
+        m_delta.first.inflate(&command->current_motion);
+        m_delta.second.inflate(&command->last_motion);
+        command->delta_format = m_deltaFormat;
+        command->has_delta_format = 1;
+    }
+    else {
+        m_snapshot.first.inflate(&command->current_motion);
+        m_snapshot.second.inflate(&command->last_motion);
+    }
     command->types = m_types;
     if (const IDrawable *drawable = currentProject()->resolveDrawable(m_motion)) {
         command->handle = drawable->handle();
@@ -115,6 +796,13 @@ MotionSnapshotCommand::name() const NANOEM_DECL_NOEXCEPT
     return "MotionSnapshotCommand";
 }
 
+nanoem_rsize_t
+MotionSnapshotCommand::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_snapshot.first.memoryUsage() + m_snapshot.second.memoryUsage() + m_delta.first.memoryUsage() +
+        m_delta.second.memoryUsage();
+}
+
 void
 MotionSnapshotCommand::execute(const LZ4Data &input, Error &error)
 {
@@ -130,29 +818,101 @@ MotionSnapshotCommand::execute(const LZ4Data &input, Error &error)
     }
 }
 
+void
+MotionSnapshotCommand::execute(const LZ4Data &from, const LZ4Data &to, Error &error)
+{
+    Project *project = currentProject();
+    if (project->containsMotion(m_motion)) {
+        nanoem_unicode_string_factory_t *factory = project->unicodeStringFactory();
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_motion_t *fromMotion = nanoemMotionCreate(factory, &status),
+                        *toMotion = nanoemMotionCreate(factory, &status);
+        if (loadMotion(from, m_deltaFormat, fromMotion, status) && loadMotion(to, m_deltaFormat, toMotion, status)) {
+            nanoem_mutable_motion_t *mutableMotion = nanoemMutableMotionCreateAsReference(m_motion->data(), &status);
+            IMotionKeyframeSelection *selection = m_motion->selection();
+            removeAllKeyframes(fromMotion, selection, mutableMotion, status);
+            removeAllKeyframes(toMotion, selection, mutableMotion, status);
+            copyAllKeyframes(toMotion, m_model, mutableMotion, status);
+            nanoemMutableMotionDestroy(mutableMotion);
+            m_motion->restoreState(m_state);
+            m_motion->setDirty(true);
+            project->setBaseDuration(m_motion->duration());
+        }
+        nanoemMotionDestroy(fromMotion);
+        nanoemMotionDestroy(toMotion);
+        assignError(status, error);
+    }
+}
+
+bool
+MotionSnapshotCommand::createDelta(const ByteArray &last)
+{
+    /* the live motion is already the current state so only the last snapshot needs to be loaded */
+    nanoem_unicode_string_factory_t *factory = currentProject()->unicodeStringFactory();
+    const nanoem_motion_format_type_t format = m_motion->format();
+    const nanoem_motion_t *currentMotion = m_motion->data();
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_motion_t *lastMotion = nanoemMotionCreate(factory, &status);
+    bool succeeded = false;
+    if (loadMotion(last, format, lastMotion, status)) {
+        KeyframeDelta delta(factory);
+        delta.compare(currentMotion, lastMotion);
+        /* operations rewriting most of keyframes like shifting all of them are still kept as whole snapshots */
+        if (delta.numChangedKeyframes() * 2 <= countAllKeyframes(currentMotion) + countAllKeyframes(lastMotion)) {
+            ByteArray bytes;
+            if (delta.save(true, m_model, format, bytes, status)) {
+                m_delta.first.deflate(bytes);
+                if (delta.save(false, m_model, format, bytes, status)) {
+                    m_delta.second.deflate(bytes);
+                    m_deltaFormat = format;
+                    succeeded = true;
+                }
+            }
+        }
+    }
+    nanoemMotionDestroy(lastMotion);
+    if (!succeeded) {
+        m_delta.first = m_delta.second = LZ4Data();
+    }
+    return succeeded;
+}
+
 MotionSnapshotCommand::MotionSnapshotCommand(Project *project)
     : BaseUndoCommand(project)
     , m_motion(0)
+    , m_model(0)
     , m_state(0)
     , m_types(0)
+    , m_deltaFormat(NANOEM_MOTION_FORMAT_TYPE_UNKNOWN)
+    , m_deltaEnabled(false)
 {
     m_snapshot.first.m_inflatedSize = m_snapshot.second.m_inflatedSize = 0;
+    m_delta.first.m_inflatedSize = m_delta.second.m_inflatedSize = 0;
 }
 
 MotionSnapshotCommand::MotionSnapshotCommand(
     Motion *motion, const Model *model, const ByteArray &snapshot, nanoem_u32_t types)
     : BaseUndoCommand(motion->project())
     , m_motion(motion)
+    , m_model(model)
     , m_state(0)
     , m_types(types)
+    , m_deltaFormat(NANOEM_MOTION_FORMAT_TYPE_UNKNOWN)
+    , m_deltaEnabled(false)
 {
-    ByteArray current;
-    Error error;
-    motion->save(current, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+    m_snapshot.first.m_inflatedSize = m_snapshot.second.m_inflatedSize = 0;
+    m_delta.first.m_inflatedSize = m_delta.second.m_inflatedSize = 0;
     motion->saveState(m_state);
-    m_snapshot.first.deflate(current);
-    m_snapshot.second.deflate(snapshot);
-    error.notify(currentProject()->eventPublisher());
+    m_deltaEnabled = createDelta(snapshot);
+    if (!m_deltaEnabled) {
+        /* the whole current motion is only needed when falling back to snapshots */
+        ByteArray current;
+        Error error;
+        motion->save(current, model, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+        m_snapshot.first.deflate(current);
+        m_snapshot.second.deflate(snapshot);
+        error.notify(currentProject()->eventPublisher());
+    }
 }
 
 } /* namespace command */
@@ -5086,14 +5086,21 @@ ImGuiWindow::drawPerformanceMonitor(const Project *project, const ImVec2 &offset
 {
     static const nanoem_f32_t kSpacingSize = 10, kMarginSize = 5;
     const nanoem_f32_t deviceScaleRatio = project->windowDevicePixelRatio();
-    char memoryBytesInString[32], usageCPUBuffer[128], usageMemoryBuffer[128];
+    char memoryBytesInString[32], uploadedBytesInString[32], usageCPUBuffer[128], usageMemoryBuffer[128],
+        usageUploadBuffer[128], physicsStepsBuffer[128];
+    const PhysicsEngine *physicsEngine = project->physicsEngine();
     bx::prettify(memoryBytesInString, sizeof(memoryBytesInString), m_currentMemoryBytes, bx::Units::Kilo);
+    bx::prettify(
+        uploadedBytesInString, sizeof(uploadedBytesInString), project->uploadedVertexBufferBytes(), bx::Units::Kilo);
     StringUtils::format(usageCPUBuffer, sizeof(usageCPUBuffer), "CPU: %.2f%%", m_currentCPUPercentage);
     StringUtils::format(usageMemoryBuffer, sizeof(usageCPUBuffer), "MEM: %s", memoryBytesInString);
+    StringUtils::format(usageUploadBuffer, sizeof(usageUploadBuffer), "VBO: %s", uploadedBytesInString);
+    StringUtils::format(physicsStepsBuffer, sizeof(physicsStepsBuffer), "PHY: %d (-%d)", physicsEngine->numSteps(),
+        physicsEngine->numDroppedSteps());
     const nanoem_f32_t offsetX = kSpacingSize * deviceScaleRatio,
                        rectWidth = 115 * deviceScaleRatio + kMarginSize * deviceScaleRatio * 2;
     const Vector4 rect(
-        offsetX, offsetX, rectWidth, ImGui::GetTextLineHeightWithSpacing() * 2 + kMarginSize * deviceScaleRatio * 2);
+        offsetX, offsetX, rectWidth, ImGui::GetTextLineHeightWithSpacing() * 4 + kMarginSize * deviceScaleRatio * 2);
     internalFillRect(rect, deviceScaleRatio);
     ImVec2 localOffset(offset);
     ImDrawList *drawList = ImGui::GetWindowDrawList();
@@ -5103,6 +5110,10 @@ ImGuiWindow::drawPerformanceMonitor(const Project *project, const ImVec2 &offset
     drawList->AddText(localOffset, IM_COL32_WHITE, usageCPUBuffer);
     localOffset.y += ImGui::GetTextLineHeightWithSpacing();
     drawList->AddText(localOffset, IM_COL32_WHITE, usageMemoryBuffer);
+    localOffset.y += ImGui::GetTextLineHeightWithSpacing();
+    drawList->AddText(localOffset, IM_COL32_WHITE, usageUploadBuffer);
+    localOffset.y += ImGui::GetTextLineHeightWithSpacing();
+    drawList->AddText(localOffset, IM_COL32_WHITE, physicsStepsBuffer);
 }
 
 void
@@ -22,6 +22,7 @@
 #include "emapp/internal/imgui/LazyPushUndoCommand.h"
 #include "emapp/internal/imgui/ModelEditCommandDialog.h"
 #include "emapp/internal/imgui/UVEditDialog.h"
+#include "emapp/model/Constraint.h"
 #include "emapp/model/IGizmo.h"
 #include "emapp/model/Validator.h"
 #include "emapp/private/CommonInclude.h"
@@ -3361,6 +3362,9 @@ ModelParameterDialog::layoutBoneConstraintPanel(nanoem_model_bone_t *bonePtr, Pr
             if (ImGui::Checkbox(tr("nanoem.gui.model.edit.bone.constraint.joint.angle-limit"), &value)) {
                 command::ScopedMutableConstraintJoint scoped(jointPtr);
                 nanoemMutableModelConstraintJointSetAngleLimitEnabled(scoped, value ? 1 : 0);
+                if (model::Constraint *constraint = model::Constraint::cast(constraintPtr)) {
+                    constraint->invalidate();
+                }
             }
         }
         {
@@ -3369,6 +3373,9 @@ ModelParameterDialog::layoutBoneConstraintPanel(nanoem_model_bone_t *bonePtr, Pr
             if (ImGui::DragFloat3("##joint.upper", glm::value_ptr(lowerLimit), 1.0f, 0.0f, 180.0f)) {
                 command::ScopedMutableConstraintJoint scoped(jointPtr);
                 nanoemMutableModelConstraintJointSetLowerLimit(scoped, glm::value_ptr(glm::radians(lowerLimit)));
+                if (model::Constraint *constraint = model::Constraint::cast(constraintPtr)) {
+                    constraint->invalidate();
+                }
             }
         }
         {
@@ -3377,6 +3384,9 @@ ModelParameterDialog::layoutBoneConstraintPanel(nanoem_model_bone_t *bonePtr, Pr
             if (ImGui::DragFloat3("##joint.lower", glm::value_ptr(upperLimit), 1.0f, 0.0f, 180.0f)) {
                 command::ScopedMutableConstraintJoint scoped(jointPtr);
                 nanoemMutableModelConstraintJointSetUpperLimit(scoped, glm::value_ptr(glm::radians(upperLimit)));
+                if (model::Constraint *constraint = model::Constraint::cast(constraintPtr)) {
+                    constraint->invalidate();
+                }
             }
         }
         ImGui::PopItemWidth();
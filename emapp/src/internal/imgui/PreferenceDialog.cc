@@ -93,6 +93,40 @@ PreferenceDialog::draw(Project *project)
             if (ImGui::Checkbox(tr("nanoem.gui.window.preference.global.sda.enable"), &enableSkinDeformerAccelerator)) {
                 preference.setSkinDeformAcceleratorEnabled(enableSkinDeformerAccelerator);
             }
+            bool enableCompactVertexFormat = preference.isCompactVertexFormatEnabled();
+            if (ImGui::Checkbox(
+                    tr("nanoem.gui.window.preference.global.compact-vertex.enable"), &enableCompactVertexFormat)) {
+                preference.setCompactVertexFormatEnabled(enableCompactVertexFormat);
+            }
+            bool enableParallelMotion = preference.isParallelMotionSynchronizationEnabled();
+            if (ImGui::Checkbox(
+                    tr("nanoem.gui.window.preference.global.parallel-motion.enable"), &enableParallelMotion)) {
+                preference.setParallelMotionSynchronizationEnabled(enableParallelMotion);
+                project->setParallelMotionSynchronizationEnabled(enableParallelMotion);
+            }
+            bool enableParallelModel = preference.isParallelModelLoadingEnabled();
+            if (ImGui::Checkbox(tr("nanoem.gui.window.preference.global.parallel-model.enable"), &enableParallelModel)) {
+                preference.setParallelModelLoadingEnabled(enableParallelModel);
+                project->setParallelModelLoadingEnabled(enableParallelModel);
+            }
+            bool enableParallelPhysics = preference.isParallelPhysicsSimulationEnabled();
+            if (ImGui::Checkbox(
+                    tr("nanoem.gui.window.preference.global.parallel-physics.enable"), &enableParallelPhysics)) {
+                preference.setParallelPhysicsSimulationEnabled(enableParallelPhysics);
+                project->setParallelPhysicsSimulationEnabled(enableParallelPhysics);
+            }
+            bool enablePhysicsWorldPerModel = preference.isPhysicsWorldPerModelEnabled();
+            if (ImGui::Checkbox(tr("nanoem.gui.window.preference.global.physics-world-per-model.enable"),
+                    &enablePhysicsWorldPerModel)) {
+                preference.setPhysicsWorldPerModelEnabled(enablePhysicsWorldPerModel);
+                project->setPhysicsWorldPerModelEnabled(enablePhysicsWorldPerModel);
+            }
+            bool enableBakedPoseCache = preference.isBakedPoseCacheEnabled();
+            if (ImGui::Checkbox(
+                    tr("nanoem.gui.window.preference.global.baked-pose-cache.enable"), &enableBakedPoseCache)) {
+                preference.setBakedPoseCacheEnabled(enableBakedPoseCache);
+                project->setBakedPoseCacheEnabled(enableBakedPoseCache);
+            }
             addSeparator();
             bool enableCrashReport = preference.isCrashReportEnabled();
             if (ImGui::Checkbox(tr("nanoem.gui.window.preference.global.crash-report.enable"), &enableCrashReport)) {
@@ -232,6 +266,8 @@ PreferenceDialog::draw(Project *project)
                 preference.setGFXPassPoolSize(ApplicationPreference::kGFXPassPoolSizeDefaultValue);
                 preference.setGFXPipelinePoolSize(ApplicationPreference::kGFXPipelinePoolSizeDefaultValue);
                 preference.setGFXUniformBufferSize(ApplicationPreference::kGFXUniformBufferSizeDefaultValue);
+                preference.setPhysicsSimulationMaxSubSteps(
+                    ApplicationPreference::kPhysicsSimulationMaxSubStepsDefaultValue);
             }
             addSeparator();
             {
@@ -284,6 +320,15 @@ PreferenceDialog::draw(Project *project)
                     preference.setGFXUniformBufferSize(value);
                 }
             }
+            addSeparator();
+            {
+                int value = preference.physicsSimulationMaxSubSteps();
+                ImGui::TextUnformatted("Max Physics Substeps per Frame");
+                if (ImGui::DragInt("##preference.physics.substeps", &value, 1.0f, 1, 0xffff)) {
+                    preference.setPhysicsSimulationMaxSubSteps(value);
+                    project->setPhysicsSimulationMaxSubSteps(value);
+                }
+            }
             ImGui::PopItemWidth();
             ImGui::EndTabItem();
         }
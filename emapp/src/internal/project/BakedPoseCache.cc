@@ -0,0 +1,216 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#include "emapp/internal/project/BakedPoseCache.h"
+
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace internal {
+namespace project {
+
+const nanoem_rsize_t BakedPoseCache::kDefaultMemoryBudget = 0x10000000;
+
+BakedPoseCache::BakedPoseCache()
+    : m_first(nullptr)
+    , m_last(nullptr)
+    , m_numPoses(0)
+    , m_memoryUsage(0)
+    , m_memoryBudget(kDefaultMemoryBudget)
+{
+}
+
+BakedPoseCache::~BakedPoseCache() NANOEM_DECL_NOEXCEPT
+{
+    clear();
+}
+
+void
+BakedPoseCache::save(const Model *model, nanoem_frame_index_t frameIndex)
+{
+    Pose *pose = findPose(model, frameIndex);
+    if (pose) {
+        unlink(pose);
+        m_memoryUsage -= sizeOf(pose);
+    }
+    else {
+        pose = nanoem_new(Pose);
+        pose->m_model = model;
+        pose->m_frameIndex = frameIndex;
+        m_poses[model].insert(tinystl::make_pair(frameIndex, pose));
+        m_numPoses++;
+    }
+    model->saveBakedPose(pose->m_bonePoses, pose->m_morphWeights);
+    m_memoryUsage += sizeOf(pose);
+    link(pose);
+    evictAllExceededPoses();
+}
+
+bool
+BakedPoseCache::restore(Model *model, nanoem_frame_index_t frameIndex)
+{
+    bool restored = false;
+    if (Pose *pose = findPose(model, frameIndex)) {
+        restored = model->restoreBakedPose(pose->m_bonePoses, pose->m_morphWeights);
+        if (restored) {
+            unlink(pose);
+            link(pose);
+        }
+        else {
+            /* bones or morphs are added or removed after saving so all poses of the model are no longer valid */
+            invalidate(model);
+        }
+    }
+    return restored;
+}
+
+bool
+BakedPoseCache::contains(const Model *model, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return findPose(model, frameIndex) != nullptr;
+}
+
+void
+BakedPoseCache::invalidate(const Model *model)
+{
+    ModelPoseMap::iterator it = m_poses.find(model);
+    if (it != m_poses.end()) {
+        const FramePoseMap &poses = it->second;
+        for (FramePoseMap::const_iterator it2 = poses.begin(), end2 = poses.end(); it2 != end2; ++it2) {
+            Pose *pose = it2->second;
+            unlink(pose);
+            m_memoryUsage -= sizeOf(pose);
+            m_numPoses--;
+            nanoem_delete(pose);
+        }
+        m_poses.erase(it);
+    }
+}
+
+void
+BakedPoseCache::clear()
+{
+    for (ModelPoseMap::const_iterator it = m_poses.begin(), end = m_poses.end(); it != end; ++it) {
+        const FramePoseMap &poses = it->second;
+        for (FramePoseMap::const_iterator it2 = poses.begin(), end2 = poses.end(); it2 != end2; ++it2) {
+            nanoem_delete(it2->second);
+        }
+    }
+    m_poses.clear();
+    m_first = m_last = nullptr;
+    m_numPoses = 0;
+    m_memoryUsage = 0;
+}
+
+nanoem_rsize_t
+BakedPoseCache::memoryBudget() const NANOEM_DECL_NOEXCEPT
+{
+    return m_memoryBudget;
+}
+
+void
+BakedPoseCache::setMemoryBudget(nanoem_rsize_t value)
+{
+    m_memoryBudget = value;
+    evictAllExceededPoses();
+}
+
+nanoem_rsize_t
+BakedPoseCache::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_memoryUsage;
+}
+
+nanoem_rsize_t
+BakedPoseCache::countAllPoses() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numPoses;
+}
+
+nanoem_rsize_t
+BakedPoseCache::sizeOf(const Pose *pose) NANOEM_DECL_NOEXCEPT
+{
+    return sizeof(*pose) + pose->m_bonePoses.capacity() * sizeof(model::Bone::Pose) +
+        pose->m_morphWeights.capacity() * sizeof(nanoem_f32_t);
+}
+
+BakedPoseCache::Pose *
+BakedPoseCache::findPose(const Model *model, nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    Pose *pose = nullptr;
+    ModelPoseMap::const_iterator it = m_poses.find(model);
+    if (it != m_poses.end()) {
+        FramePoseMap::const_iterator it2 = it->second.find(frameIndex);
+        if (it2 != it->second.end()) {
+            pose = it2->second;
+        }
+    }
+    return pose;
+}
+
+void
+BakedPoseCache::link(Pose *pose) NANOEM_DECL_NOEXCEPT
+{
+    pose->m_previous = nullptr;
+    pose->m_next = m_first;
+    if (m_first) {
+        m_first->m_previous = pose;
+    }
+    m_first = pose;
+    if (!m_last) {
+        m_last = pose;
+    }
+}
+
+void
+BakedPoseCache::unlink(Pose *pose) NANOEM_DECL_NOEXCEPT
+{
+    if (pose->m_previous) {
+        pose->m_previous->m_next = pose->m_next;
+    }
+    else {
+        m_first = pose->m_next;
+    }
+    if (pose->m_next) {
+        pose->m_next->m_previous = pose->m_previous;
+    }
+    else {
+        m_last = pose->m_previous;
+    }
+    pose->m_previous = pose->m_next = nullptr;
+}
+
+void
+BakedPoseCache::destroyPose(Pose *pose)
+{
+    ModelPoseMap::iterator it = m_poses.find(pose->m_model);
+    if (it != m_poses.end()) {
+        FramePoseMap &poses = it->second;
+        FramePoseMap::iterator it2 = poses.find(pose->m_frameIndex);
+        if (it2 != poses.end()) {
+            poses.erase(it2);
+        }
+        if (poses.empty()) {
+            m_poses.erase(it);
+        }
+    }
+    unlink(pose);
+    m_memoryUsage -= sizeOf(pose);
+    m_numPoses--;
+    nanoem_delete(pose);
+}
+
+void
+BakedPoseCache::evictAllExceededPoses()
+{
+    while (m_memoryUsage > m_memoryBudget && m_last) {
+        destroyPose(m_last);
+    }
+}
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
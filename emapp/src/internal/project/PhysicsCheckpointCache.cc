@@ -0,0 +1,240 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#include "emapp/internal/project/PhysicsCheckpointCache.h"
+
+#include "emapp/PhysicsEngine.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "lz4/lib/lz4.h"
+
+namespace nanoem {
+namespace internal {
+namespace project {
+namespace {
+
+static const nanoem_frame_index_t kInvalidFrameIndex = nanoem_frame_index_t(~0);
+
+} /* namespace anonymous */
+
+const nanoem_frame_index_t PhysicsCheckpointCache::kDefaultInterval = 30;
+const nanoem_rsize_t PhysicsCheckpointCache::kDefaultMemoryBudget = 0x4000000;
+const nanoem_frame_index_t PhysicsCheckpointCache::kDefaultMaxNumReplayFrames = 300;
+
+PhysicsCheckpointCache::PhysicsCheckpointCache()
+    : m_memoryUsage(0)
+    , m_memoryBudget(kDefaultMemoryBudget)
+    , m_interval(kDefaultInterval)
+    , m_continuousFrameIndex(kInvalidFrameIndex)
+    , m_maxNumReplayFrames(kDefaultMaxNumReplayFrames)
+{
+}
+
+PhysicsCheckpointCache::~PhysicsCheckpointCache() NANOEM_DECL_NOEXCEPT
+{
+    clear();
+}
+
+bool
+PhysicsCheckpointCache::save(nanoem_frame_index_t frameIndex, const PhysicsEngine *engine)
+{
+    bool saved = false;
+    if (!containsInterval(frameIndex)) {
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        engine->saveState(m_buffer, status);
+        if (status == NANOEM_STATUS_SUCCESS && !m_buffer.empty()) {
+            const int inflatedSize = Inline::saturateInt32(m_buffer.size());
+            Checkpoint *checkpoint = nanoem_new(Checkpoint);
+            ByteArray &deflatedBytes = checkpoint->m_deflatedBytes;
+            deflatedBytes.resize(LZ4_compressBound(inflatedSize));
+            const int deflatedSize = LZ4_compress_fast(reinterpret_cast<const char *>(m_buffer.data()),
+                reinterpret_cast<char *>(deflatedBytes.data()), inflatedSize,
+                Inline::saturateInt32(deflatedBytes.size()), 1);
+            if (deflatedSize > 0) {
+                deflatedBytes.resize(deflatedSize);
+                deflatedBytes.shrink_to_fit();
+                checkpoint->m_inflatedSize = m_buffer.size();
+                checkpoint->m_frameIndex = frameIndex;
+                m_checkpoints.push_back(checkpoint);
+                m_memoryUsage += deflatedBytes.capacity();
+                evictAllExceededCheckpoints();
+                saved = true;
+            }
+            else {
+                nanoem_delete(checkpoint);
+            }
+        }
+    }
+    return saved;
+}
+
+bool
+PhysicsCheckpointCache::restore(nanoem_frame_index_t frameIndex, PhysicsEngine *engine)
+{
+    bool restored = false;
+    if (const Checkpoint *checkpoint = findCheckpoint(frameIndex)) {
+        const ByteArray &deflatedBytes = checkpoint->m_deflatedBytes;
+        m_buffer.resize(checkpoint->m_inflatedSize);
+        const int inflatedSize = LZ4_decompress_safe(reinterpret_cast<const char *>(deflatedBytes.data()),
+            reinterpret_cast<char *>(m_buffer.data()), Inline::saturateInt32(deflatedBytes.size()),
+            Inline::saturateInt32(m_buffer.size()));
+        if (inflatedSize == Inline::saturateInt32(checkpoint->m_inflatedSize)) {
+            nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+            engine->restoreState(m_buffer, status);
+            restored = status == NANOEM_STATUS_SUCCESS;
+        }
+        if (!restored) {
+            /* bodies are added or removed after saving so all checkpoints are no longer restorable */
+            clear();
+        }
+    }
+    return restored;
+}
+
+bool
+PhysicsCheckpointCache::findNearest(
+    nanoem_frame_index_t frameIndex, nanoem_frame_index_t &found) const NANOEM_DECL_NOEXCEPT
+{
+    bool result = false;
+    found = 0;
+    for (CheckpointList::const_iterator it = m_checkpoints.begin(), end = m_checkpoints.end(); it != end; ++it) {
+        const nanoem_frame_index_t checkpointFrameIndex = (*it)->m_frameIndex;
+        if (checkpointFrameIndex <= frameIndex && (!result || checkpointFrameIndex > found)) {
+            found = checkpointFrameIndex;
+            result = true;
+        }
+    }
+    return result;
+}
+
+bool
+PhysicsCheckpointCache::containsInterval(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_frame_index_t interval = frameIndex / m_interval;
+    bool result = false;
+    for (CheckpointList::const_iterator it = m_checkpoints.begin(), end = m_checkpoints.end(); it != end; ++it) {
+        if ((*it)->m_frameIndex / m_interval == interval) {
+            result = true;
+            break;
+        }
+    }
+    return result;
+}
+
+void
+PhysicsCheckpointCache::clear()
+{
+    for (CheckpointList::const_iterator it = m_checkpoints.begin(), end = m_checkpoints.end(); it != end; ++it) {
+        nanoem_delete(*it);
+    }
+    m_checkpoints.clear();
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_memoryUsage = 0;
+    m_continuousFrameIndex = kInvalidFrameIndex;
+}
+
+bool
+PhysicsCheckpointCache::isContinuous(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return m_continuousFrameIndex != kInvalidFrameIndex && m_continuousFrameIndex == frameIndex;
+}
+
+void
+PhysicsCheckpointCache::setContinuous(nanoem_frame_index_t frameIndex)
+{
+    m_continuousFrameIndex = frameIndex;
+}
+
+void
+PhysicsCheckpointCache::resetContinuous()
+{
+    m_continuousFrameIndex = kInvalidFrameIndex;
+}
+
+nanoem_frame_index_t
+PhysicsCheckpointCache::interval() const NANOEM_DECL_NOEXCEPT
+{
+    return m_interval;
+}
+
+void
+PhysicsCheckpointCache::setInterval(nanoem_frame_index_t value)
+{
+    if (value > 0 && value != m_interval) {
+        clear();
+        m_interval = value;
+    }
+}
+
+nanoem_rsize_t
+PhysicsCheckpointCache::memoryBudget() const NANOEM_DECL_NOEXCEPT
+{
+    return m_memoryBudget;
+}
+
+void
+PhysicsCheckpointCache::setMemoryBudget(nanoem_rsize_t value)
+{
+    m_memoryBudget = value;
+    evictAllExceededCheckpoints();
+}
+
+nanoem_frame_index_t
+PhysicsCheckpointCache::maxNumReplayFrames() const NANOEM_DECL_NOEXCEPT
+{
+    return m_maxNumReplayFrames;
+}
+
+void
+PhysicsCheckpointCache::setMaxNumReplayFrames(nanoem_frame_index_t value)
+{
+    m_maxNumReplayFrames = value;
+}
+
+nanoem_rsize_t
+PhysicsCheckpointCache::memoryUsage() const NANOEM_DECL_NOEXCEPT
+{
+    return m_memoryUsage;
+}
+
+nanoem_rsize_t
+PhysicsCheckpointCache::countAllCheckpoints() const NANOEM_DECL_NOEXCEPT
+{
+    return m_checkpoints.size();
+}
+
+const PhysicsCheckpointCache::Checkpoint *
+PhysicsCheckpointCache::findCheckpoint(nanoem_frame_index_t frameIndex) const NANOEM_DECL_NOEXCEPT
+{
+    const Checkpoint *checkpoint = nullptr;
+    for (CheckpointList::const_iterator it = m_checkpoints.begin(), end = m_checkpoints.end(); it != end; ++it) {
+        if ((*it)->m_frameIndex == frameIndex) {
+            checkpoint = *it;
+            break;
+        }
+    }
+    return checkpoint;
+}
+
+void
+PhysicsCheckpointCache::evictAllExceededCheckpoints()
+{
+    nanoem_rsize_t numEvictedCheckpoints = 0;
+    const nanoem_rsize_t numCheckpoints = m_checkpoints.size();
+    while (m_memoryUsage > m_memoryBudget && numEvictedCheckpoints < numCheckpoints) {
+        Checkpoint *checkpoint = m_checkpoints[numEvictedCheckpoints++];
+        m_memoryUsage -= checkpoint->m_deflatedBytes.capacity();
+        nanoem_delete(checkpoint);
+    }
+    if (numEvictedCheckpoints > 0) {
+        m_checkpoints.erase(m_checkpoints.begin(), m_checkpoints.begin() + numEvictedCheckpoints);
+    }
+}
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
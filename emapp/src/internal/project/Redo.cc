@@ -6,20 +6,65 @@
 
 #include "emapp/internal/project/Redo.h"
 
+#include "emapp/Error.h"
+#include "emapp/FileUtils.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "lz4/lib/lz4.h"
+
+namespace nanoem {
+namespace internal {
+namespace project {
+
+const nanoem_u32_t Redo::kFileMagic = nanoem_fourcc('n', 'm', 'C', '2');
+const nanoem_u32_t Redo::kLegacyFileMagic = nanoem_fourcc('n', 'm', 'C', 'S');
+const nanoem_u32_t Redo::kUncompressedRecordFlag = 0x80000000;
+
+void
+Redo::writeRecord(IWriter *writer, nanoem_u32_t sequence, nanoem_u16_t type, const ByteArray &bytes,
+    bool compressionEnabled, ByteArray &buffer, Error &error)
+{
+    ByteArray compressed;
+    const nanoem_u8_t *dataPtr = bytes.data();
+    nanoem_u32_t size = nanoem_u32_t(bytes.size()) | kUncompressedRecordFlag;
+    if (compressionEnabled) {
+        compressed.resize(LZ4_compressBound(Inline::saturateInt32(bytes.size())));
+        int compressedSize =
+            LZ4_compress_fast(reinterpret_cast<const char *>(bytes.data()), reinterpret_cast<char *>(compressed.data()),
+                Inline::saturateInt32(bytes.size()), Inline::saturateInt32(compressed.size()), 1);
+        /* records failed to compress are stored as is instead of being dropped */
+        if (compressedSize > 0) {
+            dataPtr = compressed.data();
+            size = nanoem_u32_t(compressedSize);
+        }
+    }
+    buffer.clear();
+    MemoryWriter memoryWriter(&buffer);
+    if (sequence == 0) {
+        FileUtils::writeTyped(&memoryWriter, kFileMagic, error);
+    }
+    FileUtils::writeTyped(&memoryWriter, sequence, error);
+    FileUtils::writeTyped(&memoryWriter, type, error);
+    FileUtils::writeTyped(&memoryWriter, size, error);
+    FileUtils::write(&memoryWriter, dataPtr, size & ~kUncompressedRecordFlag, error);
+    FileUtils::write(writer, buffer, error);
+}
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
+
 #if defined(NANOEM_ENABLE_NANOMSG)
 
 #include "../../protoc/application.pb-c.h"
 #include "emapp/BaseApplicationService.h"
-#include "emapp/Error.h"
 #include "emapp/IEventPublisher.h"
 #include "emapp/IFileManager.h"
 #include "emapp/IModalDialog.h"
 #include "emapp/Project.h"
 #include "emapp/ThreadedApplicationService.h"
-#include "emapp/private/CommonInclude.h"
 
 #include "bx/readerwriter.h"
-#include "lz4/lib/lz4.h"
 #include "sokol/sokol_time.h"
 
 #define NN_STATIC_LIB
@@ -30,8 +75,6 @@ namespace nanoem {
 namespace internal {
 namespace project {
 
-const nanoem_u32_t Redo::kFileMagic = nanoem_fourcc('n', 'm', 'C', 'S');
-
 Redo::Redo(Project *project)
     : m_project(project)
 {
@@ -46,19 +89,21 @@ Redo::loadAll(ISeekableReader *reader, BaseApplicationService *application, Erro
 {
     nanoem_u32_t sig;
     nanoem_u16_t commandType;
-    if (FileUtils::readTyped(reader, sig, error) && sig == kFileMagic) {
-        nanoem_u32_t offset = 0, count = 0, lastSequnce = 0, deflatedCommandSize, sequence;
-        getCountOffset(reader, count, offset, error);
+    if (FileUtils::readTyped(reader, sig, error) && isAcceptedFileMagic(sig)) {
+        const nanoem_u32_t rawRecordFlag = uncompressedRecordFlag(sig);
+        nanoem_u32_t offset = 0, count = 0, lastSequnce = 0, recordSize, sequence;
+        getCountOffset(reader, rawRecordFlag, count, offset, error);
         m_project->setWritingRedoMessageDisabled(true);
         ByteArray deflated, inflated;
         while (FileUtils::readTyped(reader, sequence, error) == sizeof(sequence)) {
             FileUtils::readTyped(reader, commandType, error);
-            FileUtils::readTyped(reader, deflatedCommandSize, error);
+            FileUtils::readTyped(reader, recordSize, error);
+            const nanoem_u32_t deflatedCommandSize = recordSize & ~rawRecordFlag;
             if (isAccepted(commandType)) {
                 deflated.resize(deflatedCommandSize);
                 FileUtils::read(reader, deflated.data(), Inline::saturateInt32(deflated.size()), error);
                 if (offset <= sequence && (lastSequnce == 0 || lastSequnce < sequence)) {
-                    inflateChunk(deflated, inflated);
+                    inflateChunk(deflated, (recordSize & rawRecordFlag) != 0, inflated);
                     application->dispatchCommandMessage(inflated.data(), inflated.size(), m_project,
                         commandType == NANOEM__APPLICATION__COMMAND__TYPE_UNDO);
                 }
@@ -82,9 +127,10 @@ Redo::loadAllAsync(ISeekableReader *reader, IModalDialog *dialog, bool *cancelle
     nn_setsockopt(eventStreamSocket, NN_SUB, NN_SUB_SUBSCRIBE, "", 0);
     nanoem_u32_t sig;
     nanoem_u16_t commandType;
-    if (FileUtils::readTyped(reader, sig, error) && sig == kFileMagic) {
-        nanoem_u32_t offset = 0, count = 0, lastSequnce = 0, deflatedCommandSize, sequence;
-        getCountOffset(reader, count, offset, error);
+    if (FileUtils::readTyped(reader, sig, error) && isAcceptedFileMagic(sig)) {
+        const nanoem_u32_t rawRecordFlag = uncompressedRecordFlag(sig);
+        nanoem_u32_t offset = 0, count = 0, lastSequnce = 0, recordSize, sequence;
+        getCountOffset(reader, rawRecordFlag, count, offset, error);
         dialog->setProgress(0);
         m_project->setWritingRedoMessageDisabled(true);
         const URI &fileURI = m_project->redoFileURI();
@@ -100,12 +146,13 @@ Redo::loadAllAsync(ISeekableReader *reader, IModalDialog *dialog, bool *cancelle
         ByteArray deflated, inflated;
         while (!*cancelled && FileUtils::readTyped(reader, sequence, error) == sizeof(sequence)) {
             FileUtils::readTyped(reader, commandType, error);
-            FileUtils::readTyped(reader, deflatedCommandSize, error);
+            FileUtils::readTyped(reader, recordSize, error);
+            const nanoem_u32_t deflatedCommandSize = recordSize & ~rawRecordFlag;
             if (isAccepted(commandType)) {
                 deflated.resize(deflatedCommandSize);
                 FileUtils::read(reader, deflated.data(), Inline::saturateInt32(deflated.size()), error);
                 if (offset <= sequence && (lastSequnce == 0 || lastSequnce < sequence)) {
-                    inflateChunk(deflated, inflated);
+                    inflateChunk(deflated, (recordSize & rawRecordFlag) != 0, inflated);
                     sendCommandMessage(commandStreamSocket, inflated, commandType, writer, sequence);
                     waitEventMessage(commandStreamSocket, eventStreamSocket, cancelled);
                     dialog->setProgress(nanoem_f32_t((sequence - offset) / nanoem_f64_t(count - offset)));
@@ -135,39 +182,11 @@ Redo::loadAllAsync(ISeekableReader *reader, IModalDialog *dialog, bool *cancelle
 bool
 Redo::save(IWriter *writer, nanoem_u32_t sequence, const Nanoem__Application__Command *command, Error &error)
 {
-    bool saved = false;
-    if (!saved) {
-        ByteArray bytes;
-        bytes.resize(nanoem__application__command__get_packed_size(command));
-        nanoem__application__command__pack(command, bytes.data());
-        if (sequence == 0) {
-            FileUtils::writeTyped(writer, kFileMagic, error);
-        }
-        ByteArray compressed;
-        compressed.reserve(LZ4_compressBound(Inline::saturateInt32(bytes.size())));
-        int compressedSize =
-            LZ4_compress_fast(reinterpret_cast<const char *>(bytes.data()), reinterpret_cast<char *>(compressed.data()),
-                Inline::saturateInt32(bytes.size()), Inline::saturateInt32(compressed.capacity()), 1);
-        if (compressedSize > 0) {
-            bytes.clear();
-            const nanoem_u16_t type = nanoem_u16_t(command->type_case);
-            MemoryWriter memoryWriter(&bytes);
-            FileUtils::writeTyped(&memoryWriter, sequence, error);
-            FileUtils::writeTyped(&memoryWriter, type, error);
-            FileUtils::writeTyped(&memoryWriter, compressedSize, error);
-            FileUtils::write(&memoryWriter, compressed.data(), compressedSize, error);
-            FileUtils::write(writer, bytes, error);
-        }
-        else {
-            const nanoem_u16_t type = 0;
-            const nanoem_u32_t size = 0;
-            FileUtils::writeTyped(writer, sequence, error);
-            FileUtils::writeTyped(writer, type, error);
-            FileUtils::writeTyped(writer, size, error);
-        }
-        saved = !error.hasReason();
-    }
-    return saved;
+    ByteArray bytes, buffer;
+    bytes.resize(nanoem__application__command__get_packed_size(command));
+    nanoem__application__command__pack(command, bytes.data());
+    writeRecord(writer, sequence, nanoem_u16_t(command->type_case), bytes, true, buffer, error);
+    return !error.hasReason();
 }
 
 bool
@@ -224,31 +243,49 @@ Redo::isAccepted(nanoem_u32_t value) NANOEM_DECL_NOEXCEPT
     }
 }
 
+bool
+Redo::isAcceptedFileMagic(nanoem_u32_t value) NANOEM_DECL_NOEXCEPT
+{
+    return value == kFileMagic || value == kLegacyFileMagic;
+}
+
+nanoem_u32_t
+Redo::uncompressedRecordFlag(nanoem_u32_t fileMagic) NANOEM_DECL_NOEXCEPT
+{
+    return fileMagic == kFileMagic ? kUncompressedRecordFlag : 0;
+}
+
 void
-Redo::getCountOffset(ISeekableReader *reader, nanoem_u32_t &count, nanoem_u32_t &offset, Error &error)
+Redo::getCountOffset(
+    ISeekableReader *reader, nanoem_u32_t rawRecordFlag, nanoem_u32_t &count, nanoem_u32_t &offset, Error &error)
 {
-    nanoem_u32_t deflatedCommandSize, sequence;
+    nanoem_u32_t recordSize, sequence;
     nanoem_u16_t commandType;
     while (FileUtils::readTyped(reader, sequence, error) == sizeof(sequence)) {
         FileUtils::readTyped(reader, commandType, error);
         if (commandType == NANOEM__APPLICATION__COMMAND__TYPE_SAVE_POINT) {
             offset = count;
         }
-        FileUtils::readTyped(reader, deflatedCommandSize, error);
-        reader->seek(deflatedCommandSize, ISeekable::kSeekTypeCurrent, error);
+        FileUtils::readTyped(reader, recordSize, error);
+        reader->seek(recordSize & ~rawRecordFlag, ISeekable::kSeekTypeCurrent, error);
         count++;
     }
     reader->seek(4, ISeekable::kSeekTypeBegin, error);
 }
 
 void
-Redo::inflateChunk(const ByteArray &input, ByteArray &output)
+Redo::inflateChunk(const ByteArray &input, bool raw, ByteArray &output)
 {
-    m_interm.reserve(input.size() * 100);
-    int decompressedSize =
-        LZ4_decompress_safe(reinterpret_cast<const char *>(input.data()), reinterpret_cast<char *>(m_interm.data()),
-            Inline::saturateInt32(input.size()), Inline::saturateInt32(m_interm.capacity()));
-    output.assign(m_interm.data(), m_interm.data() + decompressedSize);
+    if (raw) {
+        output = input;
+    }
+    else {
+        m_interm.reserve(input.size() * 100);
+        int decompressedSize =
+            LZ4_decompress_safe(reinterpret_cast<const char *>(input.data()), reinterpret_cast<char *>(m_interm.data()),
+                Inline::saturateInt32(input.size()), Inline::saturateInt32(m_interm.capacity()));
+        output.assign(m_interm.data(), m_interm.data() + decompressedSize);
+    }
 }
 
 void
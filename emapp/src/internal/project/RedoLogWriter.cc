@@ -0,0 +1,250 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+*/
+
+#include "emapp/internal/project/RedoLogWriter.h"
+
+#include "../../protoc/application.pb-c.h"
+#include "emapp/FileUtils.h"
+#include "emapp/internal/project/Redo.h"
+#include "emapp/private/CommonInclude.h"
+
+#include "bx/cpu.h"
+#include "bx/timer.h"
+
+namespace nanoem {
+namespace internal {
+namespace project {
+namespace {
+
+BX_STATIC_ASSERT((RedoLogWriter::kMaxNumRecords & (RedoLogWriter::kMaxNumRecords - 1)) == 0);
+
+/* buffers of large records like motion snapshots are released instead of being kept in the queue */
+static const nanoem_rsize_t kMaxRetainedRecordSize = 0x10000;
+
+} /* namespace anonymous */
+
+const nanoem_u32_t RedoLogWriter::kDefaultSyncInterval = 1000;
+
+RedoLogWriter::RedoLogWriter()
+    : m_writer(nullptr)
+    , m_head(0)
+    , m_tail(0)
+    , m_synced(0)
+    , m_flushRequested(0)
+    , m_producerWaiting(0)
+    , m_syncInterval(kDefaultSyncInterval)
+    , m_compressionEnabled(true)
+    , m_running(false)
+{
+    for (nanoem_u32_t i = 0; i < kMaxNumRecords; i++) {
+        Record &record = m_records[i];
+        record.m_sequence = 0;
+        record.m_type = 0;
+    }
+}
+
+RedoLogWriter::~RedoLogWriter() NANOEM_DECL_NOEXCEPT
+{
+    Error error;
+    close(error);
+}
+
+bool
+RedoLogWriter::open(const URI &fileURI, Error &error)
+{
+    nanoem_assert(!isOpened(), "must not be opened");
+    IFileWriter *writer = FileUtils::createFileWriter();
+    if (writer->open(fileURI, true, error)) {
+        m_writer = writer;
+        m_head = m_tail = m_synced = m_flushRequested = 0;
+        m_running = true;
+        m_thread.init(execute, this, 0, "RedoLogWriter");
+    }
+    else {
+        FileUtils::destroyFileWriter(writer);
+    }
+    return isOpened();
+}
+
+void
+RedoLogWriter::enqueue(nanoem_u32_t sequence, const Nanoem__Application__Command *command)
+{
+    if (isOpened()) {
+        const nanoem_u32_t head = m_head;
+        /* the producer is blocked while the queue is full so no record is dropped */
+        waitFor(m_tail, head - kMaxNumRecords + 1);
+        Record &record = m_records[head & (kMaxNumRecords - 1)];
+        record.m_bytes.resize(nanoem__application__command__get_packed_size(command));
+        nanoem__application__command__pack(command, record.m_bytes.data());
+        record.m_sequence = sequence;
+        record.m_type = nanoem_u16_t(command->type_case);
+        bx::memoryBarrier();
+        m_head = head + 1;
+        m_wakeup.post();
+    }
+}
+
+void
+RedoLogWriter::flush()
+{
+    if (isOpened()) {
+        const nanoem_u32_t head = m_head;
+        m_flushRequested = head;
+        bx::memoryBarrier();
+        m_wakeup.post();
+        waitFor(m_synced, head);
+    }
+}
+
+void
+RedoLogWriter::close(Error &error)
+{
+    if (isOpened()) {
+        /* remaining records are written and synced by the writer thread before it exits */
+        m_running = false;
+        bx::memoryBarrier();
+        m_wakeup.post();
+        if (m_thread.isRunning()) {
+            m_thread.shutdown();
+        }
+        m_writer->close(error);
+        FileUtils::destroyFileWriter(m_writer);
+        m_writer = nullptr;
+        if (m_error.hasReason() && !error.hasReason()) {
+            error = m_error;
+        }
+        m_error = Error();
+    }
+}
+
+bool
+RedoLogWriter::isOpened() const NANOEM_DECL_NOEXCEPT
+{
+    return m_writer != nullptr;
+}
+
+nanoem_u32_t
+RedoLogWriter::syncInterval() const NANOEM_DECL_NOEXCEPT
+{
+    return m_syncInterval;
+}
+
+void
+RedoLogWriter::setSyncInterval(nanoem_u32_t value)
+{
+    m_syncInterval = value;
+}
+
+bool
+RedoLogWriter::isCompressionEnabled() const NANOEM_DECL_NOEXCEPT
+{
+    return m_compressionEnabled;
+}
+
+void
+RedoLogWriter::setCompressionEnabled(bool value)
+{
+    m_compressionEnabled = value;
+}
+
+nanoem_i32_t
+RedoLogWriter::execute(bx::Thread * /* thread */, void *userData)
+{
+    RedoLogWriter *self = static_cast<RedoLogWriter *>(userData);
+    self->run();
+    return 0;
+}
+
+void
+RedoLogWriter::run()
+{
+    const nanoem_u64_t frequency = bx::getHPFrequency();
+    nanoem_u64_t lastSynced = bx::getHPCounter();
+    ByteArray buffer;
+    bool running = true;
+    while (running) {
+        const nanoem_u32_t interval = m_syncInterval;
+        /* records are synced on each wakeup with zero interval so no timeout is needed */
+        m_wakeup.wait(interval > 0 ? nanoem_i32_t(interval) : -1);
+        running = m_running;
+        bx::memoryBarrier();
+        writeAllRecords(buffer);
+        const nanoem_u32_t tail = m_tail, synced = m_synced;
+        const nanoem_u64_t now = bx::getHPCounter();
+        const bool expired = (now - lastSynced) * 1000 >= nanoem_u64_t(interval) * frequency,
+                   requested = nanoem_i32_t(m_flushRequested - synced) > 0;
+        if (synced != tail && (expired || requested || !running)) {
+            Error error;
+            if (!m_writer->flush(error) && !m_error.hasReason()) {
+                m_error = error;
+            }
+            lastSynced = now;
+            bx::memoryBarrier();
+            m_synced = tail;
+            notifyProducer();
+        }
+        else if (requested) {
+            m_synced = tail;
+            notifyProducer();
+        }
+    }
+}
+
+void
+RedoLogWriter::writeAllRecords(ByteArray &buffer)
+{
+    const nanoem_u32_t head = m_head;
+    const bool compressionEnabled = m_compressionEnabled;
+    bx::memoryBarrier();
+    for (nanoem_u32_t tail = m_tail; tail != head; tail++) {
+        Record &record = m_records[tail & (kMaxNumRecords - 1)];
+        Error error;
+        Redo::writeRecord(
+            m_writer, record.m_sequence, record.m_type, record.m_bytes, compressionEnabled, buffer, error);
+        if (error.hasReason() && !m_error.hasReason()) {
+            m_error = error;
+        }
+        if (record.m_bytes.capacity() > kMaxRetainedRecordSize) {
+            record.m_bytes.clear();
+            record.m_bytes.shrink_to_fit();
+        }
+        bx::memoryBarrier();
+        m_tail = tail + 1;
+        notifyProducer();
+    }
+    if (buffer.capacity() > kMaxRetainedRecordSize) {
+        buffer.clear();
+        buffer.shrink_to_fit();
+    }
+}
+
+void
+RedoLogWriter::waitFor(const volatile nanoem_u32_t &counter, nanoem_u32_t value)
+{
+    while (nanoem_i32_t(counter - value) < 0) {
+        m_producerWaiting = 1;
+        bx::memoryBarrier();
+        if (nanoem_i32_t(counter - value) < 0) {
+            m_drained.wait();
+        }
+        /* the writer thread may have posted already after the counter is checked so it must be consumed */
+        else if (bx::atomicCompareAndSwap<nanoem_u32_t>(&m_producerWaiting, 1, 0) != 1) {
+            m_drained.wait();
+        }
+    }
+}
+
+void
+RedoLogWriter::notifyProducer()
+{
+    if (bx::atomicCompareAndSwap<nanoem_u32_t>(&m_producerWaiting, 1, 0) == 1) {
+        m_drained.post();
+    }
+}
+
+} /* namespace project */
+} /* namespace internal */
+} /* namespace nanoem */
@@ -161,9 +161,10 @@ Bone::synchronizeMotion(const Motion *motion, const nanoem_model_bone_t *bone,
 {
     nanoem_parameter_assert(bone, "must not be nullptr");
     FrameTransform t0(FrameTransform::kInitialFrameTransform), t1(FrameTransform::kInitialFrameTransform);
-    synchronizeTransform(motion, bone, rigidBodyPtr, frameIndex, t0);
+    const nanoem_motion_track_handle_t handle = resolveMotionTrackHandle(motion, bone);
+    synchronizeTransform(motion, bone, rigidBodyPtr, handle, &m_motionTrackCursor, frameIndex, t0);
     if (amount > 0) {
-        synchronizeTransform(motion, bone, nullptr, frameIndex + 1, t1);
+        synchronizeTransform(motion, bone, nullptr, handle, &m_motionTrackCursor, frameIndex + 1, t1);
         setLocalUserTranslation(glm::mix(t0.m_translation, t1.m_translation, amount));
         setLocalUserOrientation(glm::slerp(t0.m_orientation, t1.m_orientation, amount));
         for (size_t i = 0; i < BX_COUNTOF(m_bezierControlPoints); i++) {
@@ -366,6 +367,53 @@ Bone::updateSkinningTransform(const nanoem_model_bone_t *bone, const bx::float4x
     shrink3x3(&m_matrices.m_worldTransform, &m_matrices.m_normalTransform);
 }
 
+void
+Bone::savePose(Pose &pose) const NANOEM_DECL_NOEXCEPT
+{
+    memcpy(glm::value_ptr(pose.m_worldTransform), &m_matrices.m_worldTransform, sizeof(pose.m_worldTransform));
+    memcpy(glm::value_ptr(pose.m_localTransform), &m_matrices.m_localTransform, sizeof(pose.m_localTransform));
+    pose.m_localOrientation = m_localOrientation;
+    pose.m_localInherentOrientation = m_localInherentOrientation;
+    pose.m_localMorphOrientation = m_localMorphOrientation;
+    pose.m_localUserOrientation = m_localUserOrientation;
+    pose.m_constraintJointOrientation = m_constraintJointOrientation;
+    pose.m_localTranslation = m_localTranslation;
+    pose.m_localInherentTranslation = m_localInherentTranslation;
+    pose.m_localMorphTranslation = m_localMorphTranslation;
+    pose.m_localUserTranslation = m_localUserTranslation;
+    for (size_t i = 0; i < BX_COUNTOF(m_bezierControlPoints); i++) {
+        nanoem_motion_bone_keyframe_interpolation_type_t type =
+            static_cast<nanoem_motion_bone_keyframe_interpolation_type_t>(i);
+        pose.m_bezierControlPoints[i] = m_bezierControlPoints[i];
+        pose.m_enableLinearInterpolation[i] = isLinearInterpolation(type);
+    }
+}
+
+void
+Bone::restorePose(const nanoem_model_bone_t *bone, const Pose &pose) NANOEM_DECL_NOEXCEPT
+{
+    nanoem_parameter_assert(bone, "must not be nullptr");
+    memcpy(&m_matrices.m_worldTransform, glm::value_ptr(pose.m_worldTransform), sizeof(m_matrices.m_worldTransform));
+    memcpy(&m_matrices.m_localTransform, glm::value_ptr(pose.m_localTransform), sizeof(m_matrices.m_localTransform));
+    translate(-origin(bone), &m_matrices.m_worldTransform, &m_matrices.m_skinningTransform);
+    shrink3x3(&m_matrices.m_worldTransform, &m_matrices.m_normalTransform);
+    m_localOrientation = pose.m_localOrientation;
+    m_localInherentOrientation = pose.m_localInherentOrientation;
+    m_localMorphOrientation = pose.m_localMorphOrientation;
+    m_localUserOrientation = pose.m_localUserOrientation;
+    m_constraintJointOrientation = pose.m_constraintJointOrientation;
+    m_localTranslation = pose.m_localTranslation;
+    m_localInherentTranslation = pose.m_localInherentTranslation;
+    m_localMorphTranslation = pose.m_localMorphTranslation;
+    m_localUserTranslation = pose.m_localUserTranslation;
+    for (size_t i = 0; i < BX_COUNTOF(m_bezierControlPoints); i++) {
+        nanoem_motion_bone_keyframe_interpolation_type_t type =
+            static_cast<nanoem_motion_bone_keyframe_interpolation_type_t>(i);
+        m_bezierControlPoints[i] = pose.m_bezierControlPoints[i];
+        setLinearInterpolation(type, pose.m_enableLinearInterpolation[i]);
+    }
+}
+
 String
 Bone::name() const
 {
@@ -772,11 +820,11 @@ Bone::destroy(void *opaque, nanoem_model_object_t * /* object */) NANOEM_DECL_NO
 
 void
 Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone,
-    const nanoem_model_rigid_body_t *rigidBodyPtr, nanoem_frame_index_t frameIndex, FrameTransform &transform)
+    const nanoem_model_rigid_body_t *rigidBodyPtr, nanoem_motion_track_handle_t handle, nanoem_rsize_t *cursor,
+    nanoem_frame_index_t frameIndex, FrameTransform &transform)
 {
     nanoem_parameter_assert(bone, "must not be nullptr");
-    const nanoem_unicode_string_t *name = nanoemModelBoneGetName(bone, NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
-    if (const nanoem_motion_bone_keyframe_t *keyframe = motion->findBoneKeyframe(name, frameIndex)) {
+    if (const nanoem_motion_bone_keyframe_t *keyframe = motion->findBoneKeyframe(handle, frameIndex)) {
         transform.m_translation = toVector3(keyframe);
         transform.m_orientation = toQuaternion(keyframe);
         for (int i = NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
@@ -791,13 +839,23 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
     }
     else {
         nanoem_motion_bone_keyframe_t *prevKeyframe, *nextKeyframe;
-        nanoemMotionSearchClosestBoneKeyframes(motion->data(), name, frameIndex, &prevKeyframe, &nextKeyframe);
+        nanoemMotionSearchClosestBoneKeyframesByHandleWithCursor(
+            motion->data(), handle, frameIndex, cursor, &prevKeyframe, &nextKeyframe);
         if (prevKeyframe && nextKeyframe) {
             const nanoem_motion_bone_keyframe_t *interpolateKeyframe = nextKeyframe;
             const Vector3 translation0(toVector3(prevKeyframe)), translation1(toVector3(nextKeyframe));
             const nanoem_f32_t coef = Motion::coefficient(prevKeyframe, nextKeyframe, frameIndex);
             const bool prevEnabled = nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(prevKeyframe),
                        nextEnabled = nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(nextKeyframe);
+            bool enableBezierCurves = false;
+            for (int i = NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM;
+                 i < NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
+                enableBezierCurves |= !nanoemMotionBoneKeyframeIsLinearInterpolation(
+                    interpolateKeyframe, nanoem_motion_bone_keyframe_interpolation_type_t(i));
+            }
+            /* solves all of four interpolation curves at once */
+            const Vector4 curves(
+                enableBezierCurves ? Motion::bezierCurves(interpolateKeyframe, coef) : Vector4(coef));
             if (prevEnabled && !nextEnabled && rigidBodyPtr) {
                 transform.m_translation = glm::mix(cast(bone)->localUserTranslation(), translation1, coef);
             }
@@ -819,8 +877,7 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
                         transform.m_translation[i] = glm::mix(v0, v1, coef);
                     }
                     else if (motion) {
-                        nanoem_f32_t t2 = motion->bezierCurve(prevKeyframe, nextKeyframe, type, coef);
-                        transform.m_translation[i] = glm::mix(v0, v1, t2);
+                        transform.m_translation[i] = glm::mix(v0, v1, curves[i]);
                         transform.m_bezierControlPoints[i] =
                             glm::make_vec4(nanoemMotionBoneKeyframeGetInterpolation(interpolateKeyframe, type));
                         transform.m_enableLinearInterpolation[i] = false;
@@ -836,9 +893,8 @@ Bone::synchronizeTransform(const Motion *motion, const nanoem_model_bone_t *bone
                 transform.m_orientation = glm::slerp(orientation0, orientation1, coef);
             }
             else if (motion) {
-                nanoem_f32_t t2 = motion->bezierCurve(
-                    prevKeyframe, nextKeyframe, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION, coef);
-                transform.m_orientation = glm::slerp(orientation0, orientation1, t2);
+                transform.m_orientation = glm::slerp(
+                    orientation0, orientation1, curves[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION]);
                 transform.m_bezierControlPoints[NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION] =
                     glm::make_vec4(nanoemMotionBoneKeyframeGetInterpolation(
                         interpolateKeyframe, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION));
@@ -863,17 +919,6 @@ Bone::createConstraintUnitAxes(const Vector3 &radians, const Vector3 &lowerLimit
     z = glm::angleAxis(r.z, Constants::kUnitZ);
 }
 
-void
-Bone::constrainOrientation(const nanoem_model_constraint_joint_t *joint, Quaternion &orientation) NANOEM_DECL_NOEXCEPT
-{
-    nanoem_parameter_assert(joint, "must not be nullptr");
-    if (nanoemModelConstraintJointHasAngleLimit(joint)) {
-        const Vector3 upperLimit(glm::make_vec3(nanoemModelConstraintJointGetUpperLimit(joint)));
-        const Vector3 lowerLimit(glm::make_vec3(nanoemModelConstraintJointGetLowerLimit(joint)));
-        constrainOrientation(upperLimit, lowerLimit, orientation);
-    }
-}
-
 Vector3
 Bone::toVector3(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT
 {
@@ -886,58 +931,60 @@ Bone::toQuaternion(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT
     return glm::make_quat(glm::value_ptr(glm::make_vec4(value) * Constants::kOrientateDirection));
 }
 
+nanoem_motion_track_handle_t
+Bone::resolveMotionTrackHandle(const Motion *motion, const nanoem_model_bone_t *bone)
+{
+    /* tracks are only appended so the handle is resolved again after the motion gets new track or is recreated */
+    const nanoem_unicode_string_t *name = nanoemModelBoneGetName(bone, NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
+    const nanoem_u64_t revision = motion ? motion->trackRevision() : 0;
+    if (m_boundMotion != motion || m_boundName != name || m_boundMotionRevision != revision) {
+        m_motionTrackHandle = motion ? nanoemMotionResolveBoneTrackHandle(motion->data(), name) : 0;
+        m_motionTrackCursor = 0;
+        m_boundMotion = motion;
+        m_boundName = name;
+        m_boundMotionRevision = revision;
+    }
+    return m_motionTrackHandle;
+}
+
 void
 Bone::solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIterations)
 {
     nanoem_parameter_assert(constraintPtr, "must not be nullptr");
-    nanoem_rsize_t numJoints;
-    nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
     const nanoem_model_bone_t *targetBonePtr = nanoemModelConstraintGetTargetBoneObject(constraintPtr);
     const nanoem_model_bone_t *effectorBonePtr = nanoemModelConstraintGetEffectorBoneObject(constraintPtr);
-    const nanoem_f32_t angleLimit = nanoemModelConstraintGetAngleLimit(constraintPtr);
     const Bone *targetBone = Bone::cast(targetBonePtr);
     Bone *effectorBone = Bone::cast(effectorBonePtr);
     Constraint *constraintUserData = Constraint::cast(constraintPtr);
     if (!targetBone || !effectorBone || !constraintUserData) {
         return;
     }
+    const Constraint::CompiledJointList &joints = constraintUserData->compiledJoints();
+    const nanoem_rsize_t numJoints = joints.size();
+    numIterations = glm::min(numIterations, Inline::saturateInt32(constraintUserData->numIterations()));
     const Vector4 targetBonePosition(targetBone->worldTransformOrigin(), 1);
     for (int i = 0; i < numIterations; i++) {
         const bool firstIteration = i == 0;
         for (nanoem_rsize_t j = 0; j < numJoints; j++) {
-            const nanoem_model_constraint_joint_t *joint = joints[j];
-            Bone *jointBone = Bone::cast(nanoemModelConstraintJointGetBoneObject(joint));
-            Constraint::Joint *jointResult = constraintUserData->jointIterationResult(joint, i);
+            const Constraint::CompiledJoint &joint = joints[j];
+            Bone *jointBone = Bone::cast(joint.m_bonePtr);
+            Constraint::Joint *jointResult = constraintUserData->jointIterationResult(j, i);
             const Vector4 effectorBonePosition(effectorBone->worldTransformOrigin(), 1);
             if (jointBone &&
                 !Constraint::solveAxisAngle(
                     jointBone->worldTransform(), effectorBonePosition, targetBonePosition, jointResult)) {
-                const nanoem_model_bone_t *bone = nanoemModelConstraintJointGetBoneObject(joint);
+                const nanoem_model_bone_t *bone = joint.m_bonePtr;
                 if (nanoemModelBoneHasFixedAxis(bone)) {
                     const Vector3 axis(glm::make_vec3(nanoemModelBoneGetFixedAxis(bone)));
                     if (!glm::isNull(axis, Constants::kEpsilon)) {
                         jointResult->setAxis(glm::normalize(axis));
                     }
                 }
-                else if (firstIteration && nanoemModelConstraintJointHasAngleLimit(joint)) {
-                    static const Vector3 kEpsilon(Constants::kEpsilonVec3);
-                    const glm::bvec3 hasUpperLimit(glm::lessThanEqual(
-                        glm::abs(glm::make_vec3(nanoemModelConstraintJointGetUpperLimit(joint))), kEpsilon));
-                    const glm::bvec3 hasLowerLimit(glm::lessThanEqual(
-                        glm::abs(glm::make_vec3(nanoemModelConstraintJointGetLowerLimit(joint))), kEpsilon));
-                    if (hasLowerLimit.y && hasUpperLimit.y && hasLowerLimit.z && hasUpperLimit.z) {
-                        jointResult->setAxis(Constants::kUnitX);
-                    }
-                    else if (hasLowerLimit.x && hasUpperLimit.x && hasLowerLimit.z && hasUpperLimit.z) {
-                        jointResult->setAxis(Constants::kUnitY);
-                    }
-                    else if (hasLowerLimit.x && hasUpperLimit.x && hasLowerLimit.y && hasUpperLimit.y) {
-                        jointResult->setAxis(Constants::kUnitZ);
-                    }
+                else if (firstIteration && joint.m_hasLimitedAxis) {
+                    jointResult->setAxis(joint.m_limitedAxis);
                 }
-                nanoem_f32_t newAngleLimit = angleLimit * (j + 1);
                 const Quaternion orientation(
-                    glm::angleAxis(glm::min(jointResult->m_angle, newAngleLimit), jointResult->m_axis));
+                    glm::angleAxis(glm::min(jointResult->m_angle, joint.m_angleLimit), jointResult->m_axis));
                 Quaternion mixedOrientation;
                 if (firstIteration) {
                     mixedOrientation = orientation * jointBone->localUserOrientation();
@@ -945,18 +992,19 @@ Bone::solveConstraint(const nanoem_model_constraint_t *constraintPtr, int numIte
                 else {
                     mixedOrientation = jointBone->constraintJointOrientation() * orientation;
                 }
-                constrainOrientation(joint, mixedOrientation);
+                if (joint.m_hasAngleLimit) {
+                    constrainOrientation(joint.m_upperLimit, joint.m_lowerLimit, mixedOrientation);
+                }
                 jointBone->setConstraintJointOrientation(glm::normalize(mixedOrientation));
                 for (int k = Inline::saturateInt32(j); k >= 0; k--) {
-                    const nanoem_model_constraint_joint_t *upperJoint = joints[k];
-                    const nanoem_model_bone_t *upperJointBonePtr = nanoemModelConstraintJointGetBoneObject(upperJoint);
+                    const nanoem_model_bone_t *upperJointBonePtr = joints[k].m_bonePtr;
                     Bone *upperJointBone = Bone::cast(upperJointBonePtr);
                     upperJointBone->updateLocalTransform(upperJointBonePtr, upperJointBone->localTranslation(),
                         upperJointBone->constraintJointOrientation());
                 }
                 jointResult->setTransform(jointBone->worldTransform());
                 effectorBone->updateLocalTransform(effectorBonePtr);
-                Constraint::Joint *effectorResult = constraintUserData->effectorIterationResult(joint, i);
+                Constraint::Joint *effectorResult = constraintUserData->effectorIterationResult(j, i);
                 effectorResult->setTransform(effectorBone->worldTransform());
             }
         }
@@ -995,6 +1043,11 @@ Bone::Bone(const PlaceHolder & /* holder */) NANOEM_DECL_NOEXCEPT : m_localOrien
                                                                     m_localInherentTranslation(Constants::kZeroV3),
                                                                     m_localMorphTranslation(Constants::kZeroV3),
                                                                     m_localUserTranslation(Constants::kZeroV3),
+                                                                    m_boundMotion(nullptr),
+                                                                    m_boundName(nullptr),
+                                                                    m_boundMotionRevision(0),
+                                                                    m_motionTrackHandle(0),
+                                                                    m_motionTrackCursor(0),
                                                                     m_states(kPrivateStateInitialValue)
 {
     Inline::clearZeroMemory(m_bezierControlPoints);
@@ -0,0 +1,193 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/model/BoneTransformSchedule.h"
+
+#include "emapp/Model.h"
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace model {
+namespace {
+
+static const nanoem_u32_t kUnscheduled = ~0u;
+
+static nanoem_rsize_t
+boneIndex(const nanoem_model_bone_t *bonePtr) NANOEM_DECL_NOEXCEPT
+{
+    return nanoem_rsize_t(nanoemModelObjectGetIndex(nanoemModelBoneGetModelObject(bonePtr)));
+}
+
+} /* namespace anonymous */
+
+BoneTransformSchedule::BoneTransformSchedule()
+    : m_valid(false)
+{
+}
+
+BoneTransformSchedule::~BoneTransformSchedule() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+BoneTransformSchedule::build(const Model *model)
+{
+    clear();
+    for (int i = PhysicsEngine::kSimulationTimingFirstEnum; i < PhysicsEngine::kSimulationTimingMaxEnum; i++) {
+        buildPlan(model, static_cast<PhysicsEngine::SimulationTimingType>(i));
+    }
+    m_valid = true;
+}
+
+void
+BoneTransformSchedule::clear()
+{
+    for (int i = PhysicsEngine::kSimulationTimingFirstEnum; i < PhysicsEngine::kSimulationTimingMaxEnum; i++) {
+        Plan &plan = m_plans[i];
+        plan.m_bones.clear();
+        plan.m_levels.clear();
+    }
+    m_valid = false;
+}
+
+void
+BoneTransformSchedule::invalidate() NANOEM_DECL_NOEXCEPT
+{
+    m_valid = false;
+}
+
+bool
+BoneTransformSchedule::isValid() const NANOEM_DECL_NOEXCEPT
+{
+    return m_valid;
+}
+
+nanoem_rsize_t
+BoneTransformSchedule::numLevels(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT
+{
+    return m_plans[timing].m_levels.size();
+}
+
+const BoneTransformSchedule::Level &
+BoneTransformSchedule::level(PhysicsEngine::SimulationTimingType timing, nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
+{
+    return m_plans[timing].m_levels[index];
+}
+
+nanoem_rsize_t
+BoneTransformSchedule::numBones(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT
+{
+    return m_plans[timing].m_bones.size();
+}
+
+const nanoem_model_bone_t *const *
+BoneTransformSchedule::allBones(PhysicsEngine::SimulationTimingType timing) const NANOEM_DECL_NOEXCEPT
+{
+    return m_plans[timing].m_bones.data();
+}
+
+void
+BoneTransformSchedule::buildPlan(const Model *model, PhysicsEngine::SimulationTimingType timing)
+{
+    typedef tinystl::vector<nanoem_u32_t, TinySTLAllocator> IndexList;
+    nanoem_rsize_t numOrderedBones, numAllBones;
+    nanoem_model_bone_t *const *orderedBones = nanoemModelGetAllOrderedBoneObjects(model->data(), &numOrderedBones);
+    nanoemModelGetAllBoneObjects(model->data(), &numAllBones);
+    BoneList bones;
+    for (nanoem_rsize_t i = 0; i < numOrderedBones; i++) {
+        const nanoem_model_bone_t *bonePtr = orderedBones[i];
+        if ((nanoemModelBoneIsAffectedByPhysicsSimulation(bonePtr) != 0) == timing) {
+            bones.push_back(bonePtr);
+        }
+    }
+    const nanoem_rsize_t numBones = bones.size();
+    /* positions and levels are looked up by the bone index so the bones outside of this pass are unscheduled */
+    IndexList positions(numAllBones, kUnscheduled), levels(numBones, 0), minimumLevels(numAllBones, 0);
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        const nanoem_rsize_t index = boneIndex(bones[i]);
+        if (index < numAllBones) {
+            positions[index] = nanoem_u32_t(i);
+        }
+    }
+    nanoem_u32_t segmentOffset = 0, segmentLevel = 0, maxLevel = 0;
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        const nanoem_model_bone_t *bonePtr = bones[i];
+        const nanoem_rsize_t index = boneIndex(bonePtr);
+        if (nanoemModelBoneGetConstraintObject(bonePtr)) {
+            /*
+             * solving a constraint writes transforms of the joint and the effector bones, so it runs alone after
+             * all preceding bones and all following bones wait for it as the serial pass does
+             */
+            const nanoem_u32_t barrierLevel = i > segmentOffset ? maxLevel + 1 : segmentLevel;
+            levels[i] = barrierLevel;
+            maxLevel = barrierLevel;
+            segmentLevel = barrierLevel + 1;
+            segmentOffset = nanoem_u32_t(i + 1);
+            continue;
+        }
+        const nanoem_model_bone_t *dependencies[2] = { nanoemModelBoneGetParentBoneObject(bonePtr), nullptr };
+        if (nanoemModelBoneHasInherentOrientation(bonePtr) || nanoemModelBoneHasInherentTranslation(bonePtr)) {
+            dependencies[1] = nanoemModelBoneGetInherentParentBoneObject(bonePtr);
+        }
+        nanoem_u32_t value = segmentLevel;
+        if (index < numAllBones) {
+            value = glm::max(value, minimumLevels[index]);
+        }
+        for (nanoem_rsize_t j = 0; j < BX_COUNTOF(dependencies); j++) {
+            const nanoem_model_bone_t *dependencyPtr = dependencies[j];
+            const nanoem_rsize_t dependencyIndex = dependencyPtr ? boneIndex(dependencyPtr) : numAllBones;
+            if (dependencyIndex < numAllBones) {
+                const nanoem_u32_t position = positions[dependencyIndex];
+                if (position != kUnscheduled && position >= segmentOffset && position < i) {
+                    value = glm::max(value, levels[position] + 1);
+                }
+            }
+        }
+        for (nanoem_rsize_t j = 0; j < BX_COUNTOF(dependencies); j++) {
+            const nanoem_model_bone_t *dependencyPtr = dependencies[j];
+            const nanoem_rsize_t dependencyIndex = dependencyPtr ? boneIndex(dependencyPtr) : numAllBones;
+            if (dependencyIndex < numAllBones) {
+                /* a dependency later in transform order must keep its previous value until this bone is read */
+                const nanoem_u32_t position = positions[dependencyIndex];
+                if (position != kUnscheduled && position > i) {
+                    minimumLevels[dependencyIndex] = glm::max(minimumLevels[dependencyIndex], value + 1);
+                }
+            }
+        }
+        levels[i] = value;
+        maxLevel = glm::max(maxLevel, value);
+    }
+    Plan &plan = m_plans[timing];
+    if (numBones > 0) {
+        /* counting sort keeps transform order in each level */
+        IndexList offsets(maxLevel + 2, 0);
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            offsets[levels[i] + 1]++;
+        }
+        for (nanoem_u32_t i = 0; i <= maxLevel; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+        plan.m_bones.resize(numBones);
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            plan.m_bones[offsets[levels[i]]++] = bones[i];
+        }
+        for (nanoem_u32_t i = 0, offset = 0; i <= maxLevel; i++) {
+            /* offsets are shifted to the end of each level after scattering */
+            const nanoem_u32_t count = offsets[i] - offset;
+            if (count > 0) {
+                Level level;
+                level.m_offset = offset;
+                level.m_numBones = count;
+                level.m_barrier = count == 1 && nanoemModelBoneGetConstraintObject(plan.m_bones[offset]) != nullptr;
+                plan.m_levels.push_back(level);
+            }
+            offset = offsets[i];
+        }
+    }
+}
+
+} /* namespace model */
+} /* namespace nanoem */
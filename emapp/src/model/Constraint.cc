@@ -21,6 +21,7 @@ namespace {
 
 enum PrivateStateFlags {
     kPrivateStateEnabled = 1 << 1,
+    kPrivateStateDirty = 1 << 2,
     kPrivateStateReserved = 1 << 31,
 };
 static const nanoem_u32_t kPrivateStateInitialValue = kPrivateStateEnabled;
@@ -43,8 +44,9 @@ Constraint::Joint::~Joint()
 
 Constraint::~Constraint() NANOEM_DECL_NOEXCEPT
 {
-    m_jointIterationResult.clear();
-    m_effectorIterationResult.clear();
+    m_compiledJoints.clear();
+    m_jointIterationResults.clear();
+    m_effectorIterationResults.clear();
 }
 
 int
@@ -161,41 +163,61 @@ Constraint::resetLanguage(const nanoem_model_constraint_t *constraintPtr, nanoem
 }
 
 void
-Constraint::initialize(const nanoem_model_constraint_t *constraintPtr)
+Constraint::initialize(const nanoem_model_constraint_t *constraintPtr, nanoem_unicode_string_factory_t *factory)
 {
     nanoem_parameter_assert(constraintPtr, "must not be nullptr");
+    m_opaque = constraintPtr;
+    m_factory = factory;
+    compile();
+}
+
+void
+Constraint::invalidate() NANOEM_DECL_NOEXCEPT
+{
+    EnumUtils::setEnabled(kPrivateStateDirty, m_states, true);
+}
+
+const Constraint::CompiledJointList &
+Constraint::compiledJoints()
+{
     nanoem_rsize_t numJoints;
-    nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
-    nanoem_rsize_t numIterations = nanoem_rsize_t(glm::max(nanoemModelConstraintGetNumIterations(constraintPtr), 0));
-    for (nanoem_rsize_t i = 0; i < numJoints; i++) {
-        nanoem_model_constraint_joint_t *joint = joints[i];
-        m_jointIterationResult[joint].reserve(numIterations);
-        m_effectorIterationResult[joint].reserve(numIterations);
+    nanoemModelConstraintGetAllJointObjects(m_opaque, &numJoints);
+    /* also catches joints or iterations changed without ScopedMutableConstraint */
+    if (EnumUtils::isEnabled(kPrivateStateDirty, m_states) || numJoints != m_compiledJoints.size() ||
+        nanoemModelConstraintGetNumIterations(m_opaque) != Inline::saturateInt32(m_numIterations)) {
+        compile();
     }
+    return m_compiledJoints;
 }
 
-const Constraint::JointIterationResult *
-Constraint::jointIterationResult() const NANOEM_DECL_NOEXCEPT
+nanoem_rsize_t
+Constraint::numIterations() const NANOEM_DECL_NOEXCEPT
 {
-    return &m_jointIterationResult;
+    return m_numIterations;
 }
 
-const Constraint::JointIterationResult *
-Constraint::effectorIterationResult() const NANOEM_DECL_NOEXCEPT
+const Constraint::Joint *
+Constraint::jointIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) const NANOEM_DECL_NOEXCEPT
 {
-    return &m_effectorIterationResult;
+    return &m_jointIterationResults[jointIndex * m_numIterations + iteration];
 }
 
 Constraint::Joint *
-Constraint::jointIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset)
+Constraint::jointIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) NANOEM_DECL_NOEXCEPT
 {
-    return &m_jointIterationResult[joint][offset];
+    return &m_jointIterationResults[jointIndex * m_numIterations + iteration];
+}
+
+const Constraint::Joint *
+Constraint::effectorIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) const NANOEM_DECL_NOEXCEPT
+{
+    return &m_effectorIterationResults[jointIndex * m_numIterations + iteration];
 }
 
 Constraint::Joint *
-Constraint::effectorIterationResult(const nanoem_model_constraint_joint_t *joint, nanoem_rsize_t offset)
+Constraint::effectorIterationResult(nanoem_rsize_t jointIndex, nanoem_rsize_t iteration) NANOEM_DECL_NOEXCEPT
 {
-    return &m_effectorIterationResult[joint][offset];
+    return &m_effectorIterationResults[jointIndex * m_numIterations + iteration];
 }
 
 String
@@ -234,6 +256,51 @@ Constraint::setEnabled(bool value)
     EnumUtils::setEnabled(kPrivateStateEnabled, m_states, value);
 }
 
+void
+Constraint::compile()
+{
+    static const Vector3 kEpsilon(Constants::kEpsilonVec3);
+    nanoem_rsize_t numJoints;
+    nanoem_model_constraint_joint_t *const *joints = nanoemModelConstraintGetAllJointObjects(m_opaque, &numJoints);
+    const nanoem_f32_t angleLimit = nanoemModelConstraintGetAngleLimit(m_opaque);
+    m_numIterations = nanoem_rsize_t(glm::max(nanoemModelConstraintGetNumIterations(m_opaque), 0));
+    m_compiledJoints.resize(numJoints);
+    for (nanoem_rsize_t i = 0; i < numJoints; i++) {
+        const nanoem_model_constraint_joint_t *joint = joints[i];
+        const nanoem_model_bone_t *bonePtr = nanoemModelConstraintJointGetBoneObject(joint);
+        CompiledJoint &compiled = m_compiledJoints[i];
+        compiled.m_joint = joint;
+        compiled.m_bonePtr = bonePtr;
+        compiled.m_upperLimit = glm::make_vec3(nanoemModelConstraintJointGetUpperLimit(joint));
+        compiled.m_lowerLimit = glm::make_vec3(nanoemModelConstraintJointGetLowerLimit(joint));
+        compiled.m_limitedAxis = Constants::kZeroV3;
+        compiled.m_angleLimit = angleLimit * (i + 1);
+        compiled.m_hasAngleLimit = nanoemModelConstraintJointHasAngleLimit(joint) != 0;
+        compiled.m_hasLimitedAxis = false;
+        compiled.m_hasUnitXConstraint = bonePtr && m_factory && hasUnitXConstraint(bonePtr, m_factory);
+        if (compiled.m_hasAngleLimit) {
+            /* the joint rotating around only one axis starts iterations with the axis */
+            const glm::bvec3 hasUpperLimit(glm::lessThanEqual(glm::abs(compiled.m_upperLimit), kEpsilon));
+            const glm::bvec3 hasLowerLimit(glm::lessThanEqual(glm::abs(compiled.m_lowerLimit), kEpsilon));
+            if (hasLowerLimit.y && hasUpperLimit.y && hasLowerLimit.z && hasUpperLimit.z) {
+                compiled.m_limitedAxis = Constants::kUnitX;
+                compiled.m_hasLimitedAxis = true;
+            }
+            else if (hasLowerLimit.x && hasUpperLimit.x && hasLowerLimit.z && hasUpperLimit.z) {
+                compiled.m_limitedAxis = Constants::kUnitY;
+                compiled.m_hasLimitedAxis = true;
+            }
+            else if (hasLowerLimit.x && hasUpperLimit.x && hasLowerLimit.y && hasUpperLimit.y) {
+                compiled.m_limitedAxis = Constants::kUnitZ;
+                compiled.m_hasLimitedAxis = true;
+            }
+        }
+    }
+    m_jointIterationResults.resize(numJoints * m_numIterations);
+    m_effectorIterationResults.resize(numJoints * m_numIterations);
+    EnumUtils::setEnabled(kPrivateStateDirty, m_states, false);
+}
+
 void
 Constraint::destroy(void *opaque, nanoem_model_object_t * /* constraintPtr */) NANOEM_DECL_NOEXCEPT
 {
@@ -242,7 +309,10 @@ Constraint::destroy(void *opaque, nanoem_model_object_t * /* constraintPtr */) N
     nanoem_delete(self);
 }
 
-Constraint::Constraint(const PlaceHolder & /* holder */) NANOEM_DECL_NOEXCEPT : m_states(kPrivateStateEnabled)
+Constraint::Constraint(const PlaceHolder & /* holder */) NANOEM_DECL_NOEXCEPT : m_opaque(nullptr),
+                                                                                  m_factory(nullptr),
+                                                                                  m_numIterations(0),
+                                                                                  m_states(kPrivateStateEnabled)
 {
 }
 
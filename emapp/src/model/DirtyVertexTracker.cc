@@ -0,0 +1,176 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/model/DirtyVertexTracker.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/Bone.h"
+#include "emapp/model/Vertex.h"
+#include "emapp/private/CommonInclude.h"
+
+namespace nanoem {
+namespace model {
+namespace {
+
+static const nanoem_u32_t kNumVertexBones = 4;
+static const nanoem_u32_t kInvalidBoneIndex = ~0u;
+
+} /* namespace anonymous */
+
+DirtyVertexTracker::DirtyVertexTracker()
+    : m_numDirtyVertices(0)
+    , m_lastEdgeSizeScaleFactor(0)
+    , m_invalidated(true)
+{
+}
+
+DirtyVertexTracker::~DirtyVertexTracker() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+DirtyVertexTracker::build(const Model *model)
+{
+    typedef tinystl::unordered_map<const Bone *, nanoem_u32_t, TinySTLAllocator> BoneIndexMap;
+    BoneIndexMap boneIndices;
+    nanoem_rsize_t numVertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    clear();
+    m_vertexBoneIndices.resize(numVertices * kNumVertexBones);
+    m_vertexFlags.resize(numVertices);
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        const Vertex *vertex = Vertex::cast(vertices[i]);
+        nanoem_u32_t *indices = &m_vertexBoneIndices[i * kNumVertexBones];
+        for (nanoem_u32_t j = 0; j < kNumVertexBones; j++) {
+            const Bone *bone = vertex ? vertex->bone(j) : nullptr;
+            if (!bone) {
+                indices[j] = kInvalidBoneIndex;
+                continue;
+            }
+            BoneIndexMap::const_iterator it = boneIndices.find(bone);
+            if (it != boneIndices.end()) {
+                indices[j] = it->second;
+            }
+            else {
+                const nanoem_u32_t boneIndex = nanoem_u32_t(m_bones.size());
+                boneIndices.insert(tinystl::make_pair(bone, boneIndex));
+                m_bones.push_back(bone);
+                indices[j] = boneIndex;
+            }
+        }
+    }
+    m_lastSkinningTransforms.resize(m_bones.size());
+    m_changedBoneFlags.resize(m_bones.size());
+    invalidate();
+}
+
+void
+DirtyVertexTracker::clear()
+{
+    m_bones.clear();
+    m_lastSkinningTransforms.clear();
+    m_changedBoneFlags.clear();
+    m_vertexBoneIndices.clear();
+    m_vertexFlags.clear();
+    m_ranges.clear();
+    m_numDirtyVertices = 0;
+    m_invalidated = true;
+}
+
+void
+DirtyVertexTracker::invalidate() NANOEM_DECL_NOEXCEPT
+{
+    /* the next update performs all vertices since the staging data might be written without tracking */
+    for (FlagList::iterator it = m_vertexFlags.begin(), end = m_vertexFlags.end(); it != end; ++it) {
+        *it |= kVertexFlagPendingAllBuffers;
+    }
+    m_invalidated = true;
+}
+
+void
+DirtyVertexTracker::update(
+    nanoem_model_vertex_t *const *vertices, nanoem_f32_t edgeSizeScaleFactor) NANOEM_DECL_NOEXCEPT
+{
+    const bool allDirty = m_invalidated || m_lastEdgeSizeScaleFactor != edgeSizeScaleFactor;
+    for (nanoem_rsize_t i = 0, numBones = m_bones.size(); i < numBones; i++) {
+        const bx::float4x4_t transform(m_bones[i]->skinningTransformMatrix());
+        bx::float4x4_t &lastTransform = m_lastSkinningTransforms[i];
+        const bool changed = allDirty || memcmp(&transform, &lastTransform, sizeof(transform)) != 0;
+        if (changed) {
+            lastTransform = transform;
+        }
+        m_changedBoneFlags[i] = changed ? 1 : 0;
+    }
+    const nanoem_u32_t *boneIndices = m_vertexBoneIndices.data();
+    const nanoem_u8_t *changedBoneFlags = m_changedBoneFlags.data();
+    nanoem_rsize_t numDirtyVertices = 0;
+    for (nanoem_rsize_t i = 0, numVertices = m_vertexFlags.size(); i < numVertices; i++) {
+        const nanoem_u32_t *indices = &boneIndices[i * kNumVertexBones];
+        const Vertex *vertex = Vertex::cast(vertices[i]);
+        const bool deformed = vertex && vertex->isDeformed();
+        nanoem_u8_t &flags = m_vertexFlags[i];
+        /* the vertex must be restored when the morph is no longer applied */
+        bool dirty = allDirty || deformed || (flags & kVertexFlagDeformed) != 0;
+        for (nanoem_u32_t j = 0; !dirty && j < kNumVertexBones; j++) {
+            const nanoem_u32_t boneIndex = indices[j];
+            dirty = boneIndex != kInvalidBoneIndex && changedBoneFlags[boneIndex] != 0;
+        }
+        flags = nanoem_u8_t(flags & ~(kVertexFlagDirty | kVertexFlagDeformed));
+        if (dirty) {
+            flags |= kVertexFlagDirty | kVertexFlagPendingAllBuffers;
+            numDirtyVertices++;
+        }
+        if (deformed) {
+            flags |= kVertexFlagDeformed;
+        }
+    }
+    m_numDirtyVertices = numDirtyVertices;
+    m_lastEdgeSizeScaleFactor = edgeSizeScaleFactor;
+    m_invalidated = false;
+}
+
+const DirtyVertexTracker::RangeList &
+DirtyVertexTracker::collectRanges(nanoem_u32_t bufferIndex)
+{
+    nanoem_parameter_assert(bufferIndex < kMaxNumStagingBuffers, "must be less than kMaxNumStagingBuffers");
+    const nanoem_u8_t pendingFlag = nanoem_u8_t(kVertexFlagPendingBuffer0 << bufferIndex);
+    m_ranges.clear();
+    for (nanoem_u32_t i = 0, numVertices = nanoem_u32_t(m_vertexFlags.size()); i < numVertices; i++) {
+        nanoem_u8_t &flags = m_vertexFlags[i];
+        if ((flags & pendingFlag) != 0) {
+            flags &= ~pendingFlag;
+            /* close ranges are merged to reduce the number of upload commands */
+            if (!m_ranges.empty() && m_ranges.back().second + kMaxRangeGap >= i) {
+                m_ranges.back().second = i + 1;
+            }
+            else {
+                m_ranges.push_back(tinystl::make_pair(i, i + 1));
+            }
+        }
+    }
+    return m_ranges;
+}
+
+bool
+DirtyVertexTracker::isDirty(nanoem_rsize_t vertexIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return (m_vertexFlags[vertexIndex] & kVertexFlagDirty) != 0;
+}
+
+nanoem_rsize_t
+DirtyVertexTracker::numVertices() const NANOEM_DECL_NOEXCEPT
+{
+    return m_vertexFlags.size();
+}
+
+nanoem_rsize_t
+DirtyVertexTracker::numDirtyVertices() const NANOEM_DECL_NOEXCEPT
+{
+    return m_numDirtyVertices;
+}
+
+} /* namespace model */
+} /* namespace nanoem */
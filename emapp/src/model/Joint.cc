@@ -110,9 +110,9 @@ Joint::bind(nanoem_model_joint_t *joint, PhysicsEngine *engine, const RigidBody:
             memcpy(opaque.transform_b, glm::value_ptr(Constants::kIdentity), sizeof(opaque.transform_b));
         }
     }
-    opaque.world = engine->worldOpaque();
-    m_physicsJoint = engine->createJoint(joint, &opaque, status);
-    m_physicsEngine = engine;
+    m_physicsEngine = engine->findIsland(nanoemModelObjectGetParentModel(nanoemModelJointGetModelObject(joint)));
+    opaque.world = m_physicsEngine->worldOpaque();
+    m_physicsJoint = m_physicsEngine->createJoint(joint, &opaque, status);
     enable();
 }
 
@@ -59,9 +59,10 @@ Morph::synchronizeMotion(
 {
     nanoem_parameter_assert(name, "must not be nullptr");
     nanoem_f32_t w0, w1;
-    synchronizeWeight(motion, frameIndex, name, w0);
+    const nanoem_motion_track_handle_t handle = resolveMotionTrackHandle(motion, name);
+    synchronizeWeight(motion, frameIndex, handle, &m_motionTrackCursor, w0);
     if (amount > 0) {
-        synchronizeWeight(motion, frameIndex + 1, name, w1);
+        synchronizeWeight(motion, frameIndex + 1, handle, &m_motionTrackCursor, w1);
         setWeight(glm::mix(w0, w1, amount));
     }
     else {
@@ -176,16 +177,16 @@ Morph::destroy(void *opaque, nanoem_model_object_t * /* morph */) NANOEM_DECL_NO
 }
 
 void
-Morph::synchronizeWeight(
-    const Motion *motion, nanoem_frame_index_t frameIndex, const nanoem_unicode_string_t *name, nanoem_f32_t &weight)
+Morph::synchronizeWeight(const Motion *motion, nanoem_frame_index_t frameIndex, nanoem_motion_track_handle_t handle,
+    nanoem_rsize_t *cursor, nanoem_f32_t &weight)
 {
-    nanoem_parameter_assert(name, "must not be nullptr");
-    if (const nanoem_motion_morph_keyframe_t *keyframe = motion->findMorphKeyframe(name, frameIndex)) {
+    if (const nanoem_motion_morph_keyframe_t *keyframe = motion->findMorphKeyframe(handle, frameIndex)) {
         weight = nanoemMotionMorphKeyframeGetWeight(keyframe);
     }
     else {
         nanoem_motion_morph_keyframe_t *prevKeyframe, *nextKeyframe;
-        nanoemMotionSearchClosestMorphKeyframes(motion->data(), name, frameIndex, &prevKeyframe, &nextKeyframe);
+        nanoemMotionSearchClosestMorphKeyframesByHandleWithCursor(
+            motion->data(), handle, frameIndex, cursor, &prevKeyframe, &nextKeyframe);
         if (prevKeyframe && nextKeyframe) {
             const nanoem_f32_t &coef = Motion::coefficient(prevKeyframe, nextKeyframe, frameIndex);
             weight = glm::mix(nanoemMotionMorphKeyframeGetWeight(prevKeyframe),
@@ -197,9 +198,29 @@ Morph::synchronizeWeight(
     }
 }
 
-Morph::Morph(const PlaceHolder & /* holder */) NANOEM_DECL_NOEXCEPT : m_weight(0), m_dirty(false)
+Morph::Morph(const PlaceHolder & /* holder */) NANOEM_DECL_NOEXCEPT : m_boundMotion(nullptr),
+                                                                      m_boundName(nullptr),
+                                                                      m_boundMotionRevision(0),
+                                                                      m_motionTrackHandle(0),
+                                                                      m_motionTrackCursor(0),
+                                                                      m_weight(0),
+                                                                      m_dirty(false)
 {
 }
 
+nanoem_motion_track_handle_t
+Morph::resolveMotionTrackHandle(const Motion *motion, const nanoem_unicode_string_t *name)
+{
+    const nanoem_u64_t revision = motion ? motion->trackRevision() : 0;
+    if (m_boundMotion != motion || m_boundName != name || m_boundMotionRevision != revision) {
+        m_motionTrackHandle = motion ? nanoemMotionResolveMorphTrackHandle(motion->data(), name) : 0;
+        m_motionTrackCursor = 0;
+        m_boundMotion = motion;
+        m_boundName = name;
+        m_boundMotionRevision = revision;
+    }
+    return m_motionTrackHandle;
+}
+
 } /* namespace model */
 } /* namespace nanoem */
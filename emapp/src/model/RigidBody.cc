@@ -47,12 +47,13 @@ RigidBody::bind(nanoem_model_rigid_body_t *rigidBodyPtr, PhysicsEngine *engine,
     nanoemUserDataSetOnDestroyModelObjectCallback(userData, &RigidBody::destroy);
     nanoemUserDataSetOpaqueData(userData, this);
     nanoemModelObjectSetUserData(nanoemModelRigidBodyGetModelObjectMutable(rigidBodyPtr), userData);
-    m_physicsRigidBody = engine->createRigidBody(rigidBodyPtr, status);
-    m_physicsEngine = engine;
+    m_physicsEngine = engine->findIsland(
+        nanoemModelObjectGetParentModel(nanoemModelRigidBodyGetModelObject(rigidBodyPtr)));
+    m_physicsRigidBody = m_physicsEngine->createRigidBody(rigidBodyPtr, status);
     const nanoem_model_rigid_body_t *bodyPtr = rigidBodyPtr;
     resolver.insert(tinystl::make_pair(bodyPtr, m_physicsRigidBody));
     if (isMorph) {
-        engine->disableDeactivation(m_physicsRigidBody);
+        m_physicsEngine->disableDeactivation(m_physicsRigidBody);
     }
     enable();
 }
@@ -0,0 +1,391 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "emapp/model/SkinningBatch.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/Bone.h"
+#include "emapp/model/Vertex.h"
+#include "emapp/private/CommonInclude.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+namespace nanoem {
+namespace model {
+namespace {
+
+static const nanoem_u32_t kPaletteEntryStride = 32;
+static const nanoem_u32_t kNormalTransformOffset = 16;
+
+#if defined(__AVX2__)
+struct Lane8 {
+    __m256 m_value;
+};
+struct Lane8Index {
+    __m256i m_value;
+};
+
+static BX_FORCE_INLINE Lane8
+lane8Zero() NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { _mm256_setzero_ps() };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Load(const bx::simd128_t *value) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { _mm256_loadu_ps(reinterpret_cast<const nanoem_f32_t *>(value)) };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Load(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { _mm256_loadu_ps(value) };
+    return v;
+}
+
+static BX_FORCE_INLINE void
+lane8Store(nanoem_f32_t *ptr, const Lane8 &value) NANOEM_DECL_NOEXCEPT
+{
+    _mm256_storeu_ps(ptr, value.m_value);
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Add(const Lane8 &a, const Lane8 &b) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { _mm256_add_ps(a.m_value, b.m_value) };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Madd(const Lane8 &a, const Lane8 &b, const Lane8 &c) NANOEM_DECL_NOEXCEPT
+{
+#if defined(__FMA__)
+    Lane8 v = { _mm256_fmadd_ps(a.m_value, b.m_value, c.m_value) };
+#else
+    Lane8 v = { _mm256_add_ps(_mm256_mul_ps(a.m_value, b.m_value), c.m_value) };
+#endif /* __FMA__ */
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8Index
+lane8Index(const nanoem_u32_t *indices) NANOEM_DECL_NOEXCEPT
+{
+    Lane8Index v = { _mm256_mullo_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices)),
+        _mm256_set1_epi32(int(kPaletteEntryStride))) };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Gather(const nanoem_f32_t *base, const Lane8Index &index) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { _mm256_i32gather_ps(base, index.m_value, sizeof(nanoem_f32_t)) };
+    return v;
+}
+#else /* __AVX2__ */
+/* SSE and NEON through bx::simd, two 4 lanes registers per 8 lanes */
+struct Lane8 {
+    bx::simd128_t m_low;
+    bx::simd128_t m_high;
+};
+struct Lane8Index {
+    nanoem_u32_t m_value[SkinningBatch::kNumLanes];
+};
+
+static BX_FORCE_INLINE Lane8
+lane8Zero() NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { bx::simd_zero(), bx::simd_zero() };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Load(const bx::simd128_t *value) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { value[0], value[1] };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Load(const nanoem_f32_t *value) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { bx::simd_ld(value), bx::simd_ld(value + 4) };
+    return v;
+}
+
+static BX_FORCE_INLINE void
+lane8Store(nanoem_f32_t *ptr, const Lane8 &value) NANOEM_DECL_NOEXCEPT
+{
+    bx::simd_st(ptr, value.m_low);
+    bx::simd_st(ptr + 4, value.m_high);
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Add(const Lane8 &a, const Lane8 &b) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { bx::simd_add(a.m_low, b.m_low), bx::simd_add(a.m_high, b.m_high) };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Madd(const Lane8 &a, const Lane8 &b, const Lane8 &c) NANOEM_DECL_NOEXCEPT
+{
+    Lane8 v = { bx::simd_madd(a.m_low, b.m_low, c.m_low), bx::simd_madd(a.m_high, b.m_high, c.m_high) };
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8Index
+lane8Index(const nanoem_u32_t *indices) NANOEM_DECL_NOEXCEPT
+{
+    Lane8Index v;
+    for (nanoem_rsize_t i = 0; i < SkinningBatch::kNumLanes; i++) {
+        v.m_value[i] = indices[i] * kPaletteEntryStride;
+    }
+    return v;
+}
+
+static BX_FORCE_INLINE Lane8
+lane8Gather(const nanoem_f32_t *base, const Lane8Index &index) NANOEM_DECL_NOEXCEPT
+{
+    const nanoem_u32_t *i = index.m_value;
+    Lane8 v = { bx::simd_ld(base[i[0]], base[i[1]], base[i[2]], base[i[3]]),
+        bx::simd_ld(base[i[4]], base[i[5]], base[i[6]], base[i[7]]) };
+    return v;
+}
+#endif /* __AVX2__ */
+
+/* same as bx::simd_mul_xyz1 but per lane matrix and accumulates with weight */
+static BX_FORCE_INLINE void
+transformLanes(const nanoem_f32_t *palette, const Lane8Index &index, const Lane8 *value, const Lane8 &weight,
+    Lane8 *output) NANOEM_DECL_NOEXCEPT
+{
+    for (int i = 0; i < 3; i++) {
+        const Lane8 c0 = lane8Gather(palette + i, index), c1 = lane8Gather(palette + 4 + i, index),
+                    c2 = lane8Gather(palette + 8 + i, index), c3 = lane8Gather(palette + 12 + i, index);
+        const Lane8 v = lane8Madd(value[2], c2, lane8Madd(value[1], c1, lane8Madd(value[0], c0, c3)));
+        output[i] = lane8Madd(v, weight, output[i]);
+    }
+}
+
+} /* namespace anonymous */
+
+SkinningBatch::SkinningBatch()
+{
+}
+
+SkinningBatch::~SkinningBatch() NANOEM_DECL_NOEXCEPT
+{
+}
+
+void
+SkinningBatch::build(const Model *model)
+{
+    typedef tinystl::unordered_map<const Bone *, nanoem_u32_t, TinySTLAllocator> PaletteIndexMap;
+    static const nanoem_model_vertex_type_t kBatchTypes[] = { NANOEM_MODEL_VERTEX_TYPE_BDEF1,
+        NANOEM_MODEL_VERTEX_TYPE_BDEF2, NANOEM_MODEL_VERTEX_TYPE_BDEF4 };
+    static const nanoem_u32_t kNumInfluences[] = { 1, 2, 4 };
+    IndexList typedVertexIndices[BX_COUNTOF(kBatchTypes)];
+    PaletteIndexMap paletteIndices;
+    nanoem_rsize_t numVertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(model->data(), &numVertices);
+    clear();
+    for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+        const nanoem_model_vertex_t *vertexPtr = vertices[i];
+        const Vertex *vertex = Vertex::cast(vertexPtr);
+        bool batched = false;
+        if (vertex && !vertex->hasSoftBody()) {
+            const nanoem_model_vertex_type_t type = nanoemModelVertexGetType(vertexPtr);
+            for (nanoem_rsize_t j = 0; j < BX_COUNTOF(kBatchTypes); j++) {
+                if (type == kBatchTypes[j]) {
+                    typedVertexIndices[j].push_back(nanoem_u32_t(i));
+                    batched = true;
+                    break;
+                }
+            }
+        }
+        if (!batched) {
+            /* SDEF/QDEF and soft body vertices are still performed per vertex */
+            m_fallbackVertexIndices.push_back(nanoem_u32_t(i));
+        }
+    }
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(kBatchTypes); i++) {
+        const IndexList &indices = typedVertexIndices[i];
+        const nanoem_u32_t numInfluences = kNumInfluences[i];
+        for (nanoem_rsize_t offset = 0, numIndices = indices.size(); offset < numIndices; offset += kNumLanes) {
+            BX_ALIGN_DECL_16(nanoem_f32_t) origin[3][kNumLanes];
+            BX_ALIGN_DECL_16(nanoem_f32_t) normal[3][kNumLanes];
+            BX_ALIGN_DECL_16(nanoem_f32_t) weights[4][kNumLanes];
+            Block block;
+            Inline::clearZeroMemory(block);
+            Inline::clearZeroMemory(origin);
+            Inline::clearZeroMemory(normal);
+            Inline::clearZeroMemory(weights);
+            block.m_numVertices = nanoem_u32_t(glm::min(numIndices - offset, kNumLanes));
+            block.m_numInfluences = numInfluences;
+            for (nanoem_u32_t j = 0; j < block.m_numVertices; j++) {
+                const nanoem_u32_t vertexIndex = indices[offset + j];
+                const Vertex *vertex = Vertex::cast(vertices[vertexIndex]);
+                const bx::simd128_t o = vertex->m_simd.m_origin, n = vertex->m_simd.m_normal,
+                                    w = vertex->m_simd.m_weights;
+                block.m_vertexIndices[j] = vertexIndex;
+                origin[0][j] = bx::simd_x(o);
+                origin[1][j] = bx::simd_y(o);
+                origin[2][j] = bx::simd_z(o);
+                normal[0][j] = bx::simd_x(n);
+                normal[1][j] = bx::simd_y(n);
+                normal[2][j] = bx::simd_z(n);
+                switch (numInfluences) {
+                case 1:
+                    weights[0][j] = 1.0f;
+                    break;
+                case 2:
+                    weights[0][j] = bx::simd_x(w);
+                    weights[1][j] = 1.0f - bx::simd_x(w);
+                    break;
+                default:
+                    weights[0][j] = bx::simd_x(w);
+                    weights[1][j] = bx::simd_y(w);
+                    weights[2][j] = bx::simd_z(w);
+                    weights[3][j] = bx::simd_w(w);
+                    break;
+                }
+                for (nanoem_u32_t k = 0; k < numInfluences; k++) {
+                    const Bone *bone = vertex->bone(k);
+                    PaletteIndexMap::const_iterator it = paletteIndices.find(bone);
+                    if (it != paletteIndices.end()) {
+                        block.m_paletteIndices[k][j] = it->second;
+                    }
+                    else {
+                        const nanoem_u32_t paletteIndex = nanoem_u32_t(m_paletteBones.size());
+                        paletteIndices.insert(tinystl::make_pair(bone, paletteIndex));
+                        m_paletteBones.push_back(bone);
+                        block.m_paletteIndices[k][j] = paletteIndex;
+                    }
+                }
+            }
+            for (int j = 0; j < 3; j++) {
+                block.m_origin[j][0] = bx::simd_ld(&origin[j][0]);
+                block.m_origin[j][1] = bx::simd_ld(&origin[j][4]);
+                block.m_normal[j][0] = bx::simd_ld(&normal[j][0]);
+                block.m_normal[j][1] = bx::simd_ld(&normal[j][4]);
+            }
+            for (int j = 0; j < 4; j++) {
+                block.m_weights[j][0] = bx::simd_ld(&weights[j][0]);
+                block.m_weights[j][1] = bx::simd_ld(&weights[j][4]);
+            }
+            m_blocks.push_back(block);
+        }
+    }
+    /* padding lanes refer the first entry with zero weight so the palette must not be empty */
+    m_palette.resize(glm::max(m_paletteBones.size(), size_t(1)));
+    updateBonePalette();
+}
+
+void
+SkinningBatch::clear()
+{
+    m_blocks.clear();
+    m_palette.clear();
+    m_paletteBones.clear();
+    m_fallbackVertexIndices.clear();
+}
+
+void
+SkinningBatch::updateBonePalette() NANOEM_DECL_NOEXCEPT
+{
+    PaletteEntry *entries = m_palette.data();
+    for (nanoem_rsize_t i = 0, numBones = m_paletteBones.size(); i < numBones; i++) {
+        const Bone *bone = m_paletteBones[i];
+        PaletteEntry &entry = entries[i];
+        entry.m_skinningTransform = bone->skinningTransformMatrix();
+        entry.m_normalTransform = bone->normalTransformMatrix();
+    }
+}
+
+void
+SkinningBatch::execute(nanoem_rsize_t blockIndex, nanoem_f32_t edgeSizeScaleFactor,
+    nanoem_model_vertex_t *const *vertices, nanoem_u8_t *output) const NANOEM_DECL_NOEXCEPT
+{
+    BX_ALIGN_DECL_16(nanoem_f32_t) delta[3][kNumLanes];
+    BX_ALIGN_DECL_16(nanoem_f32_t) position[3][kNumLanes];
+    BX_ALIGN_DECL_16(nanoem_f32_t) normal[3][kNumLanes];
+    Vertex *blockVertices[kNumLanes];
+    const Block &block = m_blocks[blockIndex];
+    const nanoem_f32_t *palette = reinterpret_cast<const nanoem_f32_t *>(m_palette.data());
+    Model::VertexUnit *units = reinterpret_cast<Model::VertexUnit *>(output);
+    Inline::clearZeroMemory(delta);
+    for (nanoem_u32_t i = 0; i < block.m_numVertices; i++) {
+        Vertex *vertex = Vertex::cast(vertices[block.m_vertexIndices[i]]);
+        const bx::simd128_t d = vertex->m_simd.m_delta;
+        blockVertices[i] = vertex;
+        delta[0][i] = bx::simd_x(d);
+        delta[1][i] = bx::simd_y(d);
+        delta[2][i] = bx::simd_z(d);
+    }
+    const Lane8 op[] = { lane8Add(lane8Load(block.m_origin[0]), lane8Load(delta[0])),
+        lane8Add(lane8Load(block.m_origin[1]), lane8Load(delta[1])),
+        lane8Add(lane8Load(block.m_origin[2]), lane8Load(delta[2])) };
+    const Lane8 on[] = { lane8Load(block.m_normal[0]), lane8Load(block.m_normal[1]), lane8Load(block.m_normal[2]) };
+    Lane8 p[] = { lane8Zero(), lane8Zero(), lane8Zero() }, n[] = { lane8Zero(), lane8Zero(), lane8Zero() };
+    for (nanoem_u32_t i = 0; i < block.m_numInfluences; i++) {
+        const Lane8Index index(lane8Index(block.m_paletteIndices[i]));
+        const Lane8 weight(lane8Load(block.m_weights[i]));
+        transformLanes(palette, index, op, weight, p);
+        transformLanes(palette + kNormalTransformOffset, index, on, weight, n);
+    }
+    for (int i = 0; i < 3; i++) {
+        lane8Store(position[i], p[i]);
+        lane8Store(normal[i], n[i]);
+    }
+    for (nanoem_u32_t i = 0; i < block.m_numVertices; i++) {
+        Vertex *vertex = blockVertices[i];
+        Model::VertexUnit &unit = units[block.m_vertexIndices[i]];
+        unit.m_position = bx::simd_ld(position[0][i], position[1][i], position[2][i], 1.0f);
+        unit.m_normal = bx::simd_ld(normal[0][i], normal[1][i], normal[2][i], 1.0f);
+        unit.m_edge = bx::simd_madd(unit.m_normal,
+            bx::simd_splat(bx::simd_x(vertex->m_simd.m_info) * edgeSizeScaleFactor), unit.m_position);
+        unit.m_texcoord = bx::simd_add(vertex->m_simd.m_texcoord, vertex->m_simd.m_deltaUVA[0]);
+        unit.setUVA(vertex);
+        vertex->reset();
+    }
+}
+
+nanoem_rsize_t
+SkinningBatch::numBlocks() const NANOEM_DECL_NOEXCEPT
+{
+    return m_blocks.size();
+}
+
+nanoem_rsize_t
+SkinningBatch::numBlockVertices(nanoem_rsize_t blockIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return m_blocks[blockIndex].m_numVertices;
+}
+
+nanoem_rsize_t
+SkinningBatch::blockVertexIndex(nanoem_rsize_t blockIndex, nanoem_rsize_t laneIndex) const NANOEM_DECL_NOEXCEPT
+{
+    return m_blocks[blockIndex].m_vertexIndices[laneIndex];
+}
+
+nanoem_rsize_t
+SkinningBatch::numFallbackVertices() const NANOEM_DECL_NOEXCEPT
+{
+    return m_fallbackVertexIndices.size();
+}
+
+nanoem_rsize_t
+SkinningBatch::fallbackVertexIndex(nanoem_rsize_t index) const NANOEM_DECL_NOEXCEPT
+{
+    return m_fallbackVertexIndices[index];
+}
+
+} /* namespace model */
+} /* namespace nanoem */
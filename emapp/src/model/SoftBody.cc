@@ -73,12 +73,13 @@ SoftBody::bind(nanoem_model_soft_body_t *softBodyPtr, PhysicsEngine *engine, Rig
     nanoemUserDataSetOnDestroyModelObjectCallback(userData, &SoftBody::destroy);
     nanoemUserDataSetOpaqueData(userData, this);
     nanoemModelObjectSetUserData(nanoemModelSoftBodyGetModelObjectMutable(softBodyPtr), userData);
-    m_physicsSoftBody = engine->createSoftBody(softBodyPtr, status);
-    m_physicsEngine = engine;
+    m_physicsEngine =
+        engine->findIsland(nanoemModelObjectGetParentModel(nanoemModelSoftBodyGetModelObject(softBodyPtr)));
+    m_physicsSoftBody = m_physicsEngine->createSoftBody(softBodyPtr, status);
     enable();
-    int numSoftBodyVertices = engine->numSoftBodyVertices(m_physicsSoftBody);
+    int numSoftBodyVertices = m_physicsEngine->numSoftBodyVertices(m_physicsSoftBody);
     for (int i = 0; i < numSoftBodyVertices; i++) {
-        const nanoem_model_vertex_t *vertexPtr = engine->resolveSoftBodyVertexObject(m_physicsSoftBody, i);
+        const nanoem_model_vertex_t *vertexPtr = m_physicsEngine->resolveSoftBodyVertexObject(m_physicsSoftBody, i);
         if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
             vertex->setSoftBody(softBodyPtr);
         }
@@ -87,7 +88,8 @@ SoftBody::bind(nanoem_model_soft_body_t *softBodyPtr, PhysicsEngine *engine, Rig
     const nanoem_u32_t *indices = nanoemModelSoftBodyGetAllPinnedVertexIndices(softBodyPtr, &numIndices);
     for (nanoem_rsize_t i = 0; i < numIndices; i++) {
         const nanoem_u32_t index = indices[i];
-        const nanoem_model_vertex_t *vertexPtr = engine->resolveSoftBodyVertexObject(m_physicsSoftBody, index);
+        const nanoem_model_vertex_t *vertexPtr =
+            m_physicsEngine->resolveSoftBodyVertexObject(m_physicsSoftBody, index);
         if (model::Vertex *vertex = model::Vertex::cast(vertexPtr)) {
             vertex->setSoftBody(nullptr);
         }
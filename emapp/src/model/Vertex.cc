@@ -18,6 +18,7 @@ namespace {
 enum PrivateStateFlags {
     kPrivateStateSkinningEnabled = 1 << 1,
     kPrivateStateEditingMasked = 1 << 2,
+    kPrivateStateDeformed = 1 << 3,
     kPrivateStateReserved = 1 << 31,
 };
 static const nanoem_u32_t kPrivateStateInitialValue = 0;
@@ -201,12 +202,21 @@ Vertex::setEditingMasked(bool value)
     EnumUtils::setEnabled(kPrivateStateEditingMasked, m_states, value);
 }
 
+bool
+Vertex::isDeformed() const NANOEM_DECL_NOEXCEPT
+{
+    return EnumUtils::isEnabled(kPrivateStateDeformed, m_states);
+}
+
 void
 Vertex::deform(const nanoem_model_morph_vertex_t *morph, nanoem_f32_t weight) NANOEM_DECL_NOEXCEPT
 {
     bx::simd128_t a = m_simd.m_delta;
     bx::simd128_t b = bx::simd_ld(nanoemModelMorphVertexGetPosition(morph));
     m_simd.m_delta = bx::simd_add(a, bx::simd_mul(b, bx::simd_splat(weight)));
+    if (weight != 0) {
+        EnumUtils::setEnabled(kPrivateStateDeformed, m_states, true);
+    }
 }
 
 void
@@ -214,6 +224,9 @@ Vertex::deform(const nanoem_model_morph_uv_t *morph, int index, nanoem_f32_t wei
 {
     m_simd.m_deltaUVA[index] = bx::simd_add(
         m_simd.m_delta, bx::simd_mul(bx::simd_ld(nanoemModelMorphUVGetPosition(morph)), bx::simd_splat(weight)));
+    if (weight != 0) {
+        EnumUtils::setEnabled(kPrivateStateDeformed, m_states, true);
+    }
 }
 
 void
@@ -225,6 +238,7 @@ Vertex::reset() NANOEM_DECL_NOEXCEPT
     m_simd.m_deltaUVA[2] = bx::simd_zero();
     m_simd.m_deltaUVA[3] = bx::simd_zero();
     m_simd.m_deltaUVA[4] = bx::simd_zero();
+    EnumUtils::setEnabled(kPrivateStateDeformed, m_states, false);
 }
 
 void
@@ -21616,7 +21616,7 @@ const ProtobufCMessageDescriptor nanoem__application__redo_insert_empty_timeline
   (ProtobufCMessageInit) nanoem__application__redo_insert_empty_timeline_frame_command__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor nanoem__application__redo_save_motion_snapshot_command__field_descriptors[4] =
+static const ProtobufCFieldDescriptor nanoem__application__redo_save_motion_snapshot_command__field_descriptors[5] =
 {
   {
     "last_motion",
@@ -21666,9 +21666,22 @@ static const ProtobufCFieldDescriptor nanoem__application__redo_save_motion_snap
     0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
+  {
+    "delta_format",
+    5,
+    PROTOBUF_C_LABEL_OPTIONAL,
+    PROTOBUF_C_TYPE_UINT32,
+    offsetof(Nanoem__Application__RedoSaveMotionSnapshotCommand, has_delta_format),
+    offsetof(Nanoem__Application__RedoSaveMotionSnapshotCommand, delta_format),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
 };
 static const unsigned nanoem__application__redo_save_motion_snapshot_command__field_indices_by_name[] = {
   1,   /* field[1] = current_motion */
+  4,   /* field[4] = delta_format */
   3,   /* field[3] = handle */
   0,   /* field[0] = last_motion */
   2,   /* field[2] = types */
@@ -21676,7 +21689,7 @@ static const unsigned nanoem__application__redo_save_motion_snapshot_command__fi
 static const ProtobufCIntRange nanoem__application__redo_save_motion_snapshot_command__number_ranges[1 + 1] =
 {
   { 1, 0 },
-  { 0, 4 }
+  { 0, 5 }
 };
 const ProtobufCMessageDescriptor nanoem__application__redo_save_motion_snapshot_command__descriptor =
 {
@@ -21686,7 +21699,7 @@ const ProtobufCMessageDescriptor nanoem__application__redo_save_motion_snapshot_
   "Nanoem__Application__RedoSaveMotionSnapshotCommand",
   "nanoem.application",
   sizeof(Nanoem__Application__RedoSaveMotionSnapshotCommand),
-  4,
+  5,
   nanoem__application__redo_save_motion_snapshot_command__field_descriptors,
   nanoem__application__redo_save_motion_snapshot_command__field_indices_by_name,
   1,  nanoem__application__redo_save_motion_snapshot_command__number_ranges,
@@ -2348,10 +2348,12 @@ struct  Nanoem__Application__RedoSaveMotionSnapshotCommand
   uint32_t types;
   protobuf_c_boolean has_handle;
   uint32_t handle;
+  protobuf_c_boolean has_delta_format;
+  uint32_t delta_format;
 };
 #define NANOEM__APPLICATION__REDO_SAVE_MOTION_SNAPSHOT_COMMAND__INIT \
  { PROTOBUF_C_MESSAGE_INIT (&nanoem__application__redo_save_motion_snapshot_command__descriptor) \
-    , {0,NULL}, {0,NULL}, 0, 0, 0 }
+    , {0,NULL}, {0,NULL}, 0, 0, 0, 0, 0 }
 
 
 struct  Nanoem__Application__RedoDeleteAccessoryCommand
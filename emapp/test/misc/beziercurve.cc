@@ -0,0 +1,79 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/BezierCurve.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+/* reference implementation of the previous nearest sample lookup */
+static nanoem_f32_t
+sampleBezierCurve(const nanoem_u8_t *parameters, nanoem_frame_index_t interval, nanoem_f32_t value)
+{
+    const Vector2 p1(127), c0(parameters[0], parameters[1]), c1(parameters[2], parameters[3]);
+    Vector2 nearest(1);
+    interval = glm::max(interval, nanoem_frame_index_t(16));
+    for (nanoem_frame_index_t i = 0; i <= interval; i++) {
+        const nanoem_f32_t t = i / nanoem_f32_t(interval), it = 1.0f - t;
+        const Vector2 v((c0 * t * it * it * 3.0f + c1 * it * t * t * 3.0f + p1 * t * t * t) / p1);
+        if (glm::abs(nearest.x - value) > glm::abs(v.x - value)) {
+            nearest = v;
+        }
+    }
+    return nearest.y;
+}
+
+static const nanoem_u8_t kParameters[][4] = {
+    { 20, 20, 107, 107 },
+    { 64, 0, 64, 127 },
+    { 0, 64, 127, 64 },
+    { 30, 90, 100, 40 },
+    { 127, 127, 127, 127 },
+    { 0, 0, 0, 0 },
+};
+
+} /* namespace anonymous */
+
+TEST_CASE("beziercurve_solve_should_match_sampled_value", "[emapp][misc]")
+{
+    for (size_t i = 0; i < BX_COUNTOF(kParameters); i++) {
+        const nanoem_u8_t *parameters = kParameters[i];
+        for (nanoem_frame_index_t interval = 16; interval <= 120; interval += 13) {
+            for (nanoem_frame_index_t j = 0; j <= interval; j++) {
+                const nanoem_f32_t value = j / nanoem_f32_t(interval);
+                const nanoem_f32_t actual = BezierCurve::solve(parameters, value);
+                CHECK(actual == Approx(sampleBezierCurve(parameters, interval, value)).margin(0.08f));
+                CHECK(actual == Approx(sampleBezierCurve(parameters, 8192, value)).margin(0.001f));
+            }
+        }
+    }
+}
+
+TEST_CASE("beziercurve_solve_should_be_same_between_scalar_and_batched", "[emapp][misc]")
+{
+    const nanoem_u8_t *parameters[] = { kParameters[0], kParameters[1], kParameters[2], kParameters[3] };
+    for (int i = 0; i <= 100; i++) {
+        const nanoem_f32_t value = i / 100.0f;
+        const Vector4 actual(BezierCurve::solve(parameters, Vector4(value)));
+        for (int j = 0; j < 4; j++) {
+            CHECK(actual[j] == Approx(BezierCurve::solve(parameters[j], value)).margin(1e-5f));
+        }
+    }
+}
+
+TEST_CASE("beziercurve_value_should_be_bounded", "[emapp][misc]")
+{
+    const BezierCurve curve(Vector2U8(20, 20), Vector2U8(107, 107), 30);
+    CHECK(curve.value(0.0f) == Approx(0.0f).margin(1e-5f));
+    CHECK(curve.value(1.0f) == Approx(1.0f).margin(1e-5f));
+    CHECK(curve.value(-1.0f) == Approx(0.0f).margin(1e-5f));
+    CHECK(curve.value(2.0f) == Approx(1.0f).margin(1e-5f));
+    CHECK(curve.length() == 30);
+}
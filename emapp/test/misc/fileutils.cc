@@ -7,6 +7,7 @@
 #include "../common.h"
 
 #include "emapp/FileUtils.h"
+#include "emapp/URI.h"
 
 using namespace nanoem;
 using namespace test;
@@ -58,3 +59,28 @@ TEST_CASE("fileutils_relative_path", "[emapp][misc]")
     CHECK(FileUtils::relativePath("D:/path/to/relative", "D:/base") == String("../path/to/relative"));
     CHECK(FileUtils::relativePath("D:/path/to/relative", "C:/base") == String());
 }
+
+TEST_CASE("fileutils_mapped_file_reader_should_same_content", "[emapp][misc]")
+{
+    String path(NANOEM_TEST_FIXTURE_PATH);
+    path.append("/test.pmx");
+    const URI fileURI(URI::createFromFilePath(path));
+    FileReaderScope scope(nullptr);
+    MappedFileReader reader(nullptr);
+    Error error;
+    REQUIRE(scope.open(fileURI, error));
+    REQUIRE(reader.open(fileURI, error));
+    ByteArray bytes;
+    FileUtils::read(scope, bytes, error);
+    REQUIRE(reader.size() == bytes.size());
+    CHECK(memcmp(reader.bytes(), bytes.data(), bytes.size()) == 0);
+    nanoem_u8_t header[4], expected[4] = { 'P', 'M', 'X', ' ' };
+    CHECK(reader.read(header, sizeof(header), error) == sizeof(header));
+    CHECK(memcmp(header, expected, sizeof(header)) == 0);
+    CHECK(reader.seek(0, ISeekable::kSeekTypeEnd, error) == nanoem_i64_t(bytes.size()));
+    CHECK(reader.read(header, sizeof(header), error) == 0);
+    CHECK(reader.close(error));
+    CHECK(reader.size() == 0);
+    CHECK_FALSE(reader.open(URI::createFromFilePath("/path/to/not/found.pmx"), error));
+    CHECK(error.hasReason());
+}
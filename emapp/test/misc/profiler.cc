@@ -0,0 +1,125 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Profiler.h"
+#include "emapp/TaskScheduler.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef tinystl::vector<Profiler::Event, TinySTLAllocator> EventList;
+
+struct RecordingTask {
+    static void
+    handle(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        RecordingTask *self = static_cast<RecordingTask *>(opaque);
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            Profiler::Scope scope(self->m_profiler, "RecordingTask::handle");
+        }
+    }
+    Profiler *m_profiler;
+};
+
+static nanoem_rsize_t
+countAllEvents(const Profiler *profiler)
+{
+    EventList events(Profiler::kMaxNumEvents);
+    nanoem_rsize_t numEvents = 0;
+    for (nanoem_u32_t i = 0; i < profiler->numThreads(); i++) {
+        numEvents += profiler->copyAllEvents(i, events.data(), events.size());
+    }
+    return numEvents;
+}
+
+static std::string
+saveTrace(const Profiler *profiler)
+{
+    ByteArray bytes;
+    profiler->save(bytes);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("profiler_should_record_nested_scopes", "[emapp][misc]")
+{
+    std::unique_ptr<Profiler> profiler(new Profiler());
+    {
+        Profiler::Scope scope(profiler.get(), "disabled");
+    }
+    CHECK(profiler->numThreads() == 0);
+    CHECK(countAllEvents(profiler.get()) == 0);
+    profiler->setEnabled(true);
+    {
+        Profiler::Scope outer(profiler.get(), "outer");
+        {
+            Profiler::Scope inner(profiler.get(), "in\"ner");
+        }
+    }
+    CHECK(profiler->numThreads() == 1);
+    EventList events(Profiler::kMaxNumEvents);
+    REQUIRE(profiler->copyAllEvents(0, events.data(), events.size()) == 2);
+    /* the inner zone is closed first */
+    CHECK_THAT(events[0].m_name, Catch::Equals("in\"ner"));
+    CHECK_THAT(events[1].m_name, Catch::Equals("outer"));
+    CHECK(events[1].m_begin <= events[0].m_begin);
+    CHECK(events[0].m_end <= events[1].m_end);
+    CHECK(profiler->copyAllEvents(1, events.data(), events.size()) == 0);
+    const std::string trace(saveTrace(profiler.get()));
+    CHECK_THAT(trace, Catch::StartsWith("{\"traceEvents\":[{\"name\":\"thread_name\",\"ph\":\"M\""));
+    CHECK_THAT(trace, Catch::EndsWith("],\"displayTimeUnit\":\"ms\"}"));
+    CHECK_THAT(trace, Catch::Contains("{\"name\":\"outer\",\"cat\":\"emapp\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":"));
+    CHECK_THAT(trace, Catch::Contains("{\"name\":\"in\\\"ner\","));
+    CHECK_THAT(trace, !Catch::Contains("disabled"));
+    profiler->reset();
+    CHECK(countAllEvents(profiler.get()) == 0);
+    CHECK_THAT(saveTrace(profiler.get()), !Catch::Contains("\"ph\":\"X\""));
+}
+
+TEST_CASE("profiler_should_keep_latest_events_in_ring", "[emapp][misc]")
+{
+    static const nanoem_u32_t kNumExtraEvents = 10;
+    std::unique_ptr<Profiler> profiler(new Profiler());
+    profiler->setEnabled(true);
+    for (nanoem_u32_t i = 0; i < Profiler::kMaxNumEvents + kNumExtraEvents; i++) {
+        profiler->record("event", i + 1, i + 2);
+    }
+    EventList events(Profiler::kMaxNumEvents);
+    REQUIRE(profiler->copyAllEvents(0, events.data(), events.size()) == Profiler::kMaxNumEvents);
+    CHECK(events[0].m_begin == kNumExtraEvents + 1);
+    CHECK(events[Profiler::kMaxNumEvents - 1].m_begin == Profiler::kMaxNumEvents + kNumExtraEvents);
+    CHECK(profiler->numDroppedEvents() == kNumExtraEvents);
+    /* a smaller buffer takes the latest events */
+    REQUIRE(profiler->copyAllEvents(0, events.data(), 4) == 4);
+    CHECK(events[3].m_begin == Profiler::kMaxNumEvents + kNumExtraEvents);
+    profiler->reset();
+    CHECK(profiler->numDroppedEvents() == 0);
+    profiler->record("event", 1, 2);
+    CHECK(profiler->copyAllEvents(0, events.data(), events.size()) == 1);
+}
+
+TEST_CASE("profiler_should_record_scopes_per_thread", "[emapp][misc]")
+{
+    static const nanoem_rsize_t kNumIterations = 64;
+    std::unique_ptr<Profiler> profiler(new Profiler());
+    TaskScheduler scheduler(3);
+    RecordingTask task;
+    task.m_profiler = profiler.get();
+    profiler->setEnabled(true);
+    scheduler.parallelFor(RecordingTask::handle, &task, kNumIterations, 1);
+    CHECK(profiler->numThreads() >= 1);
+    CHECK(profiler->numThreads() <= scheduler.numWorkers() + 1);
+    CHECK(countAllEvents(profiler.get()) == kNumIterations);
+    CHECK(profiler->numDroppedEvents() == 0);
+    profiler->setEnabled(false);
+    scheduler.parallelFor(RecordingTask::handle, &task, kNumIterations, 1);
+    CHECK(countAllEvents(profiler.get()) == kNumIterations);
+}
@@ -0,0 +1,69 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/TaskScheduler.h"
+
+#include "bx/cpu.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+struct CountingTask {
+    static void
+    handle(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        CountingTask *self = static_cast<CountingTask *>(opaque);
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            bx::atomicFetchAndAdd<nanoem_u32_t>(&self->m_counts[i], 1);
+        }
+        bx::atomicFetchAndAdd<nanoem_u32_t>(&self->m_numCalls, 1);
+    }
+    tinystl::vector<nanoem_u32_t, TinySTLAllocator> m_counts;
+    volatile nanoem_u32_t m_numCalls;
+};
+
+static void
+checkAllIterationsVisitedOnce(TaskScheduler *scheduler, nanoem_rsize_t iterations, nanoem_rsize_t grainSize)
+{
+    CountingTask task;
+    task.m_counts.resize(iterations);
+    task.m_numCalls = 0;
+    scheduler->parallelFor(CountingTask::handle, &task, iterations, grainSize);
+    nanoem_rsize_t numInvalidCounts = 0;
+    for (nanoem_rsize_t i = 0; i < iterations; i++) {
+        numInvalidCounts += task.m_counts[i] != 1 ? 1 : 0;
+    }
+    CHECK(numInvalidCounts == 0);
+    CHECK(task.m_numCalls <= (iterations + grainSize - 1) / grainSize + scheduler->numWorkers() + 1);
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("taskscheduler_should_visit_all_iterations_once", "[emapp][misc]")
+{
+    TaskScheduler scheduler(3);
+    CHECK(scheduler.numWorkers() == 3);
+    checkAllIterationsVisitedOnce(&scheduler, 0, 16);
+    checkAllIterationsVisitedOnce(&scheduler, 1, 16);
+    checkAllIterationsVisitedOnce(&scheduler, 15, 16);
+    checkAllIterationsVisitedOnce(&scheduler, 17, 16);
+    checkAllIterationsVisitedOnce(&scheduler, 100003, 1024);
+    for (int i = 0; i < 64; i++) {
+        checkAllIterationsVisitedOnce(&scheduler, 4096 + i * 7, 64);
+    }
+}
+
+TEST_CASE("taskscheduler_should_run_serially_without_workers", "[emapp][misc]")
+{
+    TaskScheduler scheduler(0);
+    CHECK(scheduler.numWorkers() == 0);
+    checkAllIterationsVisitedOnce(&scheduler, 10000, 128);
+    checkAllIterationsVisitedOnce(TaskScheduler::sharedInstance(), 10000, 128);
+}
@@ -0,0 +1,70 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/BoneTransformSchedule.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("model_bone_transform_schedule_should_follow_transform_order", "[emapp][model]")
+{
+    typedef tinystl::unordered_map<const nanoem_model_bone_t *, nanoem_rsize_t, TinySTLAllocator> LevelMap;
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        Model *activeModel = o->createModel();
+        project->addModel(activeModel);
+        model::BoneTransformSchedule schedule;
+        CHECK_FALSE(schedule.isValid());
+        schedule.build(activeModel);
+        CHECK(schedule.isValid());
+        nanoem_rsize_t numOrderedBones, numScheduledBones = 0;
+        nanoem_model_bone_t *const *orderedBones =
+            nanoemModelGetAllOrderedBoneObjects(activeModel->data(), &numOrderedBones);
+        for (int i = PhysicsEngine::kSimulationTimingFirstEnum; i < PhysicsEngine::kSimulationTimingMaxEnum; i++) {
+            const PhysicsEngine::SimulationTimingType timing = static_cast<PhysicsEngine::SimulationTimingType>(i);
+            const nanoem_model_bone_t *const *bones = schedule.allBones(timing);
+            LevelMap levels;
+            nanoem_rsize_t offset = 0;
+            for (nanoem_rsize_t j = 0, numLevels = schedule.numLevels(timing); j < numLevels; j++) {
+                const model::BoneTransformSchedule::Level &level = schedule.level(timing, j);
+                CHECK(level.m_offset == offset);
+                CHECK(level.m_numBones > 0);
+                for (nanoem_rsize_t k = 0; k < level.m_numBones; k++) {
+                    levels.insert(tinystl::make_pair(bones[level.m_offset + k], j));
+                }
+                offset += level.m_numBones;
+            }
+            CHECK(offset == schedule.numBones(timing));
+            numScheduledBones += schedule.numBones(timing);
+            /* every parent preceding in transform order must be applied in the former level */
+            for (nanoem_rsize_t j = 0; j < numOrderedBones; j++) {
+                const nanoem_model_bone_t *bonePtr = orderedBones[j];
+                LevelMap::const_iterator it = levels.find(bonePtr);
+                if (it == levels.end()) {
+                    continue;
+                }
+                for (nanoem_rsize_t k = 0; k < j; k++) {
+                    if (orderedBones[k] == nanoemModelBoneGetParentBoneObject(bonePtr)) {
+                        LevelMap::const_iterator it2 = levels.find(orderedBones[k]);
+                        if (it2 != levels.end()) {
+                            CHECK(it2->second < it->second);
+                        }
+                    }
+                }
+            }
+        }
+        CHECK(numScheduledBones == numOrderedBones);
+        schedule.invalidate();
+        CHECK_FALSE(schedule.isValid());
+        schedule.clear();
+        CHECK(schedule.numBones(PhysicsEngine::kSimulationTimingBefore) == 0);
+    }
+}
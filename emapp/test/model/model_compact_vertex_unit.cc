@@ -0,0 +1,43 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("model_compact_vertex_unit_should_pack_standard_vertex_unit", "[emapp][model]")
+{
+    CHECK(Model::CompactVertexUnit::size(0) * 2 < sizeof(Model::VertexUnit));
+    CHECK(Model::CompactVertexUnit::size(4) < sizeof(Model::VertexUnit));
+    Model::VertexUnit unit;
+    unit.m_position = bx::simd_ld(1, 2, 3, 1);
+    unit.m_normal = bx::simd_ld(0, -1, 0.5f, 0);
+    unit.m_texcoord = bx::simd_ld(1.5f, -0.25f, 0, 0);
+    unit.m_edge = bx::simd_ld(4, 5, 6, 1);
+    unit.m_info = bx::simd_ld(2, 42, 1, 0);
+    unit.m_uva[0] = bx::simd_ld(0.1f, 0.2f, 0.3f, 0.4f);
+    unit.m_uva[1] = bx::simd_ld(0.5f, 0.6f, 0.7f, 0.8f);
+    ByteArray bytes(Model::CompactVertexUnit::size(2));
+    Model::CompactVertexUnit::pack(unit, 2, bytes.data());
+    const Model::CompactVertexUnit *packed = reinterpret_cast<const Model::CompactVertexUnit *>(bytes.data());
+    CHECK(packed->m_position[0] == Approx(1));
+    CHECK(packed->m_position[1] == Approx(2));
+    CHECK(packed->m_position[2] == Approx(3));
+    CHECK(packed->m_zero == 0);
+    CHECK(packed->m_normal[0] == 0);
+    CHECK(packed->m_normal[1] == -32767);
+    CHECK(packed->m_normal[2] == 16384);
+    CHECK(packed->m_texcoord[0] == Approx(1.5f));
+    CHECK(packed->m_texcoord[1] == Approx(-0.25f));
+    CHECK(packed->m_edge[2] == Approx(6));
+    CHECK(packed->m_info[1] == Approx(42));
+    const nanoem_f32_t *uva = reinterpret_cast<const nanoem_f32_t *>(bytes.data() + sizeof(*packed));
+    CHECK(uva[0] == Approx(0.1f));
+    CHECK(uva[7] == Approx(0.8f));
+}
@@ -0,0 +1,59 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/Constraint.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("model_compiled_constraint_should_mirror_joints", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        Model *activeModel = o->createModel();
+        project->addModel(activeModel);
+        nanoem_rsize_t numConstraints;
+        nanoem_model_constraint_t *const *constraints =
+            nanoemModelGetAllConstraintObjects(activeModel->data(), &numConstraints);
+        for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
+            const nanoem_model_constraint_t *constraintPtr = constraints[i];
+            model::Constraint *constraint = model::Constraint::cast(constraintPtr);
+            nanoem_rsize_t numJoints;
+            nanoem_model_constraint_joint_t *const *joints =
+                nanoemModelConstraintGetAllJointObjects(constraintPtr, &numJoints);
+            const model::Constraint::CompiledJointList &compiledJoints = constraint->compiledJoints();
+            CHECK(compiledJoints.size() == numJoints);
+            CHECK(constraint->numIterations() ==
+                nanoem_rsize_t(glm::max(nanoemModelConstraintGetNumIterations(constraintPtr), 0)));
+            const nanoem_f32_t angleLimit = nanoemModelConstraintGetAngleLimit(constraintPtr);
+            for (nanoem_rsize_t j = 0; j < numJoints; j++) {
+                const model::Constraint::CompiledJoint &joint = compiledJoints[j];
+                CHECK(joint.m_joint == joints[j]);
+                CHECK(joint.m_bonePtr == nanoemModelConstraintJointGetBoneObject(joints[j]));
+                CHECK(joint.m_hasAngleLimit == (nanoemModelConstraintJointHasAngleLimit(joints[j]) != 0));
+                CHECK(joint.m_angleLimit == Approx(angleLimit * (j + 1)));
+                CHECK(joint.m_hasUnitXConstraint ==
+                    model::Constraint::hasUnitXConstraint(joint.m_bonePtr, project->unicodeStringFactory()));
+            }
+        }
+        /* solving constraints must be stable after recompilation */
+        activeModel->performAllBonesTransform();
+        for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
+            model::Constraint::cast(constraints[i])->invalidate();
+        }
+        activeModel->performAllBonesTransform();
+        for (nanoem_rsize_t i = 0; i < numConstraints; i++) {
+            nanoem_rsize_t numJoints;
+            nanoemModelConstraintGetAllJointObjects(constraints[i], &numJoints);
+            CHECK(model::Constraint::cast(constraints[i])->compiledJoints().size() == numJoints);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/DirtyVertexTracker.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("model_dirty_vertex_tracker_should_track_changed_vertices", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        Model *activeModel = o->createModel();
+        project->addModel(activeModel);
+        nanoem_rsize_t numBones, numVertices;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(activeModel->data(), &numBones);
+        nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(activeModel->data(), &numVertices);
+        activeModel->performAllBonesTransform();
+        model::DirtyVertexTracker tracker;
+        tracker.build(activeModel);
+        CHECK(tracker.numVertices() == numVertices);
+        /* all vertices must be uploaded to both staging buffers at first */
+        tracker.update(vertices, 1.0f);
+        CHECK(tracker.numDirtyVertices() == numVertices);
+        {
+            const model::DirtyVertexTracker::RangeList &ranges = tracker.collectRanges(0);
+            CHECK(ranges.size() == 1);
+            CHECK(ranges[0].first == 0);
+            CHECK(ranges[0].second == numVertices);
+        }
+        tracker.update(vertices, 1.0f);
+        CHECK(tracker.numDirtyVertices() == 0);
+        CHECK(tracker.collectRanges(0).empty());
+        CHECK(tracker.collectRanges(1).size() == 1);
+        CHECK(tracker.collectRanges(1).empty());
+        /* changing the edge size affects all vertices */
+        tracker.update(vertices, 2.0f);
+        CHECK(tracker.numDirtyVertices() == numVertices);
+        tracker.collectRanges(0);
+        tracker.collectRanges(1);
+        model::Bone *bone = model::Bone::cast(bones[numBones - 1]);
+        bone->setLocalUserTranslation(Vector3(1, 2, 3));
+        activeModel->performAllBonesTransform();
+        tracker.update(vertices, 2.0f);
+        nanoem_rsize_t numDirtyVertices = 0;
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            numDirtyVertices += tracker.isDirty(i) ? 1 : 0;
+        }
+        CHECK(numDirtyVertices == tracker.numDirtyVertices());
+        tracker.invalidate();
+        tracker.update(vertices, 2.0f);
+        CHECK(tracker.numDirtyVertices() == numVertices);
+    }
+}
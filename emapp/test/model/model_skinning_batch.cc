@@ -0,0 +1,58 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/model/SkinningBatch.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("model_skinning_batch_should_be_same_as_per_vertex", "[emapp][model]")
+{
+    TestScope scope;
+    {
+        ProjectPtr o = scope.createProject();
+        Project *project = o->m_project;
+        Model *activeModel = o->createModel();
+        project->addModel(activeModel);
+        nanoem_rsize_t numBones, numVertices;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(activeModel->data(), &numBones);
+        nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(activeModel->data(), &numVertices);
+        for (nanoem_rsize_t i = 0; i < numBones; i++) {
+            model::Bone *bone = model::Bone::cast(bones[i]);
+            bone->setLocalUserTranslation(Vector3(0.1f * i, 0.2f, -0.3f));
+            bone->setLocalUserOrientation(glm::angleAxis(0.25f * (i + 1), glm::normalize(Vector3(1, 2, 3))));
+        }
+        activeModel->performAllBonesTransform();
+        model::SkinningBatch batch;
+        batch.build(activeModel);
+        ByteArray expected(sizeof(Model::VertexUnit) * numVertices), actual(expected.size());
+        Model::VertexUnit *expectedUnits = reinterpret_cast<Model::VertexUnit *>(expected.data());
+        Model::VertexUnit *actualUnits = reinterpret_cast<Model::VertexUnit *>(actual.data());
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            expectedUnits[i].performSkinning(1.0f, model::Vertex::cast(vertices[i]));
+        }
+        for (nanoem_rsize_t i = 0, numBlocks = batch.numBlocks(); i < numBlocks; i++) {
+            batch.execute(i, 1.0f, vertices, actual.data());
+        }
+        for (nanoem_rsize_t i = 0, numFallbacks = batch.numFallbackVertices(); i < numFallbacks; i++) {
+            const nanoem_rsize_t index = batch.fallbackVertexIndex(i);
+            actualUnits[index].performSkinning(1.0f, model::Vertex::cast(vertices[index]));
+        }
+        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
+            const Model::VertexUnit &e = expectedUnits[i], &a = actualUnits[i];
+            CHECK(bx::simd_x(a.m_position) == Approx(bx::simd_x(e.m_position)).margin(1e-4f));
+            CHECK(bx::simd_y(a.m_position) == Approx(bx::simd_y(e.m_position)).margin(1e-4f));
+            CHECK(bx::simd_z(a.m_position) == Approx(bx::simd_z(e.m_position)).margin(1e-4f));
+            CHECK(bx::simd_x(a.m_normal) == Approx(bx::simd_x(e.m_normal)).margin(1e-4f));
+            CHECK(bx::simd_y(a.m_normal) == Approx(bx::simd_y(e.m_normal)).margin(1e-4f));
+            CHECK(bx::simd_z(a.m_normal) == Approx(bx::simd_z(e.m_normal)).margin(1e-4f));
+            CHECK(bx::simd_x(a.m_edge) == Approx(bx::simd_x(e.m_edge)).margin(1e-4f));
+        }
+    }
+}
@@ -0,0 +1,216 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/CommandRegistrator.h"
+#include "emapp/IMotionKeyframeSelection.h"
+#include "emapp/Model.h"
+#include "emapp/PhysicsEngine.h"
+#include "emapp/internal/project/BakedPoseCache.h"
+#include "emapp/model/Bone.h"
+#include "emapp/model/Morph.h"
+
+#include "undo/undo.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+struct EvaluatedPose {
+    std::vector<Matrix4x4> m_worldTransforms;
+    std::vector<Matrix4x4> m_localTransforms;
+    std::vector<Matrix4x4> m_skinningTransforms;
+    std::vector<nanoem_f32_t> m_morphWeights;
+};
+
+static void
+getEvaluatedPose(const Model *model, EvaluatedPose &pose)
+{
+    nanoem_rsize_t numBones, numMorphs;
+    nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(model->data(), &numBones);
+    nanoem_model_morph_t *const *morphs = nanoemModelGetAllMorphObjects(model->data(), &numMorphs);
+    pose = EvaluatedPose();
+    for (nanoem_rsize_t i = 0; i < numBones; i++) {
+        const model::Bone *bone = model::Bone::cast(bones[i]);
+        pose.m_worldTransforms.push_back(bone->worldTransform());
+        pose.m_localTransforms.push_back(bone->localTransform());
+        pose.m_skinningTransforms.push_back(bone->skinningTransform());
+    }
+    for (nanoem_rsize_t i = 0; i < numMorphs; i++) {
+        pose.m_morphWeights.push_back(model::Morph::cast(morphs[i])->weight());
+    }
+}
+
+static void
+checkSameTransforms(const std::vector<Matrix4x4> &expected, const std::vector<Matrix4x4> &actual)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0, numTransforms = expected.size(); i < numTransforms; i++) {
+        for (int j = 0; j < 4; j++) {
+            CHECK(glm::all(glm::epsilonEqual(actual[i][j], expected[i][j], Vector4(0.0001f))));
+        }
+    }
+}
+
+static void
+checkSamePose(const EvaluatedPose &expected, const EvaluatedPose &actual)
+{
+    checkSameTransforms(expected.m_worldTransforms, actual.m_worldTransforms);
+    checkSameTransforms(expected.m_localTransforms, actual.m_localTransforms);
+    checkSameTransforms(expected.m_skinningTransforms, actual.m_skinningTransforms);
+    REQUIRE(actual.m_morphWeights.size() == expected.m_morphWeights.size());
+    for (size_t i = 0, numMorphs = expected.m_morphWeights.size(); i < numMorphs; i++) {
+        CHECK(actual.m_morphWeights[i] == Approx(expected.m_morphWeights[i]));
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_baked_pose_cache_should_bake_while_seeking", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    const internal::project::BakedPoseCache *cache = project->bakedPoseCache();
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeDisable);
+    project->setBakedPoseCacheEnabled(true);
+    CHECK(project->isBakedPoseCacheEnabled());
+    Model *model = first->createModel();
+    project->addModel(model);
+    for (nanoem_frame_index_t i = 1; i <= 10; i++) {
+        project->seek(i, true);
+    }
+    CHECK(cache->countAllPoses() == 10);
+    CHECK(cache->memoryUsage() > 0);
+    SECTION("seeking baked frames restores poses")
+    {
+        project->seek(5, true);
+        CHECK(project->currentLocalFrameIndex() == 5);
+        CHECK(cache->countAllPoses() == 10);
+        CHECK(cache->contains(model, 5));
+    }
+    SECTION("clearing poses of the model removes all of them")
+    {
+        project->clearBakedPoses(model);
+        CHECK(cache->countAllPoses() == 0);
+        CHECK(cache->memoryUsage() == 0);
+    }
+    SECTION("removing the model clears all poses")
+    {
+        project->removeModel(model);
+        CHECK(cache->countAllPoses() == 0);
+        project->destroyModel(model);
+    }
+    SECTION("disabling the cache clears all poses")
+    {
+        project->setBakedPoseCacheEnabled(false);
+        CHECK(cache->countAllPoses() == 0);
+        project->seek(11, true);
+        CHECK(cache->countAllPoses() == 0);
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_baked_pose_cache_should_evict_least_recently_used_poses", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Model *model = first->createModel();
+    {
+        internal::project::BakedPoseCache cache;
+        cache.save(model, 0);
+        cache.setMemoryBudget(cache.memoryUsage() * 2);
+        cache.save(model, 1);
+        CHECK(cache.countAllPoses() == 2);
+        /* restoring marks the pose as recently used so the other one is evicted */
+        CHECK(cache.restore(model, 0));
+        cache.save(model, 2);
+        CHECK(cache.countAllPoses() == 2);
+        CHECK(cache.contains(model, 0));
+        CHECK_FALSE(cache.contains(model, 1));
+        CHECK(cache.contains(model, 2));
+        cache.invalidate(model);
+        CHECK(cache.countAllPoses() == 0);
+        CHECK(cache.memoryUsage() == 0);
+    }
+    first->m_project->destroyModel(model);
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_baked_pose_cache_should_restore_same_pose_as_evaluating", "[emapp][project]")
+{
+    static const nanoem_frame_index_t kLastFrameIndex = 10;
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    const internal::project::BakedPoseCache *cache = project->bakedPoseCache();
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeDisable);
+    Model *activeModel = first->createModel();
+    project->addModel(activeModel);
+    project->setActiveModel(activeModel);
+    CommandRegistrator registrator(project);
+    const nanoem_model_bone_t *activeBonePtr = activeModel->activeBone();
+    model::Bone *activeBone = model::Bone::cast(activeBonePtr);
+    model::Morph *morph = model::Morph::cast(TestScope::findRandomMorph(activeModel));
+    for (nanoem_frame_index_t i = 0; i <= kLastFrameIndex; i += kLastFrameIndex) {
+        project->seek(i, true);
+        activeBone->setLocalUserTranslation(Vector3(i, 0, 0));
+        activeModel->performAllBonesTransform();
+        registrator.registerAddBoneKeyframesCommandBySelectedBoneSet(activeModel);
+        morph->setWeight(i / nanoem_f32_t(kLastFrameIndex));
+        registrator.registerAddMorphKeyframesCommandByAllMorphs(activeModel);
+    }
+    undoStackClear(project->undoStack());
+    activeBone->resetUserTransform();
+    project->setBakedPoseCacheEnabled(true);
+    for (nanoem_frame_index_t i = 0; i <= kLastFrameIndex; i++) {
+        project->seek(i, true);
+    }
+    REQUIRE(cache->contains(activeModel, 5));
+    EvaluatedPose restored, evaluated;
+    project->seek(5, true);
+    getEvaluatedPose(activeModel, restored);
+    const Vector3 lastTranslation(activeBone->localTranslation());
+    CHECK(lastTranslation.x > 0);
+    CHECK(morph->weight() > 0);
+    SECTION("restored pose is the same as the evaluated one")
+    {
+        project->setBakedPoseCacheEnabled(false);
+        project->seek(kLastFrameIndex, true);
+        project->seek(5, true);
+        getEvaluatedPose(activeModel, evaluated);
+        checkSamePose(evaluated, restored);
+    }
+    SECTION("editing keyframes by the undo command evaluates the pose again")
+    {
+        Motion *motion = project->resolveMotion(activeModel);
+        motion->selection()->addBoneKeyframes(activeBonePtr, kLastFrameIndex, kLastFrameIndex);
+        registrator.registerCorrectAllSelectedBoneKeyframesCommand(activeModel,
+            Motion::CorrectionVectorFactor(Vector3(1), Vector3(kLastFrameIndex)), Motion::CorrectionVectorFactor(),
+            error);
+        CHECK_FALSE(error.hasReason());
+        /* pushing the command invalidates all poses of the active model by BaseUndoCommand::invalidateAllCaches */
+        CHECK(cache->countAllPoses() == 0);
+        project->seek(kLastFrameIndex, true);
+        project->seek(5, true);
+        CHECK(activeBone->localTranslation().x > lastTranslation.x);
+        CHECK(cache->contains(activeModel, 5));
+        SECTION("undo")
+        {
+            project->handleUndoAction();
+            CHECK(cache->countAllPoses() == 0);
+            project->seek(kLastFrameIndex, true);
+            project->seek(5, true);
+            CHECK(activeBone->localTranslation().x == Approx(lastTranslation.x));
+            getEvaluatedPose(activeModel, evaluated);
+            checkSamePose(restored, evaluated);
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
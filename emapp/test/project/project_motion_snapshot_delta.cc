@@ -0,0 +1,227 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/CommandRegistrator.h"
+#include "emapp/ICamera.h"
+#include "emapp/IMotionKeyframeSelection.h"
+#include "emapp/Model.h"
+
+#include "undo/undo.h"
+
+using namespace nanoem;
+using namespace test;
+
+static const nanoem_frame_index_t kNumKeyframes = 64;
+static const nanoem_frame_index_t kKeyframeIndexShouldChanged = 42;
+
+TEST_CASE("project_motion_snapshot_keeps_only_changed_keyframes", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    CommandRegistrator registrator(project);
+    ICamera *camera = project->globalCamera();
+    for (nanoem_frame_index_t i = 0; i < kNumKeyframes; i++) {
+        project->seek(i, true);
+        camera->setAngle(Vector3(0.01f * i, 0.2f, 0.3f));
+        camera->setLookAt(Vector3(i, 2, 3));
+        camera->setDistance(42.0f + i);
+        camera->setFov(21);
+        registrator.registerAddCameraKeyframesCommandByCurrentLocalFrameIndex();
+    }
+    undoStackClear(project->undoStack());
+    CHECK(project->undoMemoryUsage() == 0);
+    Motion *motion = project->cameraMotion();
+    ByteArray snapshot;
+    motion->save(snapshot, nullptr, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+    motion->selection()->addCameraKeyframes(kKeyframeIndexShouldChanged, kKeyframeIndexShouldChanged);
+    registrator.registerCorrectAllSelectedCameraKeyframesCommand(
+        Motion::CorrectionVectorFactor(), Motion::CorrectionVectorFactor(Vector3(1), Vector3(1)),
+        Motion::CorrectionScalarFactor(1, 0), error);
+    CHECK(!error.hasReason());
+    CHECK(project->canUndo());
+    CHECK(project->undoMemoryUsage() > 0);
+    CHECK(project->undoMemoryUsage() < snapshot.size());
+    nanoem_rsize_t numKeyframes;
+    const nanoem_motion_camera_keyframe_t *k = motion->findCameraKeyframe(kKeyframeIndexShouldChanged);
+    CHECK(nanoemMotionCameraKeyframeGetAngle(k)[1] == Approx(1.2f));
+    SECTION("undo")
+    {
+        project->handleUndoAction();
+        nanoemMotionGetAllCameraKeyframeObjects(motion->data(), &numKeyframes);
+        CHECK(numKeyframes == kNumKeyframes);
+        k = motion->findCameraKeyframe(kKeyframeIndexShouldChanged);
+        CHECK(nanoemMotionCameraKeyframeGetAngle(k)[1] == Approx(0.2f));
+        CHECK(nanoemMotionCameraKeyframeGetDistance(k) == Approx(-42.0f - kKeyframeIndexShouldChanged));
+        k = motion->findCameraKeyframe(kKeyframeIndexShouldChanged + 1);
+        CHECK(nanoemMotionCameraKeyframeGetDistance(k) == Approx(-43.0f - kKeyframeIndexShouldChanged));
+        CHECK(project->canRedo());
+        SECTION("redo")
+        {
+            project->handleRedoAction();
+            nanoemMotionGetAllCameraKeyframeObjects(motion->data(), &numKeyframes);
+            CHECK(numKeyframes == kNumKeyframes);
+            k = motion->findCameraKeyframe(kKeyframeIndexShouldChanged);
+            CHECK(nanoemMotionCameraKeyframeGetAngle(k)[1] == Approx(1.2f));
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_motion_snapshot_keeps_only_changed_bone_keyframes", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    Model *activeModel = first->createModel();
+    project->addModel(activeModel);
+    project->setActiveModel(activeModel);
+    CommandRegistrator registrator(project);
+    const nanoem_model_bone_t *activeBonePtr = activeModel->activeBone();
+    model::Bone *activeBone = model::Bone::cast(activeBonePtr);
+    for (nanoem_frame_index_t i = 0; i < kNumKeyframes; i++) {
+        project->seek(i, true);
+        activeBone->setLocalUserTranslation(Vector3(i, 2, 3));
+        activeModel->performAllBonesTransform();
+        registrator.registerAddBoneKeyframesCommandBySelectedBoneSet(activeModel);
+    }
+    undoStackClear(project->undoStack());
+    Motion *motion = project->resolveMotion(activeModel);
+    ByteArray snapshot;
+    motion->save(snapshot, activeModel, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+    motion->selection()->addBoneKeyframes(activeBonePtr, kKeyframeIndexShouldChanged, kKeyframeIndexShouldChanged);
+    registrator.registerCorrectAllSelectedBoneKeyframesCommand(activeModel,
+        Motion::CorrectionVectorFactor(Vector3(1), Vector3(1)), Motion::CorrectionVectorFactor(), error);
+    CHECK(!error.hasReason());
+    CHECK(project->canUndo());
+    CHECK(project->undoMemoryUsage() > 0);
+    CHECK(project->undoMemoryUsage() < snapshot.size());
+    const nanoem_unicode_string_t *name = nanoemModelBoneGetName(activeBonePtr, NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
+    nanoem_rsize_t numKeyframes, numExpectedKeyframes;
+    nanoemMotionGetAllBoneKeyframeObjects(motion->data(), &numExpectedKeyframes);
+    const nanoem_motion_bone_keyframe_t *k = motion->findBoneKeyframe(name, kKeyframeIndexShouldChanged);
+    CHECK(nanoemMotionBoneKeyframeGetTranslation(k)[0] == Approx(kKeyframeIndexShouldChanged + 1.0f));
+    SECTION("undo")
+    {
+        project->handleUndoAction();
+        nanoemMotionGetAllBoneKeyframeObjects(motion->data(), &numKeyframes);
+        CHECK(numKeyframes == numExpectedKeyframes);
+        k = motion->findBoneKeyframe(name, kKeyframeIndexShouldChanged);
+        CHECK(nanoemMotionBoneKeyframeGetTranslation(k)[0] == Approx(kKeyframeIndexShouldChanged));
+        k = motion->findBoneKeyframe(name, kKeyframeIndexShouldChanged + 1);
+        CHECK(nanoemMotionBoneKeyframeGetTranslation(k)[0] == Approx(kKeyframeIndexShouldChanged + 1.0f));
+        SECTION("redo")
+        {
+            project->handleRedoAction();
+            nanoemMotionGetAllBoneKeyframeObjects(motion->data(), &numKeyframes);
+            CHECK(numKeyframes == numExpectedKeyframes);
+            k = motion->findBoneKeyframe(name, kKeyframeIndexShouldChanged);
+            CHECK(nanoemMotionBoneKeyframeGetTranslation(k)[0] == Approx(kKeyframeIndexShouldChanged + 1.0f));
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_motion_snapshot_keeps_only_changed_morph_keyframes", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    Model *activeModel = first->createModel();
+    project->addModel(activeModel);
+    project->setActiveModel(activeModel);
+    CommandRegistrator registrator(project);
+    const nanoem_model_morph_t *activeMorphPtr = TestScope::findRandomMorph(activeModel);
+    model::Morph *activeMorph = model::Morph::cast(activeMorphPtr);
+    for (nanoem_frame_index_t i = 0; i < kNumKeyframes; i++) {
+        project->seek(i, true);
+        activeMorph->setWeight(i / nanoem_f32_t(kNumKeyframes));
+        registrator.registerAddMorphKeyframesCommandByAllMorphs(activeModel);
+    }
+    undoStackClear(project->undoStack());
+    Motion *motion = project->resolveMotion(activeModel);
+    ByteArray snapshot;
+    motion->save(snapshot, activeModel, NANOEM_MUTABLE_MOTION_KEYFRAME_TYPE_ALL, error);
+    motion->selection()->addMorphKeyframes(activeMorphPtr, kKeyframeIndexShouldChanged, kKeyframeIndexShouldChanged);
+    registrator.registerCorrectAllSelectedMorphKeyframesCommand(
+        activeModel, Motion::CorrectionScalarFactor(0.5f, 0), error);
+    CHECK(!error.hasReason());
+    CHECK(project->canUndo());
+    CHECK(project->undoMemoryUsage() > 0);
+    CHECK(project->undoMemoryUsage() < snapshot.size());
+    const nanoem_unicode_string_t *name = nanoemModelMorphGetName(activeMorphPtr, NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
+    const nanoem_f32_t weight = kKeyframeIndexShouldChanged / nanoem_f32_t(kNumKeyframes);
+    nanoem_rsize_t numKeyframes, numExpectedKeyframes;
+    nanoemMotionGetAllMorphKeyframeObjects(motion->data(), &numExpectedKeyframes);
+    const nanoem_motion_morph_keyframe_t *k = motion->findMorphKeyframe(name, kKeyframeIndexShouldChanged);
+    CHECK(nanoemMotionMorphKeyframeGetWeight(k) == Approx(weight * 0.5f));
+    SECTION("undo")
+    {
+        project->handleUndoAction();
+        nanoemMotionGetAllMorphKeyframeObjects(motion->data(), &numKeyframes);
+        CHECK(numKeyframes == numExpectedKeyframes);
+        k = motion->findMorphKeyframe(name, kKeyframeIndexShouldChanged);
+        CHECK(nanoemMotionMorphKeyframeGetWeight(k) == Approx(weight));
+        SECTION("redo")
+        {
+            project->handleRedoAction();
+            nanoemMotionGetAllMorphKeyframeObjects(motion->data(), &numKeyframes);
+            CHECK(numKeyframes == numExpectedKeyframes);
+            k = motion->findMorphKeyframe(name, kKeyframeIndexShouldChanged);
+            CHECK(nanoemMotionMorphKeyframeGetWeight(k) == Approx(weight * 0.5f));
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_motion_snapshot_persists_changed_keyframes_to_redo", "[emapp][project]")
+{
+    TestScope scope;
+    Error error;
+    {
+        ProjectPtr first = scope.createProject();
+        Project *project = first->withRecoverable();
+        Model *activeModel = first->createModel();
+        project->addModel(activeModel);
+        project->setActiveModel(activeModel);
+        CommandRegistrator registrator(project);
+        const nanoem_model_bone_t *activeBonePtr = activeModel->activeBone();
+        model::Bone *activeBone = model::Bone::cast(activeBonePtr);
+        for (nanoem_frame_index_t i = 0; i < kNumKeyframes; i++) {
+            project->seek(i, true);
+            activeBone->setLocalUserTranslation(Vector3(i, 2, 3));
+            activeModel->performAllBonesTransform();
+            registrator.registerAddBoneKeyframesCommandBySelectedBoneSet(activeModel);
+        }
+        Motion *motion = project->resolveMotion(activeModel);
+        motion->selection()->addBoneKeyframes(activeBonePtr, kKeyframeIndexShouldChanged, kKeyframeIndexShouldChanged);
+        registrator.registerCorrectAllSelectedBoneKeyframesCommand(activeModel,
+            Motion::CorrectionVectorFactor(Vector3(1), Vector3(1)), Motion::CorrectionVectorFactor(), error);
+        CHECK(!error.hasReason());
+    }
+    {
+        ProjectPtr second = scope.createProject();
+        Project *project = second->m_project;
+        scope.recover(project);
+        Model *activeModel = project->activeModel();
+        REQUIRE(activeModel);
+        const nanoem_unicode_string_t *name =
+            nanoemModelBoneGetName(activeModel->activeBone(), NANOEM_LANGUAGE_TYPE_FIRST_ENUM);
+        Motion *motion = project->resolveMotion(activeModel);
+        for (nanoem_frame_index_t i = 0; i < kNumKeyframes; i++) {
+            const nanoem_motion_bone_keyframe_t *k = motion->findBoneKeyframe(name, i);
+            REQUIRE(k);
+            CHECK(nanoemMotionBoneKeyframeGetTranslation(k)[0] ==
+                Approx(i == kKeyframeIndexShouldChanged ? i + 1.0f : nanoem_f32_t(i)));
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
@@ -0,0 +1,71 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/emapp.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef tinystl::vector<Matrix4x4, TinySTLAllocator> Matrix4x4List;
+
+static void
+collectAllBoneTransforms(Model *const *models, nanoem_rsize_t numModels, Matrix4x4List &transforms)
+{
+    transforms.clear();
+    for (nanoem_rsize_t i = 0; i < numModels; i++) {
+        nanoem_rsize_t numBones;
+        nanoem_model_bone_t *const *bones = nanoemModelGetAllBoneObjects(models[i]->data(), &numBones);
+        for (nanoem_rsize_t j = 0; j < numBones; j++) {
+            transforms.push_back(model::Bone::cast(bones[j])->worldTransform());
+        }
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_parallel_motion_synchronization_should_match_serial", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->withRecoverable();
+    CommandRegistrator registrator(project);
+    Model *models[4];
+    for (nanoem_rsize_t i = 0; i < BX_COUNTOF(models); i++) {
+        Model *model = models[i] = first->createModel();
+        project->addModel(model);
+        model::Bone *bone = model::Bone::cast(model->activeBone());
+        bone->setLocalUserTranslation(Vector3(i + 1, 2, 3));
+        bone->setDirty(true);
+        model->performAllBonesTransform();
+        registrator.registerAddBoneKeyframesCommandBySelectedBoneSet(model);
+    }
+    /* the third model must wait for the first one since it follows a bone of the first one */
+    const model::Bone *parentBone = model::Bone::cast(models[0]->activeBone());
+    models[2]->setOutsideParent(models[2]->activeBone(), StringPair(models[0]->name(), parentBone->name()));
+    Matrix4x4List expected, actual;
+    /* the parallel path is opt-in so the serial one is used by default */
+    CHECK_FALSE(project->isParallelMotionSynchronizationEnabled());
+    project->synchronizeAllMotions(10, 0, PhysicsEngine::kSimulationTimingBefore);
+    project->synchronizeAllMotions(10, 0, PhysicsEngine::kSimulationTimingAfter);
+    collectAllBoneTransforms(models, BX_COUNTOF(models), expected);
+    project->setParallelMotionSynchronizationEnabled(true);
+    CHECK(project->isParallelMotionSynchronizationEnabled());
+    for (int i = 0; i < 8; i++) {
+        project->synchronizeAllMotions(10, 0, PhysicsEngine::kSimulationTimingBefore);
+        project->synchronizeAllMotions(10, 0, PhysicsEngine::kSimulationTimingAfter);
+        collectAllBoneTransforms(models, BX_COUNTOF(models), actual);
+        REQUIRE(actual.size() == expected.size());
+        nanoem_rsize_t numMismatches = 0;
+        for (nanoem_rsize_t j = 0, numTransforms = expected.size(); j < numTransforms; j++) {
+            numMismatches += actual[j] != expected[j] ? 1 : 0;
+        }
+        CHECK(numMismatches == 0);
+    }
+}
@@ -0,0 +1,129 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/PhysicsEngine.h"
+#include "emapp/internal/project/PhysicsCheckpointCache.h"
+#include "emapp/model/RigidBody.h"
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+typedef std::vector<Matrix4x4> RigidBodyTransformList;
+
+static void
+getAllRigidBodyTransforms(const Model *model, RigidBodyTransformList &transforms)
+{
+    nanoem_rsize_t numRigidBodies;
+    nanoem_model_rigid_body_t *const *rigidBodies = nanoemModelGetAllRigidBodyObjects(model->data(), &numRigidBodies);
+    transforms.clear();
+    for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+        transforms.push_back(model::RigidBody::cast(rigidBodies[i])->worldTransform());
+    }
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_physics_checkpoint_cache_should_record_while_seeking_forward", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    const internal::project::PhysicsCheckpointCache *cache = project->physicsCheckpointCache();
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableTracing);
+    CHECK(project->isPhysicsCheckpointCacheEnabled());
+    Model *model = first->createModel();
+    project->addModel(model);
+    project->restart(0);
+    for (nanoem_frame_index_t i = 1; i <= 90; i++) {
+        project->seek(i, true);
+    }
+    /* one checkpoint is taken per interval */
+    CHECK(cache->countAllCheckpoints() == 4);
+    CHECK(cache->isContinuous(90));
+    SECTION("seeking backward restores the checkpoint")
+    {
+        project->seek(45, true);
+        CHECK(cache->countAllCheckpoints() == 4);
+        CHECK(cache->isContinuous(45));
+        project->seek(46, true);
+        CHECK(cache->isContinuous(46));
+    }
+    SECTION("seeking forward replays frames from the current state")
+    {
+        project->seek(120, true);
+        CHECK(cache->isContinuous(120));
+        CHECK(cache->countAllCheckpoints() == 5);
+    }
+    SECTION("seeking forward beyond the max number of replay frames breaks continuity")
+    {
+        const nanoem_frame_index_t frameIndex = 90 + cache->maxNumReplayFrames() + 1;
+        project->seek(frameIndex, true);
+        CHECK_FALSE(cache->isContinuous(frameIndex));
+        CHECK(cache->countAllCheckpoints() == 4);
+    }
+    SECTION("seeking backward restores the nearest checkpoint at any distance")
+    {
+        /* frames replayed while seeking forward are not saved so the nearest checkpoint of 170 is 90 */
+        project->seek(200, true);
+        CHECK(cache->countAllCheckpoints() == 5);
+        nanoem_frame_index_t found;
+        CHECK(cache->findNearest(170, found));
+        CHECK(found == 90);
+        project->seek(170, true);
+        CHECK(cache->isContinuous(170));
+    }
+    SECTION("removing the model clears all checkpoints")
+    {
+        project->removeModel(model);
+        CHECK(cache->countAllCheckpoints() == 0);
+        project->destroyModel(model);
+    }
+    SECTION("simulating physics in realtime clears all checkpoints")
+    {
+        project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableAnytime);
+        CHECK_FALSE(project->isPhysicsCheckpointCacheEnabled());
+        CHECK(cache->countAllCheckpoints() == 0);
+        project->seek(1, true);
+        CHECK(cache->countAllCheckpoints() == 0);
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
+
+TEST_CASE("project_physics_checkpoint_cache_should_restore_same_rigid_bodies_as_playing", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    const internal::project::PhysicsCheckpointCache *cache = project->physicsCheckpointCache();
+    project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableTracing);
+    Model *model = first->createModel();
+    project->addModel(model);
+    project->restart(0);
+    RigidBodyTransformList expected, actual;
+    for (nanoem_frame_index_t i = 1; i <= 90; i++) {
+        project->seek(i, true);
+        if (i == 45) {
+            getAllRigidBodyTransforms(model, expected);
+        }
+    }
+    REQUIRE_FALSE(expected.empty());
+    /* seeking back replays frames from the checkpoint at 30 and must reproduce the simulation of playing */
+    project->seek(45, true);
+    CHECK(cache->isContinuous(45));
+    getAllRigidBodyTransforms(model, actual);
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0, numTransforms = expected.size(); i < numTransforms; i++) {
+        for (int j = 0; j < 4; j++) {
+            CHECK(glm::all(glm::epsilonEqual(actual[i][j], expected[i][j], Vector4(0.0001f))));
+        }
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
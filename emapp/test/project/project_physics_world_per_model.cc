@@ -0,0 +1,68 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "emapp/Model.h"
+#include "emapp/PhysicsEngine.h"
+#include "emapp/model/RigidBody.h"
+
+using namespace nanoem;
+using namespace test;
+
+TEST_CASE("project_physics_world_per_model_should_bind_model_to_island", "[emapp][project]")
+{
+    TestScope scope;
+    ProjectPtr first = scope.createProject();
+    Project *project = first->m_project;
+    PhysicsEngine *engine = project->physicsEngine();
+    project->setPhysicsWorldPerModelEnabled(true);
+    CHECK(project->isPhysicsWorldPerModelEnabled());
+    Model *isolatedModel = first->createModel();
+    project->addModel(isolatedModel);
+    CHECK(engine->countAllIslands() == 1);
+    const PhysicsEngine *island = engine->findIsland(isolatedModel->data());
+    CHECK(island != engine);
+    nanoem_rsize_t numRigidBodies;
+    nanoem_model_rigid_body_t *const *rigidBodies =
+        nanoemModelGetAllRigidBodyObjects(isolatedModel->data(), &numRigidBodies);
+    for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+        CHECK(model::RigidBody::cast(rigidBodies[i])->physicsEngine() == island);
+    }
+    project->setPhysicsWorldPerModelEnabled(false);
+    Model *sharedModel = first->createModel();
+    project->addModel(sharedModel);
+    CHECK(engine->countAllIslands() == 1);
+    CHECK(engine->findIsland(sharedModel->data()) == engine);
+    rigidBodies = nanoemModelGetAllRigidBodyObjects(sharedModel->data(), &numRigidBodies);
+    for (nanoem_rsize_t i = 0; i < numRigidBodies; i++) {
+        CHECK(model::RigidBody::cast(rigidBodies[i])->physicsEngine() == engine);
+    }
+    project->performPhysicsSimulationOnce();
+    SECTION("settings of the parent are propagated to the island")
+    {
+        engine->setGroundEnabled(!engine->isGroundEnabled());
+        CHECK(island->isGroundEnabled() == engine->isGroundEnabled());
+        engine->setParallelSimulationEnabled(!engine->isParallelSimulationEnabled());
+        CHECK(island->isParallelSimulationEnabled() == engine->isParallelSimulationEnabled());
+    }
+    SECTION("interpolation of the island follows the simulation mode")
+    {
+        project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnablePlaying);
+        CHECK(engine->isInterpolationEnabled());
+        CHECK(island->isInterpolationEnabled());
+        project->setPhysicsSimulationMode(PhysicsEngine::kSimulationModeEnableTracing);
+        CHECK_FALSE(engine->isInterpolationEnabled());
+        CHECK_FALSE(island->isInterpolationEnabled());
+    }
+    SECTION("destroying the model destroys its island")
+    {
+        project->removeModel(isolatedModel);
+        project->destroyModel(isolatedModel);
+        CHECK(engine->countAllIslands() == 0);
+    }
+    CHECK_FALSE(scope.hasAnyError());
+}
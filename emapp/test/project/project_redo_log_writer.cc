@@ -0,0 +1,209 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of emapp component and it's licensed under Mozilla Public License. see LICENSE.md for more details.
+ */
+
+#include "../common.h"
+
+#include "../../src/protoc/application.pb-c.h"
+#include "emapp/FileUtils.h"
+#include "emapp/URI.h"
+#include "emapp/internal/project/Redo.h"
+#include "emapp/internal/project/RedoLogWriter.h"
+
+#include "lz4/lib/lz4.h"
+
+#include <chrono>
+
+using namespace nanoem;
+using namespace test;
+
+namespace {
+
+static const char kRedoLogWriterPath[] = "test_redo_log_writer.redo";
+static const nanoem_u32_t kLongSyncInterval = 60000;
+
+struct RedoRecord {
+    nanoem_u32_t m_sequence;
+    nanoem_u16_t m_type;
+    nanoem_u32_t m_size;
+    ByteArray m_bytes;
+};
+using RedoRecordList = std::vector<RedoRecord>;
+
+static void
+enqueueSetActiveModel(internal::project::RedoLogWriter &writer, nanoem_u32_t sequence)
+{
+    Nanoem__Application__SetActiveModelCommand base = NANOEM__APPLICATION__SET_ACTIVE_MODEL_COMMAND__INIT;
+    Nanoem__Application__Command command = NANOEM__APPLICATION__COMMAND__INIT;
+    base.model_handle = sequence + 1;
+    command.type_case = NANOEM__APPLICATION__COMMAND__TYPE_SET_ACTIVE_MODEL;
+    command.set_active_model = &base;
+    writer.enqueue(sequence, &command);
+}
+
+static nanoem_u32_t
+unpackModelHandle(const RedoRecord &record)
+{
+    ByteArray bytes;
+    if ((record.m_size & internal::project::Redo::kUncompressedRecordFlag) != 0) {
+        bytes = record.m_bytes;
+    }
+    else {
+        bytes.resize(0x1000);
+        int size = LZ4_decompress_safe(reinterpret_cast<const char *>(record.m_bytes.data()),
+            reinterpret_cast<char *>(bytes.data()), int(record.m_bytes.size()), int(bytes.size()));
+        bytes.resize(size > 0 ? size : 0);
+    }
+    nanoem_u32_t handle = 0;
+    if (Nanoem__Application__Command *command =
+            nanoem__application__command__unpack(nullptr, bytes.size(), bytes.data())) {
+        if (command->type_case == NANOEM__APPLICATION__COMMAND__TYPE_SET_ACTIVE_MODEL) {
+            handle = command->set_active_model->model_handle;
+        }
+        nanoem__application__command__free_unpacked(command, nullptr);
+    }
+    return handle;
+}
+
+static bool
+readAllRedoRecords(RedoRecordList &records)
+{
+    bool result = false;
+    records.clear();
+    if (FILE *fp = fopen(kRedoLogWriterPath, "rb")) {
+        nanoem_u32_t magic = 0;
+        result = fread(&magic, sizeof(magic), 1, fp) == 1 && magic == internal::project::Redo::kFileMagic;
+        RedoRecord record;
+        while (result && fread(&record.m_sequence, sizeof(record.m_sequence), 1, fp) == 1) {
+            result = fread(&record.m_type, sizeof(record.m_type), 1, fp) == 1 &&
+                fread(&record.m_size, sizeof(record.m_size), 1, fp) == 1;
+            if (result) {
+                record.m_bytes.resize(record.m_size & ~internal::project::Redo::kUncompressedRecordFlag);
+                result = fread(record.m_bytes.data(), 1, record.m_bytes.size(), fp) == record.m_bytes.size();
+                records.push_back(record);
+            }
+        }
+        fclose(fp);
+    }
+    return result;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("project_redo_log_writer_should_write_records_in_order", "[emapp][project]")
+{
+    static const nanoem_u32_t kNumRecords = internal::project::RedoLogWriter::kMaxNumRecords * 4;
+    TestScope scope;
+    Error error;
+    scope.deleteFile(kRedoLogWriterPath);
+    {
+        internal::project::RedoLogWriter writer;
+        CHECK(writer.open(URI::createFromFilePath(kRedoLogWriterPath), error));
+        writer.setSyncInterval(0);
+        for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+            enqueueSetActiveModel(writer, i);
+        }
+        writer.close(error);
+        CHECK_FALSE(writer.isOpened());
+        CHECK_FALSE(error.hasReason());
+    }
+    RedoRecordList records;
+    REQUIRE(readAllRedoRecords(records));
+    REQUIRE(records.size() == kNumRecords);
+    for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+        const RedoRecord &record = records[i];
+        CHECK(record.m_sequence == i);
+        CHECK(record.m_type == NANOEM__APPLICATION__COMMAND__TYPE_SET_ACTIVE_MODEL);
+        CHECK((record.m_size & internal::project::Redo::kUncompressedRecordFlag) == 0);
+        CHECK(unpackModelHandle(record) == i + 1);
+    }
+    scope.deleteFile(kRedoLogWriterPath);
+}
+
+TEST_CASE("project_redo_log_writer_flush_should_wait_for_sync", "[emapp][project]")
+{
+    static const nanoem_u32_t kNumRecords = 16;
+    TestScope scope;
+    Error error;
+    scope.deleteFile(kRedoLogWriterPath);
+    internal::project::RedoLogWriter writer;
+    REQUIRE(writer.open(URI::createFromFilePath(kRedoLogWriterPath), error));
+    /* records must be synced by the flush request instead of the expiration of the sync interval */
+    writer.setSyncInterval(kLongSyncInterval);
+    const auto start = std::chrono::steady_clock::now();
+    for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+        enqueueSetActiveModel(writer, i);
+    }
+    writer.flush();
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CHECK(elapsed < kLongSyncInterval);
+    CHECK(writer.isOpened());
+    RedoRecordList records;
+    REQUIRE(readAllRedoRecords(records));
+    REQUIRE(records.size() == kNumRecords);
+    for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+        CHECK(records[i].m_sequence == i);
+    }
+    writer.close(error);
+    CHECK_FALSE(error.hasReason());
+    scope.deleteFile(kRedoLogWriterPath);
+}
+
+TEST_CASE("project_redo_log_writer_close_should_drain_all_records", "[emapp][project]")
+{
+    static const nanoem_u32_t kNumRecords = internal::project::RedoLogWriter::kMaxNumRecords + 1;
+    TestScope scope;
+    Error error;
+    scope.deleteFile(kRedoLogWriterPath);
+    {
+        internal::project::RedoLogWriter writer;
+        REQUIRE(writer.open(URI::createFromFilePath(kRedoLogWriterPath), error));
+        writer.setSyncInterval(kLongSyncInterval);
+        for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+            enqueueSetActiveModel(writer, i);
+        }
+        /* no flush is requested so remaining records are written only by closing */
+        writer.close(error);
+        CHECK_FALSE(error.hasReason());
+    }
+    RedoRecordList records;
+    REQUIRE(readAllRedoRecords(records));
+    REQUIRE(records.size() == kNumRecords);
+    CHECK(records.back().m_sequence == kNumRecords - 1);
+    CHECK(unpackModelHandle(records.back()) == kNumRecords);
+    scope.deleteFile(kRedoLogWriterPath);
+}
+
+TEST_CASE("project_redo_log_writer_should_write_raw_records_without_compression", "[emapp][project]")
+{
+    static const nanoem_u32_t kNumRecords = 8;
+    TestScope scope;
+    Error error;
+    scope.deleteFile(kRedoLogWriterPath);
+    {
+        internal::project::RedoLogWriter writer;
+        REQUIRE(writer.open(URI::createFromFilePath(kRedoLogWriterPath), error));
+        writer.setCompressionEnabled(false);
+        CHECK_FALSE(writer.isCompressionEnabled());
+        for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+            enqueueSetActiveModel(writer, i);
+        }
+        writer.close(error);
+        CHECK_FALSE(error.hasReason());
+    }
+    RedoRecordList records;
+    /* raw records are only valid in redo files with the current file magic */
+    REQUIRE(readAllRedoRecords(records));
+    REQUIRE(records.size() == kNumRecords);
+    for (nanoem_u32_t i = 0; i < kNumRecords; i++) {
+        const RedoRecord &record = records[i];
+        CHECK(record.m_sequence == i);
+        CHECK((record.m_size & internal::project::Redo::kUncompressedRecordFlag) != 0);
+        CHECK(unpackModelHandle(record) == i + 1);
+    }
+    CHECK(internal::project::Redo::kFileMagic != internal::project::Redo::kLegacyFileMagic);
+    scope.deleteFile(kRedoLogWriterPath);
+}
@@ -9,12 +9,9 @@
 #include "emapp/Error.h"
 #include "emapp/ICamera.h"
 #include "emapp/Model.h"
+#include "emapp/TaskScheduler.h"
 #include "emapp/private/CommonInclude.h"
 
-#if defined(NANOEM_ENABLE_TBB)
-#include "tbb/tbb.h"
-#endif /* NANOEM_ENABLE_TBB */
-
 namespace nanoem {
 namespace glfw {
 namespace {
@@ -50,6 +47,18 @@ static const char *kTransformFeedbackOutput[] = {
 };
 
 struct BatchUpdateMatrixBufferRunner {
+    static void
+    handle(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        const BatchUpdateMatrixBufferRunner *self = static_cast<const BatchUpdateMatrixBufferRunner *>(opaque);
+        bx::float4x4_t *matrices = reinterpret_cast<bx::float4x4_t *>(self->m_bytes->data());
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            const model::Bone *bone = self->m_bones[i];
+            const bx::float4x4_t m = bone->skinningTransformMatrix();
+            memcpy(&matrices[i], &m, sizeof(*matrices));
+        }
+    }
+
     BatchUpdateMatrixBufferRunner(ByteArray *bytes, model::Bone *const *bones)
         : m_bytes(bytes)
         , m_bones(bones)
@@ -62,24 +71,8 @@ struct BatchUpdateMatrixBufferRunner {
     void
     execute(nanoem_rsize_t numBones)
     {
-        bx::float4x4_t *matrices = reinterpret_cast<bx::float4x4_t *>(m_bytes->data());
-        nanoem_parameter_assert(m_bytes->size() >= numBones * sizeof(*matrices), "must be bigger than capacity");
-#if defined(NANOEM_ENABLE_TBB)
-        tbb::parallel_for(tbb::blocked_range<nanoem_rsize_t>(0, numBones),
-            [this, matrices](const tbb::blocked_range<nanoem_rsize_t> &range) {
-                for (nanoem_rsize_t i = range.begin(), end = range.end(); i != end; i++) {
-                    const model::Bone *bone = m_bones[i];
-                    const bx::float4x4_t m = bone->skinningTransformMatrix();
-                    memcpy(&matrices[i], &m, sizeof(*matrices));
-                }
-            });
-#else
-        for (nanoem_rsize_t i = 0; i < numBones; i++) {
-            const model::Bone *bone = m_bones[i];
-            const bx::float4x4_t m = bone->skinningTransformMatrix();
-            memcpy(&matrices[i], &m, sizeof(matrices[0]));
-        }
-#endif /* NANOEM_ENABLE_TBB */
+        nanoem_parameter_assert(m_bytes->size() >= numBones * sizeof(bx::float4x4_t), "must be bigger than capacity");
+        TaskScheduler::sharedInstance()->parallelFor(handle, this, numBones);
     }
 
     ByteArray *m_bytes;
@@ -87,6 +80,19 @@ struct BatchUpdateMatrixBufferRunner {
 };
 
 struct BatchUpdateVertexDeltaBufferRunner {
+    static void
+    handle(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        const BatchUpdateVertexDeltaBufferRunner *self =
+            static_cast<const BatchUpdateVertexDeltaBufferRunner *>(opaque);
+        bx::simd128_t *vertexDeltas = reinterpret_cast<bx::simd128_t *>(self->m_bytes->data());
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            model::Vertex *vertex = self->m_vertexDeltas[i];
+            vertexDeltas[i] = vertex->m_simd.m_delta;
+            vertex->reset();
+        }
+    }
+
     BatchUpdateVertexDeltaBufferRunner(ByteArray *bytes, model::Vertex *const *vertices)
         : m_bytes(bytes)
         , m_vertexDeltas(vertices)
@@ -99,23 +105,7 @@ struct BatchUpdateVertexDeltaBufferRunner {
     void
     execute(nanoem_rsize_t numVertices)
     {
-        bx::simd128_t *vertexDeltas = reinterpret_cast<bx::simd128_t *>(m_bytes->data());
-#if defined(NANOEM_ENABLE_TBB)
-        tbb::parallel_for(tbb::blocked_range<nanoem_rsize_t>(0, numVertices),
-            [this, vertexDeltas](const tbb::blocked_range<nanoem_rsize_t> &range) {
-                for (nanoem_rsize_t i = range.begin(), end = range.end(); i != end; i++) {
-                    model::Vertex *vertex = m_vertexDeltas[i];
-                    vertexDeltas[i] = vertex->m_simd.m_delta;
-                    vertex->reset();
-                }
-            });
-#else
-        for (nanoem_rsize_t i = 0; i < numVertices; i++) {
-            model::Vertex *vertex = m_vertexDeltas[i];
-            vertexDeltas[i] = vertex->m_simd.m_delta;
-            vertex->reset();
-        }
-#endif /* NANOEM_ENABLE_TBB */
+        TaskScheduler::sharedInstance()->parallelFor(handle, this, numVertices);
     }
 
     ByteArray *m_bytes;
@@ -11,15 +11,86 @@
 #include <unicode/ucnv.h>
 #include <unicode/ustring.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+typedef SRWLOCK nanoem_icu_mutex_t;
+#define nanoem_icu_mutex_init(mutex) InitializeSRWLock((mutex))
+#define nanoem_icu_mutex_lock(mutex) AcquireSRWLockExclusive((mutex))
+#define nanoem_icu_mutex_unlock(mutex) ReleaseSRWLockExclusive((mutex))
+#define nanoem_icu_mutex_destroy(mutex)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t nanoem_icu_mutex_t;
+#define nanoem_icu_mutex_init(mutex) pthread_mutex_init((mutex), NULL)
+#define nanoem_icu_mutex_lock(mutex) pthread_mutex_lock((mutex))
+#define nanoem_icu_mutex_unlock(mutex) pthread_mutex_unlock((mutex))
+#define nanoem_icu_mutex_destroy(mutex) pthread_mutex_destroy((mutex))
+#endif
+
+/* UChar units converted on stack before interning, longer strings are converted on heap */
+#define NANOEM_ICU_STACK_BUFFER_CAPACITY 256
+#define NANOEM_ICU_ATOM_TABLE_INITIAL_CAPACITY 1024
+
+typedef enum nanoem_icu_converter_type_t {
+    NANOEM_ICU_CONVERTER_TYPE_CP932,
+    NANOEM_ICU_CONVERTER_TYPE_UTF8,
+    NANOEM_ICU_CONVERTER_TYPE_UTF16,
+    NANOEM_ICU_CONVERTER_TYPE_MAX_ENUM
+} nanoem_icu_converter_type_t;
+
+static const char *const __nanoem_icu_converter_names[NANOEM_ICU_CONVERTER_TYPE_MAX_ENUM] = {
+    "cp932",
+    "utf8",
+    "utf16le"
+};
+
+/*
+ * UConverter is stateful and must not be shared between threads, so each converter is checked out from the
+ * per codec pool and returned after the conversion. The pool grows up to the number of concurrent threads
+ */
+typedef struct nanoem_icu_converter_pool_t nanoem_icu_converter_pool_t;
+struct nanoem_icu_converter_pool_t {
+    UConverter **items;
+    nanoem_rsize_t num_items;
+    nanoem_rsize_t capacity;
+};
+
+/*
+ * each distinct string is stored once and identified by the atom that is the index of the entry plus one.
+ * entries are reference counted by strings and freed entries are reused by the next interned string
+ */
+typedef struct nanoem_icu_atom_entry_t nanoem_icu_atom_entry_t;
+struct nanoem_icu_atom_entry_t {
+    UChar *data;
+    int length;
+    nanoem_u32_t hash;
+    nanoem_u32_t num_references;
+    nanoem_u32_t next_free_atom;
+};
+
+typedef struct nanoem_icu_atom_table_t nanoem_icu_atom_table_t;
+struct nanoem_icu_atom_table_t {
+    nanoem_icu_atom_entry_t *entries;
+    nanoem_rsize_t num_entries;
+    nanoem_rsize_t num_alive_entries;
+    nanoem_rsize_t entry_capacity;
+    nanoem_u32_t *buckets;
+    nanoem_rsize_t num_buckets;
+    nanoem_u32_t free_atom;
+};
+
 struct nanoem_unicode_factory_opaque_data_icu_t {
-    UConverter *cp932;
-    UConverter *utf8;
-    UConverter *utf16;
+    nanoem_icu_mutex_t converter_lock;
+    nanoem_icu_mutex_t atom_lock;
+    nanoem_icu_converter_pool_t converters[NANOEM_ICU_CONVERTER_TYPE_MAX_ENUM];
+    nanoem_icu_atom_table_t atoms;
 };
 
 struct nanoem_unicode_string_icu_t {
-    UChar *data;
+    const UChar *data;
     int length;
+    nanoem_u32_t atom;
+    nanoem_u32_t hash;
     struct nanoem_unicode_string_icu_cache_t {
         nanoem_u8_t *data;
         nanoem_rsize_t length;
@@ -99,18 +170,244 @@ MurmurHash(const void *key, int len, unsigned int seed)
     return h;
 }
 
+static UConverter *
+nanoemICUConverterPoolAcquire(nanoem_unicode_factory_opaque_data_icu_t *opaque, nanoem_icu_converter_type_t type)
+{
+    nanoem_icu_converter_pool_t *pool = &opaque->converters[type];
+    UConverter *converter = NULL;
+    UErrorCode code = U_ZERO_ERROR;
+    nanoem_icu_mutex_lock(&opaque->converter_lock);
+    if (pool->num_items > 0) {
+        converter = pool->items[--pool->num_items];
+    }
+    nanoem_icu_mutex_unlock(&opaque->converter_lock);
+    if (nanoem_is_null(converter)) {
+        converter = ucnv_open(__nanoem_icu_converter_names[type], &code);
+    }
+    return converter;
+}
+
+static void
+nanoemICUConverterPoolRelease(nanoem_unicode_factory_opaque_data_icu_t *opaque, nanoem_icu_converter_type_t type, UConverter *converter)
+{
+    nanoem_icu_converter_pool_t *pool = &opaque->converters[type];
+    UConverter **items;
+    nanoem_rsize_t capacity;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    if (nanoem_is_null(converter)) {
+        return;
+    }
+    ucnv_reset(converter);
+    nanoem_icu_mutex_lock(&opaque->converter_lock);
+    if (pool->num_items >= pool->capacity) {
+        capacity = pool->capacity > 0 ? pool->capacity * 2 : 4;
+        items = (UConverter **) nanoem_realloc(pool->items, capacity * sizeof(*items), &status);
+        if (nanoem_is_not_null(items)) {
+            pool->items = items;
+            pool->capacity = capacity;
+        }
+    }
+    if (pool->num_items < pool->capacity) {
+        pool->items[pool->num_items++] = converter;
+        converter = NULL;
+    }
+    nanoem_icu_mutex_unlock(&opaque->converter_lock);
+    if (nanoem_is_not_null(converter)) {
+        ucnv_close(converter);
+    }
+}
+
+static void
+nanoemICUConverterPoolDestroy(nanoem_icu_converter_pool_t *pool)
+{
+    nanoem_rsize_t i;
+    for (i = 0; i < pool->num_items; i++) {
+        ucnv_close(pool->items[i]);
+    }
+    nanoem_free(pool->items);
+    pool->items = NULL;
+    pool->num_items = pool->capacity = 0;
+}
+
+static nanoem_bool_t
+nanoemICUAtomTableRehash(nanoem_icu_atom_table_t *table, nanoem_rsize_t num_buckets, nanoem_status_t *status)
+{
+    nanoem_u32_t *buckets;
+    nanoem_rsize_t i, j, mask = num_buckets - 1;
+    buckets = (nanoem_u32_t *) nanoem_calloc(num_buckets, sizeof(*buckets), status);
+    if (nanoem_is_null(buckets)) {
+        return nanoem_false;
+    }
+    for (i = 0; i < table->num_entries; i++) {
+        if (nanoem_is_null(table->entries[i].data)) {
+            continue;
+        }
+        j = table->entries[i].hash & mask;
+        while (buckets[j] != 0) {
+            j = (j + 1) & mask;
+        }
+        buckets[j] = (nanoem_u32_t) (i + 1);
+    }
+    nanoem_free(table->buckets);
+    table->buckets = buckets;
+    table->num_buckets = num_buckets;
+    return nanoem_true;
+}
+
+static const nanoem_icu_atom_entry_t *
+nanoemICUAtomTableIntern(nanoem_icu_atom_table_t *table, const UChar *data, int length, nanoem_u32_t hash, nanoem_u32_t *atom, nanoem_status_t *status)
+{
+    nanoem_icu_atom_entry_t *entry, *entries;
+    nanoem_rsize_t i, mask, capacity, index;
+    UChar *interned;
+    if ((table->num_alive_entries + 1) * 2 > table->num_buckets
+        && !nanoemICUAtomTableRehash(table, table->num_buckets > 0 ? table->num_buckets * 2 : NANOEM_ICU_ATOM_TABLE_INITIAL_CAPACITY, status)) {
+        return NULL;
+    }
+    mask = table->num_buckets - 1;
+    for (i = hash & mask; table->buckets[i] != 0; i = (i + 1) & mask) {
+        entry = &table->entries[table->buckets[i] - 1];
+        if (entry->hash == hash && entry->length == length && nanoem_crt_memcmp(entry->data, data, length * sizeof(*data)) == 0) {
+            entry->num_references++;
+            *atom = table->buckets[i];
+            return entry;
+        }
+    }
+    if (table->free_atom == 0 && table->num_entries >= table->entry_capacity) {
+        capacity = table->entry_capacity > 0 ? table->entry_capacity * 2 : NANOEM_ICU_ATOM_TABLE_INITIAL_CAPACITY / 2;
+        entries = (nanoem_icu_atom_entry_t *) nanoem_realloc(table->entries, capacity * sizeof(*entries), status);
+        if (nanoem_is_null(entries)) {
+            return NULL;
+        }
+        table->entries = entries;
+        table->entry_capacity = capacity;
+    }
+    interned = (UChar *) nanoem_calloc(length + 1, sizeof(*interned), status);
+    if (nanoem_is_null(interned)) {
+        return NULL;
+    }
+    nanoem_crt_memcpy(interned, data, length * sizeof(*data));
+    if (table->free_atom != 0) {
+        index = table->free_atom - 1;
+        table->free_atom = table->entries[index].next_free_atom;
+    }
+    else {
+        index = table->num_entries++;
+    }
+    entry = &table->entries[index];
+    entry->data = interned;
+    entry->length = length;
+    entry->hash = hash;
+    entry->num_references = 1;
+    entry->next_free_atom = 0;
+    table->num_alive_entries++;
+    table->buckets[i] = *atom = (nanoem_u32_t) (index + 1);
+    return entry;
+}
+
+static void
+nanoemICUAtomTableRelease(nanoem_icu_atom_table_t *table, nanoem_u32_t atom)
+{
+    nanoem_icu_atom_entry_t *entry;
+    nanoem_rsize_t i, j, k, mask;
+    if (atom == 0 || atom > table->num_entries) {
+        return;
+    }
+    entry = &table->entries[atom - 1];
+    if (--entry->num_references > 0) {
+        return;
+    }
+    mask = table->num_buckets - 1;
+    for (i = entry->hash & mask; table->buckets[i] != atom; i = (i + 1) & mask) {
+    }
+    /* backward shift deletion keeps every probe sequence unbroken without tombstones */
+    for (j = i;;) {
+        j = (j + 1) & mask;
+        if (table->buckets[j] == 0) {
+            break;
+        }
+        k = table->entries[table->buckets[j] - 1].hash & mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        table->buckets[i] = table->buckets[j];
+        i = j;
+    }
+    table->buckets[i] = 0;
+    nanoem_free(entry->data);
+    entry->data = NULL;
+    entry->length = 0;
+    entry->next_free_atom = table->free_atom;
+    table->free_atom = atom;
+    table->num_alive_entries--;
+}
+
+static void
+nanoemICUAtomTableDestroy(nanoem_icu_atom_table_t *table)
+{
+    nanoem_rsize_t i;
+    for (i = 0; i < table->num_entries; i++) {
+        nanoem_free(table->entries[i].data);
+    }
+    nanoem_free(table->entries);
+    nanoem_free(table->buckets);
+    table->entries = NULL;
+    table->buckets = NULL;
+    table->num_entries = table->num_alive_entries = table->entry_capacity = table->num_buckets = 0;
+    table->free_atom = 0;
+}
+
 static nanoem_unicode_string_icu_t *
-nanoemUnicodeStringFactoryFromStringICU(UConverter *converter, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
+nanoemUnicodeStringFactoryFromStringICU(nanoem_unicode_factory_opaque_data_icu_t *opaque, nanoem_icu_converter_type_t type, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
-    nanoem_unicode_string_icu_t *s;
+    UChar stack_buffer[NANOEM_ICU_STACK_BUFFER_CAPACITY], *buffer = stack_buffer;
+    const nanoem_icu_atom_entry_t *entry = NULL;
+    nanoem_unicode_string_icu_t *s = NULL;
+    UConverter *converter;
     UErrorCode code = U_ZERO_ERROR;
-    int capacity = length * ucnv_getMinCharSize(converter) + 1;
-    s = (nanoem_unicode_string_icu_t *) nanoem_calloc(1, sizeof(*s), status);
-    if (nanoem_is_not_null(s)) {
-        s->data = (UChar *) nanoem_calloc(capacity, sizeof(*s->data), status);
-        s->length = ucnv_toUChars(converter, s->data, capacity, (const char *) string, length, &code);
-        nanoem_status_ptr_assign(status, U_SUCCESS(code) == TRUE ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+    nanoem_u32_t atom = 0;
+    int capacity, converted_length;
+    converter = nanoemICUConverterPoolAcquire(opaque, type);
+    if (nanoem_is_null(converter)) {
+        nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+        return NULL;
+    }
+    capacity = length * ucnv_getMinCharSize(converter) + 1;
+    if (capacity > NANOEM_ICU_STACK_BUFFER_CAPACITY) {
+        buffer = (UChar *) nanoem_calloc(capacity, sizeof(*buffer), status);
+    }
+    if (nanoem_is_not_null(buffer)) {
+        converted_length = ucnv_toUChars(converter, buffer, capacity, (const char *) string, length, &code);
+        if (U_SUCCESS(code)) {
+            /* the hash is computed once with the same terminated range as comparison */
+            const nanoem_u32_t hash = MurmurHash(buffer, u_strlen(buffer) * sizeof(*buffer), 0);
+            nanoem_icu_mutex_lock(&opaque->atom_lock);
+            entry = nanoemICUAtomTableIntern(&opaque->atoms, buffer, converted_length, hash, &atom, status);
+            nanoem_icu_mutex_unlock(&opaque->atom_lock);
+        }
+        if (nanoem_is_not_null(entry)) {
+            s = (nanoem_unicode_string_icu_t *) nanoem_calloc(1, sizeof(*s), status);
+            if (nanoem_is_not_null(s)) {
+                s->data = entry->data;
+                s->length = entry->length;
+                s->hash = entry->hash;
+                s->atom = atom;
+                nanoem_status_ptr_assign_succeeded(status);
+            }
+            else {
+                nanoem_icu_mutex_lock(&opaque->atom_lock);
+                nanoemICUAtomTableRelease(&opaque->atoms, atom);
+                nanoem_icu_mutex_unlock(&opaque->atom_lock);
+            }
+        }
+        else {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_DECODE_UNICODE_STRING_FAILED);
+        }
+        if (buffer != stack_buffer) {
+            nanoem_free(buffer);
+        }
     }
+    nanoemICUConverterPoolRelease(opaque, type, converter);
     return s;
 }
 
@@ -128,15 +425,23 @@ nanoemUnicodeStringFactoryToStringICU(UConverter *converter, const nanoem_unicod
 }
 
 static nanoem_u8_t *
-nanoemUnicodeStringFactoryToStringOnHeapICU(UConverter *converter, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_status_t *status)
+nanoemUnicodeStringFactoryToStringOnHeapICU(nanoem_unicode_factory_opaque_data_icu_t *opaque, nanoem_icu_converter_type_t type, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_status_t *status)
 {
     const nanoem_unicode_string_icu_t *s = (const nanoem_unicode_string_icu_t *) string;
     nanoem_u8_t *buffer = NULL;
+    UConverter *converter;
     int capacity;
     if (s) {
-        capacity = s->length * ucnv_getMaxCharSize(converter) + 1;
-        buffer = (nanoem_u8_t *) nanoem_calloc(capacity, sizeof(*buffer), status);
-        nanoemUnicodeStringFactoryToStringICU(converter, s, length, buffer, capacity, status);
+        converter = nanoemICUConverterPoolAcquire(opaque, type);
+        if (nanoem_is_not_null(converter)) {
+            capacity = s->length * ucnv_getMaxCharSize(converter) + 1;
+            buffer = (nanoem_u8_t *) nanoem_calloc(capacity, sizeof(*buffer), status);
+            nanoemUnicodeStringFactoryToStringICU(converter, s, length, buffer, capacity, status);
+            nanoemICUConverterPoolRelease(opaque, type, converter);
+        }
+        else {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_ENCODE_UNICODE_STRING_FAILED);
+        }
     }
     return buffer;
 }
@@ -145,51 +450,50 @@ static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromCp932CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->cp932, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, NANOEM_ICU_CONVERTER_TYPE_CP932, string, length, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf8CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->utf8, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, NANOEM_ICU_CONVERTER_TYPE_UTF8, string, length, status);
 }
 
 static nanoem_unicode_string_t *
 nanoemUnicodeStringFactoryFromUtf16CallbackICU(void *opaque, const nanoem_u8_t *string, nanoem_rsize_t length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data->utf16, string, length, status);
+    return (nanoem_unicode_string_t *) nanoemUnicodeStringFactoryFromStringICU(data, NANOEM_ICU_CONVERTER_TYPE_UTF16, string, length, status);
 }
 
 static nanoem_u8_t *
 nanoemUnicodeStringFactoryToCp932CallbackICU(void *opaque, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return nanoemUnicodeStringFactoryToStringOnHeapICU(data->cp932, string, length, status);
+    return nanoemUnicodeStringFactoryToStringOnHeapICU(data, NANOEM_ICU_CONVERTER_TYPE_CP932, string, length, status);
 }
 
 static nanoem_u8_t *
 nanoemUnicodeStringFactoryToUtf8CallbackICU(void *opaque, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return nanoemUnicodeStringFactoryToStringOnHeapICU(data->utf8, string, length, status);
+    return nanoemUnicodeStringFactoryToStringOnHeapICU(data, NANOEM_ICU_CONVERTER_TYPE_UTF8, string, length, status);
 }
 
 static nanoem_u8_t *
 nanoemUnicodeStringFactoryToUtf16CallbackICU(void *opaque, const nanoem_unicode_string_t *string, nanoem_rsize_t *length, nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    return nanoemUnicodeStringFactoryToStringOnHeapICU(data->utf16, string, length, status);
+    return nanoemUnicodeStringFactoryToStringOnHeapICU(data, NANOEM_ICU_CONVERTER_TYPE_UTF16, string, length, status);
 }
 
 static nanoem_i32_t
 nanoemUnicodeStringFactoryHashCallbackICU(void *opaque, const nanoem_unicode_string_t *string)
 {
     const nanoem_unicode_string_icu_t *s = (const nanoem_unicode_string_icu_t *) string;
-    nanoem_i32_t hash = s ? (nanoem_i32_t) MurmurHash(s->data, u_strlen(s->data) * sizeof(*s->data), 0) : -1;
     nanoem_mark_unused(opaque);
-    return hash;
+    return s ? (nanoem_i32_t) s->hash : -1;
 }
 
 static int
@@ -198,7 +502,11 @@ nanoemUnicodeStringFactoryCompareCallbackICU(void *opaque, const nanoem_unicode_
     const nanoem_unicode_string_icu_t *lvalue = (const nanoem_unicode_string_icu_t *) left,
                                       *rvalue = (const nanoem_unicode_string_icu_t *) right;
     nanoem_mark_unused(opaque);
-    return nanoem_is_not_null(lvalue) && nanoem_is_not_null(rvalue) ? u_strcmp(lvalue->data, rvalue->data) : -1;
+    if (nanoem_is_null(lvalue) || nanoem_is_null(rvalue)) {
+        return -1;
+    }
+    /* same atom means same string, different atoms still need ordering from the content */
+    return lvalue->atom == rvalue->atom ? 0 : u_strcmp(lvalue->data, rvalue->data);
 }
 
 static const nanoem_u8_t *
@@ -246,10 +554,15 @@ nanoemUnicodeStringFactorySetCacheCallbackICU(void *opaque, nanoem_unicode_strin
 static void
 nanoemUnicodeStringFactoryDestroyStringCallbackICU(void *opaque, nanoem_unicode_string_t *string)
 {
+    nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
     nanoem_unicode_string_icu_t *s = (nanoem_unicode_string_icu_t *) string;
-    nanoem_mark_unused(opaque);
     if (s) {
-        nanoem_free(s->data);
+        /* data is owned by the atom table of the factory and freed when the last string is destroyed */
+        if (nanoem_is_not_null(data)) {
+            nanoem_icu_mutex_lock(&data->atom_lock);
+            nanoemICUAtomTableRelease(&data->atoms, s->atom);
+            nanoem_icu_mutex_unlock(&data->atom_lock);
+        }
         nanoem_free(s->cache.data);
         nanoem_free(s);
     }
@@ -269,12 +582,15 @@ nanoemUnicodeStringFactoryCreateICU(nanoem_status_t *status)
 {
     nanoem_unicode_factory_opaque_data_icu_t *opaque;
     nanoem_unicode_string_factory_t *factory;
-    UErrorCode code = U_ZERO_ERROR;
+    int i;
     opaque = (nanoem_unicode_factory_opaque_data_icu_t *) nanoem_calloc(1, sizeof(*opaque), status);
     if (nanoem_is_not_null(opaque)) {
-        opaque->cp932 = ucnv_open("cp932", &code);
-        opaque->utf8 = ucnv_open("utf8", &code);
-        opaque->utf16 = ucnv_open("utf16le", &code);
+        nanoem_icu_mutex_init(&opaque->converter_lock);
+        nanoem_icu_mutex_init(&opaque->atom_lock);
+        /* opens one converter of each codec ahead of time as before */
+        for (i = 0; i < NANOEM_ICU_CONVERTER_TYPE_MAX_ENUM; i++) {
+            nanoemICUConverterPoolRelease(opaque, (nanoem_icu_converter_type_t) i, nanoemICUConverterPoolAcquire(opaque, (nanoem_icu_converter_type_t) i));
+        }
     }
     factory = nanoemUnicodeStringFactoryCreate(status);
     nanoemUnicodeStringFactorySetGetCacheCallback(factory, nanoemUnicodeStringFactoryGetCacheCallbackICU);
@@ -297,12 +613,16 @@ void APIENTRY
 nanoemUnicodeStringFactoryDestroyICU(nanoem_unicode_string_factory_t *factory)
 {
     nanoem_unicode_factory_opaque_data_icu_t *opaque;
+    int i;
     opaque = (nanoem_unicode_factory_opaque_data_icu_t *) nanoemUnicodeStringFactoryGetOpaqueData(factory);
     if (nanoem_is_not_null(opaque)) {
-        ucnv_close(opaque->cp932);
-        ucnv_close(opaque->utf8);
-        ucnv_close(opaque->utf16);
+        for (i = 0; i < NANOEM_ICU_CONVERTER_TYPE_MAX_ENUM; i++) {
+            nanoemICUConverterPoolDestroy(&opaque->converters[i]);
+        }
         ucnv_flushCache();
+        nanoemICUAtomTableDestroy(&opaque->atoms);
+        nanoem_icu_mutex_destroy(&opaque->converter_lock);
+        nanoem_icu_mutex_destroy(&opaque->atom_lock);
         nanoem_free(opaque);
     }
     nanoemUnicodeStringFactoryDestroy(factory);
@@ -314,7 +634,15 @@ nanoemUnicodeStringFactoryToUtf8OnStackICU(nanoem_unicode_string_factory_t *fact
     void *opaque = nanoemUnicodeStringFactoryGetOpaqueData(factory);
     const nanoem_unicode_string_icu_t *s = (const nanoem_unicode_string_icu_t *) string;
     nanoem_unicode_factory_opaque_data_icu_t *data = (nanoem_unicode_factory_opaque_data_icu_t *) opaque;
-    nanoemUnicodeStringFactoryToStringICU(data->utf8, s, length, buffer, capacity, status);
+    UConverter *converter = nanoemICUConverterPoolAcquire(data, NANOEM_ICU_CONVERTER_TYPE_UTF8);
+    *length = 0;
+    if (nanoem_is_not_null(converter)) {
+        nanoemUnicodeStringFactoryToStringICU(converter, s, length, buffer, capacity, status);
+        nanoemICUConverterPoolRelease(data, NANOEM_ICU_CONVERTER_TYPE_UTF8, converter);
+    }
+    else {
+        nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_ENCODE_UNICODE_STRING_FAILED);
+    }
     buffer[*length >= capacity ? (capacity - 1) : *length] = '\0';
 }
 
@@ -278,6 +278,18 @@ nanoemMotionReadEffectParametersNMD(nanoem_motion_effect_parameter_t *effect_par
     }
 }
 
+static nanoem_bool_t
+nanoemMotionKeyframeObjectArrayIsUnordered(nanoem_motion_keyframe_object_t *const *items, nanoem_rsize_t num_items)
+{
+    nanoem_rsize_t i;
+    for (i = 1; i < num_items; i++) {
+        if (items[i - 1]->frame_index > items[i]->frame_index) {
+            return nanoem_true;
+        }
+    }
+    return nanoem_false;
+}
+
 static void
 nanoemMotionReadAccessoryKeyframeEffectParametersNMD(nanoem_motion_accessory_keyframe_t *accessory_keyframe, const Nanoem__Motion__AccessoryKeyframe *accessory_keyframe_message, nanoem_status_t *status)
 {
@@ -386,6 +398,9 @@ nanoemMotionReadBoneKeyframeBundleUnitNMD(nanoem_motion_t *motion, const Nanoem_
                     track.factory = factory;
                     track.id = (nanoem_motion_track_index_t) track_message->index;
                     track.keyframes = kh_init_keyframe_map();
+                    track.ordered_keyframes = NULL;
+                    track.num_ordered_keyframes = 0;
+                    track.is_ordered_keyframes_dirty = nanoem_false;
                     kh_put_motion_track_bundle(motion->local_bone_motion_track_bundle, track, &ret);
                     if (ret >= 0 && motion->local_bone_motion_track_allocated_id < track.id) {
                         motion->local_bone_motion_track_allocated_id = track.id;
@@ -702,6 +717,9 @@ nanoemMotionReadMorphKeyframeBundleUnitNMD(nanoem_motion_t *motion, const Nanoem
                     track.factory = factory;
                     track.id = (nanoem_motion_track_index_t) track_message->index;
                     track.keyframes = kh_init_keyframe_map();
+                    track.ordered_keyframes = NULL;
+                    track.num_ordered_keyframes = 0;
+                    track.is_ordered_keyframes_dirty = nanoem_false;
                     kh_put_motion_track_bundle(motion->local_morph_motion_track_bundle, track, &ret);
                     if (ret >= 0 && motion->local_morph_motion_track_allocated_id < track.id) {
                         motion->local_morph_motion_track_allocated_id = track.id;
@@ -809,6 +827,9 @@ nanoemMotionLoadFromBufferNMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer,
                         track.factory = factory;
                         track.id = (nanoem_motion_track_index_t) track_message->index;
                         track.keyframes = kh_init_keyframe_map();
+                        track.ordered_keyframes = NULL;
+                        track.num_ordered_keyframes = 0;
+                        track.is_ordered_keyframes_dirty = nanoem_false;
                         kh_put_motion_track_bundle(motion->global_motion_track_bundle, track, &ret);
                         if (motion->global_motion_track_allocated_id < track.id) {
                             motion->global_motion_track_allocated_id = track.id;
@@ -862,6 +883,13 @@ nanoemMotionLoadFromBufferNMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer,
                         break;
                     }
                 }
+                motion->order.flags.is_accessory_keyframes_unordered = nanoemMotionKeyframeObjectArrayIsUnordered((nanoem_motion_keyframe_object_t *const *) motion->accessory_keyframes, motion->num_accessory_keyframes);
+                motion->order.flags.is_camera_keyframes_unordered = nanoemMotionKeyframeObjectArrayIsUnordered((nanoem_motion_keyframe_object_t *const *) motion->camera_keyframes, motion->num_camera_keyframes);
+                motion->order.flags.is_light_keyframes_unordered = nanoemMotionKeyframeObjectArrayIsUnordered((nanoem_motion_keyframe_object_t *const *) motion->light_keyframes, motion->num_light_keyframes);
+                motion->order.flags.is_model_keyframes_unordered = nanoemMotionKeyframeObjectArrayIsUnordered((nanoem_motion_keyframe_object_t *const *) motion->model_keyframes, motion->num_model_keyframes);
+                motion->order.flags.is_self_shadow_keyframes_unordered = nanoemMotionKeyframeObjectArrayIsUnordered((nanoem_motion_keyframe_object_t *const *) motion->self_shadow_keyframes, motion->num_self_shadow_keyframes);
+                nanoemMotionTrackBundleRebuildAllOrderedKeyframes(motion->local_bone_motion_track_bundle);
+                nanoemMotionTrackBundleRebuildAllOrderedKeyframes(motion->local_morph_motion_track_bundle);
             }
             nanoem__motion__motion__free_unpacked(motion_message, &__nanoem_protobuf_allocator);
         }
@@ -760,11 +760,15 @@ nanoemMotionTrackBundleRemoveKeyframe(kh_motion_track_bundle_t *bundle, nanoem_f
         track.factory = factory;
         track.id = 0;
         track.keyframes = NULL;
+        track.ordered_keyframes = NULL;
+        track.num_ordered_keyframes = 0;
+        track.is_ordered_keyframes_dirty = nanoem_false;
         track.name = name;
         it = kh_get_motion_track_bundle(bundle, track);
         if (it != kh_end(bundle)) {
             keyframes = kh_key(bundle, it).keyframes;
             kh_del_keyframe_map(keyframes, kh_get_keyframe_map(keyframes, frame_index));
+            kh_key(bundle, it).is_ordered_keyframes_dirty = nanoem_true;
         }
     }
 }
@@ -2506,6 +2510,9 @@ nanoemMutableMotionAddAccessoryKeyframe(nanoem_mutable_motion_t *motion, nanoem_
             nanoemMotionKeyframeObjectArrayAddObject((nanoem_motion_keyframe_object_t ***) &origin_motion->accessory_keyframes, (nanoem_motion_keyframe_object_t *) keyframe->origin, frame_index, &origin_motion->num_accessory_keyframes, &motion->num_allocated_accessory_keyframes, status);
             if (!nanoem_status_ptr_has_error(status)) {
                 keyframe->base.is_in_motion = nanoem_true;
+                if (nanoemMotionKeyframeObjectArrayIsLastObjectUnordered((nanoem_motion_keyframe_object_t *const *) origin_motion->accessory_keyframes, origin_motion->num_accessory_keyframes)) {
+                    origin_motion->order.flags.is_accessory_keyframes_unordered = 1;
+                }
             }
         }
         else {
@@ -2558,6 +2565,9 @@ nanoemMutableMotionAddCameraKeyframe(nanoem_mutable_motion_t *motion, nanoem_mut
             nanoemMotionKeyframeObjectArrayAddObject((nanoem_motion_keyframe_object_t ***) &origin_motion->camera_keyframes, (nanoem_motion_keyframe_object_t *) keyframe->origin, frame_index, &origin_motion->num_camera_keyframes, &motion->num_allocated_camera_keyframes, status);
             if (!nanoem_status_ptr_has_error(status)) {
                 keyframe->base.is_in_motion = nanoem_true;
+                if (nanoemMotionKeyframeObjectArrayIsLastObjectUnordered((nanoem_motion_keyframe_object_t *const *) origin_motion->camera_keyframes, origin_motion->num_camera_keyframes)) {
+                    origin_motion->order.flags.is_camera_keyframes_unordered = 1;
+                }
             }
         }
         else {
@@ -2579,6 +2589,9 @@ nanoemMutableMotionAddLightKeyframe(nanoem_mutable_motion_t *motion, nanoem_muta
             nanoemMotionKeyframeObjectArrayAddObject((nanoem_motion_keyframe_object_t ***) &origin_motion->light_keyframes, (nanoem_motion_keyframe_object_t *) keyframe->origin, frame_index, &origin_motion->num_light_keyframes, &motion->num_allocated_light_keyframes, status);
             if (!nanoem_status_ptr_has_error(status)) {
                 keyframe->base.is_in_motion = nanoem_true;
+                if (nanoemMotionKeyframeObjectArrayIsLastObjectUnordered((nanoem_motion_keyframe_object_t *const *) origin_motion->light_keyframes, origin_motion->num_light_keyframes)) {
+                    origin_motion->order.flags.is_light_keyframes_unordered = 1;
+                }
             }
         }
         else {
@@ -2597,6 +2610,9 @@ nanoemMutableMotionAddModelKeyframe(nanoem_mutable_motion_t *motion, nanoem_muta
             nanoemMotionKeyframeObjectArrayAddObject((nanoem_motion_keyframe_object_t ***) &origin_motion->model_keyframes, (nanoem_motion_keyframe_object_t *) keyframe->origin, frame_index, &origin_motion->num_model_keyframes, &motion->num_allocated_model_keyframes, status);
             if (!nanoem_status_ptr_has_error(status)) {
                 keyframe->base.is_in_motion = nanoem_true;
+                if (nanoemMotionKeyframeObjectArrayIsLastObjectUnordered((nanoem_motion_keyframe_object_t *const *) origin_motion->model_keyframes, origin_motion->num_model_keyframes)) {
+                    origin_motion->order.flags.is_model_keyframes_unordered = 1;
+                }
             }
         }
         else {
@@ -2649,6 +2665,9 @@ nanoemMutableMotionAddSelfShadowKeyframe(nanoem_mutable_motion_t *motion, nanoem
             nanoemMotionKeyframeObjectArrayAddObject((nanoem_motion_keyframe_object_t ***) &origin_motion->self_shadow_keyframes, (nanoem_motion_keyframe_object_t *) keyframe->origin, frame_index, &origin_motion->num_self_shadow_keyframes, &motion->num_allocated_self_shadow_keyframes, status);
             if (!nanoem_status_ptr_has_error(status)) {
                 keyframe->base.is_in_motion = nanoem_true;
+                if (nanoemMotionKeyframeObjectArrayIsLastObjectUnordered((nanoem_motion_keyframe_object_t *const *) origin_motion->self_shadow_keyframes, origin_motion->num_self_shadow_keyframes)) {
+                    origin_motion->order.flags.is_self_shadow_keyframes_unordered = 1;
+                }
             }
         }
         else {
@@ -2801,6 +2820,9 @@ nanoemMutableMotionSortAllKeyframes(nanoem_mutable_motion_t *motion)
     if (nanoem_is_not_null(motion)) {
         origin = motion->origin;
         origin->max_frame_index = 0;
+        origin->order.value = 0;
+        nanoemMotionTrackBundleRebuildAllOrderedKeyframes(origin->local_bone_motion_track_bundle);
+        nanoemMotionTrackBundleRebuildAllOrderedKeyframes(origin->local_morph_motion_track_bundle);
         if (origin->num_accessory_keyframes > 0) {
             nanoem_crt_qsort(origin->accessory_keyframes, origin->num_accessory_keyframes, sizeof(*origin->accessory_keyframes), nanoemMotionCompareKeyframe);
             nanoemMutableMotionSetMaxFrameIndex(origin, nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionAccessoryKeyframeGetKeyframeObject(origin->accessory_keyframes[origin->num_accessory_keyframes - 1])));
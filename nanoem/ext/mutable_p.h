@@ -542,6 +542,12 @@ nanoemMotionKeyframeObjectArrayAddObject(nanoem_motion_keyframe_object_t ***item
     }
 }
 
+NANOEM_DECL_INLINE static nanoem_bool_t
+nanoemMotionKeyframeObjectArrayIsLastObjectUnordered(nanoem_motion_keyframe_object_t *const *items, nanoem_rsize_t num_items)
+{
+    return num_items > 1 && items[num_items - 2]->frame_index > items[num_items - 1]->frame_index;
+}
+
 static void
 nanoemMotionKeyframeObjectArrayRemoveObject(nanoem_motion_keyframe_object_t **items, nanoem_motion_keyframe_object_t *item, nanoem_rsize_t *num_items, nanoem_status_t not_found_error, nanoem_status_t *status)
 {
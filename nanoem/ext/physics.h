@@ -31,6 +31,15 @@ NANOEM_DECL_OPAQUE(nanoem_physics_motion_state_t);
  * @{
  */
 
+/**
+ * \defgroup nanoem_physics_world_callback Physics World Callback
+ * @{
+ */
+/* the callback must call the task for all iterations possibly from multiple threads and wait for all of them */
+typedef void (*nanoem_physics_world_task_t)(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end);
+typedef void (*nanoem_physics_world_parallel_for_t)(void *user_data, nanoem_physics_world_task_t task, void *opaque, nanoem_rsize_t iterations);
+/** @} */
+
 NANOEM_DECL_API nanoem_bool_t APIENTRY
 nanoemPhysicsWorldIsAvailable(void *opaque);
 NANOEM_DECL_API nanoem_physics_world_t *APIENTRY
@@ -72,6 +81,32 @@ nanoemPhysicsWorldIsGroundEnabled(const nanoem_physics_world_t *world);
 NANOEM_DECL_API void APIENTRY
 nanoemPhysicsWorldSetGroundEnabled(nanoem_physics_world_t *world, nanoem_bool_t value);
 NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldSetParallelForCallback(nanoem_physics_world_t *world, nanoem_physics_world_parallel_for_t callback, void *user_data);
+NANOEM_DECL_API nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsParallelSimulationEnabled(const nanoem_physics_world_t *world);
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldSetParallelSimulationEnabled(nanoem_physics_world_t *world, nanoem_bool_t value);
+NANOEM_DECL_API int APIENTRY
+nanoemPhysicsWorldGetMaxSubSteps(const nanoem_physics_world_t *world);
+/* substeps exceeding the value are dropped and only the remaining time less than a fixed step is carried over */
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldSetMaxSubSteps(nanoem_physics_world_t *world, int value);
+NANOEM_DECL_API nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsInterpolationEnabled(const nanoem_physics_world_t *world);
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldSetInterpolationEnabled(nanoem_physics_world_t *world, nanoem_bool_t value);
+NANOEM_DECL_API int APIENTRY
+nanoemPhysicsWorldGetNumSteps(const nanoem_physics_world_t *world);
+NANOEM_DECL_API int APIENTRY
+nanoemPhysicsWorldGetNumDroppedSteps(const nanoem_physics_world_t *world);
+/* a saved state can be restored only to the world having the same bodies added in the same order */
+NANOEM_DECL_API nanoem_rsize_t APIENTRY
+nanoemPhysicsWorldGetStateSize(const nanoem_physics_world_t *world);
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldSaveState(const nanoem_physics_world_t *world, nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY
+nanoemPhysicsWorldRestoreState(nanoem_physics_world_t *world, const nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY
 nanoemPhysicsWorldDestroy(nanoem_physics_world_t *world);
 /** @} */
 
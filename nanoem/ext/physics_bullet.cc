@@ -31,6 +31,7 @@ nanoem_pragma_diagnostics_ignore_msvc(4101);
 #include "BulletCollision/CollisionShapes/btSphereShape.h"
 #include "BulletCollision/CollisionShapes/btStaticPlaneShape.h"
 #include "BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h"
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
 #include "BulletDynamics/ConstraintSolver/btConeTwistConstraint.h"
 #include "BulletDynamics/ConstraintSolver/btGeneric6DofConstraint.h"
 #include "BulletDynamics/ConstraintSolver/btGeneric6DofSpringConstraint.h"
@@ -48,6 +49,14 @@ nanoem_pragma_diagnostics_ignore_msvc(4101);
 #include "LinearMath/btDefaultMotionState.h"
 nanoem_pragma_diagnostics_pop();
 
+/*
+ * solver bodies are stored in shared kinematic bodies since 2.81 and BT_PROFILE writes the global profile manager
+ * without locks, so islands are solved concurrently only with older bullet built without its profiler
+ */
+#if BT_BULLET_VERSION < 281 && defined(BT_NO_PROFILE)
+#define NANOEM_PHYSICS_BULLET_ENABLE_CONCURRENT_ISLANDS
+#endif
+
 #ifndef NDEBUG
 #include "glm/gtx/string_cast.hpp"
 #include <stdio.h>
@@ -156,6 +165,119 @@ resetRigidBody(btRigidBody *body)
     body->updateInertiaTensor();
 }
 
+/* states are written in the native byte order as they are only restored to the same world in the same process */
+class StateWriter {
+public:
+    StateWriter(nanoem_u8_t *data)
+        : m_data(data)
+        , m_offset(0)
+    {
+    }
+
+    void
+    writeInt(int value)
+    {
+        const nanoem_i32_t v = value;
+        write(&v, sizeof(v));
+    }
+    void
+    writeScalar(btScalar value)
+    {
+        const nanoem_f32_t v = nanoem_f32_t(value);
+        write(&v, sizeof(v));
+    }
+    void
+    writeVector3(const btVector3 &value)
+    {
+        writeScalar(value.x());
+        writeScalar(value.y());
+        writeScalar(value.z());
+    }
+    void
+    writeQuaternion(const btQuaternion &value)
+    {
+        writeScalar(value.x());
+        writeScalar(value.y());
+        writeScalar(value.z());
+        writeScalar(value.w());
+    }
+    nanoem_rsize_t
+    offset() const
+    {
+        return m_offset;
+    }
+
+private:
+    void
+    write(const void *value, nanoem_rsize_t size)
+    {
+        /* only the size is counted when no buffer is given */
+        if (m_data) {
+            nanoem_crt_memcpy(m_data + m_offset, value, size);
+        }
+        m_offset += size;
+    }
+
+    nanoem_u8_t *m_data;
+    nanoem_rsize_t m_offset;
+};
+
+class StateReader {
+public:
+    StateReader(const nanoem_u8_t *data, nanoem_rsize_t size)
+        : m_data(data)
+        , m_size(size)
+        , m_offset(0)
+    {
+    }
+
+    int
+    readInt()
+    {
+        nanoem_i32_t v = 0;
+        read(&v, sizeof(v));
+        return v;
+    }
+    btScalar
+    readScalar()
+    {
+        nanoem_f32_t v = 0;
+        read(&v, sizeof(v));
+        return btScalar(v);
+    }
+    btVector3
+    readVector3()
+    {
+        const btScalar x = readScalar(), y = readScalar(), z = readScalar();
+        return btVector3(x, y, z);
+    }
+    btQuaternion
+    readQuaternion()
+    {
+        const btScalar x = readScalar(), y = readScalar(), z = readScalar(), w = readScalar();
+        return btQuaternion(x, y, z, w);
+    }
+    bool
+    isEnd() const
+    {
+        return m_offset == m_size;
+    }
+
+private:
+    void
+    read(void *value, nanoem_rsize_t size)
+    {
+        if (m_offset + size <= m_size) {
+            nanoem_crt_memcpy(value, m_data + m_offset, size);
+        }
+        m_offset += size;
+    }
+
+    const nanoem_u8_t *m_data;
+    nanoem_rsize_t m_size;
+    nanoem_rsize_t m_offset;
+};
+
 struct nanoem_physics_joint_opaque_t {
     nanoem_physics_world_t *m_world;
     nanoem_physics_rigid_body_t *m_rigidBodyA;
@@ -242,6 +364,383 @@ public:
     nanoem_u32_t m_flags;
 };
 
+/*
+ * Solves constraints of each simulation island concurrently with the solver owned by each batch.
+ * Dynamic bodies, contact manifolds and constraints never belong to two islands and the sequential impulse solver
+ * only reads static and kinematic bodies, so islands are solved in the same way as the sequential world does.
+ * The split impulse pass counts recoveries in gNumSplitImpulseRecoveries of bullet without locks, so the world
+ * with split impulses is always solved by the stock solver to keep global counters out of worker threads.
+ */
+class ParallelSoftRigidDynamicsWorld : public btSoftRigidDynamicsWorld {
+public:
+    static const int kMaxNumSolvers = 32;
+
+    ParallelSoftRigidDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *broadphase,
+        btConstraintSolver *solver, btCollisionConfiguration *config)
+        : btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, config)
+        , m_parallelFor(0)
+        , m_parallelForUserData(0)
+        , m_currentSolverInfo(0)
+        , m_numBatches(0)
+        , m_lastTimeStep(0)
+        , m_parallelSimulationEnabled(false)
+        , m_interpolationEnabled(false)
+    {
+        for (int i = 0; i < kMaxNumSolvers; i++) {
+            m_solvers[i] = 0;
+        }
+    }
+    ~ParallelSoftRigidDynamicsWorld()
+    {
+        for (int i = 0; i < kMaxNumSolvers; i++) {
+            delete m_solvers[i];
+            m_solvers[i] = 0;
+        }
+    }
+
+    void
+    setParallelForCallback(nanoem_physics_world_parallel_for_t callback, void *userData)
+    {
+        m_parallelFor = callback;
+        m_parallelForUserData = userData;
+    }
+    bool
+    isParallelSimulationEnabled() const
+    {
+        return m_parallelSimulationEnabled;
+    }
+    void
+    setParallelSimulationEnabled(bool value)
+    {
+        m_parallelSimulationEnabled = value;
+    }
+    bool
+    isInterpolationEnabled() const
+    {
+        return m_interpolationEnabled;
+    }
+    void
+    setInterpolationEnabled(bool value)
+    {
+        m_interpolationEnabled = value;
+        m_previousTransforms.resize(0);
+    }
+    void
+    resetAllSolvers()
+    {
+        for (int i = 0; i < kMaxNumSolvers; i++) {
+            if (m_solvers[i]) {
+                m_solvers[i]->reset();
+            }
+        }
+        m_previousTransforms.resize(0);
+    }
+    btScalar
+    localTime() const
+    {
+        return m_localTime;
+    }
+    void
+    setLocalTime(btScalar value)
+    {
+        m_localTime = value;
+    }
+    void
+    synchronizeMotionStates()
+    {
+        if (m_interpolationEnabled && m_lastTimeStep > 0) {
+            synchronizeAllInterpolatedMotionStates();
+        }
+        else {
+            btSoftRigidDynamicsWorld::synchronizeMotionStates();
+        }
+    }
+
+protected:
+    void
+    internalSingleStepSimulation(btScalar timeStep)
+    {
+        if (m_interpolationEnabled) {
+            saveAllPreviousTransforms();
+        }
+        m_lastTimeStep = timeStep;
+        btSoftRigidDynamicsWorld::internalSingleStepSimulation(timeStep);
+    }
+    void
+    solveConstraints(btContactSolverInfo &solverInfo)
+    {
+        bool solved = false;
+#if defined(NANOEM_PHYSICS_BULLET_ENABLE_CONCURRENT_ISLANDS)
+        if (m_parallelSimulationEnabled && m_parallelFor && !solverInfo.m_splitImpulse &&
+            getSimulationIslandManager()->getSplitIslands()) {
+            solveAllIslandsConcurrently(solverInfo);
+            solved = true;
+        }
+#endif
+        if (!solved) {
+            btSoftRigidDynamicsWorld::solveConstraints(solverInfo);
+        }
+    }
+
+private:
+    struct Island {
+        int m_firstBody;
+        int m_numBodies;
+        int m_firstManifold;
+        int m_numManifolds;
+        int m_firstConstraint;
+        int m_numConstraints;
+        int m_cost;
+        int m_batch;
+    };
+    struct SortConstraintByIslandPredicate {
+        bool
+        operator()(const btTypedConstraint *left, const btTypedConstraint *right) const
+        {
+            return constraintIslandId(left) < constraintIslandId(right);
+        }
+    };
+    struct SortIslandByCostPredicate {
+        SortIslandByCostPredicate(const btAlignedObjectArray<Island> &islands)
+            : m_islands(islands)
+        {
+        }
+        bool
+        operator()(int left, int right) const
+        {
+            const int leftCost = m_islands[left].m_cost, rightCost = m_islands[right].m_cost;
+            return leftCost != rightCost ? leftCost > rightCost : left < right;
+        }
+        const btAlignedObjectArray<Island> &m_islands;
+    };
+    class IslandCollector : public btSimulationIslandManager::IslandCallback {
+    public:
+        IslandCollector(ParallelSoftRigidDynamicsWorld *parent)
+            : m_parent(parent)
+        {
+        }
+        void
+        ProcessIsland(
+            btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds, int numManifolds, int islandId)
+        {
+            m_parent->addIsland(bodies, numBodies, manifolds, numManifolds, islandId);
+        }
+
+    private:
+        ParallelSoftRigidDynamicsWorld *m_parent;
+    };
+
+    struct PreviousTransform {
+        const btCollisionObject *m_object;
+        btTransform m_transform;
+    };
+
+    static int
+    constraintIslandId(const btTypedConstraint *constraint)
+    {
+        const btCollisionObject &bodyA = constraint->getRigidBodyA(), &bodyB = constraint->getRigidBodyB();
+        return bodyA.getIslandTag() >= 0 ? bodyA.getIslandTag() : bodyB.getIslandTag();
+    }
+    static void
+    solveAllBatches(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+    {
+        ParallelSoftRigidDynamicsWorld *self = static_cast<ParallelSoftRigidDynamicsWorld *>(opaque);
+        for (nanoem_rsize_t i = begin; i < end; i++) {
+            self->solveBatch(int(i));
+        }
+    }
+
+    void
+    saveAllPreviousTransforms()
+    {
+        const int numObjects = m_collisionObjects.size();
+        m_previousTransforms.resize(numObjects);
+        for (int i = 0; i < numObjects; i++) {
+            PreviousTransform &previous = m_previousTransforms[i];
+            previous.m_object = m_collisionObjects[i];
+            previous.m_transform = m_collisionObjects[i]->getWorldTransform();
+        }
+    }
+    void
+    synchronizeAllInterpolatedMotionStates()
+    {
+        /* the remaining time is always less than a fixed step so motion states lag behind at most one step */
+        const btScalar alpha = btMin(m_localTime / m_lastTimeStep, btScalar(1));
+        const int numPreviousTransforms = m_previousTransforms.size();
+        for (int i = 0, numObjects = m_collisionObjects.size(); i < numObjects; i++) {
+            btRigidBody *body = btRigidBody::upcast(m_collisionObjects[i]);
+            if (body && body->getMotionState() && !body->isStaticOrKinematicObject() && body->isActive()) {
+                const btTransform &current = body->getWorldTransform();
+                if (i < numPreviousTransforms && m_previousTransforms[i].m_object == body) {
+                    const btTransform &previous = m_previousTransforms[i].m_transform;
+                    const btQuaternion from(previous.getRotation());
+                    btQuaternion to(current.getRotation());
+                    if (from.dot(to) < 0) {
+                        to = -to;
+                    }
+                    btTransform interpolated;
+                    interpolated.setOrigin(previous.getOrigin().lerp(current.getOrigin(), alpha));
+                    interpolated.setRotation(from.slerp(to, alpha));
+                    body->getMotionState()->setWorldTransform(interpolated);
+                }
+                else {
+                    /* the body is added after the last step so there is nothing to interpolate from */
+                    body->getMotionState()->setWorldTransform(current);
+                }
+            }
+        }
+    }
+    void
+    solveAllIslandsConcurrently(btContactSolverInfo &solverInfo)
+    {
+        const int numConstraints = getNumConstraints();
+        m_sortedConstraints.resize(numConstraints);
+        for (int i = 0; i < numConstraints; i++) {
+            m_sortedConstraints[i] = getConstraint(i);
+        }
+        /* same ordering as btDiscreteDynamicsWorld::solveConstraints */
+        m_sortedConstraints.quickSort(SortConstraintByIslandPredicate());
+        m_islands.resize(0);
+        m_islandBodies.resize(0);
+        m_islandManifolds.resize(0);
+        /* same as btDiscreteDynamicsWorld::solveConstraints, the world solver is notified on the calling thread */
+        btConstraintSolver *solver = getConstraintSolver();
+        solver->prepareSolve(getNumCollisionObjects(), getDispatcher()->getNumManifolds());
+        IslandCollector collector(this);
+        getSimulationIslandManager()->buildAndProcessIslands(getDispatcher(), this, &collector);
+        const int numIslands = m_islands.size();
+        m_numBatches = numIslands < kMaxNumSolvers ? numIslands : kMaxNumSolvers;
+        if (m_numBatches > 0) {
+            assignAllIslandsToBatches();
+            m_currentSolverInfo = &solverInfo;
+            if (m_numBatches > 1) {
+                m_parallelFor(m_parallelForUserData, solveAllBatches, this, nanoem_rsize_t(m_numBatches));
+            }
+            else {
+                solveBatch(0);
+            }
+            m_currentSolverInfo = 0;
+        }
+        solver->allSolved(solverInfo, getDebugDrawer(), m_stackAlloc);
+    }
+    void
+    addIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds, int numManifolds,
+        int islandId)
+    {
+        const int numConstraints = m_sortedConstraints.size();
+        int firstConstraint = 0, lastConstraint = numConstraints;
+        /* constraints are sorted by the island ID so the range is found by binary search */
+        while (firstConstraint < lastConstraint) {
+            const int mid = firstConstraint + (lastConstraint - firstConstraint) / 2;
+            if (constraintIslandId(m_sortedConstraints[mid]) < islandId) {
+                firstConstraint = mid + 1;
+            }
+            else {
+                lastConstraint = mid;
+            }
+        }
+        lastConstraint = firstConstraint;
+        while (lastConstraint < numConstraints && constraintIslandId(m_sortedConstraints[lastConstraint]) == islandId) {
+            lastConstraint++;
+        }
+        const int numIslandConstraints = lastConstraint - firstConstraint;
+        if (numManifolds + numIslandConstraints > 0) {
+            /* both arrays are owned by the island manager and may be reused for the next island */
+            Island &island = m_islands.expand();
+            island.m_firstBody = m_islandBodies.size();
+            island.m_numBodies = numBodies;
+            island.m_firstManifold = m_islandManifolds.size();
+            island.m_numManifolds = numManifolds;
+            island.m_firstConstraint = firstConstraint;
+            island.m_numConstraints = numIslandConstraints;
+            island.m_cost = numBodies + numManifolds + numIslandConstraints;
+            island.m_batch = 0;
+            for (int i = 0; i < numBodies; i++) {
+                m_islandBodies.push_back(bodies[i]);
+            }
+            for (int i = 0; i < numManifolds; i++) {
+                m_islandManifolds.push_back(manifolds[i]);
+            }
+        }
+    }
+    void
+    assignAllIslandsToBatches()
+    {
+        const int numIslands = m_islands.size();
+        int costs[kMaxNumSolvers], cursors[kMaxNumSolvers];
+        m_islandOrder.resize(numIslands);
+        for (int i = 0; i < numIslands; i++) {
+            m_islandOrder[i] = i;
+        }
+        m_islandOrder.quickSort(SortIslandByCostPredicate(m_islands));
+        for (int i = 0; i < m_numBatches; i++) {
+            costs[i] = 0;
+            m_batchOffsets[i] = 0;
+            if (!m_solvers[i]) {
+                m_solvers[i] = new btSequentialImpulseConstraintSolver();
+            }
+        }
+        /* the most expensive island goes to the least loaded batch first */
+        for (int i = 0; i < numIslands; i++) {
+            Island &island = m_islands[m_islandOrder[i]];
+            int batch = 0;
+            for (int j = 1; j < m_numBatches; j++) {
+                if (costs[j] < costs[batch]) {
+                    batch = j;
+                }
+            }
+            costs[batch] += island.m_cost;
+            island.m_batch = batch;
+            m_batchOffsets[batch]++;
+        }
+        for (int i = 0, offset = 0; i <= m_numBatches; i++) {
+            const int count = i < m_numBatches ? m_batchOffsets[i] : 0;
+            m_batchOffsets[i] = offset;
+            offset += count;
+        }
+        m_batchIslands.resize(numIslands);
+        for (int i = 0; i < m_numBatches; i++) {
+            cursors[i] = m_batchOffsets[i];
+        }
+        for (int i = 0; i < numIslands; i++) {
+            m_batchIslands[cursors[m_islands[i].m_batch]++] = i;
+        }
+    }
+    void
+    solveBatch(int index)
+    {
+        btConstraintSolver *solver = m_solvers[index];
+        btCollisionObject **bodies = m_islandBodies.size() > 0 ? &m_islandBodies[0] : 0;
+        btPersistentManifold **manifolds = m_islandManifolds.size() > 0 ? &m_islandManifolds[0] : 0;
+        btTypedConstraint **constraints = m_sortedConstraints.size() > 0 ? &m_sortedConstraints[0] : 0;
+        for (int i = m_batchOffsets[index], end = m_batchOffsets[index + 1]; i < end; i++) {
+            const Island &island = m_islands[m_batchIslands[i]];
+            /* the debug drawer and the stack allocator are not thread safe and the solver does not use them */
+            solver->solveGroup(bodies + island.m_firstBody, island.m_numBodies,
+                island.m_numManifolds > 0 ? manifolds + island.m_firstManifold : 0, island.m_numManifolds,
+                island.m_numConstraints > 0 ? constraints + island.m_firstConstraint : 0, island.m_numConstraints,
+                *m_currentSolverInfo, 0, 0, getDispatcher());
+        }
+    }
+
+    btConstraintSolver *m_solvers[kMaxNumSolvers];
+    int m_batchOffsets[kMaxNumSolvers + 1];
+    btAlignedObjectArray<Island> m_islands;
+    btAlignedObjectArray<btCollisionObject *> m_islandBodies;
+    btAlignedObjectArray<btPersistentManifold *> m_islandManifolds;
+    btAlignedObjectArray<btTypedConstraint *> m_sortedConstraints;
+    btAlignedObjectArray<int> m_islandOrder;
+    btAlignedObjectArray<int> m_batchIslands;
+    btAlignedObjectArray<PreviousTransform> m_previousTransforms;
+    nanoem_physics_world_parallel_for_t m_parallelFor;
+    void *m_parallelForUserData;
+    const btContactSolverInfo *m_currentSolverInfo;
+    int m_numBatches;
+    btScalar m_lastTimeStep;
+    bool m_parallelSimulationEnabled;
+    bool m_interpolationEnabled;
+};
+
 } /* namespace anonymous */
 
 struct nanoem_physics_world_t {
@@ -252,7 +751,7 @@ struct nanoem_physics_world_t {
         m_dispatcher = new btCollisionDispatcher(m_config);
         m_broadphase = new btDbvtBroadphase();
         m_solver = new btSequentialImpulseConstraintSolver();
-        m_world = new btSoftRigidDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config);
+        m_world = new ParallelSoftRigidDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config);
         m_groundPlaneShape = new btStaticPlaneShape(btVector3(0, 1, 0), 0);
         m_groundBoxShape = new btBoxShape(btVector3(50, 50, 50));
         m_groundBoxShape->setMargin(0.5f);
@@ -287,21 +786,28 @@ struct nanoem_physics_world_t {
         m_worldInfo->m_sparsesdf.Initialize();
         m_fixedTimeStep = 1.0f / 60.0f;
         m_maxSubSteps = INT_MAX;
+        m_numSteps = 0;
+        m_numDroppedSteps = 0;
         m_active = nanoem_false;
         setGroundEnable(nanoem_true);
     }
     int
     stepSimulation(nanoem_f32_t delta)
     {
-        int num_steps = 0;
+        int num_steps = 0, num_dropped_steps = 0;
         if (m_active) {
-            m_world->stepSimulation(delta, m_maxSubSteps, m_fixedTimeStep);
+            /* bullet returns the number of substeps before clamping and drops the exceeded ones */
+            const int num_substeps = m_world->stepSimulation(delta, m_maxSubSteps, m_fixedTimeStep);
+            num_steps = btMin(num_substeps, m_maxSubSteps);
+            num_dropped_steps = num_substeps - num_steps;
             if (m_debugger->m_flags != 0) {
                 m_debugger->clearGeometryData();
                 m_world->debugDrawWorld();
             }
             m_worldInfo->m_sparsesdf.GarbageCollect();
         }
+        m_numSteps = num_steps;
+        m_numDroppedSteps = num_dropped_steps;
         return num_steps;
     }
     void
@@ -330,10 +836,101 @@ struct nanoem_physics_world_t {
         }
         m_world->getBroadphase()->resetPool(dispatcher);
         m_world->getConstraintSolver()->reset();
+        m_world->resetAllSolvers();
         m_world->clearForces();
         m_worldInfo->m_sparsesdf.Reset();
     }
     void
+    saveState(StateWriter &writer) const
+    {
+        const btCollisionObjectArray &objects = m_world->getCollisionObjectArray();
+        const int numObjects = m_world->getNumCollisionObjects();
+        writer.writeInt(numObjects);
+        writer.writeScalar(m_world->localTime());
+        for (int i = 0; i < numObjects; i++) {
+            const btCollisionObject *object = objects[i];
+            if (const btSoftBody *body = btSoftBody::upcast(object)) {
+                const int numNodes = body->m_nodes.size();
+                writer.writeInt(numNodes);
+                for (int j = 0; j < numNodes; j++) {
+                    const btSoftBody::Node &node = body->m_nodes[j];
+                    writer.writeVector3(node.m_x);
+                    writer.writeVector3(node.m_q);
+                    writer.writeVector3(node.m_v);
+                    writer.writeVector3(node.m_n);
+                }
+            }
+            else if (const btRigidBody *body = btRigidBody::upcast(object)) {
+                const btTransform &transform = body->getWorldTransform();
+                writer.writeVector3(transform.getOrigin());
+                writer.writeQuaternion(transform.getRotation());
+                writer.writeVector3(body->getLinearVelocity());
+                writer.writeVector3(body->getAngularVelocity());
+                writer.writeInt(body->getActivationState());
+                writer.writeScalar(body->getDeactivationTime());
+            }
+        }
+    }
+    bool
+    restoreState(StateReader &reader)
+    {
+        const btCollisionObjectArray &objects = m_world->getCollisionObjectArray();
+        const int numObjects = m_world->getNumCollisionObjects();
+        if (reader.readInt() != numObjects) {
+            return false;
+        }
+        m_world->setLocalTime(reader.readScalar());
+        btOverlappingPairCache *cache = m_world->getPairCache();
+        btDispatcher *dispatcher = m_world->getDispatcher();
+        for (int i = 0; i < numObjects; i++) {
+            btCollisionObject *object = objects[i];
+            if (btSoftBody *body = btSoftBody::upcast(object)) {
+                const int numNodes = body->m_nodes.size();
+                if (reader.readInt() != numNodes) {
+                    return false;
+                }
+                for (int j = 0; j < numNodes; j++) {
+                    btSoftBody::Node &node = body->m_nodes[j];
+                    node.m_x = reader.readVector3();
+                    node.m_q = reader.readVector3();
+                    node.m_v = reader.readVector3();
+                    node.m_n = reader.readVector3();
+                }
+                body->updateBounds();
+                cache->cleanProxyFromPairs(body->getBroadphaseHandle(), dispatcher);
+            }
+            else if (btRigidBody *body = btRigidBody::upcast(object)) {
+                const btVector3 origin(reader.readVector3());
+                const btQuaternion rotation(reader.readQuaternion());
+                const btVector3 linearVelocity(reader.readVector3()), angularVelocity(reader.readVector3());
+                const int activationState = reader.readInt();
+                const btScalar deactivationTime = reader.readScalar();
+                const btTransform transform(rotation, origin);
+                body->setWorldTransform(transform);
+                body->setInterpolationWorldTransform(transform);
+                body->setLinearVelocity(linearVelocity);
+                body->setAngularVelocity(angularVelocity);
+                body->setInterpolationLinearVelocity(linearVelocity);
+                body->setInterpolationAngularVelocity(angularVelocity);
+                body->forceActivationState(activationState);
+                body->setDeactivationTime(deactivationTime);
+                body->clearForces();
+                body->updateInertiaTensor();
+                /* kinematic bodies follow bones so their motion states must not be overwritten */
+                if (!body->isKinematicObject() && body->getMotionState()) {
+                    body->getMotionState()->setWorldTransform(transform);
+                }
+                cache->cleanProxyFromPairs(body->getBroadphaseHandle(), dispatcher);
+            }
+        }
+        /* contact points and warm starting caches are not restored and rebuilt on the next step */
+        m_world->getBroadphase()->resetPool(dispatcher);
+        m_world->getConstraintSolver()->reset();
+        m_world->resetAllSolvers();
+        m_worldInfo->m_sparsesdf.Reset();
+        return reader.isEnd();
+    }
+    void
     setGravity(const nanoem_f32_t *value)
     {
         const btVector3 v(value[0], value[1], value[2]);
@@ -398,7 +995,7 @@ struct nanoem_physics_world_t {
     btCollisionDispatcher *m_dispatcher;
     btDbvtBroadphase *m_broadphase;
     btSequentialImpulseConstraintSolver *m_solver;
-    btSoftRigidDynamicsWorld *m_world;
+    ParallelSoftRigidDynamicsWorld *m_world;
     btSoftBodyWorldInfo *m_worldInfo;
     btStaticPlaneShape *m_groundPlaneShape;
     btBoxShape *m_groundBoxShape;
@@ -413,6 +1010,8 @@ struct nanoem_physics_world_t {
     nanoem_bool_t m_active;
     nanoem_bool_t m_groundEnabled;
     int m_maxSubSteps;
+    int m_numSteps;
+    int m_numDroppedSteps;
 };
 
 struct nanoem_physics_rigid_body_t {
@@ -1202,6 +1801,120 @@ nanoemPhysicsWorldSetGroundEnabled(nanoem_physics_world_t *world, nanoem_bool_t
     }
 }
 
+void APIENTRY
+nanoemPhysicsWorldSetParallelForCallback(
+    nanoem_physics_world_t *world, nanoem_physics_world_parallel_for_t callback, void *user_data)
+{
+    if (nanoem_is_not_null(world)) {
+        world->m_world->setParallelForCallback(callback, user_data);
+    }
+}
+
+nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsParallelSimulationEnabled(const nanoem_physics_world_t *world)
+{
+    return nanoem_is_not_null(world) && world->m_world->isParallelSimulationEnabled() ? nanoem_true : nanoem_false;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetParallelSimulationEnabled(nanoem_physics_world_t *world, nanoem_bool_t value)
+{
+    if (nanoem_is_not_null(world)) {
+        world->m_world->setParallelSimulationEnabled(value != 0);
+    }
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetMaxSubSteps(const nanoem_physics_world_t *world)
+{
+    return nanoem_is_not_null(world) ? world->m_maxSubSteps : 0;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetMaxSubSteps(nanoem_physics_world_t *world, int value)
+{
+    /* zero makes bullet step with a variable time step so at least one substep is required */
+    if (nanoem_is_not_null(world) && value > 0) {
+        world->m_maxSubSteps = value;
+    }
+}
+
+nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsInterpolationEnabled(const nanoem_physics_world_t *world)
+{
+    return nanoem_is_not_null(world) && world->m_world->isInterpolationEnabled() ? nanoem_true : nanoem_false;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetInterpolationEnabled(nanoem_physics_world_t *world, nanoem_bool_t value)
+{
+    if (nanoem_is_not_null(world)) {
+        world->m_world->setInterpolationEnabled(value != 0);
+    }
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetNumSteps(const nanoem_physics_world_t *world)
+{
+    return nanoem_is_not_null(world) ? world->m_numSteps : 0;
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetNumDroppedSteps(const nanoem_physics_world_t *world)
+{
+    return nanoem_is_not_null(world) ? world->m_numDroppedSteps : 0;
+}
+
+nanoem_rsize_t APIENTRY
+nanoemPhysicsWorldGetStateSize(const nanoem_physics_world_t *world)
+{
+    nanoem_rsize_t size = 0;
+    if (nanoem_is_not_null(world)) {
+        StateWriter writer(NULL);
+        world->saveState(writer);
+        size = writer.offset();
+    }
+    return size;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSaveState(
+    const nanoem_physics_world_t *world, nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status)
+{
+    if (nanoem_is_not_null(world) && nanoem_is_not_null(data)) {
+        if (size == nanoemPhysicsWorldGetStateSize(world)) {
+            StateWriter writer(data);
+            world->saveState(writer);
+            nanoem_status_ptr_assign_succeeded(status);
+        }
+        else {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_BUFFER_END);
+        }
+    }
+    else {
+        nanoem_status_ptr_assign_null_object(status);
+    }
+}
+
+void APIENTRY
+nanoemPhysicsWorldRestoreState(
+    nanoem_physics_world_t *world, const nanoem_u8_t *data, nanoem_rsize_t size, nanoem_status_t *status)
+{
+    if (nanoem_is_not_null(world) && nanoem_is_not_null(data)) {
+        if (size == nanoemPhysicsWorldGetStateSize(world)) {
+            StateReader reader(data, size);
+            nanoem_status_ptr_assign(
+                status, world->restoreState(reader) ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_BUFFER_END);
+        }
+        else {
+            nanoem_status_ptr_assign(status, NANOEM_STATUS_ERROR_BUFFER_END);
+        }
+    }
+    else {
+        nanoem_status_ptr_assign_null_object(status);
+    }
+}
+
 void APIENTRY
 nanoemPhysicsWorldDestroy(nanoem_physics_world_t *world)
 {
@@ -1585,6 +2298,8 @@ nanoemPhysicsSoftBodyDestroy(nanoem_physics_soft_body_t *soft_body)
 
 #include "./physics.h"
 
+#include "../nanoem_p.h"
+
 nanoem_bool_t APIENTRY
 nanoemPhysicsWorldIsAvailable(void * /* opaque */)
 {
@@ -1684,6 +2399,77 @@ nanoemPhysicsWorldSetDeactivationTimeThreshold(nanoem_physics_world_t * /* world
 {
 }
 
+void APIENTRY
+nanoemPhysicsWorldSetParallelForCallback(
+    nanoem_physics_world_t * /* world */, nanoem_physics_world_parallel_for_t /* callback */, void * /* user_data */)
+{
+}
+
+nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsParallelSimulationEnabled(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetParallelSimulationEnabled(nanoem_physics_world_t * /* world */, nanoem_bool_t /* value */)
+{
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetMaxSubSteps(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetMaxSubSteps(nanoem_physics_world_t * /* world */, int /* value */)
+{
+}
+
+nanoem_bool_t APIENTRY
+nanoemPhysicsWorldIsInterpolationEnabled(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSetInterpolationEnabled(nanoem_physics_world_t * /* world */, nanoem_bool_t /* value */)
+{
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetNumSteps(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+int APIENTRY
+nanoemPhysicsWorldGetNumDroppedSteps(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+nanoem_rsize_t APIENTRY
+nanoemPhysicsWorldGetStateSize(const nanoem_physics_world_t * /* world */)
+{
+    return 0;
+}
+
+void APIENTRY
+nanoemPhysicsWorldSaveState(const nanoem_physics_world_t * /* world */, nanoem_u8_t * /* data */,
+    nanoem_rsize_t /* size */, nanoem_status_t *status)
+{
+    nanoem_status_ptr_assign_null_object(status);
+}
+
+void APIENTRY
+nanoemPhysicsWorldRestoreState(nanoem_physics_world_t * /* world */, const nanoem_u8_t * /* data */,
+    nanoem_rsize_t /* size */, nanoem_status_t *status)
+{
+    nanoem_status_ptr_assign_null_object(status);
+}
+
 void APIENTRY
 nanoemPhysicsWorldDestroy(nanoem_physics_world_t * /* world */)
 {
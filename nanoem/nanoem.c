@@ -539,6 +539,137 @@ nanoemBufferDestroy(nanoem_buffer_t *buffer)
     }
 }
 
+/* every object is aligned as same as nanoem_f128_t */
+#define NANOEM_OBJECT_ARENA_ALIGNMENT 16
+#define nanoem_object_arena_align(size) (((size) + (NANOEM_OBJECT_ARENA_ALIGNMENT - 1)) & ~((nanoem_rsize_t) NANOEM_OBJECT_ARENA_ALIGNMENT - 1))
+static const nanoem_rsize_t __nanoem_object_arena_default_chunk_size = 256 * 1024;
+
+nanoem_object_arena_t *
+nanoemObjectArenaCreate(nanoem_rsize_t chunk_size, nanoem_status_t *status)
+{
+    nanoem_object_arena_t *arena;
+    arena = (nanoem_object_arena_t *) nanoem_calloc(1, sizeof(*arena), status);
+    if (nanoem_is_not_null(arena)) {
+        arena->chunk_size = nanoem_object_arena_align(chunk_size > 0 ? chunk_size : __nanoem_object_arena_default_chunk_size);
+    }
+    return arena;
+}
+
+void *
+nanoemObjectArenaAllocate(nanoem_object_arena_t *arena, nanoem_rsize_t size, nanoem_status_t *status)
+{
+    static const nanoem_rsize_t header_size = nanoem_object_arena_align(sizeof(nanoem_object_arena_chunk_t));
+    nanoem_object_arena_chunk_t *chunk = arena->chunks;
+    nanoem_rsize_t capacity;
+    void *ptr;
+    size = nanoem_object_arena_align(size);
+    if (nanoem_is_null(chunk) || chunk->capacity - chunk->offset < size) {
+        capacity = size > arena->chunk_size ? size : arena->chunk_size;
+        /* chunks are never reused so objects carved from them are zero cleared as nanoem_calloc does */
+        chunk = (nanoem_object_arena_chunk_t *) nanoem_calloc(1, header_size + capacity, status);
+        if (nanoem_is_null(chunk)) {
+            return NULL;
+        }
+        chunk->capacity = capacity;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    ptr = (nanoem_u8_t *) chunk + header_size + chunk->offset;
+    chunk->offset += size;
+    arena->num_objects++;
+    return ptr;
+}
+
+static void
+nanoemObjectArenaDestroy(nanoem_object_arena_t *arena)
+{
+    nanoem_object_arena_chunk_t *chunk = arena->chunks, *next;
+    while (nanoem_is_not_null(chunk)) {
+        next = chunk->next;
+        nanoem_free(chunk);
+        chunk = next;
+    }
+    nanoem_free(arena);
+}
+
+void
+nanoemObjectArenaRelease(nanoem_object_arena_t *arena)
+{
+    if (nanoem_is_not_null(arena) && arena->num_objects > 0) {
+        arena->num_objects--;
+        if (arena->is_detached && arena->num_objects == 0) {
+            nanoemObjectArenaDestroy(arena);
+        }
+    }
+}
+
+void
+nanoemObjectArenaDetach(nanoem_object_arena_t *arena)
+{
+    if (nanoem_is_not_null(arena)) {
+        arena->is_detached = nanoem_true;
+        if (arena->num_objects == 0) {
+            nanoemObjectArenaDestroy(arena);
+        }
+    }
+}
+
+static void *
+nanoemModelObjectAllocate(const nanoem_model_t *model, nanoem_rsize_t size, nanoem_status_t *status)
+{
+    nanoem_object_arena_t *arena = nanoem_is_not_null(model) ? model->object_arena : NULL;
+    nanoem_model_object_t *object;
+    if (nanoem_is_not_null(arena)) {
+        object = (nanoem_model_object_t *) nanoemObjectArenaAllocate(arena, size, status);
+        if (nanoem_is_not_null(object)) {
+            object->arena = arena;
+        }
+    }
+    else {
+        object = (nanoem_model_object_t *) nanoem_calloc(1, size, status);
+    }
+    return object;
+}
+
+static void
+nanoemModelObjectFree(nanoem_model_object_t *object)
+{
+    if (nanoem_is_not_null(object->arena)) {
+        nanoemObjectArenaRelease(object->arena);
+    }
+    else {
+        nanoem_free(object);
+    }
+}
+
+static void *
+nanoemMotionKeyframeObjectAllocate(const nanoem_motion_t *motion, nanoem_rsize_t size, nanoem_status_t *status)
+{
+    nanoem_object_arena_t *arena = nanoem_is_not_null(motion) ? motion->object_arena : NULL;
+    nanoem_motion_keyframe_object_t *object;
+    if (nanoem_is_not_null(arena)) {
+        object = (nanoem_motion_keyframe_object_t *) nanoemObjectArenaAllocate(arena, size, status);
+        if (nanoem_is_not_null(object)) {
+            object->arena = arena;
+        }
+    }
+    else {
+        object = (nanoem_motion_keyframe_object_t *) nanoem_calloc(1, size, status);
+    }
+    return object;
+}
+
+static void
+nanoemMotionKeyframeObjectFree(nanoem_motion_keyframe_object_t *object)
+{
+    if (nanoem_is_not_null(object->arena)) {
+        nanoemObjectArenaRelease(object->arena);
+    }
+    else {
+        nanoem_free(object);
+    }
+}
+
 static int
 nanoemModelGetBoneGetDepth(const nanoem_model_bone_t *bone, const nanoem_model_bone_t **parent)
 {
@@ -610,7 +741,7 @@ nanoem_model_vertex_t *
 nanoemModelVertexCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_vertex_t *vertex;
-    vertex = (nanoem_model_vertex_t *) nanoem_calloc(1, sizeof(*vertex), status);
+    vertex = (nanoem_model_vertex_t *) nanoemModelObjectAllocate(model, sizeof(*vertex), status);
     if (nanoem_is_not_null(vertex)) {
         nanoemModelObjectInitialize(&vertex->base, model);
         vertex->type = NANOEM_MODEL_VERTEX_TYPE_UNKNOWN;
@@ -1144,6 +1275,327 @@ nanoemModelParsePMD(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_statu
     return nanoemBufferIsEnd(buffer);
 }
 
+/* grain sizes of the parallel dispatcher, a morph record is usually much larger than a vertex record */
+static const nanoem_rsize_t __nanoem_model_parallel_vertex_grain_size = 1024;
+static const nanoem_rsize_t __nanoem_model_parallel_morph_grain_size = 8;
+
+typedef struct nanoem_model_parallel_parse_pmx_t nanoem_model_parallel_parse_pmx_t;
+struct nanoem_model_parallel_parse_pmx_t {
+    nanoem_model_t *model;
+    const nanoem_global_allocator_t *allocator;
+    const nanoem_u8_t *data;
+    nanoem_rsize_t length;
+    const nanoem_rsize_t *offsets;
+    nanoem_status_t *statuses;
+};
+
+static nanoem_bool_t
+nanoemModelIsValidIndexSizePMX(nanoem_rsize_t size)
+{
+    return size == 1 || size == 2 || size == 4;
+}
+
+/* same as nanoemBufferReadLength, the length exceeding the rest of the buffer is treated as zero */
+static nanoem_bool_t
+nanoemModelScanLengthPMX(const nanoem_u8_t *data, nanoem_rsize_t length, nanoem_rsize_t *offset, nanoem_rsize_t *value)
+{
+    const nanoem_u8_t *ptr;
+    nanoem_rsize_t v;
+    if (length - *offset < 4) {
+        return nanoem_false;
+    }
+    ptr = data + *offset;
+    v = (nanoem_rsize_t) (nanoem_i32_t) ((nanoem_u32_t) ptr[0] | ((nanoem_u32_t) ptr[1] << 8) | ((nanoem_u32_t) ptr[2] << 16) | ((nanoem_u32_t) ptr[3] << 24));
+    *offset += 4;
+    *value = length - *offset >= v ? v : 0;
+    return nanoem_true;
+}
+
+static nanoem_rsize_t *
+nanoemModelScanVertexBlockPMX(const nanoem_model_t *model, const nanoem_buffer_t *buffer, nanoem_rsize_t num_vertices)
+{
+    const nanoem_u8_t *data = buffer->data;
+    nanoem_rsize_t *offsets, length = buffer->length, offset = buffer->offset, bone_index_size, base_size, size, i;
+    bone_index_size = model->info.bone_index_size;
+    if (!nanoemModelIsValidIndexSizePMX(bone_index_size) || model->info.additional_uv_size > 4) {
+        return NULL;
+    }
+    /* origin, normal, uv and additional uvs precede the vertex type */
+    base_size = sizeof(nanoem_f32_t) * (3 + 3 + 2 + 4 * model->info.additional_uv_size);
+    offsets = (nanoem_rsize_t *) nanoem_calloc(num_vertices + 1, sizeof(*offsets), NULL);
+    if (nanoem_is_not_null(offsets)) {
+        for (i = 0; i < num_vertices; i++) {
+            offsets[i] = offset;
+            if (length - offset <= base_size) {
+                break;
+            }
+            switch (data[offset + base_size]) {
+            case NANOEM_MODEL_VERTEX_TYPE_BDEF1:
+                size = bone_index_size;
+                break;
+            case NANOEM_MODEL_VERTEX_TYPE_BDEF2:
+                size = bone_index_size * 2 + sizeof(nanoem_f32_t);
+                break;
+            case NANOEM_MODEL_VERTEX_TYPE_BDEF4:
+            case NANOEM_MODEL_VERTEX_TYPE_QDEF:
+                size = bone_index_size * 4 + sizeof(nanoem_f32_t) * 4;
+                break;
+            case NANOEM_MODEL_VERTEX_TYPE_SDEF:
+                size = bone_index_size * 2 + sizeof(nanoem_f32_t) * (1 + 3 * 3);
+                break;
+            default:
+                size = 0;
+                break;
+            }
+            /* type and edge size are added to the bone weights */
+            if (size == 0 || length - offset < base_size + 1 + size + sizeof(nanoem_f32_t)) {
+                break;
+            }
+            offset += base_size + 1 + size + sizeof(nanoem_f32_t);
+        }
+        if (i < num_vertices) {
+            nanoem_free(offsets);
+            offsets = NULL;
+        }
+        else {
+            offsets[num_vertices] = offset;
+        }
+    }
+    return offsets;
+}
+
+static nanoem_rsize_t
+nanoemModelGetMorphItemSizePMX(const nanoem_model_t *model, int type)
+{
+    nanoem_rsize_t index_size, size;
+    switch (type) {
+    case NANOEM_MODEL_MORPH_TYPE_BONE:
+        index_size = model->info.bone_index_size;
+        size = sizeof(nanoem_f32_t) * (3 + 4);
+        break;
+    case NANOEM_MODEL_MORPH_TYPE_FLIP:
+    case NANOEM_MODEL_MORPH_TYPE_GROUP:
+        index_size = model->info.morph_index_size;
+        size = sizeof(nanoem_f32_t);
+        break;
+    case NANOEM_MODEL_MORPH_TYPE_IMPULUSE:
+        index_size = model->info.rigid_body_index_size;
+        size = 1 + sizeof(nanoem_f32_t) * (3 + 3);
+        break;
+    case NANOEM_MODEL_MORPH_TYPE_MATERIAL:
+        index_size = model->info.material_index_size;
+        size = 1 + sizeof(nanoem_f32_t) * (4 + 4 + 3 + 4 + 1 + 4 + 4 + 4);
+        break;
+    case NANOEM_MODEL_MORPH_TYPE_TEXTURE:
+    case NANOEM_MODEL_MORPH_TYPE_UVA1:
+    case NANOEM_MODEL_MORPH_TYPE_UVA2:
+    case NANOEM_MODEL_MORPH_TYPE_UVA3:
+    case NANOEM_MODEL_MORPH_TYPE_UVA4:
+        index_size = model->info.vertex_index_size;
+        size = sizeof(nanoem_f32_t) * 4;
+        break;
+    case NANOEM_MODEL_MORPH_TYPE_VERTEX:
+        index_size = model->info.vertex_index_size;
+        size = sizeof(nanoem_f32_t) * 3;
+        break;
+    default:
+        index_size = size = 0;
+        break;
+    }
+    return nanoemModelIsValidIndexSizePMX(index_size) ? index_size + size : 0;
+}
+
+static nanoem_rsize_t *
+nanoemModelScanMorphBlockPMX(const nanoem_model_t *model, const nanoem_buffer_t *buffer, nanoem_rsize_t num_morphs)
+{
+    const nanoem_u8_t *data = buffer->data;
+    nanoem_rsize_t *offsets, length = buffer->length, offset = buffer->offset, item_size, num_objects, i;
+    offsets = (nanoem_rsize_t *) nanoem_calloc(num_morphs + 1, sizeof(*offsets), NULL);
+    if (nanoem_is_not_null(offsets)) {
+        for (i = 0; i < num_morphs; i++) {
+            offsets[i] = offset;
+            /* name_ja and name_en, an empty string consumes only its length */
+            if (!nanoemModelScanLengthPMX(data, length, &offset, &item_size)) {
+                break;
+            }
+            offset += item_size;
+            if (!nanoemModelScanLengthPMX(data, length, &offset, &item_size)) {
+                break;
+            }
+            offset += item_size;
+            if (length - offset < 2 || data[offset] >= NANOEM_MODEL_MORPH_CATEGORY_MAX_ENUM) {
+                break;
+            }
+            item_size = nanoemModelGetMorphItemSizePMX(model, data[offset + 1]);
+            offset += 2;
+            if (item_size == 0 || !nanoemModelScanLengthPMX(data, length, &offset, &num_objects) || (length - offset) / item_size < num_objects) {
+                break;
+            }
+            offset += item_size * num_objects;
+        }
+        if (i < num_morphs) {
+            nanoem_free(offsets);
+            offsets = NULL;
+        }
+        else {
+            offsets[num_morphs] = offset;
+        }
+    }
+    return offsets;
+}
+
+static void
+nanoemModelParseVertexRangePMX(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const nanoem_model_parallel_parse_pmx_t *context = (const nanoem_model_parallel_parse_pmx_t *) opaque;
+    const nanoem_global_allocator_t *allocator = nanoemGlobalGetCustomAllocator();
+    nanoem_buffer_t buffer;
+    nanoem_rsize_t i;
+    nanoemGlobalSetCustomAllocator(context->allocator);
+    buffer.data = context->data;
+    buffer.length = context->length;
+    for (i = begin; i < end; i++) {
+        buffer.offset = context->offsets[i];
+        nanoemModelVertexParsePMX(context->model->vertices[i], &buffer, &context->statuses[i]);
+    }
+    nanoemGlobalSetCustomAllocator(allocator);
+}
+
+static void
+nanoemModelParseMorphRangePMX(void *opaque, nanoem_rsize_t begin, nanoem_rsize_t end)
+{
+    const nanoem_model_parallel_parse_pmx_t *context = (const nanoem_model_parallel_parse_pmx_t *) opaque;
+    const nanoem_global_allocator_t *allocator = nanoemGlobalGetCustomAllocator();
+    nanoem_buffer_t buffer;
+    nanoem_rsize_t i;
+    /* the custom allocator is thread local so the caller's one is used to allocate morph items and strings */
+    nanoemGlobalSetCustomAllocator(context->allocator);
+    buffer.data = context->data;
+    buffer.length = context->length;
+    for (i = begin; i < end; i++) {
+        buffer.offset = context->offsets[i];
+        nanoemModelMorphParsePMX(context->model->morphs[i], &buffer, &context->statuses[i]);
+    }
+    nanoemGlobalSetCustomAllocator(allocator);
+}
+
+static nanoem_status_t *
+nanoemModelParallelParseBeginPMX(nanoem_model_parallel_parse_pmx_t *context, nanoem_model_t *model, const nanoem_buffer_t *buffer, nanoem_rsize_t *offsets, nanoem_rsize_t num_objects)
+{
+    nanoem_status_t *statuses = NULL;
+    nanoem_rsize_t i;
+    if (nanoem_is_not_null(offsets)) {
+        statuses = (nanoem_status_t *) nanoem_calloc(num_objects, sizeof(*statuses), NULL);
+        if (nanoem_is_not_null(statuses)) {
+            for (i = 0; i < num_objects; i++) {
+                statuses[i] = NANOEM_STATUS_SUCCESS;
+            }
+            context->model = model;
+            context->allocator = nanoemGlobalGetCustomAllocator();
+            context->data = buffer->data;
+            context->length = buffer->length;
+            context->offsets = offsets;
+            context->statuses = statuses;
+        }
+        else {
+            nanoem_free(offsets);
+        }
+    }
+    return statuses;
+}
+
+static nanoem_bool_t
+nanoemModelParseVertexBlockParallelPMX(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_rsize_t num_vertices, nanoem_status_t *status)
+{
+    nanoem_model_parallel_parse_pmx_t context;
+    nanoem_model_vertex_t *vertex;
+    nanoem_rsize_t *offsets, num_created, i;
+    nanoem_status_t *statuses;
+    offsets = nanoemModelScanVertexBlockPMX(model, buffer, num_vertices);
+    statuses = nanoemModelParallelParseBeginPMX(&context, model, buffer, offsets, num_vertices);
+    if (nanoem_is_null(statuses)) {
+        return nanoem_false;
+    }
+    /* objects are created on the caller thread since the object arena is not thread safe */
+    for (i = 0; i < num_vertices; i++) {
+        vertex = nanoemModelVertexCreate(model, &statuses[i]);
+        if (nanoem_is_null(vertex)) {
+            nanoem_status_ptr_assign_null_object(&statuses[i]);
+            break;
+        }
+        model->vertices[i] = vertex;
+    }
+    num_created = i;
+    if (num_created > 0) {
+        model->parallel_dispatcher(model->parallel_dispatcher_user_data, nanoemModelParseVertexRangePMX, &context, num_created, __nanoem_model_parallel_vertex_grain_size);
+    }
+    for (i = 0; i < num_vertices && !nanoem_status_ptr_has_error(&statuses[i]); i++) {
+        model->vertices[i]->base.index = (int) i;
+    }
+    /* discard the first failed vertex and the followings as the serial parser never reaches them */
+    if (i < num_vertices) {
+        nanoem_status_ptr_assign(status, statuses[i]);
+        model->num_vertices = i;
+        for (; i < num_created; i++) {
+            nanoemModelVertexDestroy(model->vertices[i]);
+            model->vertices[i] = NULL;
+        }
+    }
+    else {
+        buffer->offset = offsets[num_vertices];
+    }
+    nanoem_free(statuses);
+    nanoem_free(offsets);
+    return nanoem_true;
+}
+
+static nanoem_bool_t
+nanoemModelParseMorphBlockParallelPMX(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_rsize_t num_morphs, nanoem_status_t *status)
+{
+    nanoem_model_parallel_parse_pmx_t context;
+    nanoem_model_morph_t *morph;
+    nanoem_rsize_t *offsets, num_created, i;
+    nanoem_status_t *statuses;
+    /* morph items are allocated while parsing and cannot be allocated from the object arena concurrently */
+    if (nanoem_is_not_null(model->object_arena)) {
+        return nanoem_false;
+    }
+    offsets = nanoemModelScanMorphBlockPMX(model, buffer, num_morphs);
+    statuses = nanoemModelParallelParseBeginPMX(&context, model, buffer, offsets, num_morphs);
+    if (nanoem_is_null(statuses)) {
+        return nanoem_false;
+    }
+    for (i = 0; i < num_morphs; i++) {
+        morph = nanoemModelMorphCreate(model, &statuses[i]);
+        if (nanoem_is_null(morph)) {
+            nanoem_status_ptr_assign_null_object(&statuses[i]);
+            break;
+        }
+        model->morphs[i] = morph;
+    }
+    num_created = i;
+    if (num_created > 0) {
+        model->parallel_dispatcher(model->parallel_dispatcher_user_data, nanoemModelParseMorphRangePMX, &context, num_created, __nanoem_model_parallel_morph_grain_size);
+    }
+    for (i = 0; i < num_morphs && !nanoem_status_ptr_has_error(&statuses[i]); i++) {
+        model->morphs[i]->base.index = (int) i;
+    }
+    if (i < num_morphs) {
+        nanoem_status_ptr_assign(status, statuses[i]);
+        model->num_morphs = i;
+        for (; i < num_created; i++) {
+            nanoemModelMorphDestroy(model->morphs[i]);
+            model->morphs[i] = NULL;
+        }
+    }
+    else {
+        buffer->offset = offsets[num_morphs];
+    }
+    nanoem_free(statuses);
+    nanoem_free(offsets);
+    return nanoem_true;
+}
+
 static void
 nanoemModelParseVertexBlockPMX(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_status_t *status)
 {
@@ -1154,6 +1606,9 @@ nanoemModelParseVertexBlockPMX(nanoem_model_t *model, nanoem_buffer_t *buffer, n
         model->vertices = (nanoem_model_vertex_t **) nanoem_calloc(num_vertices, sizeof(*model->vertices), status);
         if (nanoem_is_not_null(model->vertices)) {
             model->num_vertices = num_vertices;
+            if (nanoem_is_not_null(model->parallel_dispatcher) && nanoemModelParseVertexBlockParallelPMX(model, buffer, num_vertices, status)) {
+                return;
+            }
             for (i = 0; i < num_vertices; i++) {
                 vertex = nanoemModelVertexCreate(model, status);
                 nanoemModelVertexParsePMX(vertex, buffer, status);
@@ -1289,6 +1744,9 @@ nanoemModelParseMorphBlockPMX(nanoem_model_t *model, nanoem_buffer_t *buffer, na
         model->morphs = (nanoem_model_morph_t **) nanoem_calloc(num_morphs, sizeof(*model->morphs), status);
         if (nanoem_is_not_null(model->morphs)) {
             model->num_morphs = num_morphs;
+            if (nanoem_is_not_null(model->parallel_dispatcher) && nanoemModelParseMorphBlockParallelPMX(model, buffer, num_morphs, status)) {
+                return;
+            }
             for (i = 0; i < num_morphs; i++) {
                 morph = nanoemModelMorphCreate(model, status);
                 nanoemModelMorphParsePMX(morph, buffer, status);
@@ -1565,7 +2023,7 @@ nanoemModelVertexDestroy(nanoem_model_vertex_t *vertex)
 {
     if (nanoem_is_not_null(vertex)) {
         nanoemModelObjectDestroy(&vertex->base);
-        nanoem_free(vertex);
+        nanoemModelObjectFree(&vertex->base);
     }
 }
 
@@ -1573,7 +2031,7 @@ nanoem_model_material_t *
 nanoemModelMaterialCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_material_t *material;
-    material = (nanoem_model_material_t *) nanoem_calloc(1, sizeof(*material), status);
+    material = (nanoem_model_material_t *) nanoemModelObjectAllocate(model, sizeof(*material), status);
     if (nanoem_is_not_null(material)) {
         nanoemModelObjectInitialize(&material->base, model);
         material->sphere_map_texture_type = NANOEM_MODEL_MATERIAL_SPHERE_MAP_TEXTURE_UNKNOWN;
@@ -1740,7 +2198,7 @@ nanoemModelMaterialDestroy(nanoem_model_material_t *material)
             nanoemUtilDestroyString(material->name_en, factory);
             nanoemUtilDestroyString(material->clob, factory);
         }
-        nanoem_free(material);
+        nanoemModelObjectFree(&material->base);
     }
 }
 
@@ -1748,7 +2206,7 @@ nanoem_model_bone_t *
 nanoemModelBoneCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_bone_t *bone;
-    bone = (nanoem_model_bone_t *) nanoem_calloc(1, sizeof(*bone), status);
+    bone = (nanoem_model_bone_t *) nanoemModelObjectAllocate(model, sizeof(*bone), status);
     if (nanoem_is_not_null(bone)) {
         nanoemModelObjectInitialize(&bone->base, model);
         bone->parent_bone_index = NANOEM_MODEL_OBJECT_NOT_FOUND;
@@ -1907,7 +2365,7 @@ nanoemModelBoneDestroy(nanoem_model_bone_t *bone)
             nanoemUtilDestroyString(bone->name_ja, factory);
             nanoemUtilDestroyString(bone->name_en, factory);
         }
-        nanoem_free(bone);
+        nanoemModelObjectFree(&bone->base);
     }
 }
 
@@ -1915,7 +2373,7 @@ nanoem_model_constraint_joint_t *
 nanoemModelConstraintJointCreate(const nanoem_model_constraint_t *constraint, nanoem_status_t *status)
 {
     nanoem_model_constraint_joint_t *joint;
-    joint = (nanoem_model_constraint_joint_t *) nanoem_calloc(1, sizeof(*joint), status);
+    joint = (nanoem_model_constraint_joint_t *) nanoemModelObjectAllocate(nanoem_is_not_null(constraint) ? constraint->base.parent.model : NULL, sizeof(*joint), status);
     if (nanoem_is_not_null(joint)) {
         joint->base.parent.constraint = constraint;
         joint->bone_index = NANOEM_MODEL_OBJECT_NOT_FOUND;
@@ -1927,7 +2385,7 @@ void
 nanoemModelConstraintJointDestroy(nanoem_model_constraint_joint_t *joint)
 {
     if (nanoem_is_not_null(joint)) {
-        nanoem_free(joint);
+        nanoemModelObjectFree(&joint->base);
     }
 }
 
@@ -1935,7 +2393,7 @@ nanoem_model_constraint_t *
 nanoemModelConstraintCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_constraint_t *constraint;
-    constraint = (nanoem_model_constraint_t *) nanoem_calloc(1, sizeof(*constraint), status);
+    constraint = (nanoem_model_constraint_t *) nanoemModelObjectAllocate(model, sizeof(*constraint), status);
     if (nanoem_is_not_null(constraint)) {
         nanoemModelObjectInitialize(&constraint->base, model);
         constraint->effector_bone_index = -1;
@@ -2045,7 +2503,7 @@ nanoemModelConstraintDestroy(nanoem_model_constraint_t *constraint)
             }
             nanoem_free(constraint->joints);
         }
-        nanoem_free(constraint);
+        nanoemModelObjectFree(&constraint->base);
     }
 }
 
@@ -2053,7 +2511,7 @@ nanoem_model_texture_t *
 nanoemModelTextureCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_texture_t *texture;
-    texture = (nanoem_model_texture_t *) nanoem_calloc(1, sizeof(*texture), status);
+    texture = (nanoem_model_texture_t *) nanoemModelObjectAllocate(model, sizeof(*texture), status);
     if (nanoem_is_not_null(texture)) {
         nanoemModelObjectInitialize(&texture->base, model);
     }
@@ -2098,7 +2556,7 @@ nanoemModelTextureDestroy(nanoem_model_texture_t *texture)
             factory = parent_model->factory;
             nanoemUtilDestroyString(texture->path, factory);
         }
-        nanoem_free(texture);
+        nanoemModelObjectFree(&texture->base);
     }
 }
 
@@ -2106,7 +2564,7 @@ nanoem_model_morph_bone_t *
 nanoemModelMorphBoneCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_bone_t *morph;
-    morph = (nanoem_model_morph_bone_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_bone_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
     }
@@ -2117,7 +2575,7 @@ void
 nanoemModelMorphBoneDestroy(nanoem_model_morph_bone_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2125,7 +2583,7 @@ nanoem_model_morph_flip_t *
 nanoemModelMorphFlipCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_flip_t *morph;
-    morph = (nanoem_model_morph_flip_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_flip_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
     }
@@ -2136,7 +2594,7 @@ void
 nanoemModelMorphFlipDestroy(nanoem_model_morph_flip_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2144,7 +2602,7 @@ nanoem_model_morph_group_t *
 nanoemModelMorphGroupCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_group_t *morph;
-    morph = (nanoem_model_morph_group_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_group_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
     }
@@ -2155,7 +2613,7 @@ void
 nanoemModelMorphGroupDestroy(nanoem_model_morph_group_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2163,7 +2621,7 @@ nanoem_model_morph_impulse_t *
 nanoemModelMorphImpulseCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_impulse_t *morph;
-    morph = (nanoem_model_morph_impulse_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_impulse_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
     }
@@ -2174,7 +2632,7 @@ void
 nanoemModelMorphImpulseDestroy(nanoem_model_morph_impulse_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2182,7 +2640,7 @@ nanoem_model_morph_material_t *
 nanoemModelMorphMaterialCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_material_t *morph;
-    morph = (nanoem_model_morph_material_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_material_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
         morph->operation = NANOEM_MODEL_MORPH_MATERIAL_OPERATION_TYPE_UNKNOWN;
@@ -2194,7 +2652,7 @@ void
 nanoemModelMorphMaterialDestroy(nanoem_model_morph_material_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2202,7 +2660,7 @@ nanoem_model_morph_uv_t *
 nanoemModelMorphUVCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_uv_t *morph;
-    morph = (nanoem_model_morph_uv_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_uv_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
     }
@@ -2213,7 +2671,7 @@ void
 nanoemModelMorphUVDestroy(nanoem_model_morph_uv_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2221,7 +2679,7 @@ nanoem_model_morph_vertex_t *
 nanoemModelMorphVertexCreate(const nanoem_model_morph_t *parent, nanoem_status_t *status)
 {
     nanoem_model_morph_vertex_t *morph;
-    morph = (nanoem_model_morph_vertex_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_vertex_t *) nanoemModelObjectAllocate(nanoem_is_not_null(parent) ? parent->base.parent.model : NULL, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         morph->base.parent.morph = parent;
         morph->relative_index = NANOEM_MODEL_OBJECT_NOT_FOUND;
@@ -2233,7 +2691,7 @@ void
 nanoemModelMorphVertexDestroy(nanoem_model_morph_vertex_t *morph)
 {
     if (nanoem_is_not_null(morph)) {
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2241,7 +2699,7 @@ nanoem_model_morph_t *
 nanoemModelMorphCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_morph_t *morph;
-    morph = (nanoem_model_morph_t *) nanoem_calloc(1, sizeof(*morph), status);
+    morph = (nanoem_model_morph_t *) nanoemModelObjectAllocate(model, sizeof(*morph), status);
     if (nanoem_is_not_null(morph)) {
         nanoemModelObjectInitialize(&morph->base, model);
         morph->category = NANOEM_MODEL_MORPH_CATEGORY_UNKNOWN;
@@ -2780,7 +3238,7 @@ nanoemModelMorphDestroy(nanoem_model_morph_t *morph)
             nanoemUtilDestroyString(morph->name_en, factory);
         }
         nanoemModelObjectDestroy(&morph->base);
-        nanoem_free(morph);
+        nanoemModelObjectFree(&morph->base);
     }
 }
 
@@ -2789,7 +3247,7 @@ nanoemModelLabelItemCreate(const nanoem_model_label_t *parent, nanoem_status_t *
 {
     nanoem_model_label_item_t *item = NULL;
     if (nanoem_is_not_null(parent)) {
-        item = (nanoem_model_label_item_t *) nanoem_calloc(1, sizeof(*item), status);
+        item = (nanoem_model_label_item_t *) nanoemModelObjectAllocate(parent->base.parent.model, sizeof(*item), status);
         if (nanoem_is_not_null(item)) {
             item->base.parent.label = parent;
             item->type = NANOEM_MODEL_LABEL_ITEM_TYPE_UNKNOWN;
@@ -2802,7 +3260,7 @@ void
 nanoemModelLabelItemDestroy(nanoem_model_label_item_t *item)
 {
     if (nanoem_is_not_null(item)) {
-        nanoem_free(item);
+        nanoemModelObjectFree(&item->base);
     }
 }
 
@@ -2810,7 +3268,7 @@ nanoem_model_label_t *
 nanoemModelLabelCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_label_t *label;
-    label = (nanoem_model_label_t *) nanoem_calloc(1, sizeof(*label), status);
+    label = (nanoem_model_label_t *) nanoemModelObjectAllocate(model, sizeof(*label), status);
     if (nanoem_is_not_null(label)) {
         nanoemModelObjectInitialize(&label->base, model);
     }
@@ -2900,7 +3358,7 @@ nanoemModelLabelDestroy(nanoem_model_label_t *label)
             }
             nanoem_free(label->items);
         }
-        nanoem_free(label);
+        nanoemModelObjectFree(&label->base);
     }
 }
 
@@ -2908,7 +3366,7 @@ nanoem_model_rigid_body_t *
 nanoemModelRigidBodyCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_rigid_body_t *rigid_body;
-    rigid_body = (nanoem_model_rigid_body_t *) nanoem_calloc(1, sizeof(*rigid_body), status);
+    rigid_body = (nanoem_model_rigid_body_t *) nanoemModelObjectAllocate(model, sizeof(*rigid_body), status);
     if (nanoem_is_not_null(rigid_body)) {
         nanoemModelObjectInitialize(&rigid_body->base, model);
         rigid_body->shape_type = NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_UNKNOWN;
@@ -3011,7 +3469,7 @@ nanoemModelRigidBodyDestroy(nanoem_model_rigid_body_t *rigid_body)
             nanoemUtilDestroyString(rigid_body->name_en, factory);
         }
         nanoemModelObjectDestroy(&rigid_body->base);
-        nanoem_free(rigid_body);
+        nanoemModelObjectFree(&rigid_body->base);
     }
 }
 
@@ -3019,7 +3477,7 @@ nanoem_model_joint_t *
 nanoemModelJointCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_joint_t *joint;
-    joint = (nanoem_model_joint_t *) nanoem_calloc(1, sizeof(*joint), status);
+    joint = (nanoem_model_joint_t *) nanoemModelObjectAllocate(model, sizeof(*joint), status);
     if (nanoem_is_not_null(joint)) {
         nanoemModelObjectInitialize(&joint->base, model);
         joint->type = NANOEM_MODEL_JOINT_TYPE_UNKNOWN;
@@ -3114,7 +3572,7 @@ nanoemModelJointDestroy(nanoem_model_joint_t *joint)
             nanoemUtilDestroyString(joint->name_en, factory);
         }
         nanoemModelObjectDestroy(&joint->base);
-        nanoem_free(joint);
+        nanoemModelObjectFree(&joint->base);
     }
 }
 
@@ -3123,7 +3581,7 @@ nanoemModelSoftBodyAnchorCreate(const nanoem_model_soft_body_t *parent, nanoem_s
 {
     nanoem_model_soft_body_anchor_t *item = NULL;
     if (nanoem_is_not_null(parent)) {
-        item = (nanoem_model_soft_body_anchor_t *) nanoem_calloc(1, sizeof(*item), status);
+        item = (nanoem_model_soft_body_anchor_t *) nanoemModelObjectAllocate(parent->base.parent.model, sizeof(*item), status);
         if (nanoem_is_not_null(item)) {
             item->base.parent.soft_body = parent;
         }
@@ -3135,7 +3593,7 @@ nanoem_model_soft_body_t *
 nanoemModelSoftBodyCreate(const nanoem_model_t *model, nanoem_status_t *status)
 {
     nanoem_model_soft_body_t *soft_body;
-    soft_body = (nanoem_model_soft_body_t *) nanoem_calloc(1, sizeof(*soft_body), status);
+    soft_body = (nanoem_model_soft_body_t *) nanoemModelObjectAllocate(model, sizeof(*soft_body), status);
     if (nanoem_is_not_null(soft_body)) {
         nanoemModelObjectInitialize(&soft_body->base, model);
     }
@@ -3256,7 +3714,7 @@ void
 nanoemModelSoftBodyAnchorDestroy(nanoem_model_soft_body_anchor_t *anchor)
 {
     if (nanoem_is_not_null(anchor)) {
-        nanoem_free(anchor);
+        nanoemModelObjectFree(&anchor->base);
     }
 }
 
@@ -3282,7 +3740,7 @@ nanoemModelSoftBodyDestroy(nanoem_model_soft_body_t *soft_body)
         }
         nanoemModelObjectDestroy(&soft_body->base);
         nanoem_free(soft_body->pinned_vertex_indices);
-        nanoem_free(soft_body);
+        nanoemModelObjectFree(&soft_body->base);
     }
 }
 
@@ -4812,6 +5270,32 @@ nanoemModelCreate(nanoem_unicode_string_factory_t *factory, nanoem_status_t *sta
     return model;
 }
 
+void APIENTRY
+nanoemModelEnableObjectArena(nanoem_model_t *model, nanoem_rsize_t chunk_size, nanoem_status_t *status)
+{
+    if (nanoem_is_not_null(model)) {
+        if (nanoem_is_null(model->object_arena)) {
+            model->object_arena = nanoemObjectArenaCreate(chunk_size, status);
+        }
+    }
+    else {
+        nanoem_status_ptr_assign_null_object(status);
+    }
+}
+
+/*
+ * the dispatcher must call the range function over [0, iterations) split by the grain size and return after all
+ * ranges are done. the unicode string factory of the model must be thread safe while loading in parallel
+ */
+void APIENTRY
+nanoemModelSetParallelDispatcher(nanoem_model_t *model, nanoem_model_parallel_dispatcher_t dispatcher, void *user_data)
+{
+    if (nanoem_is_not_null(model)) {
+        model->parallel_dispatcher = dispatcher;
+        model->parallel_dispatcher_user_data = user_data;
+    }
+}
+
 nanoem_bool_t APIENTRY
 nanoemModelLoadFromBufferPMD(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_status_t *status)
 {
@@ -5235,6 +5719,7 @@ nanoemModelDestroy(nanoem_model_t *model)
             }
             nanoem_free(model->soft_bodies);
         }
+        nanoemObjectArenaDetach(model->object_arena);
         nanoem_free(model);
     }
 }
@@ -5254,12 +5739,16 @@ nanoemMotionTrackBundleAddKeyframe(kh_motion_track_bundle_t *bundle, nanoem_moti
         track.factory = factory;
         track.id = 0;
         track.keyframes = NULL;
+        track.ordered_keyframes = NULL;
+        track.num_ordered_keyframes = 0;
+        track.is_ordered_keyframes_dirty = nanoem_false;
         track.name = u.m;
         it = kh_get_motion_track_bundle(bundle, track);
         if (it != kh_end(bundle)) {
             keyframes = kh_key(bundle, it).keyframes;
             it2 = kh_put_keyframe_map(keyframes, frame_index, ret);
             kh_val(keyframes, it2) = keyframe;
+            kh_key(bundle, it).is_ordered_keyframes_dirty = nanoem_true;
         }
     }
 }
@@ -5276,6 +5765,7 @@ nanoemMotionTrackBundleDestroy(kh_motion_track_bundle_t *bundle, nanoem_unicode_
                 name = kh_key(bundle, it).name;
                 nanoemUtilDestroyString(name, factory);
                 kh_destroy_keyframe_map(kh_key(bundle, it).keyframes);
+                nanoem_free(kh_key(bundle, it).ordered_keyframes);
             }
         }
         kh_destroy_motion_track_bundle(bundle);
@@ -5294,53 +5784,407 @@ nanoemStringCacheDestroy(kh_string_cache_t *cache)
     kh_destroy_string_cache(cache);
 }
 
+/* keyframes below this count are sorted by qsort as a histogram pass costs more than sorting itself */
+#define NANOEM_MOTION_KEYFRAME_RADIX_SORT_THRESHOLD 64
+
 static void
-nanoemMotionParseBoneKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status)
+nanoemMotionSortKeyframes(nanoem_motion_keyframe_object_t **keyframes, nanoem_rsize_t num_keyframes)
+{
+    nanoem_motion_keyframe_object_t **temporary, **source, **dest, **swap;
+    nanoem_frame_index_t min_frame_index, max_frame_index, frame_index;
+    nanoem_rsize_t counts[256], sum, count, i;
+    int shift;
+    if (num_keyframes < NANOEM_MOTION_KEYFRAME_RADIX_SORT_THRESHOLD) {
+        nanoem_crt_qsort(keyframes, num_keyframes, sizeof(*keyframes), nanoemMotionCompareKeyframe);
+        return;
+    }
+    temporary = (nanoem_motion_keyframe_object_t **) nanoem_calloc(num_keyframes, sizeof(*temporary), NULL);
+    if (nanoem_is_null(temporary)) {
+        nanoem_crt_qsort(keyframes, num_keyframes, sizeof(*keyframes), nanoemMotionCompareKeyframe);
+        return;
+    }
+    min_frame_index = max_frame_index = keyframes[0]->frame_index;
+    for (i = 1; i < num_keyframes; i++) {
+        frame_index = keyframes[i]->frame_index;
+        if (frame_index < min_frame_index) {
+            min_frame_index = frame_index;
+        }
+        else if (frame_index > max_frame_index) {
+            max_frame_index = frame_index;
+        }
+    }
+    /* LSD radix sort is stable and skips digits above the frame range so usual motions need only one or two passes */
+    source = keyframes;
+    dest = temporary;
+    for (shift = 0; shift < 32 && ((max_frame_index - min_frame_index) >> shift) != 0; shift += 8) {
+        for (i = 0; i < 256; i++) {
+            counts[i] = 0;
+        }
+        for (i = 0; i < num_keyframes; i++) {
+            counts[((source[i]->frame_index - min_frame_index) >> shift) & 0xff]++;
+        }
+        for (i = 0, sum = 0; i < 256; i++) {
+            count = counts[i];
+            counts[i] = sum;
+            sum += count;
+        }
+        for (i = 0; i < num_keyframes; i++) {
+            dest[counts[((source[i]->frame_index - min_frame_index) >> shift) & 0xff]++] = source[i];
+        }
+        swap = source;
+        source = dest;
+        dest = swap;
+    }
+    if (source != keyframes) {
+        nanoem_crt_memcpy(keyframes, source, num_keyframes * sizeof(*keyframes));
+    }
+    nanoem_free(temporary);
+}
+
+static void
+nanoemMotionTrackRebuildOrderedKeyframes(nanoem_motion_track_t *track)
 {
-    kh_string_cache_t *cache;
-    nanoem_motion_bone_keyframe_t *keyframe;
-    nanoem_rsize_t num_bone_keyframes, i;
-    num_bone_keyframes = nanoemBufferReadLength(buffer, status);
-    if (num_bone_keyframes > 0) {
-        cache = kh_init_string_cache();
-        motion->bone_keyframes = (nanoem_motion_bone_keyframe_t **) nanoem_calloc(num_bone_keyframes, sizeof(*motion->bone_keyframes), status);
-        if (nanoem_is_not_null(motion->bone_keyframes)) {
-            motion->num_bone_keyframes = num_bone_keyframes;
-            for (i = 0; i < num_bone_keyframes; i++) {
-                keyframe = nanoemMotionBoneKeyframeCreate(motion, status);
-                nanoemMotionBoneKeyframeParseVMD(keyframe, buffer, cache, offset, status);
-                if (nanoem_status_ptr_has_error(status)) {
-                    nanoemMotionBoneKeyframeDestroy(keyframe);
-                    num_bone_keyframes = motion->num_bone_keyframes = i;
-                    break;
-                }
-                nanoemMotionSetMaxFrameIndex(motion, &keyframe->base);
-                keyframe->base.index = (int) i;
-                motion->bone_keyframes[i] = keyframe;
+    kh_keyframe_map_t *keyframes_map = track->keyframes;
+    khiter_t it, end;
+    nanoem_rsize_t i = 0;
+    nanoem_free(track->ordered_keyframes);
+    track->ordered_keyframes = NULL;
+    track->num_ordered_keyframes = 0;
+    if (nanoem_is_not_null(keyframes_map) && kh_size(keyframes_map) > 0) {
+        track->ordered_keyframes = (nanoem_motion_keyframe_object_t **) nanoem_calloc(kh_size(keyframes_map), sizeof(*track->ordered_keyframes), NULL);
+        if (nanoem_is_null(track->ordered_keyframes)) {
+            /* keep the track dirty to fallback to linear search */
+            return;
+        }
+        for (it = kh_begin(keyframes_map), end = kh_end(keyframes_map); it != end; it++) {
+            if (kh_exist(keyframes_map, it)) {
+                track->ordered_keyframes[i++] = kh_val(keyframes_map, it);
             }
-            if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->bone_keyframes, num_bone_keyframes, sizeof(*motion->bone_keyframes), nanoemMotionCompareKeyframe);
+        }
+        nanoemMotionSortKeyframes(track->ordered_keyframes, i);
+        track->num_ordered_keyframes = i;
+    }
+    track->is_ordered_keyframes_dirty = nanoem_false;
+}
+
+void
+nanoemMotionTrackBundleRebuildAllOrderedKeyframes(kh_motion_track_bundle_t *bundle)
+{
+    khiter_t it, end;
+    if (nanoem_is_not_null(bundle)) {
+        end = kh_end(bundle);
+        for (it = kh_begin(bundle); it != end; it++) {
+            if (kh_exist(bundle, it)) {
+                nanoemMotionTrackRebuildOrderedKeyframes(&kh_key(bundle, it));
             }
         }
-        nanoemStringCacheDestroy(cache);
     }
 }
 
-static void
-nanoemMotionParseMorphKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status)
+NANOEM_DECL_INLINE static nanoem_bool_t
+nanoemMotionCanDecodeKeyframeBlockVMD(const nanoem_buffer_t *buffer, nanoem_rsize_t num_keyframes, nanoem_rsize_t keyframe_length)
 {
-    kh_string_cache_t *cache;
-    nanoem_motion_morph_keyframe_t *keyframe;
+    return nanoem_is_not_null(buffer) && buffer->length >= buffer->offset && (buffer->length - buffer->offset) / keyframe_length >= num_keyframes;
+}
+
+NANOEM_DECL_INLINE static nanoem_i32_t
+nanoemMotionDecodeInt32VMD(const nanoem_u8_t *ptr)
+{
+    union nanoem_u32_to_int32_cast_t {
+        nanoem_i32_t i;
+        nanoem_u32_t u;
+    } u;
+    u.u = (nanoem_u32_t) ptr[0] | ((nanoem_u32_t) ptr[1] << 8) | ((nanoem_u32_t) ptr[2] << 16) | ((nanoem_u32_t) ptr[3] << 24);
+    return u.i;
+}
+
+NANOEM_DECL_INLINE static void
+nanoemMotionDecodeFloat32VMD(const nanoem_u8_t *ptr, nanoem_f32_t *values, nanoem_rsize_t num_values)
+{
+    union nanoem_i32_to_float32_cast_t {
+        nanoem_i32_t i;
+        nanoem_f32_t f;
+    } u;
+    nanoem_rsize_t i;
+    for (i = 0; i < num_values; i++) {
+        u.i = nanoemMotionDecodeInt32VMD(ptr + i * sizeof(nanoem_f32_t));
+        values[i] = u.f;
+    }
+}
+
+NANOEM_DECL_INLINE static void
+nanoemMotionDecodeInterpolationVMD(const nanoem_u8_t *ptr, nanoem_interpolation_t *interpolation, nanoem_rsize_t num_interpolations)
+{
+    nanoem_rsize_t i, j;
+    /* interpolation parameters are stored component major (x0 of all types first) */
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < num_interpolations; j++) {
+            interpolation[j].u.values[i] = ptr[i * num_interpolations + j];
+        }
+    }
+}
+
+typedef nanoem_motion_track_index_t (*nanoem_motion_resolve_track_id_t)(nanoem_motion_t *, nanoem_unicode_string_t *, nanoem_unicode_string_t **, int *);
+NANOEM_STATIC_ASSERT(VMD_BONE_KEYFRAME_NAME_LENGTH == VMD_MORPH_KEYFRAME_NAME_LENGTH, "bone and morph keyframes share the same name length");
+
+static nanoem_bool_t
+nanoemMotionParseTrackNameVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, kh_string_cache_t *cache, kh_motion_track_bundle_t *bundle, nanoem_motion_resolve_track_id_t resolve, nanoem_motion_track_index_t *id, nanoem_unicode_string_t **name, nanoem_status_t *status)
+{
+    nanoem_unicode_string_factory_t *factory = motion->factory;
+    nanoem_unicode_string_t *found_name;
+    nanoem_rsize_t length = nanoemBufferGetLength(buffer) - nanoemBufferGetOffset(buffer);
+    khiter_t it;
+    int ret = 0;
+    char str[VMD_BONE_KEYFRAME_NAME_LENGTH + 1];
+    nanoemUtilCopyString(str, sizeof(str), (const char *) nanoemBufferGetDataPtr(buffer), length >= VMD_BONE_KEYFRAME_NAME_LENGTH ? VMD_BONE_KEYFRAME_NAME_LENGTH : length);
+    if (*str) {
+        it = kh_get_string_cache(cache, str);
+        if (it != kh_end(cache)) {
+            nanoemBufferSkip(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, status);
+            *name = nanoemMotionTrackBundleResolveName(bundle, kh_val(cache, it));
+            *id = kh_val(cache, it);
+        }
+        else {
+            *name = nanoemBufferGetStringFromCp932(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, factory, status);
+            *id = resolve(motion, *name, &found_name, &ret);
+            if (nanoem_unlikely(found_name)) {
+                nanoemUtilDestroyString(*name, factory);
+                *name = found_name;
+            }
+            if (ret < 0) {
+                return nanoem_false;
+            }
+            it = kh_put_string_cache(cache, nanoemUtilCloneString(str, status), &ret);
+            if (ret < 0) {
+                return nanoem_false;
+            }
+            kh_val(cache, it) = *id;
+        }
+    }
+    else {
+        nanoemBufferSkip(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, status);
+        *name = NULL;
+    }
+    return nanoem_true;
+}
+
+/*
+ * decoders below assume the whole keyframe block is validated by nanoemMotionCanDecodeKeyframeBlockVMD so they
+ * read fixed layout records straight from the buffer and skip per field bounds checks
+ */
+typedef struct nanoem_motion_track_table_vmd_t nanoem_motion_track_table_vmd_t;
+struct nanoem_motion_track_table_vmd_t {
+    nanoem_motion_t *motion;
+    kh_motion_track_bundle_t *bundle;
+    nanoem_motion_resolve_track_id_t resolve;
+    kh_string_cache_t *cache;
+    kh_keyframe_map_t **keyframes;
+    nanoem_rsize_t num_keyframes;
+};
+
+static void
+nanoemMotionTrackTableInitializeVMD(nanoem_motion_track_table_vmd_t *table, nanoem_motion_t *motion, kh_motion_track_bundle_t *bundle, nanoem_motion_resolve_track_id_t resolve, kh_string_cache_t *cache)
+{
+    table->motion = motion;
+    table->bundle = bundle;
+    table->resolve = resolve;
+    table->cache = cache;
+    table->keyframes = NULL;
+    table->num_keyframes = 0;
+}
+
+static void
+nanoemMotionTrackTableDestroyVMD(nanoem_motion_track_table_vmd_t *table)
+{
+    if (nanoem_is_not_null(table->keyframes)) {
+        /* keyframes are put into the maps directly so ordered keyframes of all tracks must be rebuilt */
+        nanoemMotionTrackBundleRebuildAllOrderedKeyframes(table->bundle);
+        nanoem_free(table->keyframes);
+    }
+}
+
+static kh_keyframe_map_t *
+nanoemMotionTrackTableResolveVMD(nanoem_motion_track_table_vmd_t *table, nanoem_buffer_t *buffer, nanoem_motion_track_index_t *id, nanoem_status_t *status)
+{
+    kh_keyframe_map_t **keyframes;
+    nanoem_motion_track_t *track;
+    nanoem_unicode_string_t *name;
+    nanoem_rsize_t num_keyframes, i;
+    khiter_t it;
+    char str[VMD_BONE_KEYFRAME_NAME_LENGTH + 1];
+    nanoemUtilCopyString(str, sizeof(str), (const char *) buffer->data + buffer->offset, VMD_BONE_KEYFRAME_NAME_LENGTH);
+    if (*str && (it = kh_get_string_cache(table->cache, str)) != kh_end(table->cache)) {
+        /* track names are resolved once per block instead of scanning the track bundle for each keyframe */
+        buffer->offset += VMD_BONE_KEYFRAME_NAME_LENGTH;
+        *id = kh_val(table->cache, it);
+        return (nanoem_rsize_t) *id < table->num_keyframes ? table->keyframes[*id] : NULL;
+    }
+    else if (nanoemMotionParseTrackNameVMD(table->motion, buffer, table->cache, table->bundle, table->resolve, id, &name, status) && !nanoem_status_ptr_has_error(status)) {
+        track = nanoemMotionTrackBundleFindTrack(table->bundle, name, table->motion->factory);
+        if (nanoem_is_not_null(track) && *id >= 0) {
+            if ((nanoem_rsize_t) *id >= table->num_keyframes) {
+                num_keyframes = (nanoem_rsize_t) *id * 2 + 1;
+                keyframes = (kh_keyframe_map_t **) nanoem_realloc(table->keyframes, num_keyframes * sizeof(*keyframes), status);
+                if (nanoem_is_null(keyframes)) {
+                    return NULL;
+                }
+                for (i = table->num_keyframes; i < num_keyframes; i++) {
+                    keyframes[i] = NULL;
+                }
+                table->keyframes = keyframes;
+                table->num_keyframes = num_keyframes;
+            }
+            table->keyframes[*id] = track->keyframes;
+            return track->keyframes;
+        }
+    }
+    return NULL;
+}
+
+static void
+nanoemMotionTrackTableAddKeyframeVMD(kh_keyframe_map_t *keyframes, nanoem_motion_keyframe_object_t *keyframe, nanoem_status_t *status)
+{
+    khiter_t it;
+    int ret = 0;
+    if (nanoem_is_not_null(keyframes)) {
+        it = kh_put_keyframe_map(keyframes, keyframe->frame_index, &ret);
+        if (ret >= 0) {
+            kh_val(keyframes, it) = keyframe;
+        }
+        nanoem_status_ptr_assign(status, ret >= 0 ? NANOEM_STATUS_SUCCESS : NANOEM_STATUS_ERROR_MALLOC_FAILED);
+    }
+}
+
+static void
+nanoemMotionBoneKeyframeDecodeVMD(nanoem_motion_bone_keyframe_t *keyframe, nanoem_buffer_t *buffer, nanoem_motion_track_table_vmd_t *table, nanoem_frame_index_t offset, nanoem_status_t *status)
+{
+    kh_keyframe_map_t *keyframes = nanoemMotionTrackTableResolveVMD(table, buffer, &keyframe->bone_id, status);
+    const nanoem_u8_t *ptr;
+    if (!nanoem_status_ptr_has_error(status)) {
+        ptr = buffer->data + buffer->offset;
+        keyframe->base.frame_index = nanoemMotionDecodeInt32VMD(ptr) + offset;
+        nanoemMotionDecodeFloat32VMD(ptr + 4, keyframe->translation.values, 3);
+        nanoemMotionDecodeFloat32VMD(ptr + 16, keyframe->orientation.values, 4);
+        nanoemMotionDecodeInterpolationVMD(ptr + 32, keyframe->interplation, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM);
+        buffer->offset += VMD_BONE_KEYFRAME_LENGTH - VMD_BONE_KEYFRAME_NAME_LENGTH;
+        nanoemMotionTrackTableAddKeyframeVMD(keyframes, &keyframe->base, status);
+    }
+}
+
+static void
+nanoemMotionMorphKeyframeDecodeVMD(nanoem_motion_morph_keyframe_t *keyframe, nanoem_buffer_t *buffer, nanoem_motion_track_table_vmd_t *table, nanoem_frame_index_t offset, nanoem_status_t *status)
+{
+    kh_keyframe_map_t *keyframes = nanoemMotionTrackTableResolveVMD(table, buffer, &keyframe->morph_id, status);
+    const nanoem_u8_t *ptr;
+    if (!nanoem_status_ptr_has_error(status)) {
+        ptr = buffer->data + buffer->offset;
+        keyframe->base.frame_index = nanoemMotionDecodeInt32VMD(ptr) + offset;
+        nanoemMotionDecodeFloat32VMD(ptr + 4, &keyframe->weight, 1);
+        buffer->offset += VMD_MORPH_KEYFRAME_LENGTH - VMD_MORPH_KEYFRAME_NAME_LENGTH;
+        nanoemMotionTrackTableAddKeyframeVMD(keyframes, &keyframe->base, status);
+    }
+}
+
+static void
+nanoemMotionCameraKeyframeDecodeVMD(nanoem_motion_camera_keyframe_t *keyframe, nanoem_buffer_t *buffer, nanoem_frame_index_t offset)
+{
+    const nanoem_u8_t *ptr = buffer->data + buffer->offset;
+    keyframe->base.frame_index = nanoemMotionDecodeInt32VMD(ptr) + offset;
+    nanoemMotionDecodeFloat32VMD(ptr + 4, &keyframe->distance, 1);
+    nanoemMotionDecodeFloat32VMD(ptr + 8, keyframe->look_at.values, 3);
+    nanoemMotionDecodeFloat32VMD(ptr + 20, keyframe->angle.values, 3);
+    nanoemMotionDecodeInterpolationVMD(ptr + 32, keyframe->interplation, NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM);
+    keyframe->fov = nanoemMotionDecodeInt32VMD(ptr + 56);
+    keyframe->is_perspective_view = ptr[60] == 0;
+    buffer->offset += VMD_CAMERA_KEYFRAME_LENGTH;
+}
+
+static void
+nanoemMotionLightKeyframeDecodeVMD(nanoem_motion_light_keyframe_t *keyframe, nanoem_buffer_t *buffer, nanoem_frame_index_t offset)
+{
+    const nanoem_u8_t *ptr = buffer->data + buffer->offset;
+    keyframe->base.frame_index = nanoemMotionDecodeInt32VMD(ptr) + offset;
+    nanoemMotionDecodeFloat32VMD(ptr + 4, keyframe->color.values, 3);
+    nanoemMotionDecodeFloat32VMD(ptr + 16, keyframe->direction.values, 3);
+    buffer->offset += VMD_LIGHT_KEYFRAME_LENGTH;
+}
+
+static void
+nanoemMotionSelfShadowKeyframeDecodeVMD(nanoem_motion_self_shadow_keyframe_t *keyframe, nanoem_buffer_t *buffer, nanoem_frame_index_t offset)
+{
+    const nanoem_u8_t *ptr = buffer->data + buffer->offset;
+    keyframe->base.frame_index = nanoemMotionDecodeInt32VMD(ptr) + offset;
+    keyframe->mode = ptr[4];
+    nanoemMotionDecodeFloat32VMD(ptr + 5, &keyframe->distance, 1);
+    buffer->offset += VMD_SELF_SHADOW_KEYFRAME_LENGTH;
+}
+
+static void
+nanoemMotionParseBoneKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status)
+{
+    kh_string_cache_t *cache;
+    nanoem_motion_bone_keyframe_t *keyframe;
+    nanoem_motion_track_table_vmd_t table;
+    nanoem_rsize_t num_bone_keyframes, i;
+    nanoem_bool_t bulk;
+    num_bone_keyframes = nanoemBufferReadLength(buffer, status);
+    if (num_bone_keyframes > 0) {
+        cache = kh_init_string_cache();
+        motion->bone_keyframes = (nanoem_motion_bone_keyframe_t **) nanoem_calloc(num_bone_keyframes, sizeof(*motion->bone_keyframes), status);
+        if (nanoem_is_not_null(motion->bone_keyframes)) {
+            motion->num_bone_keyframes = num_bone_keyframes;
+            bulk = nanoemMotionCanDecodeKeyframeBlockVMD(buffer, num_bone_keyframes, VMD_BONE_KEYFRAME_LENGTH);
+            nanoemMotionTrackTableInitializeVMD(&table, motion, motion->local_bone_motion_track_bundle, nanoemMotionResolveLocalBoneTrackId, cache);
+            for (i = 0; i < num_bone_keyframes; i++) {
+                keyframe = nanoemMotionBoneKeyframeCreate(motion, status);
+                if (bulk && nanoem_is_not_null(keyframe)) {
+                    nanoemMotionBoneKeyframeDecodeVMD(keyframe, buffer, &table, offset, status);
+                }
+                else {
+                    nanoemMotionBoneKeyframeParseVMD(keyframe, buffer, cache, offset, status);
+                }
+                if (nanoem_status_ptr_has_error(status)) {
+                    nanoemMotionBoneKeyframeDestroy(keyframe);
+                    num_bone_keyframes = motion->num_bone_keyframes = i;
+                    break;
+                }
+                nanoemMotionSetMaxFrameIndex(motion, &keyframe->base);
+                keyframe->base.index = (int) i;
+                motion->bone_keyframes[i] = keyframe;
+            }
+            if (!nanoem_status_ptr_has_error(status)) {
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->bone_keyframes, num_bone_keyframes);
+            }
+            nanoemMotionTrackTableDestroyVMD(&table);
+        }
+        nanoemStringCacheDestroy(cache);
+    }
+}
+
+static void
+nanoemMotionParseMorphKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status)
+{
+    kh_string_cache_t *cache;
+    nanoem_motion_morph_keyframe_t *keyframe;
+    nanoem_motion_track_table_vmd_t table;
     nanoem_rsize_t num_morph_keyframes, i;
+    nanoem_bool_t bulk;
     num_morph_keyframes = nanoemBufferReadLength(buffer, status);
     if (num_morph_keyframes > 0) {
         motion->morph_keyframes = (nanoem_motion_morph_keyframe_t **) nanoem_calloc(num_morph_keyframes, sizeof(*motion->morph_keyframes), status);
         cache = kh_init_string_cache();
         if (nanoem_is_not_null(motion->morph_keyframes)) {
             motion->num_morph_keyframes = num_morph_keyframes;
+            bulk = nanoemMotionCanDecodeKeyframeBlockVMD(buffer, num_morph_keyframes, VMD_MORPH_KEYFRAME_LENGTH);
+            nanoemMotionTrackTableInitializeVMD(&table, motion, motion->local_morph_motion_track_bundle, nanoemMotionResolveLocalMorphTrackId, cache);
             for (i = 0; i < num_morph_keyframes; i++) {
                 keyframe = nanoemMotionMorphKeyframeCreate(motion, status);
-                nanoemMotionMorphKeyframeParseVMD(keyframe, buffer, cache, offset, status);
+                if (bulk && nanoem_is_not_null(keyframe)) {
+                    nanoemMotionMorphKeyframeDecodeVMD(keyframe, buffer, &table, offset, status);
+                }
+                else {
+                    nanoemMotionMorphKeyframeParseVMD(keyframe, buffer, cache, offset, status);
+                }
                 if (nanoem_status_ptr_has_error(status)) {
                     nanoemMotionMorphKeyframeDestroy(keyframe);
                     num_morph_keyframes = motion->num_morph_keyframes = i;
@@ -5351,8 +6195,9 @@ nanoemMotionParseMorphKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
                 motion->morph_keyframes[i] = keyframe;
             }
             if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->morph_keyframes, num_morph_keyframes, sizeof(*motion->morph_keyframes), nanoemMotionCompareKeyframe);
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->morph_keyframes, num_morph_keyframes);
             }
+            nanoemMotionTrackTableDestroyVMD(&table);
         }
         nanoemStringCacheDestroy(cache);
     }
@@ -5363,14 +6208,21 @@ nanoemMotionParseCameraKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
 {
     nanoem_motion_camera_keyframe_t *keyframe;
     nanoem_rsize_t num_camera_keyframes, i;
+    nanoem_bool_t bulk;
     num_camera_keyframes = nanoemBufferReadLength(buffer, status);
     if (num_camera_keyframes > 0) {
         motion->camera_keyframes = (nanoem_motion_camera_keyframe_t **) nanoem_calloc(num_camera_keyframes, sizeof(*motion->camera_keyframes), status);
         if (nanoem_is_not_null(motion->camera_keyframes)) {
             motion->num_camera_keyframes = num_camera_keyframes;
+            bulk = nanoemMotionCanDecodeKeyframeBlockVMD(buffer, num_camera_keyframes, VMD_CAMERA_KEYFRAME_LENGTH);
             for (i = 0; i < num_camera_keyframes; i++) {
                 keyframe = nanoemMotionCameraKeyframeCreate(motion, status);
-                nanoemMotionCameraKeyframeParseVMD(keyframe, buffer, offset, status);
+                if (bulk && nanoem_is_not_null(keyframe)) {
+                    nanoemMotionCameraKeyframeDecodeVMD(keyframe, buffer, offset);
+                }
+                else {
+                    nanoemMotionCameraKeyframeParseVMD(keyframe, buffer, offset, status);
+                }
                 if (nanoem_status_ptr_has_error(status)) {
                     nanoemMotionCameraKeyframeDestroy(keyframe);
                     num_camera_keyframes = motion->num_camera_keyframes = i;
@@ -5381,7 +6233,7 @@ nanoemMotionParseCameraKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
                 motion->camera_keyframes[i] = keyframe;
             }
             if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->camera_keyframes, num_camera_keyframes, sizeof(*motion->camera_keyframes), nanoemMotionCompareKeyframe);
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->camera_keyframes, num_camera_keyframes);
             }
         }
     }
@@ -5395,14 +6247,21 @@ nanoemMotionParseLightKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
 {
     nanoem_motion_light_keyframe_t *keyframe;
     nanoem_rsize_t num_light_keyframes, i;
+    nanoem_bool_t bulk;
     num_light_keyframes = nanoemBufferReadLength(buffer, status);
     if (num_light_keyframes > 0) {
         motion->light_keyframes = (nanoem_motion_light_keyframe_t **) nanoem_calloc(num_light_keyframes, sizeof(*motion->light_keyframes), status);
         if (nanoem_is_not_null(motion->light_keyframes)) {
             motion->num_light_keyframes = num_light_keyframes;
+            bulk = nanoemMotionCanDecodeKeyframeBlockVMD(buffer, num_light_keyframes, VMD_LIGHT_KEYFRAME_LENGTH);
             for (i = 0; i < num_light_keyframes; i++) {
                 keyframe = nanoemMotionLightKeyframeCreate(motion, status);
-                nanoemMotionLightKeyframeParseVMD(keyframe, buffer, offset, status);
+                if (bulk && nanoem_is_not_null(keyframe)) {
+                    nanoemMotionLightKeyframeDecodeVMD(keyframe, buffer, offset);
+                }
+                else {
+                    nanoemMotionLightKeyframeParseVMD(keyframe, buffer, offset, status);
+                }
                 if (nanoem_status_ptr_has_error(status)) {
                     nanoemMotionLightKeyframeDestroy(keyframe);
                     num_light_keyframes = motion->num_light_keyframes = i;
@@ -5413,7 +6272,7 @@ nanoemMotionParseLightKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
                 motion->light_keyframes[i] = keyframe;
             }
             if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->light_keyframes, num_light_keyframes, sizeof(*motion->light_keyframes), nanoemMotionCompareKeyframe);
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->light_keyframes, num_light_keyframes);
             }
         }
     }
@@ -5427,14 +6286,21 @@ nanoemMotionParseSelfShadowKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buff
 {
     nanoem_motion_self_shadow_keyframe_t *keyframe;
     nanoem_rsize_t num_self_shadow_keyframes, i;
+    nanoem_bool_t bulk;
     num_self_shadow_keyframes = nanoemBufferReadLength(buffer, status);
     if (num_self_shadow_keyframes > 0) {
         motion->self_shadow_keyframes = (nanoem_motion_self_shadow_keyframe_t **) nanoem_calloc(num_self_shadow_keyframes, sizeof(*motion->self_shadow_keyframes), status);
         if (nanoem_is_not_null(motion->self_shadow_keyframes)) {
             motion->num_self_shadow_keyframes = num_self_shadow_keyframes;
+            bulk = nanoemMotionCanDecodeKeyframeBlockVMD(buffer, num_self_shadow_keyframes, VMD_SELF_SHADOW_KEYFRAME_LENGTH);
             for (i = 0; i < num_self_shadow_keyframes; i++) {
                 keyframe = nanoemMotionSelfShadowKeyframeCreate(motion, status);
-                nanoemMotionSelfShadowKeyframeParseVMD(keyframe, buffer, offset, status);
+                if (bulk && nanoem_is_not_null(keyframe)) {
+                    nanoemMotionSelfShadowKeyframeDecodeVMD(keyframe, buffer, offset);
+                }
+                else {
+                    nanoemMotionSelfShadowKeyframeParseVMD(keyframe, buffer, offset, status);
+                }
                 if (nanoem_status_ptr_has_error(status)) {
                     nanoemMotionSelfShadowKeyframeDestroy(keyframe);
                     num_self_shadow_keyframes = motion->num_self_shadow_keyframes = i;
@@ -5445,7 +6311,7 @@ nanoemMotionParseSelfShadowKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buff
                 motion->self_shadow_keyframes[i] = keyframe;
             }
             if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->self_shadow_keyframes, num_self_shadow_keyframes, sizeof(*motion->self_shadow_keyframes), nanoemMotionCompareKeyframe);
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->self_shadow_keyframes, num_self_shadow_keyframes);
             }
         }
     }
@@ -5477,7 +6343,7 @@ nanoemMotionParseModelKeyframeBlockVMD(nanoem_motion_t *motion, nanoem_buffer_t
                 motion->model_keyframes[i] = keyframe;
             }
             if (!nanoem_status_ptr_has_error(status)) {
-                nanoem_crt_qsort(motion->model_keyframes, num_model_keyframes, sizeof(*motion->model_keyframes), nanoemMotionCompareKeyframe);
+                nanoemMotionSortKeyframes((nanoem_motion_keyframe_object_t **) motion->model_keyframes, num_model_keyframes);
             }
         }
     }
@@ -5577,7 +6443,7 @@ nanoemMotionAccessoryKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *st
 {
     nanoem_motion_accessory_keyframe_t *keyframe = NULL;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_accessory_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_accessory_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
             keyframe->is_shadow_enabled = nanoem_true;
@@ -5643,7 +6509,7 @@ nanoemMotionAccessoryKeyframeDestroy(nanoem_motion_accessory_keyframe_t *keyfram
         }
         nanoem_free(keyframe->effect_parameters);
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -5654,7 +6520,7 @@ nanoemMotionBoneKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *status)
     nanoem_rsize_t j;
     int i;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_bone_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_bone_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
             keyframe->is_physics_simulation_enabled = nanoem_true;
@@ -5671,48 +6537,17 @@ nanoemMotionBoneKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *status)
 void
 nanoemMotionBoneKeyframeParseVMD(nanoem_motion_bone_keyframe_t *keyframe, nanoem_buffer_t *buffer, kh_string_cache_t *cache, nanoem_frame_index_t offset, nanoem_status_t *status)
 {
-    const nanoem_motion_t *motion;
+    nanoem_motion_t *motion;
     nanoem_unicode_string_factory_t *factory;
-    nanoem_unicode_string_t *name, *found_name;
-    nanoem_rsize_t i, length;
-    khiter_t it;
+    nanoem_unicode_string_t *name;
+    nanoem_rsize_t i;
     int j, ret = 0;
-    const char *buffer_ptr;
-    char str[VMD_BONE_KEYFRAME_NAME_LENGTH + 1];
     if (nanoem_is_not_null(keyframe) && nanoem_is_not_null(buffer)) {
         motion = keyframe->base.parent_motion;
         factory = motion->factory;
-        buffer_ptr = (const char *) nanoemBufferGetDataPtr(buffer);
-        if (buffer_ptr) {
-            length = nanoemBufferGetLength(buffer) - nanoemBufferGetOffset(buffer);
-            nanoemUtilCopyString(str, sizeof(str), buffer_ptr, length >= VMD_BONE_KEYFRAME_NAME_LENGTH ? VMD_BONE_KEYFRAME_NAME_LENGTH : length);
-            if (*str) {
-                it = kh_get_string_cache(cache, str);
-                if (it != kh_end(cache)) {
-                    nanoemBufferSkip(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, status);
-                    name = nanoemMotionTrackBundleResolveName(keyframe->base.parent_motion->local_bone_motion_track_bundle, kh_val(cache, it));
-                    keyframe->bone_id = kh_val(cache, it);
-                }
-                else {
-                    name = nanoemBufferGetStringFromCp932(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, factory, status);
-                    keyframe->bone_id = nanoemMotionResolveLocalBoneTrackId(keyframe->base.parent_motion, name, &found_name, &ret);
-                    if (nanoem_unlikely(found_name)) {
-                        nanoemUtilDestroyString(name, factory);
-                        name = found_name;
-                    }
-                    if (ret < 0) {
-                        return;
-                    }
-                    it = kh_put_string_cache(cache, nanoemUtilCloneString(str, status), &ret);
-                    if (ret < 0) {
-                        return;
-                    }
-                    kh_val(cache, it) = keyframe->bone_id;
-                }
-            }
-            else {
-                nanoemBufferSkip(buffer, VMD_BONE_KEYFRAME_NAME_LENGTH, status);
-                name = NULL;
+        if (nanoemBufferGetDataPtr(buffer)) {
+            if (!nanoemMotionParseTrackNameVMD(motion, buffer, cache, motion->local_bone_motion_track_bundle, nanoemMotionResolveLocalBoneTrackId, &keyframe->bone_id, &name, status)) {
+                return;
             }
             keyframe->base.frame_index = nanoemBufferReadInt32LittleEndian(buffer, status) + offset;
             nanoemBufferReadFloat32x3LittleEndian(buffer, &keyframe->translation, status);
@@ -5742,7 +6577,7 @@ nanoemMotionBoneKeyframeDestroy(nanoem_motion_bone_keyframe_t *keyframe)
 {
     if (nanoem_is_not_null(keyframe)) {
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -5753,7 +6588,7 @@ nanoemMotionCameraKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *statu
     nanoem_rsize_t j;
     int i;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_camera_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_camera_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
             for (i = NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FIRST_ENUM; i < NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_MAX_ENUM; i++) {
@@ -5796,7 +6631,7 @@ nanoemMotionCameraKeyframeDestroy(nanoem_motion_camera_keyframe_t *keyframe)
     if (nanoem_is_not_null(keyframe)) {
         nanoemMotionOutsideParentDestroy(keyframe->outside_parent);
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -5805,7 +6640,7 @@ nanoemMotionLightKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *status
 {
     nanoem_motion_light_keyframe_t *keyframe = NULL;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_light_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_light_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
         }
@@ -5832,7 +6667,7 @@ nanoemMotionLightKeyframeDestroy(nanoem_motion_light_keyframe_t *keyframe)
 {
     if (nanoem_is_not_null(keyframe)) {
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -5841,7 +6676,7 @@ nanoemMotionModelKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *status
 {
     nanoem_motion_model_keyframe_t *keyframe = NULL;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_model_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_model_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
             keyframe->is_physics_simulation_enabled = nanoem_true;
@@ -5932,7 +6767,7 @@ nanoemMotionModelKeyframeDestroy(nanoem_motion_model_keyframe_t *keyframe)
             nanoem_free(keyframe->effect_parameters);
         }
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -5941,7 +6776,7 @@ nanoemMotionMorphKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *status
 {
     nanoem_motion_morph_keyframe_t *keyframe = NULL;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_morph_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_morph_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
         }
@@ -5954,46 +6789,14 @@ nanoemMotionMorphKeyframeParseVMD(nanoem_motion_morph_keyframe_t *keyframe, nano
 {
     nanoem_motion_t *motion;
     nanoem_unicode_string_factory_t *factory;
-    nanoem_unicode_string_t *name, *found_name;
-    nanoem_rsize_t length;
-    khiter_t it;
-    const char *buffer_ptr;
-    char str[VMD_MORPH_KEYFRAME_NAME_LENGTH + 1];
+    nanoem_unicode_string_t *name;
     int ret = 0;
     if (nanoem_is_not_null(keyframe) && nanoem_is_not_null(buffer)) {
         motion = keyframe->base.parent_motion;
         factory = motion->factory;
-        buffer_ptr = (const char *) nanoemBufferGetDataPtr(buffer);
-        if (buffer_ptr) {
-            length = nanoemBufferGetLength(buffer) - nanoemBufferGetOffset(buffer);
-            nanoemUtilCopyString(str, sizeof(str), buffer_ptr, length >= VMD_MORPH_KEYFRAME_NAME_LENGTH ? VMD_MORPH_KEYFRAME_NAME_LENGTH : length);
-            if (*str) {
-                it = kh_get_string_cache(cache, str);
-                if (it != kh_end(cache)) {
-                    nanoemBufferSkip(buffer, VMD_MORPH_KEYFRAME_NAME_LENGTH, status);
-                    name = nanoemMotionTrackBundleResolveName(motion->local_morph_motion_track_bundle, kh_val(cache, it));
-                    keyframe->morph_id = kh_val(cache, it);
-                }
-                else {
-                    name = nanoemBufferGetStringFromCp932(buffer, VMD_MORPH_KEYFRAME_NAME_LENGTH, factory, status);
-                    keyframe->morph_id = nanoemMotionResolveLocalMorphTrackId(motion, name, &found_name, &ret);
-                    if (nanoem_unlikely(found_name)) {
-                        nanoemUtilDestroyString(name, factory);
-                        name = found_name;
-                    }
-                    if (ret < 0) {
-                        return;
-                    }
-                    it = kh_put_string_cache(cache, nanoemUtilCloneString(str, status), &ret);
-                    if (ret < 0) {
-                        return;
-                    }
-                    kh_val(cache, it) = keyframe->morph_id;
-                }
-            }
-            else {
-                nanoemBufferSkip(buffer, VMD_MORPH_KEYFRAME_NAME_LENGTH, status);
-                name = NULL;
+        if (nanoemBufferGetDataPtr(buffer)) {
+            if (!nanoemMotionParseTrackNameVMD(motion, buffer, cache, motion->local_morph_motion_track_bundle, nanoemMotionResolveLocalMorphTrackId, &keyframe->morph_id, &name, status)) {
+                return;
             }
             keyframe->base.frame_index = nanoemBufferReadInt32LittleEndian(buffer, status) + offset;
             keyframe->weight = nanoemBufferReadFloat32LittleEndian(buffer, status);
@@ -6016,7 +6819,7 @@ nanoemMotionMorphKeyframeDestroy(nanoem_motion_morph_keyframe_t *keyframe)
 {
     if (nanoem_is_not_null(keyframe)) {
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -6025,7 +6828,7 @@ nanoemMotionSelfShadowKeyframeCreate(nanoem_motion_t *motion, nanoem_status_t *s
 {
     nanoem_motion_self_shadow_keyframe_t *keyframe = NULL;
     if (nanoem_is_not_null(motion)) {
-        keyframe = (nanoem_motion_self_shadow_keyframe_t *) nanoem_calloc(1, sizeof(*keyframe), status);
+        keyframe = (nanoem_motion_self_shadow_keyframe_t *) nanoemMotionKeyframeObjectAllocate(motion, sizeof(*keyframe), status);
         if (nanoem_is_not_null(keyframe)) {
             keyframe->base.parent_motion = motion;
         }
@@ -6052,7 +6855,7 @@ nanoemMotionSelfShadowKeyframeDestroy(nanoem_motion_self_shadow_keyframe_t *keyf
 {
     if (nanoem_is_not_null(keyframe)) {
         nanoemMotionKeyframeObjectDestroy(&keyframe->base);
-        nanoem_free(keyframe);
+        nanoemMotionKeyframeObjectFree(&keyframe->base);
     }
 }
 
@@ -6652,6 +7455,19 @@ nanoemMotionCreate(nanoem_unicode_string_factory_t *factory, nanoem_status_t *st
     return motion;
 }
 
+void APIENTRY
+nanoemMotionEnableObjectArena(nanoem_motion_t *motion, nanoem_rsize_t chunk_size, nanoem_status_t *status)
+{
+    if (nanoem_is_not_null(motion)) {
+        if (nanoem_is_null(motion->object_arena)) {
+            motion->object_arena = nanoemObjectArenaCreate(chunk_size, status);
+        }
+    }
+    else {
+        nanoem_status_ptr_assign_null_object(status);
+    }
+}
+
 nanoem_bool_t APIENTRY
 nanoemMotionLoadFromBufferVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status)
 {
@@ -6891,6 +7707,108 @@ nanoemMotionFindAccessoryKeyframeObject(const nanoem_motion_t *motion, nanoem_fr
     return keyframe;
 }
 
+static nanoem_motion_track_t *
+nanoemMotionTrackHandleTableGetTrack(nanoem_motion_track_handle_table_t *table, kh_motion_track_bundle_t *bundle, nanoem_motion_track_index_t allocated_id, nanoem_motion_track_handle_t handle)
+{
+    nanoem_motion_track_t *track;
+    nanoem_rsize_t num_tracks;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    khiter_t it, end;
+    if (nanoem_is_null(bundle) || handle <= 0) {
+        return NULL;
+    }
+    /* tracks are never removed, so the size only changes when a track is added */
+    if (nanoem_is_null(table->tracks) || table->num_buckets != kh_n_buckets(bundle) || table->size != kh_size(bundle)) {
+        num_tracks = (nanoem_rsize_t) allocated_id + 1;
+        nanoem_free(table->tracks);
+        table->tracks = (nanoem_motion_track_t **) nanoem_calloc(num_tracks, sizeof(*table->tracks), &status);
+        table->num_tracks = 0;
+        if (nanoem_is_null(table->tracks)) {
+            return NULL;
+        }
+        end = kh_end(bundle);
+        for (it = kh_begin(bundle); it != end; it++) {
+            if (kh_exist(bundle, it)) {
+                track = &kh_key(bundle, it);
+                if (track->id > 0 && (nanoem_rsize_t) track->id < num_tracks) {
+                    table->tracks[track->id] = track;
+                }
+            }
+        }
+        table->num_tracks = num_tracks;
+        table->num_buckets = kh_n_buckets(bundle);
+        table->size = kh_size(bundle);
+    }
+    return (nanoem_rsize_t) handle < table->num_tracks ? table->tracks[handle] : NULL;
+}
+
+NANOEM_DECL_INLINE static nanoem_motion_track_t *
+nanoemMotionGetLocalBoneTrack(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle)
+{
+    nanoem_motion_t *mutable_motion = (nanoem_motion_t *) motion;
+    return nanoemMotionTrackHandleTableGetTrack(&mutable_motion->local_bone_motion_track_handles, mutable_motion->local_bone_motion_track_bundle, mutable_motion->local_bone_motion_track_allocated_id, handle);
+}
+
+NANOEM_DECL_INLINE static nanoem_motion_track_t *
+nanoemMotionGetLocalMorphTrack(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle)
+{
+    nanoem_motion_t *mutable_motion = (nanoem_motion_t *) motion;
+    return nanoemMotionTrackHandleTableGetTrack(&mutable_motion->local_morph_motion_track_handles, mutable_motion->local_morph_motion_track_bundle, mutable_motion->local_morph_motion_track_allocated_id, handle);
+}
+
+NANOEM_DECL_INLINE static nanoem_motion_keyframe_object_t *
+nanoemMotionTrackFindKeyframeObject(const nanoem_motion_track_t *track, nanoem_frame_index_t index)
+{
+    nanoem_motion_keyframe_object_t *keyframe = NULL;
+    khiter_t it;
+    if (nanoem_is_not_null(track) && nanoem_is_not_null(track->keyframes)) {
+        it = kh_get_keyframe_map(track->keyframes, index);
+        if (it != kh_end(track->keyframes)) {
+            keyframe = kh_val(track->keyframes, it);
+        }
+    }
+    return keyframe;
+}
+
+nanoem_motion_track_handle_t APIENTRY
+nanoemMotionResolveBoneTrackHandle(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name)
+{
+    nanoem_motion_track_t *track;
+    nanoem_motion_track_handle_t handle = 0;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionTrackBundleFindTrack(motion->local_bone_motion_track_bundle, name, motion->factory);
+        handle = nanoem_is_not_null(track) ? track->id : 0;
+    }
+    return handle;
+}
+
+nanoem_motion_track_handle_t APIENTRY
+nanoemMotionResolveMorphTrackHandle(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name)
+{
+    nanoem_motion_track_t *track;
+    nanoem_motion_track_handle_t handle = 0;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionTrackBundleFindTrack(motion->local_morph_motion_track_bundle, name, motion->factory);
+        handle = nanoem_is_not_null(track) ? track->id : 0;
+    }
+    return handle;
+}
+
+nanoem_u32_t APIENTRY
+nanoemMotionGetLocalTrackRevision(const nanoem_motion_t *motion)
+{
+    nanoem_u32_t revision = 0;
+    if (nanoem_is_not_null(motion)) {
+        if (nanoem_is_not_null(motion->local_bone_motion_track_bundle)) {
+            revision += kh_size(motion->local_bone_motion_track_bundle);
+        }
+        if (nanoem_is_not_null(motion->local_morph_motion_track_bundle)) {
+            revision += kh_size(motion->local_morph_motion_track_bundle);
+        }
+    }
+    return revision;
+}
+
 const nanoem_motion_bone_keyframe_t *APIENTRY
 nanoemMotionFindBoneKeyframeObject(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t index)
 {
@@ -6909,6 +7827,16 @@ nanoemMotionFindBoneKeyframeObject(const nanoem_motion_t *motion, const nanoem_u
     return keyframe;
 }
 
+const nanoem_motion_bone_keyframe_t *APIENTRY
+nanoemMotionFindBoneKeyframeObjectByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t index)
+{
+    nanoem_motion_bone_keyframe_t *keyframe = NULL;
+    if (nanoem_is_not_null(motion)) {
+        keyframe = (nanoem_motion_bone_keyframe_t *) nanoemMotionTrackFindKeyframeObject(nanoemMotionGetLocalBoneTrack(motion, handle), index);
+    }
+    return keyframe;
+}
+
 const nanoem_motion_camera_keyframe_t *APIENTRY
 nanoemMotionFindCameraKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index)
 {
@@ -6975,6 +7903,16 @@ nanoemMotionFindMorphKeyframeObject(const nanoem_motion_t *motion, const nanoem_
     return keyframe;
 }
 
+const nanoem_motion_morph_keyframe_t *APIENTRY
+nanoemMotionFindMorphKeyframeObjectByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t index)
+{
+    nanoem_motion_morph_keyframe_t *keyframe = NULL;
+    if (nanoem_is_not_null(motion)) {
+        keyframe = (nanoem_motion_morph_keyframe_t *) nanoemMotionTrackFindKeyframeObject(nanoemMotionGetLocalMorphTrack(motion, handle), index);
+    }
+    return keyframe;
+}
+
 const nanoem_motion_self_shadow_keyframe_t *APIENTRY
 nanoemMotionFindSelfShadowKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index)
 {
@@ -6991,44 +7929,93 @@ nanoemMotionFindSelfShadowKeyframeObject(const nanoem_motion_t *motion, nanoem_f
     return keyframe;
 }
 
-void APIENTRY
-nanoemMotionSearchClosestAccessoryKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_accessory_keyframe_t **prev_keyframe, nanoem_motion_accessory_keyframe_t **next_keyframe)
+static nanoem_bool_t
+nanoemMotionIsLowerBoundOrderedKeyframe(nanoem_motion_keyframe_object_t *const *keyframes, nanoem_rsize_t num_keyframes, nanoem_rsize_t offset, nanoem_frame_index_t base_index)
 {
-    nanoem_motion_accessory_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    nanoem_motion_accessory_keyframe_t *const *accessory_keyframes;
-    nanoem_rsize_t num_accessory_keyframes, i;
-    if (nanoem_is_not_null(prev_keyframe)) {
-        *prev_keyframe = NULL;
-    }
-    if (nanoem_is_not_null(next_keyframe)) {
-        *next_keyframe = NULL;
+    return offset <= num_keyframes &&
+        (offset == 0 || keyframes[offset - 1]->frame_index < base_index) &&
+        (offset == num_keyframes || keyframes[offset]->frame_index >= base_index);
+}
+
+static void
+nanoemMotionSearchClosestOrderedKeyframes(nanoem_motion_keyframe_object_t *const *keyframes, nanoem_rsize_t num_keyframes, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_keyframe_object_t **prev_keyframe, nanoem_motion_keyframe_object_t **next_keyframe)
+{
+    nanoem_rsize_t lower = 0, upper = num_keyframes, mid, offset;
+    nanoem_bool_t found = nanoem_false;
+    if (num_keyframes > 0) {
+        if (nanoem_is_not_null(cursor)) {
+            /*
+             * the caller owned cursor remembers the last position so sequential access (e.g. playback) only needs to
+             * check the same or the adjacent interval, falls back to binary search otherwise
+             */
+            offset = *cursor;
+            found = nanoem_true;
+            if (nanoemMotionIsLowerBoundOrderedKeyframe(keyframes, num_keyframes, offset, base_index)) {
+                lower = offset;
+            }
+            else if (nanoemMotionIsLowerBoundOrderedKeyframe(keyframes, num_keyframes, offset + 1, base_index)) {
+                lower = offset + 1;
+            }
+            else if (offset > 0 && nanoemMotionIsLowerBoundOrderedKeyframe(keyframes, num_keyframes, offset - 1, base_index)) {
+                lower = offset - 1;
+            }
+            else {
+                found = nanoem_false;
+            }
+        }
+        if (!found) {
+            /* find the first keyframe whose frame index is not less than base_index */
+            while (lower < upper) {
+                mid = lower + ((upper - lower) >> 1);
+                if (keyframes[mid]->frame_index < base_index) {
+                    lower = mid + 1;
+                }
+                else {
+                    upper = mid;
+                }
+            }
+        }
+        if (nanoem_is_not_null(cursor)) {
+            *cursor = lower;
+        }
+        if (nanoem_is_not_null(prev_keyframe) && lower > 0) {
+            *prev_keyframe = keyframes[lower - 1];
+        }
+        if (nanoem_is_not_null(next_keyframe)) {
+            if (lower < num_keyframes && keyframes[lower]->frame_index == base_index) {
+                lower++;
+            }
+            /* fallback to the last keyframe when there is no keyframe after base_index */
+            *next_keyframe = keyframes[lower < num_keyframes ? lower : num_keyframes - 1];
+        }
     }
-    if (nanoem_is_not_null(motion)) {
-        accessory_keyframes = motion->accessory_keyframes;
-        num_accessory_keyframes = motion->num_accessory_keyframes;
-        for (i = 0; i < num_accessory_keyframes; i++) {
-            current_keyframe = accessory_keyframes[i];
-            nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                base_index,
-                &prev_nearest,
-                &next_nearest,
-                (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                (nanoem_motion_keyframe_object_t **) next_keyframe,
-                (nanoem_motion_keyframe_object_t **) &last_keyframe);
+}
+
+static void
+nanoemMotionSearchClosestKeyframeObjects(nanoem_motion_keyframe_object_t *const *keyframes, nanoem_rsize_t num_keyframes, nanoem_bool_t is_unordered, nanoem_frame_index_t base_index, nanoem_motion_keyframe_object_t **prev_keyframe, nanoem_motion_keyframe_object_t **next_keyframe)
+{
+    nanoem_motion_keyframe_object_t *last_keyframe = NULL;
+    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
+    nanoem_rsize_t i;
+    if (is_unordered) {
+        for (i = 0; i < num_keyframes; i++) {
+            nanoemMotionGetNearestKeyframes(keyframes[i], base_index, &prev_nearest, &next_nearest, prev_keyframe, next_keyframe, &last_keyframe);
         }
         if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
             *next_keyframe = last_keyframe;
         }
     }
+    else {
+        nanoemMotionSearchClosestOrderedKeyframes(keyframes, num_keyframes, base_index, NULL, prev_keyframe, next_keyframe);
+    }
 }
 
-void APIENTRY
-nanoemMotionSearchClosestBoneKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe)
+static void
+nanoemMotionTrackSearchClosestKeyframes(const nanoem_motion_track_t *track, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_keyframe_object_t **prev_keyframe, nanoem_motion_keyframe_object_t **next_keyframe)
 {
-    nanoem_motion_bone_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
     kh_keyframe_map_t *keyframes_map;
+    nanoem_motion_keyframe_object_t *last_keyframe = NULL;
+    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
     khiter_t it, end;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
@@ -7036,35 +8023,31 @@ nanoemMotionSearchClosestBoneKeyframes(const nanoem_motion_t *motion, const nano
     if (nanoem_is_not_null(next_keyframe)) {
         *next_keyframe = NULL;
     }
-    if (nanoem_is_not_null(motion)) {
-        keyframes_map = nanoemMotionFindKeyframesMap(motion->local_bone_motion_track_bundle, name, motion->factory);
-        if (keyframes_map) {
+    if (nanoem_is_not_null(track)) {
+        if (track->is_ordered_keyframes_dirty) {
+            /*
+             * searching never rebuilds ordered keyframes since the motion is const here,
+             * the track is scanned linearly until the next load or nanoemMutableMotionSortAllKeyframes
+             */
+            keyframes_map = track->keyframes;
             for (it = kh_begin(keyframes_map), end = kh_end(keyframes_map); it != end; it++) {
                 if (kh_exist(keyframes_map, it)) {
-                    current_keyframe = (nanoem_motion_bone_keyframe_t *) kh_val(keyframes_map, it);
-                    nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                        base_index,
-                        &prev_nearest,
-                        &next_nearest,
-                        (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                        (nanoem_motion_keyframe_object_t **) next_keyframe,
-                        (nanoem_motion_keyframe_object_t **) &last_keyframe);
+                    nanoemMotionGetNearestKeyframes(kh_val(keyframes_map, it), base_index, &prev_nearest, &next_nearest, prev_keyframe, next_keyframe, &last_keyframe);
                 }
             }
             if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
                 *next_keyframe = last_keyframe;
             }
         }
+        else {
+            nanoemMotionSearchClosestOrderedKeyframes(track->ordered_keyframes, track->num_ordered_keyframes, base_index, cursor, prev_keyframe, next_keyframe);
+        }
     }
 }
 
 void APIENTRY
-nanoemMotionSearchClosestCameraKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_camera_keyframe_t **prev_keyframe, nanoem_motion_camera_keyframe_t **next_keyframe)
+nanoemMotionSearchClosestAccessoryKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_accessory_keyframe_t **prev_keyframe, nanoem_motion_accessory_keyframe_t **next_keyframe)
 {
-    nanoem_motion_camera_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    nanoem_motion_camera_keyframe_t *const *camera_keyframes;
-    nanoem_rsize_t num_camera_keyframes, i;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
     }
@@ -7072,31 +8055,52 @@ nanoemMotionSearchClosestCameraKeyframes(const nanoem_motion_t *motion, nanoem_f
         *next_keyframe = NULL;
     }
     if (nanoem_is_not_null(motion)) {
-        camera_keyframes = motion->camera_keyframes;
-        num_camera_keyframes = motion->num_camera_keyframes;
-        for (i = 0; i < num_camera_keyframes; i++) {
-            current_keyframe = camera_keyframes[i];
-            nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                base_index,
-                &prev_nearest,
-                &next_nearest,
-                (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                (nanoem_motion_keyframe_object_t **) next_keyframe,
-                (nanoem_motion_keyframe_object_t **) &last_keyframe);
-        }
-        if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
-            *next_keyframe = last_keyframe;
-        }
+        nanoemMotionSearchClosestKeyframeObjects((nanoem_motion_keyframe_object_t *const *) motion->accessory_keyframes,
+            motion->num_accessory_keyframes,
+            motion->order.flags.is_accessory_keyframes_unordered,
+            base_index,
+            (nanoem_motion_keyframe_object_t **) prev_keyframe,
+            (nanoem_motion_keyframe_object_t **) next_keyframe);
     }
 }
 
 void APIENTRY
-nanoemMotionSearchClosestLightKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_light_keyframe_t **prev_keyframe, nanoem_motion_light_keyframe_t **next_keyframe)
+nanoemMotionSearchClosestBoneKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe)
+{
+    nanoem_motion_track_t *track = NULL;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionTrackBundleFindTrack(motion->local_bone_motion_track_bundle, name, motion->factory);
+    }
+    nanoemMotionTrackSearchClosestKeyframes(track,
+        base_index,
+        NULL,
+        (nanoem_motion_keyframe_object_t **) prev_keyframe,
+        (nanoem_motion_keyframe_object_t **) next_keyframe);
+}
+
+void APIENTRY
+nanoemMotionSearchClosestBoneKeyframesByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe)
+{
+    nanoemMotionSearchClosestBoneKeyframesByHandleWithCursor(motion, handle, base_index, NULL, prev_keyframe, next_keyframe);
+}
+
+void APIENTRY
+nanoemMotionSearchClosestBoneKeyframesByHandleWithCursor(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe)
+{
+    nanoem_motion_track_t *track = NULL;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionGetLocalBoneTrack(motion, handle);
+    }
+    nanoemMotionTrackSearchClosestKeyframes(track,
+        base_index,
+        cursor,
+        (nanoem_motion_keyframe_object_t **) prev_keyframe,
+        (nanoem_motion_keyframe_object_t **) next_keyframe);
+}
+
+void APIENTRY
+nanoemMotionSearchClosestCameraKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_camera_keyframe_t **prev_keyframe, nanoem_motion_camera_keyframe_t **next_keyframe)
 {
-    nanoem_motion_light_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    nanoem_motion_light_keyframe_t *const *light_keyframes;
-    nanoem_rsize_t num_light_keyframes, i;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
     }
@@ -7104,31 +8108,18 @@ nanoemMotionSearchClosestLightKeyframes(const nanoem_motion_t *motion, nanoem_fr
         *next_keyframe = NULL;
     }
     if (nanoem_is_not_null(motion)) {
-        light_keyframes = motion->light_keyframes;
-        num_light_keyframes = motion->num_light_keyframes;
-        for (i = 0; i < num_light_keyframes; i++) {
-            current_keyframe = light_keyframes[i];
-            nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                base_index,
-                &prev_nearest,
-                &next_nearest,
-                (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                (nanoem_motion_keyframe_object_t **) next_keyframe,
-                (nanoem_motion_keyframe_object_t **) &last_keyframe);
-        }
-        if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
-            *next_keyframe = last_keyframe;
-        }
+        nanoemMotionSearchClosestKeyframeObjects((nanoem_motion_keyframe_object_t *const *) motion->camera_keyframes,
+            motion->num_camera_keyframes,
+            motion->order.flags.is_camera_keyframes_unordered,
+            base_index,
+            (nanoem_motion_keyframe_object_t **) prev_keyframe,
+            (nanoem_motion_keyframe_object_t **) next_keyframe);
     }
 }
 
 void APIENTRY
-nanoemMotionSearchClosestModelKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_model_keyframe_t **prev_keyframe, nanoem_motion_model_keyframe_t **next_keyframe)
+nanoemMotionSearchClosestLightKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_light_keyframe_t **prev_keyframe, nanoem_motion_light_keyframe_t **next_keyframe)
 {
-    nanoem_motion_model_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    nanoem_motion_model_keyframe_t *const *model_keyframes;
-    nanoem_rsize_t num_model_keyframes, i;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
     }
@@ -7136,31 +8127,18 @@ nanoemMotionSearchClosestModelKeyframes(const nanoem_motion_t *motion, nanoem_fr
         *next_keyframe = NULL;
     }
     if (nanoem_is_not_null(motion)) {
-        model_keyframes = motion->model_keyframes;
-        num_model_keyframes = motion->num_model_keyframes;
-        for (i = 0; i < num_model_keyframes; i++) {
-            current_keyframe = model_keyframes[i];
-            nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                base_index,
-                &prev_nearest,
-                &next_nearest,
-                (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                (nanoem_motion_keyframe_object_t **) next_keyframe,
-                (nanoem_motion_keyframe_object_t **) &last_keyframe);
-        }
-        if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
-            *next_keyframe = last_keyframe;
-        }
+        nanoemMotionSearchClosestKeyframeObjects((nanoem_motion_keyframe_object_t *const *) motion->light_keyframes,
+            motion->num_light_keyframes,
+            motion->order.flags.is_light_keyframes_unordered,
+            base_index,
+            (nanoem_motion_keyframe_object_t **) prev_keyframe,
+            (nanoem_motion_keyframe_object_t **) next_keyframe);
     }
 }
 
 void APIENTRY
-nanoemMotionSearchClosestMorphKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe)
+nanoemMotionSearchClosestModelKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_model_keyframe_t **prev_keyframe, nanoem_motion_model_keyframe_t **next_keyframe)
 {
-    nanoem_motion_morph_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    kh_keyframe_map_t *keyframes_map;
-    khiter_t it, end;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
     }
@@ -7168,34 +8146,52 @@ nanoemMotionSearchClosestMorphKeyframes(const nanoem_motion_t *motion, const nan
         *next_keyframe = NULL;
     }
     if (nanoem_is_not_null(motion)) {
-        keyframes_map = nanoemMotionFindKeyframesMap(motion->local_morph_motion_track_bundle, name, motion->factory);
-        if (keyframes_map) {
-            for (it = kh_begin(keyframes_map), end = kh_end(keyframes_map); it != end; it++) {
-                if (kh_exist(keyframes_map, it)) {
-                    current_keyframe = (nanoem_motion_morph_keyframe_t *) kh_val(keyframes_map, it);
-                    nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                        base_index,
-                        &prev_nearest,
-                        &next_nearest,
-                        (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                        (nanoem_motion_keyframe_object_t **) next_keyframe,
-                        (nanoem_motion_keyframe_object_t **) &last_keyframe);
-                }
-            }
-            if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
-                *next_keyframe = last_keyframe;
-            }
-        }
+        nanoemMotionSearchClosestKeyframeObjects((nanoem_motion_keyframe_object_t *const *) motion->model_keyframes,
+            motion->num_model_keyframes,
+            motion->order.flags.is_model_keyframes_unordered,
+            base_index,
+            (nanoem_motion_keyframe_object_t **) prev_keyframe,
+            (nanoem_motion_keyframe_object_t **) next_keyframe);
     }
 }
 
+void APIENTRY
+nanoemMotionSearchClosestMorphKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe)
+{
+    nanoem_motion_track_t *track = NULL;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionTrackBundleFindTrack(motion->local_morph_motion_track_bundle, name, motion->factory);
+    }
+    nanoemMotionTrackSearchClosestKeyframes(track,
+        base_index,
+        NULL,
+        (nanoem_motion_keyframe_object_t **) prev_keyframe,
+        (nanoem_motion_keyframe_object_t **) next_keyframe);
+}
+
+void APIENTRY
+nanoemMotionSearchClosestMorphKeyframesByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe)
+{
+    nanoemMotionSearchClosestMorphKeyframesByHandleWithCursor(motion, handle, base_index, NULL, prev_keyframe, next_keyframe);
+}
+
+void APIENTRY
+nanoemMotionSearchClosestMorphKeyframesByHandleWithCursor(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe)
+{
+    nanoem_motion_track_t *track = NULL;
+    if (nanoem_is_not_null(motion)) {
+        track = nanoemMotionGetLocalMorphTrack(motion, handle);
+    }
+    nanoemMotionTrackSearchClosestKeyframes(track,
+        base_index,
+        cursor,
+        (nanoem_motion_keyframe_object_t **) prev_keyframe,
+        (nanoem_motion_keyframe_object_t **) next_keyframe);
+}
+
 void APIENTRY
 nanoemMotionSearchClosestSelfShadowKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_self_shadow_keyframe_t **prev_keyframe, nanoem_motion_self_shadow_keyframe_t **next_keyframe)
 {
-    nanoem_motion_self_shadow_keyframe_t *current_keyframe, *last_keyframe = NULL;
-    nanoem_frame_index_t prev_nearest = NANOEM_FRAME_INDEX_MAX_SIZE, next_nearest = NANOEM_FRAME_INDEX_MAX_SIZE;
-    nanoem_motion_self_shadow_keyframe_t *const *self_shadow_keyframes;
-    nanoem_rsize_t num_self_shadow_keyframes, i;
     if (nanoem_is_not_null(prev_keyframe)) {
         *prev_keyframe = NULL;
     }
@@ -7203,21 +8199,12 @@ nanoemMotionSearchClosestSelfShadowKeyframes(const nanoem_motion_t *motion, nano
         *next_keyframe = NULL;
     }
     if (nanoem_is_not_null(motion)) {
-        self_shadow_keyframes = motion->self_shadow_keyframes;
-        num_self_shadow_keyframes = motion->num_self_shadow_keyframes;
-        for (i = 0; i < num_self_shadow_keyframes; i++) {
-            current_keyframe = self_shadow_keyframes[i];
-            nanoemMotionGetNearestKeyframes(&current_keyframe->base,
-                base_index,
-                &prev_nearest,
-                &next_nearest,
-                (nanoem_motion_keyframe_object_t **) prev_keyframe,
-                (nanoem_motion_keyframe_object_t **) next_keyframe,
-                (nanoem_motion_keyframe_object_t **) &last_keyframe);
-        }
-        if (nanoem_is_not_null(next_keyframe) && !*next_keyframe) {
-            *next_keyframe = last_keyframe;
-        }
+        nanoemMotionSearchClosestKeyframeObjects((nanoem_motion_keyframe_object_t *const *) motion->self_shadow_keyframes,
+            motion->num_self_shadow_keyframes,
+            motion->order.flags.is_self_shadow_keyframes_unordered,
+            base_index,
+            (nanoem_motion_keyframe_object_t **) prev_keyframe,
+            (nanoem_motion_keyframe_object_t **) next_keyframe);
     }
 }
 
@@ -7251,6 +8238,8 @@ nanoemMotionDestroy(nanoem_motion_t *motion)
         nanoemMotionTrackBundleDestroy(motion->local_bone_motion_track_bundle, factory);
         nanoemMotionTrackBundleDestroy(motion->local_morph_motion_track_bundle, factory);
         nanoemMotionTrackBundleDestroy(motion->global_motion_track_bundle, factory);
+        nanoem_free(motion->local_bone_motion_track_handles.tracks);
+        nanoem_free(motion->local_morph_motion_track_handles.tracks);
         nanoemAnnotationDestroy(motion->annotations);
         if (nanoem_is_not_null(motion->target_model_name)) {
             nanoemUtilDestroyString(motion->target_model_name, factory);
@@ -7304,6 +8293,7 @@ nanoemMotionDestroy(nanoem_motion_t *motion)
             }
             nanoem_free(motion->self_shadow_keyframes);
         }
+        nanoemObjectArenaDetach(motion->object_arena);
         nanoem_free(motion);
     }
 }
@@ -1199,8 +1199,15 @@ nanoemModelSoftBodyGetModelObjectMutable(nanoem_model_soft_body_t *body);
 
 /** @} */
 
+typedef void (*nanoem_model_parallel_range_t)(void *, nanoem_rsize_t, nanoem_rsize_t);
+typedef void (*nanoem_model_parallel_dispatcher_t)(void *, nanoem_model_parallel_range_t, void *, nanoem_rsize_t, nanoem_rsize_t);
+
 NANOEM_DECL_API nanoem_model_t *APIENTRY
 nanoemModelCreate(nanoem_unicode_string_factory_t *factory, nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY
+nanoemModelEnableObjectArena(nanoem_model_t *model, nanoem_rsize_t chunk_size, nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY
+nanoemModelSetParallelDispatcher(nanoem_model_t *model, nanoem_model_parallel_dispatcher_t dispatcher, void *user_data);
 NANOEM_DECL_API nanoem_bool_t APIENTRY
 nanoemModelLoadFromBufferPMD(nanoem_model_t *model, nanoem_buffer_t *buffer, nanoem_status_t *status);
 NANOEM_DECL_API nanoem_bool_t APIENTRY
@@ -1263,6 +1270,7 @@ NANOEM_DECL_OPAQUE(nanoem_motion_physics_world_keyframe_t);
 NANOEM_DECL_OPAQUE(nanoem_motion_self_shadow_keyframe_t);
 NANOEM_DECL_OPAQUE(nanoem_motion_t);
 typedef nanoem_u32_t nanoem_frame_index_t;
+typedef nanoem_i32_t nanoem_motion_track_handle_t;
 
 NANOEM_DECL_ENUM(nanoem_i32_t, nanoem_motion_format_type_t){
     NANOEM_MOTION_FORMAT_TYPE_UNKNOWN = -1,
@@ -1518,6 +1526,8 @@ nanoemMotionSelfShadowKeyframeGetKeyframeObjectMutable(nanoem_motion_self_shadow
 
 NANOEM_DECL_API nanoem_motion_t *APIENTRY
 nanoemMotionCreate(nanoem_unicode_string_factory_t *factory, nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY
+nanoemMotionEnableObjectArena(nanoem_motion_t *motion, nanoem_rsize_t chunk_size, nanoem_status_t *status);
 NANOEM_DECL_API nanoem_bool_t APIENTRY
 nanoemMotionLoadFromBufferVMD(nanoem_motion_t *motion, nanoem_buffer_t *buffer, nanoem_frame_index_t offset, nanoem_status_t *status);
 NANOEM_DECL_API nanoem_bool_t APIENTRY
@@ -1550,10 +1560,18 @@ NANOEM_DECL_API nanoem_motion_bone_keyframe_t *const *APIENTRY
 nanoemMotionExtractBoneTrackKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_rsize_t *num_keyframes, nanoem_status_t *status);
 NANOEM_DECL_API nanoem_motion_morph_keyframe_t *const *APIENTRY
 nanoemMotionExtractMorphTrackKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_rsize_t *num_keyframes, nanoem_status_t *status);
+NANOEM_DECL_API nanoem_motion_track_handle_t APIENTRY
+nanoemMotionResolveBoneTrackHandle(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name);
+NANOEM_DECL_API nanoem_motion_track_handle_t APIENTRY
+nanoemMotionResolveMorphTrackHandle(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name);
+NANOEM_DECL_API nanoem_u32_t APIENTRY
+nanoemMotionGetLocalTrackRevision(const nanoem_motion_t *motion);
 NANOEM_DECL_API const nanoem_motion_accessory_keyframe_t *APIENTRY
 nanoemMotionFindAccessoryKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index);
 NANOEM_DECL_API const nanoem_motion_bone_keyframe_t *APIENTRY
 nanoemMotionFindBoneKeyframeObject(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t index);
+NANOEM_DECL_API const nanoem_motion_bone_keyframe_t *APIENTRY
+nanoemMotionFindBoneKeyframeObjectByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t index);
 NANOEM_DECL_API const nanoem_motion_camera_keyframe_t *APIENTRY
 nanoemMotionFindCameraKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index);
 NANOEM_DECL_API const nanoem_motion_light_keyframe_t *APIENTRY
@@ -1562,13 +1580,24 @@ NANOEM_DECL_API const nanoem_motion_model_keyframe_t *APIENTRY
 nanoemMotionFindModelKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index);
 NANOEM_DECL_API const nanoem_motion_morph_keyframe_t *APIENTRY
 nanoemMotionFindMorphKeyframeObject(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t index);
+NANOEM_DECL_API const nanoem_motion_morph_keyframe_t *APIENTRY
+nanoemMotionFindMorphKeyframeObjectByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t index);
 NANOEM_DECL_API const nanoem_motion_self_shadow_keyframe_t *APIENTRY
 nanoemMotionFindSelfShadowKeyframeObject(const nanoem_motion_t *motion, nanoem_frame_index_t index);
+/*
+ * nanoemMotionSearchClosest*Keyframes never modify the motion and can be called from multiple threads.
+ * nanoemMotionSearchClosest*KeyframesByHandleWithCursor take a caller owned cursor initialized with zero that remembers
+ * the last found position of the track to speed up sequential access, a cursor must not be shared between threads.
+ */
 NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestAccessoryKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_accessory_keyframe_t **prev_keyframe, nanoem_motion_accessory_keyframe_t **next_keyframe);
 NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestBoneKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe);
 NANOEM_DECL_API void APIENTRY
+nanoemMotionSearchClosestBoneKeyframesByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe);
+NANOEM_DECL_API void APIENTRY
+nanoemMotionSearchClosestBoneKeyframesByHandleWithCursor(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_bone_keyframe_t **prev_keyframe, nanoem_motion_bone_keyframe_t **next_keyframe);
+NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestCameraKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_camera_keyframe_t **prev_keyframe, nanoem_motion_camera_keyframe_t **next_keyframe);
 NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestLightKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_light_keyframe_t **prev_keyframe, nanoem_motion_light_keyframe_t **next_keyframe);
@@ -1577,6 +1606,10 @@ nanoemMotionSearchClosestModelKeyframes(const nanoem_motion_t *motion, nanoem_fr
 NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestMorphKeyframes(const nanoem_motion_t *motion, const nanoem_unicode_string_t *name, nanoem_frame_index_t base_index, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe);
 NANOEM_DECL_API void APIENTRY
+nanoemMotionSearchClosestMorphKeyframesByHandle(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe);
+NANOEM_DECL_API void APIENTRY
+nanoemMotionSearchClosestMorphKeyframesByHandleWithCursor(const nanoem_motion_t *motion, nanoem_motion_track_handle_t handle, nanoem_frame_index_t base_index, nanoem_rsize_t *cursor, nanoem_motion_morph_keyframe_t **prev_keyframe, nanoem_motion_morph_keyframe_t **next_keyframe);
+NANOEM_DECL_API void APIENTRY
 nanoemMotionSearchClosestSelfShadowKeyframes(const nanoem_motion_t *motion, nanoem_frame_index_t base_index, nanoem_motion_self_shadow_keyframe_t **prev_keyframe, nanoem_motion_self_shadow_keyframe_t **next_keyframe);
 NANOEM_DECL_API void APIENTRY
 nanoemMotionDestroy(nanoem_motion_t *motion);
@@ -109,6 +109,11 @@
 #define VMD_CAMERA_KEYFRAME_TWEAK_LENGTH 61
 #define VMD_LIGHT_KEYFRAME_TWEAK_LENGTH 28
 #define VMD_SELF_SHADOW_KEYFRAME_TWEAK_LENGTH 9
+#define VMD_BONE_KEYFRAME_LENGTH 111
+#define VMD_MORPH_KEYFRAME_LENGTH 23
+#define VMD_CAMERA_KEYFRAME_LENGTH 61
+#define VMD_LIGHT_KEYFRAME_LENGTH 28
+#define VMD_SELF_SHADOW_KEYFRAME_LENGTH 9
 
 NANOEM_DECL_TLS NANOEM_DECL_API const nanoem_global_allocator_t *
     __nanoem_global_allocator;
@@ -255,11 +260,41 @@ struct nanoem_motion_track_t {
     nanoem_unicode_string_factory_t *factory;
     nanoem_unicode_string_t *name;
     kh_keyframe_map_t *keyframes;
+    nanoem_motion_keyframe_object_t **ordered_keyframes;
+    nanoem_rsize_t num_ordered_keyframes;
+    nanoem_bool_t is_ordered_keyframes_dirty;
 };
 #define nanoem_motion_track_hash_equal(a, b) ((a).factory->compare((a).factory->opaque_data, (a).name, (b).name) == 0)
 #define nanoem_motion_track_hash_func(a) ((a).factory->hash((a).factory->opaque_data, (a).name))
 KHASH_INIT(motion_track_bundle, nanoem_motion_track_t, char, 0, nanoem_motion_track_hash_func, nanoem_motion_track_hash_equal)
 
+/* tracks indexed by the track id, rebuilt after the bundle is resized since it moves all tracks */
+typedef struct nanoem_motion_track_handle_table_t nanoem_motion_track_handle_table_t;
+struct nanoem_motion_track_handle_table_t {
+    nanoem_motion_track_t **tracks;
+    nanoem_rsize_t num_tracks;
+    khint_t num_buckets;
+    khint_t size;
+};
+
+/*
+ * objects are carved out of large chunks and the chunks are released at once when the owner is destroyed and
+ * every carved object is released, objects removed from the owner and destroyed later keep the chunks alive
+ */
+typedef struct nanoem_object_arena_chunk_t nanoem_object_arena_chunk_t;
+struct nanoem_object_arena_chunk_t {
+    nanoem_object_arena_chunk_t *next;
+    nanoem_rsize_t capacity;
+    nanoem_rsize_t offset;
+};
+typedef struct nanoem_object_arena_t nanoem_object_arena_t;
+struct nanoem_object_arena_t {
+    nanoem_object_arena_chunk_t *chunks;
+    nanoem_rsize_t chunk_size;
+    nanoem_rsize_t num_objects;
+    nanoem_bool_t is_detached;
+};
+
 
 struct nanoem_f128_components_t {
     float x;
@@ -325,6 +360,9 @@ struct nanoem_model_t {
     nanoem_model_joint_t **joints;
     nanoem_rsize_t num_soft_bodies;
     nanoem_model_soft_body_t **soft_bodies;
+    nanoem_object_arena_t *object_arena;
+    nanoem_model_parallel_dispatcher_t parallel_dispatcher;
+    void *parallel_dispatcher_user_data;
     nanoem_user_data_t *user_data;
 };
 
@@ -338,6 +376,7 @@ struct nanoem_model_object_t {
         const nanoem_model_soft_body_t *soft_body;
     } parent;
     nanoem_user_data_t *user_data;
+    nanoem_object_arena_t *arena;
 };
 
 struct nanoem_model_vertex_t {
@@ -689,11 +728,24 @@ struct nanoem_motion_t {
     kh_motion_track_bundle_t *local_bone_motion_track_bundle;
     nanoem_motion_track_index_t local_morph_motion_track_allocated_id;
     kh_motion_track_bundle_t *local_morph_motion_track_bundle;
+    nanoem_motion_track_handle_table_t local_bone_motion_track_handles;
+    nanoem_motion_track_handle_table_t local_morph_motion_track_handles;
     nanoem_motion_track_index_t global_motion_track_allocated_id;
     kh_motion_track_bundle_t *global_motion_track_bundle;
     nanoem_motion_format_type_t type;
     nanoem_frame_index_t max_frame_index;
     nanoem_f32_t preferred_fps;
+    union nanoem_motion_keyframes_order_union_t {
+        struct nanoem_motion_keyframes_order_flags_t {
+            unsigned int is_accessory_keyframes_unordered : 1;
+            unsigned int is_camera_keyframes_unordered : 1;
+            unsigned int is_light_keyframes_unordered : 1;
+            unsigned int is_model_keyframes_unordered : 1;
+            unsigned int is_self_shadow_keyframes_unordered : 1;
+        } flags;
+        nanoem_u8_t value;
+    } order;
+    nanoem_object_arena_t *object_arena;
     nanoem_user_data_t *user_data;
 };
 
@@ -703,6 +755,7 @@ struct nanoem_motion_keyframe_object_t {
     nanoem_frame_index_t frame_index;
     nanoem_user_data_t *user_data;
     kh_annotation_t *annotations;
+    nanoem_object_arena_t *arena;
 };
 
 enum nanoem_parent_keyframe_type_t {
@@ -856,6 +909,15 @@ struct nanoem_user_data_t {
     void *opaque;
 };
 
+NANOEM_DECL_INTERNAL nanoem_object_arena_t *
+nanoemObjectArenaCreate(nanoem_rsize_t chunk_size, nanoem_status_t *status);
+NANOEM_DECL_INTERNAL void *
+nanoemObjectArenaAllocate(nanoem_object_arena_t *arena, nanoem_rsize_t size, nanoem_status_t *status);
+NANOEM_DECL_INTERNAL void
+nanoemObjectArenaRelease(nanoem_object_arena_t *arena);
+NANOEM_DECL_INTERNAL void
+nanoemObjectArenaDetach(nanoem_object_arena_t *arena);
+
 NANOEM_DECL_INTERNAL int
 nanoemModelCompareBonePMD(const void *a, const void *b);
 NANOEM_DECL_INTERNAL int
@@ -1055,6 +1117,8 @@ nanoemStringCacheDestroy(kh_string_cache_t *cache);
 NANOEM_DECL_INTERNAL void
 nanoemMotionTrackBundleAddKeyframe(kh_motion_track_bundle_t *bundle, nanoem_motion_keyframe_object_t *keyframe, nanoem_frame_index_t frame_index, const nanoem_unicode_string_t *name, nanoem_unicode_string_factory_t *factory, int *ret);
 NANOEM_DECL_INTERNAL void
+nanoemMotionTrackBundleRebuildAllOrderedKeyframes(kh_motion_track_bundle_t *bundle);
+NANOEM_DECL_INTERNAL void
 nanoemMotionTrackBundleDestroy(kh_motion_track_bundle_t *bundle, nanoem_unicode_string_factory_t *factory);
 
 nanoem_pragma_diagnostics_push();
@@ -1290,6 +1354,9 @@ nanoemMotionTrackBundleResolveId(kh_motion_track_bundle_t *bundle, nanoem_unicod
     pair.factory = factory;
     pair.id = 0;
     pair.keyframes = NULL;
+    pair.ordered_keyframes = NULL;
+    pair.num_ordered_keyframes = 0;
+    pair.is_ordered_keyframes_dirty = nanoem_false;
     pair.name = name;
     *found_name = NULL;
     if (nanoem_is_not_null(bundle) && nanoem_is_not_null(name) && nanoem_is_not_null(factory)) {
@@ -1337,28 +1404,37 @@ nanoemMotionSetMaxFrameIndex(nanoem_motion_t *motion, const nanoem_motion_keyfra
     }
 }
 
-NANOEM_DECL_INLINE static kh_keyframe_map_t *
-nanoemMotionFindKeyframesMap(kh_motion_track_bundle_t *track_bundle, const nanoem_unicode_string_t *name, nanoem_unicode_string_factory_t *factory)
+NANOEM_DECL_INLINE static nanoem_motion_track_t *
+nanoemMotionTrackBundleFindTrack(kh_motion_track_bundle_t *track_bundle, const nanoem_unicode_string_t *name, nanoem_unicode_string_factory_t *factory)
 {
-    nanoem_motion_track_t track;
-    kh_keyframe_map_t *keyframes_map = NULL;
+    nanoem_motion_track_t track, *found_track = NULL;
     khiter_t it;
     union nanoem_const_to_mutable_unicode_string_cast_t {
         const nanoem_unicode_string_t *s;
         nanoem_unicode_string_t *m;
     } u;
-    if (nanoem_is_not_null(name)) {
+    if (nanoem_is_not_null(track_bundle) && nanoem_is_not_null(name)) {
         u.s = name;
         track.factory = factory;
         track.name = u.m;
         track.id = 0;
         track.keyframes = NULL;
+        track.ordered_keyframes = NULL;
+        track.num_ordered_keyframes = 0;
+        track.is_ordered_keyframes_dirty = nanoem_false;
         it = kh_get_motion_track_bundle(track_bundle, track);
         if (it != kh_end(track_bundle)) {
-            keyframes_map = kh_key(track_bundle, it).keyframes;
+            found_track = &kh_key(track_bundle, it);
         }
     }
-    return keyframes_map;
+    return found_track;
+}
+
+NANOEM_DECL_INLINE static kh_keyframe_map_t *
+nanoemMotionFindKeyframesMap(kh_motion_track_bundle_t *track_bundle, const nanoem_unicode_string_t *name, nanoem_unicode_string_factory_t *factory)
+{
+    nanoem_motion_track_t *track = nanoemMotionTrackBundleFindTrack(track_bundle, name, factory);
+    return nanoem_is_not_null(track) ? track->keyframes : NULL;
 }
 
 NANOEM_DECL_INLINE static int
@@ -70,6 +70,42 @@ TEST_CASE("mutable_bone_keyframe_manipulate", "[nanoem]")
     CHECK(status == NANOEM_STATUS_ERROR_MOTION_BONE_KEYFRAME_NOT_FOUND);
 }
 
+TEST_CASE("mutable_bone_keyframe_object_arena_outlives_motion", "[nanoem]")
+{
+    static const nanoem_f32_t expected_translation[] = { 1, 2, 3, 0 };
+    nanoem_mutable_motion_bone_keyframe_t *removed_keyframe = 0;
+    {
+        MotionScope scope;
+        nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+        nanoem_mutable_motion_t *mutable_motion = scope.newMotion();
+        nanoem_motion_t *origin = nanoemMutableMotionGetOriginObject(mutable_motion);
+        nanoemMotionEnableObjectArena(origin, 0, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoem_unicode_string_t *name = scope.newString("bone_keyframe");
+        for (nanoem_frame_index_t i = 0; i < 64; i++) {
+            nanoem_mutable_motion_bone_keyframe_t *keyframe = nanoemMutableMotionBoneKeyframeCreate(origin, &status);
+            nanoemMutableMotionBoneKeyframeSetTranslation(keyframe, expected_translation);
+            nanoemMutableMotionAddBoneKeyframe(mutable_motion, keyframe, name, i, &status);
+            CHECK(status == NANOEM_STATUS_SUCCESS);
+            if (i == 42) {
+                removed_keyframe = keyframe;
+            }
+            else {
+                nanoemMutableMotionBoneKeyframeDestroy(keyframe);
+            }
+        }
+        nanoemMutableMotionRemoveBoneKeyframe(mutable_motion, removed_keyframe, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoem_rsize_t num_keyframes;
+        nanoemMotionGetAllBoneKeyframeObjects(origin, &num_keyframes);
+        CHECK(num_keyframes == 63);
+    }
+    /* the removed keyframe must be still readable after the motion owning the arena is destroyed */
+    nanoem_motion_bone_keyframe_t *origin_keyframe = nanoemMutableMotionBoneKeyframeGetOriginObject(removed_keyframe);
+    CHECK_THAT(nanoemMotionBoneKeyframeGetTranslation(origin_keyframe), Equals(1, 2, 3, 0));
+    nanoemMutableMotionBoneKeyframeDestroy(removed_keyframe);
+}
+
 TEST_CASE("mutable_bone_keyframe_generate_vmd", "[nanoem]")
 {
     static const nanoem_u8_t expected_interpolation[] = { 12, 24, 36, 48 };
@@ -203,3 +239,151 @@ TEST_CASE("mutable_bone_keyframe_generate_nmd", "[nanoem]")
         CHECK(nanoemMotionBoneKeyframeIsPhysicsSimulationEnabled(generated_keyframe) == nanoem_false);
     }
 }
+
+TEST_CASE("mutable_bone_keyframe_search_closest", "[nanoem]")
+{
+    static const nanoem_frame_index_t frame_indices[] = { 30, 10, 50, 20, 40 };
+    MotionScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutable_motion = scope.newMotion();
+    nanoem_motion_t *motion = nanoemMutableMotionGetOriginObject(mutable_motion);
+    nanoem_unicode_string_t *name = scope.newString("bone_keyframe");
+    nanoem_motion_bone_keyframe_t *prev_keyframe, *next_keyframe;
+    for (size_t i = 0; i < sizeof(frame_indices) / sizeof(frame_indices[0]); i++) {
+        nanoem_mutable_motion_bone_keyframe_t *mutable_keyframe =
+            nanoemMutableMotionBoneKeyframeCreate(motion, &status);
+        nanoemMutableMotionAddBoneKeyframe(mutable_motion, mutable_keyframe, name, frame_indices[i], &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoemMutableMotionBoneKeyframeDestroy(mutable_keyframe);
+    }
+    SECTION("between keyframes")
+    {
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 25, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 30);
+    }
+    SECTION("exactly at keyframe")
+    {
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 30, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 40);
+    }
+    SECTION("before first keyframe")
+    {
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 5, &prev_keyframe, &next_keyframe);
+        CHECK_FALSE(prev_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 10);
+    }
+    SECTION("after last keyframe should fallback to the last keyframe")
+    {
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 60, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 50);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 50);
+    }
+    SECTION("sequential and jumping access should be consistent")
+    {
+        static const nanoem_frame_index_t expected_prev[] = { 0, 0, 10, 20, 30, 40, 50 };
+        static const nanoem_frame_index_t expected_next[] = { 10, 20, 30, 40, 50, 50, 50 };
+        static const nanoem_frame_index_t order[] = { 0, 1, 2, 3, 4, 5, 6, 5, 4, 3, 2, 1, 0, 6, 0, 3 };
+        nanoemMutableMotionSortAllKeyframes(mutable_motion);
+        const nanoem_motion_track_handle_t handle = nanoemMotionResolveBoneTrackHandle(motion, name);
+        nanoem_motion_bone_keyframe_t *stateless_prev_keyframe, *stateless_next_keyframe;
+        nanoem_rsize_t cursor = 0;
+        for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+            const nanoem_frame_index_t index = order[i];
+            nanoemMotionSearchClosestBoneKeyframesByHandleWithCursor(
+                motion, handle, index * 10, &cursor, &prev_keyframe, &next_keyframe);
+            nanoemMotionSearchClosestBoneKeyframes(
+                motion, name, index * 10, &stateless_prev_keyframe, &stateless_next_keyframe);
+            CHECK(prev_keyframe == stateless_prev_keyframe);
+            CHECK(next_keyframe == stateless_next_keyframe);
+            if (expected_prev[index] > 0) {
+                CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(
+                          prev_keyframe)) == expected_prev[index]);
+            }
+            else {
+                CHECK_FALSE(prev_keyframe);
+            }
+            CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) ==
+                expected_next[index]);
+        }
+    }
+    SECTION("removing keyframe should be reflected")
+    {
+        nanoem_mutable_motion_bone_keyframe_t *mutable_keyframe =
+            nanoemMutableMotionBoneKeyframeCreateByFound(motion, name, 30, &status);
+        nanoemMutableMotionRemoveBoneKeyframe(mutable_motion, mutable_keyframe, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoemMutableMotionBoneKeyframeDestroy(mutable_keyframe);
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 25, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 40);
+    }
+    SECTION("keyframes added after sorting should be found before sorting again")
+    {
+        nanoemMutableMotionSortAllKeyframes(mutable_motion);
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 25, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 30);
+        nanoem_mutable_motion_bone_keyframe_t *mutable_keyframe = nanoemMutableMotionBoneKeyframeCreate(motion, &status);
+        nanoemMutableMotionAddBoneKeyframe(mutable_motion, mutable_keyframe, name, 25, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoemMutableMotionBoneKeyframeDestroy(mutable_keyframe);
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 27, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 25);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 30);
+        nanoemMutableMotionSortAllKeyframes(mutable_motion);
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 27, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 25);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 30);
+    }
+    SECTION("unknown track should not be found")
+    {
+        nanoemMotionSearchClosestBoneKeyframes(motion, scope.newString("unknown"), 25, &prev_keyframe, &next_keyframe);
+        CHECK_FALSE(prev_keyframe);
+        CHECK_FALSE(next_keyframe);
+    }
+}
+
+TEST_CASE("mutable_bone_keyframe_find_by_track_handle", "[nanoem]")
+{
+    MotionScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutable_motion = scope.newMotion();
+    nanoem_motion_t *motion = nanoemMutableMotionGetOriginObject(mutable_motion);
+    nanoem_unicode_string_t *name = scope.newString("bone_keyframe");
+    nanoem_motion_bone_keyframe_t *prev_keyframe, *next_keyframe;
+    CHECK(nanoemMotionResolveBoneTrackHandle(motion, name) == 0);
+    const nanoem_u32_t revision = nanoemMotionGetLocalTrackRevision(motion);
+    for (nanoem_frame_index_t i = 10; i <= 30; i += 10) {
+        nanoem_mutable_motion_bone_keyframe_t *mutable_keyframe =
+            nanoemMutableMotionBoneKeyframeCreate(motion, &status);
+        nanoemMutableMotionAddBoneKeyframe(mutable_motion, mutable_keyframe, name, i, &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoemMutableMotionBoneKeyframeDestroy(mutable_keyframe);
+    }
+    CHECK(nanoemMotionGetLocalTrackRevision(motion) != revision);
+    const nanoem_motion_track_handle_t handle = nanoemMotionResolveBoneTrackHandle(motion, name);
+    CHECK(handle != 0);
+    CHECK(nanoemMotionFindBoneKeyframeObjectByHandle(motion, handle, 20) ==
+        nanoemMotionFindBoneKeyframeObject(motion, name, 20));
+    CHECK_FALSE(nanoemMotionFindBoneKeyframeObjectByHandle(motion, handle, 25));
+    nanoemMotionSearchClosestBoneKeyframesByHandle(motion, handle, 25, &prev_keyframe, &next_keyframe);
+    CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(prev_keyframe)) == 20);
+    CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionBoneKeyframeGetKeyframeObject(next_keyframe)) == 30);
+    /* the handle must survive rehashing tracks by adding many tracks */
+    for (int i = 0; i < 64; i++) {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "bone%d", i);
+        nanoem_mutable_motion_bone_keyframe_t *mutable_keyframe =
+            nanoemMutableMotionBoneKeyframeCreate(motion, &status);
+        nanoemMutableMotionAddBoneKeyframe(mutable_motion, mutable_keyframe, scope.newString(buffer), 0, &status);
+        nanoemMutableMotionBoneKeyframeDestroy(mutable_keyframe);
+    }
+    CHECK(nanoemMotionResolveBoneTrackHandle(motion, name) == handle);
+    CHECK(nanoemMotionFindBoneKeyframeObjectByHandle(motion, handle, 30) ==
+        nanoemMotionFindBoneKeyframeObject(motion, name, 30));
+    nanoemMotionSearchClosestBoneKeyframesByHandle(motion, 0, 25, &prev_keyframe, &next_keyframe);
+    CHECK_FALSE(prev_keyframe);
+    CHECK_FALSE(next_keyframe);
+}
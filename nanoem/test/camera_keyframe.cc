@@ -202,3 +202,51 @@ TEST_CASE("mutable_camera_keyframe_generate_nmd", "[nanoem]")
         CHECK(nanoemMotionCameraKeyframeIsPerspectiveView(generated_keyframe));
     }
 }
+
+TEST_CASE("mutable_camera_keyframe_search_closest", "[nanoem]")
+{
+    static const nanoem_frame_index_t frame_indices[] = { 30, 10, 50, 20, 40 };
+    MotionScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_motion_t *mutable_motion = scope.newMotion();
+    nanoem_motion_t *motion = nanoemMutableMotionGetOriginObject(mutable_motion);
+    nanoem_motion_camera_keyframe_t *prev_keyframe, *next_keyframe;
+    for (size_t i = 0; i < sizeof(frame_indices) / sizeof(frame_indices[0]); i++) {
+        nanoem_mutable_motion_camera_keyframe_t *mutable_keyframe =
+            nanoemMutableMotionCameraKeyframeCreate(motion, &status);
+        nanoemMutableMotionAddCameraKeyframe(mutable_motion, mutable_keyframe, frame_indices[i], &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        nanoemMutableMotionCameraKeyframeDestroy(mutable_keyframe);
+    }
+    SECTION("unsorted keyframes")
+    {
+        nanoemMotionSearchClosestCameraKeyframes(motion, 25, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev_keyframe)) ==
+            20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next_keyframe)) ==
+            30);
+    }
+    SECTION("sorted keyframes")
+    {
+        nanoemMutableMotionSortAllKeyframes(mutable_motion);
+        nanoemMotionSearchClosestCameraKeyframes(motion, 25, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev_keyframe)) ==
+            20);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next_keyframe)) ==
+            30);
+        nanoemMotionSearchClosestCameraKeyframes(motion, 40, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev_keyframe)) ==
+            30);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next_keyframe)) ==
+            50);
+        nanoemMotionSearchClosestCameraKeyframes(motion, 0, &prev_keyframe, &next_keyframe);
+        CHECK_FALSE(prev_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next_keyframe)) ==
+            10);
+        nanoemMotionSearchClosestCameraKeyframes(motion, 100, &prev_keyframe, &next_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(prev_keyframe)) ==
+            50);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(nanoemMotionCameraKeyframeGetKeyframeObject(next_keyframe)) ==
+            50);
+    }
+}
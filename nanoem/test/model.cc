@@ -114,3 +114,120 @@ TEST_CASE("mutable_model_copy_name", "[nanoem]")
         }
     }
 }
+
+namespace {
+
+static void
+dispatchParallelRangesInReverseOrder(
+    void *user_data, nanoem_model_parallel_range_t func, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grain_size)
+{
+    /* runs the ranges backward to detect dependencies between records */
+    nanoem_rsize_t *num_calls = static_cast<nanoem_rsize_t *>(user_data);
+    nanoem_rsize_t num_ranges = (iterations + grain_size - 1) / grain_size;
+    for (nanoem_rsize_t i = num_ranges; i > 0; i--) {
+        nanoem_rsize_t begin = (i - 1) * grain_size, end = begin + grain_size;
+        func(opaque, begin, end < iterations ? end : iterations);
+    }
+    *num_calls += 1;
+}
+
+static nanoem_model_t *
+loadModel(nanoem_unicode_string_factory_t *factory, const std::vector<nanoem_u8_t> &bytes, nanoem_rsize_t length,
+    nanoem_rsize_t *num_calls, nanoem_status_t *status)
+{
+    nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), length, status);
+    nanoem_model_t *model = nanoemModelCreate(factory, status);
+    if (num_calls) {
+        nanoemModelSetParallelDispatcher(model, dispatchParallelRangesInReverseOrder, num_calls);
+    }
+    nanoemModelLoadFromBuffer(model, buffer, status);
+    nanoemBufferDestroy(buffer);
+    return model;
+}
+
+static std::vector<nanoem_u8_t>
+saveModel(nanoem_model_t *model)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_model_t *mutable_model = nanoemMutableModelCreateAsReference(model, &status);
+    nanoem_mutable_buffer_t *mutable_buffer = nanoemMutableBufferCreate(&status);
+    nanoemMutableModelSaveToBuffer(mutable_model, mutable_buffer, &status);
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutable_buffer, &status);
+    const nanoem_u8_t *ptr = nanoemBufferGetDataPtr(buffer);
+    std::vector<nanoem_u8_t> bytes(ptr, ptr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableBufferDestroy(mutable_buffer);
+    nanoemMutableModelDestroy(mutable_model);
+    return bytes;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("model_parallel_dispatcher_pmx", "[nanoem]")
+{
+    static const nanoem_f32_t expected_origin[] = { 1, 2, 3, 0 };
+    ModelScope scope;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_model_t *mutable_model = scope.newModel();
+    nanoem_mutable_model_bone_t *bone = scope.appendedBone("bone");
+    for (int i = 0; i < 4096; i++) {
+        nanoem_mutable_model_vertex_t *vertex = scope.appendedVertex();
+        nanoemMutableModelVertexSetOrigin(vertex, expected_origin);
+        nanoemMutableModelVertexSetType(vertex, static_cast<nanoem_model_vertex_type_t>(i % NANOEM_MODEL_VERTEX_TYPE_MAX_ENUM));
+        nanoemMutableModelVertexSetBoneObject(vertex, nanoemMutableModelBoneGetOriginObject(bone), 0);
+        nanoemMutableModelVertexSetBoneWeight(vertex, (i % 10) * 0.1f, 0);
+    }
+    nanoem_rsize_t num_origin_vertices;
+    nanoem_model_vertex_t *const *vertices = nanoemModelGetAllVertexObjects(scope.origin(), &num_origin_vertices);
+    for (int i = 0; i < 64; i++) {
+        nanoem_mutable_model_morph_t *morph = scope.appendedMorph(i % 2 ? "morph" : nullptr);
+        nanoemMutableModelMorphSetType(morph, NANOEM_MODEL_MORPH_TYPE_VERTEX);
+        for (int j = 0; j < i; j++) {
+            nanoem_mutable_model_morph_vertex_t *item = scope.newVertexMorph();
+            nanoemMutableModelMorphVertexSetVertexObject(item, vertices[i * 64 + j]);
+            nanoemMutableModelMorphVertexSetPosition(item, expected_origin);
+            nanoemMutableModelMorphInsertVertexMorphObject(morph, item, -1, &status);
+        }
+    }
+    nanoem_u32_t indices[] = { 0, 1, 2 };
+    nanoemMutableModelSetVertexIndices(mutable_model, indices, 3, &status);
+    nanoemMutableModelSetFormatType(mutable_model, NANOEM_MODEL_FORMAT_TYPE_PMX_2_0);
+    const std::vector<nanoem_u8_t> bytes = saveModel(scope.origin());
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    SECTION("same as the serial parser")
+    {
+        nanoem_status_t expected_status = NANOEM_STATUS_SUCCESS, actual_status = NANOEM_STATUS_SUCCESS;
+        nanoem_rsize_t num_calls = 0, num_vertices, num_morphs;
+        nanoem_model_t *expected_model = loadModel(factory, bytes, bytes.size(), nullptr, &expected_status);
+        nanoem_model_t *actual_model = loadModel(factory, bytes, bytes.size(), &num_calls, &actual_status);
+        CHECK(expected_status == NANOEM_STATUS_SUCCESS);
+        CHECK(actual_status == NANOEM_STATUS_SUCCESS);
+        CHECK(num_calls == 2);
+        nanoem_model_vertex_t *const *actual_vertices = nanoemModelGetAllVertexObjects(actual_model, &num_vertices);
+        nanoem_model_morph_t *const *actual_morphs = nanoemModelGetAllMorphObjects(actual_model, &num_morphs);
+        CHECK(num_vertices == 4096);
+        CHECK(num_morphs == 64);
+        CHECK(nanoemModelObjectGetIndex(nanoemModelVertexGetModelObject(actual_vertices[4095])) == 4095);
+        CHECK(nanoemModelObjectGetIndex(nanoemModelMorphGetModelObject(actual_morphs[63])) == 63);
+        CHECK(saveModel(actual_model) == saveModel(expected_model));
+        nanoemModelDestroy(expected_model);
+        nanoemModelDestroy(actual_model);
+    }
+    SECTION("truncated in the morph block")
+    {
+        nanoem_status_t expected_status = NANOEM_STATUS_SUCCESS, actual_status = NANOEM_STATUS_SUCCESS;
+        nanoem_rsize_t num_calls = 0, expected_num_morphs, actual_num_morphs;
+        /* the last morph record and the rest blocks are truncated */
+        const nanoem_rsize_t length = bytes.size() - 64;
+        nanoem_model_t *expected_model = loadModel(factory, bytes, length, nullptr, &expected_status);
+        nanoem_model_t *actual_model = loadModel(factory, bytes, length, &num_calls, &actual_status);
+        CHECK(expected_status != NANOEM_STATUS_SUCCESS);
+        CHECK(actual_status == expected_status);
+        nanoemModelGetAllMorphObjects(expected_model, &expected_num_morphs);
+        nanoemModelGetAllMorphObjects(actual_model, &actual_num_morphs);
+        CHECK(actual_num_morphs == expected_num_morphs);
+        nanoemModelDestroy(expected_model);
+        nanoemModelDestroy(actual_model);
+    }
+    nanoemUnicodeStringFactoryDestroyEXT(factory);
+}
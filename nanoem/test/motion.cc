@@ -134,3 +134,185 @@ TEST_CASE("mutable_motion_null_values", "[nanoem]")
     CHECK_FALSE(nanoemMutableMotionSaveToBuffer(mutable_motion, NULL, &status));
     CHECK_FALSE(nanoemMutableMotionSaveToBufferNMD(mutable_motion, NULL, &status));
 }
+
+namespace {
+
+static void
+writeName(nanoem_mutable_buffer_t *buffer, const char *name, nanoem_rsize_t length, nanoem_status_t *status)
+{
+    std::vector<nanoem_u8_t> bytes(length);
+    memcpy(bytes.data(), name, strlen(name) < length ? strlen(name) : length);
+    nanoemMutableBufferWriteByteArray(buffer, bytes.data(), length, status);
+}
+
+static std::vector<nanoem_u8_t>
+generateKeyframeBlocksVMD(const char *const *bone_names, int num_bone_names, int num_frames)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_mutable_buffer_t *mutable_buffer = nanoemMutableBufferCreate(&status);
+    writeName(mutable_buffer, "Vocaloid Motion Data 0002", 30, &status);
+    writeName(mutable_buffer, "model", 20, &status);
+    /* keyframes are written in descending order of frames to make the parser sort them */
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, num_bone_names * num_frames, &status);
+    for (int i = num_frames - 1; i >= 0; i--) {
+        for (int j = 0; j < num_bone_names; j++) {
+            writeName(mutable_buffer, bone_names[j], 15, &status);
+            nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, i * 2, &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, nanoem_f32_t(i), &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, nanoem_f32_t(j), &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, 0, &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, 0, &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, 0, &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, 0, &status);
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, 1, &status);
+            for (int k = 0; k < 64; k++) {
+                nanoemMutableBufferWriteByte(mutable_buffer, nanoem_u8_t(k), &status);
+            }
+        }
+    }
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, num_frames, &status);
+    for (int i = num_frames - 1; i >= 0; i--) {
+        writeName(mutable_buffer, "morph", 15, &status);
+        nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, i, &status);
+        nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, i / nanoem_f32_t(num_frames), &status);
+    }
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, 2, &status);
+    for (int i = 1; i >= 0; i--) {
+        nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, i * 10, &status);
+        for (int j = 0; j < 7; j++) {
+            nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, nanoem_f32_t(i * 7 + j), &status);
+        }
+        for (int j = 0; j < 24; j++) {
+            nanoemMutableBufferWriteByte(mutable_buffer, nanoem_u8_t(j), &status);
+        }
+        nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, 30 + i, &status);
+        nanoemMutableBufferWriteByte(mutable_buffer, nanoem_u8_t(i), &status);
+    }
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, 1, &status);
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, 5, &status);
+    for (int i = 0; i < 6; i++) {
+        nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, i * 0.1f, &status);
+    }
+    nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, 2, &status);
+    for (int i = 1; i >= 0; i--) {
+        nanoemMutableBufferWriteInt32LittleEndian(mutable_buffer, i * 3, &status);
+        nanoemMutableBufferWriteByte(mutable_buffer, nanoem_u8_t(i + 1), &status);
+        nanoemMutableBufferWriteFloat32LittleEndian(mutable_buffer, i * 0.5f, &status);
+    }
+    nanoem_buffer_t *buffer = nanoemMutableBufferCreateBufferObject(mutable_buffer, &status);
+    const nanoem_u8_t *ptr = nanoemBufferGetDataPtr(buffer);
+    std::vector<nanoem_u8_t> bytes(ptr, ptr + nanoemBufferGetLength(buffer));
+    nanoemBufferDestroy(buffer);
+    nanoemMutableBufferDestroy(mutable_buffer);
+    return bytes;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("motion_load_vmd_keyframe_blocks", "[nanoem]")
+{
+    static const char *const bone_names[] = { "center", "upper", "lower" };
+    static const int num_frames = 100;
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    const std::vector<nanoem_u8_t> bytes = generateKeyframeBlocksVMD(bone_names, 3, num_frames);
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    nanoem_motion_t *motion = nanoemMotionCreate(factory, &status);
+    SECTION("all keyframes should be sorted by frame index")
+    {
+        nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), bytes.size(), &status);
+        CHECK(nanoemMotionLoadFromBufferVMD(motion, buffer, 0, &status));
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        CHECK(nanoemBufferGetOffset(buffer) == bytes.size());
+        nanoemBufferDestroy(buffer);
+        CHECK(nanoemMotionGetMaxFrameIndex(motion) == (num_frames - 1) * 2);
+        nanoem_rsize_t num_keyframes;
+        nanoem_motion_bone_keyframe_t *const *bone_keyframes =
+            nanoemMotionGetAllBoneKeyframeObjects(motion, &num_keyframes);
+        REQUIRE(num_keyframes == 3 * num_frames);
+        for (nanoem_rsize_t i = 1; i < num_keyframes; i++) {
+            const nanoem_motion_keyframe_object_t *prev =
+                nanoemMotionBoneKeyframeGetKeyframeObject(bone_keyframes[i - 1]);
+            const nanoem_motion_keyframe_object_t *next = nanoemMotionBoneKeyframeGetKeyframeObject(bone_keyframes[i]);
+            CHECK(nanoemMotionKeyframeObjectGetFrameIndex(prev) <= nanoemMotionKeyframeObjectGetFrameIndex(next));
+            /* keyframes of the same frame index keep the order of the file */
+            if (nanoemMotionKeyframeObjectGetFrameIndex(prev) == nanoemMotionKeyframeObjectGetFrameIndex(next)) {
+                CHECK(nanoemMotionKeyframeObjectGetIndex(prev) < nanoemMotionKeyframeObjectGetIndex(next));
+            }
+        }
+        nanoem_unicode_string_t *name =
+            nanoemUnicodeStringFactoryCreateString(factory, reinterpret_cast<const nanoem_u8_t *>("upper"), 5, &status);
+        const nanoem_motion_bone_keyframe_t *bone_keyframe = nanoemMotionFindBoneKeyframeObject(motion, name, 42);
+        REQUIRE(bone_keyframe);
+        CHECK_THAT(nanoemMotionBoneKeyframeGetTranslation(bone_keyframe), Equals(21, 1, 0, 0));
+        CHECK_THAT(nanoemMotionBoneKeyframeGetOrientation(bone_keyframe), Equals(0, 0, 0, 1));
+        CHECK_THAT(nanoemMotionBoneKeyframeGetInterpolation(
+                       bone_keyframe, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_TRANSLATION_X),
+            EqualsU8(0, 4, 8, 12));
+        CHECK_THAT(nanoemMotionBoneKeyframeGetInterpolation(
+                       bone_keyframe, NANOEM_MOTION_BONE_KEYFRAME_INTERPOLATION_TYPE_ORIENTATION),
+            EqualsU8(3, 7, 11, 15));
+        nanoem_motion_bone_keyframe_t *prev_bone_keyframe, *next_bone_keyframe;
+        nanoemMotionSearchClosestBoneKeyframes(motion, name, 43, &prev_bone_keyframe, &next_bone_keyframe);
+        CHECK(prev_bone_keyframe == bone_keyframe);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(
+                  nanoemMotionBoneKeyframeGetKeyframeObject(next_bone_keyframe)) == 44);
+        nanoemUnicodeStringFactoryDestroyString(factory, name);
+        nanoem_motion_morph_keyframe_t *const *morph_keyframes =
+            nanoemMotionGetAllMorphKeyframeObjects(motion, &num_keyframes);
+        REQUIRE(num_keyframes == num_frames);
+        for (nanoem_rsize_t i = 0; i < num_keyframes; i++) {
+            CHECK(nanoemMotionKeyframeObjectGetFrameIndex(
+                      nanoemMotionMorphKeyframeGetKeyframeObject(morph_keyframes[i])) == i);
+            CHECK(nanoemMotionMorphKeyframeGetWeight(morph_keyframes[i]) == Approx(i / nanoem_f32_t(num_frames)));
+        }
+        name =
+            nanoemUnicodeStringFactoryCreateString(factory, reinterpret_cast<const nanoem_u8_t *>("morph"), 5, &status);
+        CHECK(nanoemMotionFindMorphKeyframeObject(motion, name, 0) == morph_keyframes[0]);
+        nanoemUnicodeStringFactoryDestroyString(factory, name);
+        nanoem_motion_camera_keyframe_t *const *camera_keyframes =
+            nanoemMotionGetAllCameraKeyframeObjects(motion, &num_keyframes);
+        REQUIRE(num_keyframes == 2);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(
+                  nanoemMotionCameraKeyframeGetKeyframeObject(camera_keyframes[1])) == 10);
+        CHECK(nanoemMotionCameraKeyframeGetDistance(camera_keyframes[1]) == Approx(7));
+        CHECK_THAT(nanoemMotionCameraKeyframeGetLookAt(camera_keyframes[1]), Equals(8, 9, 10, 0));
+        CHECK_THAT(nanoemMotionCameraKeyframeGetAngle(camera_keyframes[1]), Equals(11, 12, 13, 0));
+        CHECK_THAT(nanoemMotionCameraKeyframeGetInterpolation(
+                       camera_keyframes[1], NANOEM_MOTION_CAMERA_KEYFRAME_INTERPOLATION_TYPE_FOV),
+            EqualsU8(4, 10, 16, 22));
+        CHECK(nanoemMotionCameraKeyframeGetFov(camera_keyframes[1]) == 31);
+        CHECK_FALSE(nanoemMotionCameraKeyframeIsPerspectiveView(camera_keyframes[1]));
+        CHECK(nanoemMotionCameraKeyframeIsPerspectiveView(camera_keyframes[0]));
+        nanoem_motion_light_keyframe_t *const *light_keyframes =
+            nanoemMotionGetAllLightKeyframeObjects(motion, &num_keyframes);
+        REQUIRE(num_keyframes == 1);
+        CHECK_THAT(nanoemMotionLightKeyframeGetColor(light_keyframes[0]), Equals(0, 0.1f, 0.2f, 0));
+        CHECK_THAT(nanoemMotionLightKeyframeGetDirection(light_keyframes[0]), Equals(0.3f, 0.4f, 0.5f, 0));
+        nanoem_motion_self_shadow_keyframe_t *const *self_shadow_keyframes =
+            nanoemMotionGetAllSelfShadowKeyframeObjects(motion, &num_keyframes);
+        REQUIRE(num_keyframes == 2);
+        CHECK(nanoemMotionKeyframeObjectGetFrameIndex(
+                  nanoemMotionSelfShadowKeyframeGetKeyframeObject(self_shadow_keyframes[1])) == 3);
+        CHECK(nanoemMotionSelfShadowKeyframeGetMode(self_shadow_keyframes[1]) == 2);
+        CHECK(nanoemMotionSelfShadowKeyframeGetDistance(self_shadow_keyframes[1]) == Approx(0.5f));
+    }
+    SECTION("truncated bone keyframe block should reject")
+    {
+        nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), 54 + 111 * 150 + 50, &status);
+        CHECK_FALSE(nanoemMotionLoadFromBufferVMD(motion, buffer, 0, &status));
+        CHECK(status == NANOEM_STATUS_ERROR_BUFFER_END);
+        nanoemBufferDestroy(buffer);
+        nanoem_rsize_t num_keyframes;
+        nanoemMotionGetAllBoneKeyframeObjects(motion, &num_keyframes);
+        CHECK(num_keyframes == 150);
+    }
+    SECTION("truncated self shadow keyframe block should reject")
+    {
+        nanoem_buffer_t *buffer = nanoemBufferCreate(bytes.data(), bytes.size() - 1, &status);
+        CHECK_FALSE(nanoemMotionLoadFromBufferVMD(motion, buffer, 0, &status));
+        CHECK(status == NANOEM_STATUS_ERROR_MOTION_SELF_SHADOW_KEYFRAME_CORRUPTED);
+        nanoemBufferDestroy(buffer);
+    }
+    nanoemMotionDestroy(motion);
+    nanoemUnicodeStringFactoryDestroyEXT(factory);
+}
@@ -0,0 +1,261 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of nanoem component and it's licensed under MIT license. see LICENSE.md for more details.
+ */
+
+#include "./common.h"
+
+#include "nanoem/ext/physics.h"
+
+#include <thread>
+
+using namespace nanoem::test;
+
+namespace {
+
+static const int kNumStacks = 16;
+static const int kNumBoxesPerStack = 4;
+static const int kNumSteps = 120;
+
+static void
+parallelForWithThreads(void * /* user_data */, nanoem_physics_world_task_t task, void *opaque, nanoem_rsize_t iterations)
+{
+    std::vector<std::thread> threads;
+    for (nanoem_rsize_t i = 0; i < iterations; i++) {
+        threads.push_back(std::thread(task, opaque, i, i + 1));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+static void
+simulateStacks(ModelScope &scope, bool parallel, std::vector<nanoem_f32_t> &transforms)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_physics_world_t *world = nanoemPhysicsWorldCreate(NULL, &status);
+    nanoemPhysicsWorldSetParallelForCallback(world, parallelForWithThreads, NULL);
+    nanoemPhysicsWorldSetParallelSimulationEnabled(world, parallel);
+    nanoemPhysicsWorldSetGroundEnabled(world, nanoem_true);
+    nanoemPhysicsWorldSetActive(world, nanoem_true);
+    std::vector<nanoem_physics_rigid_body_t *> bodies;
+    const nanoem_f32_t size[] = { 0.5f, 0.5f, 0.5f, 0 };
+    for (int i = 0; i < kNumStacks; i++) {
+        for (int j = 0; j < kNumBoxesPerStack; j++) {
+            /* stacks are placed apart from each other so each stack becomes its own simulation island */
+            const nanoem_f32_t origin[] = { i * 4.0f, 0.5f + j * 1.05f, (i % 4) * 0.1f, 0 };
+            nanoem_mutable_model_rigid_body_t *rigid_body = scope.newRigidBody();
+            nanoemMutableModelRigidBodySetShapeType(rigid_body, NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_BOX);
+            nanoemMutableModelRigidBodySetTransformType(
+                rigid_body, NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_SIMULATION_TO_BONE);
+            nanoemMutableModelRigidBodySetShapeSize(rigid_body, size);
+            nanoemMutableModelRigidBodySetOrigin(rigid_body, origin);
+            nanoemMutableModelRigidBodySetMass(rigid_body, 1);
+            nanoemMutableModelRigidBodySetFriction(rigid_body, 0.5f);
+            nanoemMutableModelRigidBodySetCollisionMask(rigid_body, 0xffff);
+            nanoem_physics_rigid_body_t *body =
+                nanoemPhysicsRigidBodyCreate(nanoemMutableModelRigidBodyGetOriginObject(rigid_body), NULL, &status);
+            nanoemPhysicsWorldAddRigidBody(world, body);
+            bodies.push_back(body);
+        }
+    }
+    for (int i = 0; i < kNumSteps; i++) {
+        nanoemPhysicsWorldStepSimulation(world, 1.0f / 60.0f);
+    }
+    transforms.resize(bodies.size() * 16);
+    for (size_t i = 0, numBodies = bodies.size(); i < numBodies; i++) {
+        nanoem_physics_rigid_body_t *body = bodies[i];
+        nanoemPhysicsRigidBodyGetWorldTransform(body, &transforms[i * 16]);
+        nanoemPhysicsWorldRemoveRigidBody(world, body);
+        nanoemPhysicsRigidBodyDestroy(body);
+    }
+    nanoemPhysicsWorldDestroy(world);
+}
+
+static nanoem_physics_rigid_body_t *
+createFallingBox(ModelScope &scope, nanoem_physics_world_t *world)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    const nanoem_f32_t size[] = { 0.5f, 0.5f, 0.5f, 0 }, origin[] = { 0, 10, 0, 0 };
+    nanoem_mutable_model_rigid_body_t *rigid_body = scope.newRigidBody();
+    nanoemMutableModelRigidBodySetShapeType(rigid_body, NANOEM_MODEL_RIGID_BODY_SHAPE_TYPE_BOX);
+    nanoemMutableModelRigidBodySetTransformType(
+        rigid_body, NANOEM_MODEL_RIGID_BODY_TRANSFORM_TYPE_FROM_SIMULATION_TO_BONE);
+    nanoemMutableModelRigidBodySetShapeSize(rigid_body, size);
+    nanoemMutableModelRigidBodySetOrigin(rigid_body, origin);
+    nanoemMutableModelRigidBodySetMass(rigid_body, 1);
+    nanoemMutableModelRigidBodySetCollisionMask(rigid_body, 0xffff);
+    nanoem_physics_rigid_body_t *body =
+        nanoemPhysicsRigidBodyCreate(nanoemMutableModelRigidBodyGetOriginObject(rigid_body), NULL, &status);
+    nanoemPhysicsWorldAddRigidBody(world, body);
+    return body;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("null_physics_world_parallel_simulation", "[nanoem]")
+{
+    nanoemPhysicsWorldSetParallelForCallback(NULL, NULL, NULL);
+    nanoemPhysicsWorldSetParallelSimulationEnabled(NULL, nanoem_true);
+    CHECK_FALSE(nanoemPhysicsWorldIsParallelSimulationEnabled(NULL));
+}
+
+TEST_CASE("null_physics_world_substeps", "[nanoem]")
+{
+    nanoemPhysicsWorldSetMaxSubSteps(NULL, 1);
+    nanoemPhysicsWorldSetInterpolationEnabled(NULL, nanoem_true);
+    CHECK(nanoemPhysicsWorldGetMaxSubSteps(NULL) == 0);
+    CHECK_FALSE(nanoemPhysicsWorldIsInterpolationEnabled(NULL));
+    CHECK(nanoemPhysicsWorldGetNumSteps(NULL) == 0);
+    CHECK(nanoemPhysicsWorldGetNumDroppedSteps(NULL) == 0);
+}
+
+TEST_CASE("null_physics_world_state", "[nanoem]")
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_u8_t data[4] = { 0 };
+    CHECK(nanoemPhysicsWorldGetStateSize(NULL) == 0);
+    nanoemPhysicsWorldSaveState(NULL, data, sizeof(data), &status);
+    CHECK(status == NANOEM_STATUS_ERROR_NULL_OBJECT);
+    status = NANOEM_STATUS_SUCCESS;
+    nanoemPhysicsWorldRestoreState(NULL, data, sizeof(data), &status);
+    CHECK(status == NANOEM_STATUS_ERROR_NULL_OBJECT);
+}
+
+#ifdef NANOEM_ENABLE_BULLET
+
+TEST_CASE("physics_world_parallel_simulation_enabled", "[nanoem]")
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_physics_world_t *world = nanoemPhysicsWorldCreate(NULL, &status);
+    CHECK_FALSE(nanoemPhysicsWorldIsParallelSimulationEnabled(world));
+    nanoemPhysicsWorldSetParallelSimulationEnabled(world, nanoem_true);
+    CHECK(nanoemPhysicsWorldIsParallelSimulationEnabled(world));
+    nanoemPhysicsWorldSetParallelSimulationEnabled(world, nanoem_false);
+    CHECK_FALSE(nanoemPhysicsWorldIsParallelSimulationEnabled(world));
+    nanoemPhysicsWorldDestroy(world);
+}
+
+TEST_CASE("physics_world_parallel_simulation_matches_sequential", "[nanoem]")
+{
+    ModelScope scope;
+    scope.newModel();
+    std::vector<nanoem_f32_t> sequential, parallel;
+    simulateStacks(scope, false, sequential);
+    simulateStacks(scope, true, parallel);
+    REQUIRE(sequential.size() == parallel.size());
+    for (size_t i = 0, size = sequential.size(); i < size; i++) {
+        CHECK(parallel[i] == Approx(sequential[i]).margin(1e-4));
+    }
+}
+
+TEST_CASE("physics_world_max_substeps_drop_exceeded_steps", "[nanoem]")
+{
+    static const nanoem_f32_t kFixedTimeStep = 1.0f / 60.0f;
+    ModelScope scope;
+    scope.newModel();
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_physics_world_t *world = nanoemPhysicsWorldCreate(NULL, &status);
+    nanoem_physics_rigid_body_t *body = createFallingBox(scope, world);
+    nanoemPhysicsWorldSetActive(world, nanoem_true);
+    nanoemPhysicsWorldSetMaxSubSteps(world, 0);
+    CHECK(nanoemPhysicsWorldGetMaxSubSteps(world) > 0);
+    nanoemPhysicsWorldSetMaxSubSteps(world, 4);
+    CHECK(nanoemPhysicsWorldGetMaxSubSteps(world) == 4);
+    SECTION("exceeded substeps are dropped")
+    {
+        CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep * 10.5f) == 4);
+        CHECK(nanoemPhysicsWorldGetNumSteps(world) == 4);
+        CHECK(nanoemPhysicsWorldGetNumDroppedSteps(world) == 6);
+    }
+    SECTION("remaining time is carried over to the next step")
+    {
+        CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep * 10.5f) == 4);
+        CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep * 0.25f) == 0);
+        CHECK(nanoemPhysicsWorldGetNumDroppedSteps(world) == 0);
+        CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep * 0.5f) == 1);
+        CHECK(nanoemPhysicsWorldGetNumSteps(world) == 1);
+        CHECK(nanoemPhysicsWorldGetNumDroppedSteps(world) == 0);
+    }
+    nanoemPhysicsWorldRemoveRigidBody(world, body);
+    nanoemPhysicsRigidBodyDestroy(body);
+    nanoemPhysicsWorldDestroy(world);
+}
+
+TEST_CASE("physics_world_interpolation_between_last_two_steps", "[nanoem]")
+{
+    static const nanoem_f32_t kFixedTimeStep = 1.0f / 60.0f;
+    ModelScope scope;
+    scope.newModel();
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_physics_world_t *world = nanoemPhysicsWorldCreate(NULL, &status);
+    nanoem_physics_rigid_body_t *body = createFallingBox(scope, world);
+    nanoemPhysicsWorldSetActive(world, nanoem_true);
+    CHECK_FALSE(nanoemPhysicsWorldIsInterpolationEnabled(world));
+    nanoemPhysicsWorldSetInterpolationEnabled(world, nanoem_true);
+    CHECK(nanoemPhysicsWorldIsInterpolationEnabled(world));
+    nanoem_f32_t previous[16], current[16], interpolated[16];
+    CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep) == 1);
+    nanoemPhysicsRigidBodyGetWorldTransform(body, previous);
+    CHECK(nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep * 1.5f) == 1);
+    nanoemPhysicsRigidBodyGetWorldTransform(body, current);
+    nanoemPhysicsMotionStateGetCurrentWorldTransform(nanoemPhysicsRigidBodyGetMotionState(body), interpolated);
+    /* the box is falling so the interpolated position lies between positions of the last two steps */
+    CHECK(current[13] < previous[13]);
+    CHECK(interpolated[13] == Approx((previous[13] + current[13]) * 0.5f).margin(1e-4));
+    nanoemPhysicsWorldRemoveRigidBody(world, body);
+    nanoemPhysicsRigidBodyDestroy(body);
+    nanoemPhysicsWorldDestroy(world);
+}
+
+TEST_CASE("physics_world_restore_state_resumes_simulation", "[nanoem]")
+{
+    static const nanoem_f32_t kFixedTimeStep = 1.0f / 60.0f;
+    ModelScope scope;
+    scope.newModel();
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_physics_world_t *world = nanoemPhysicsWorldCreate(NULL, &status);
+    nanoem_physics_rigid_body_t *body = createFallingBox(scope, world);
+    nanoemPhysicsWorldSetActive(world, nanoem_true);
+    for (int i = 0; i < 10; i++) {
+        nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep);
+    }
+    std::vector<nanoem_u8_t> state(nanoemPhysicsWorldGetStateSize(world));
+    REQUIRE_FALSE(state.empty());
+    nanoemPhysicsWorldSaveState(world, state.data(), state.size() - 1, &status);
+    CHECK(status == NANOEM_STATUS_ERROR_BUFFER_END);
+    nanoemPhysicsWorldSaveState(world, state.data(), state.size(), &status);
+    CHECK(status == NANOEM_STATUS_SUCCESS);
+    nanoem_f32_t expected[16], actual[16];
+    for (int i = 0; i < 10; i++) {
+        nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep);
+    }
+    nanoemPhysicsRigidBodyGetWorldTransform(body, expected);
+    SECTION("the state is restored and the simulation resumes from it")
+    {
+        nanoemPhysicsWorldReset(world);
+        nanoemPhysicsWorldRestoreState(world, state.data(), state.size(), &status);
+        CHECK(status == NANOEM_STATUS_SUCCESS);
+        for (int i = 0; i < 10; i++) {
+            nanoemPhysicsWorldStepSimulation(world, kFixedTimeStep);
+        }
+        nanoemPhysicsRigidBodyGetWorldTransform(body, actual);
+        /* the box is still falling so no contact is lost by restoring */
+        for (int i = 0; i < 16; i++) {
+            CHECK(actual[i] == Approx(expected[i]).margin(1e-4));
+        }
+    }
+    SECTION("the state of the different size is rejected")
+    {
+        nanoemPhysicsWorldRestoreState(world, state.data(), state.size() - 1, &status);
+        CHECK(status == NANOEM_STATUS_ERROR_BUFFER_END);
+        nanoemPhysicsRigidBodyGetWorldTransform(body, actual);
+        CHECK(actual[13] == Approx(expected[13]));
+    }
+    nanoemPhysicsWorldRemoveRigidBody(world, body);
+    nanoemPhysicsRigidBodyDestroy(body);
+    nanoemPhysicsWorldDestroy(world);
+}
+
+#endif /* NANOEM_ENABLE_BULLET */
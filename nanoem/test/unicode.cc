@@ -0,0 +1,140 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is part of nanoem component and it's licensed under MIT license. see LICENSE.md for more details.
+ */
+
+#include "./common.h"
+
+#if defined(NANOEM_ENABLE_ICU)
+
+#include "nanoem/ext/icu.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static const char kCenterUtf8[] = "\xe3\x82\xbb\xe3\x83\xb3\xe3\x82\xbf\xe3\x83\xbc";
+static const char kCenterSjis[] = "\x83\x5a\x83\x93\x83\x5e\x81\x5b";
+
+static nanoem_unicode_string_t *
+createString(nanoem_unicode_string_factory_t *factory, const char *value, nanoem_codec_type_t codec)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    return nanoemUnicodeStringFactoryCreateStringWithEncoding(
+        factory, reinterpret_cast<const nanoem_u8_t *>(value), strlen(value), codec, &status);
+}
+
+static bool
+convertsTo(nanoem_unicode_string_factory_t *factory, const nanoem_unicode_string_t *string, const char *expected,
+    nanoem_codec_type_t codec)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_rsize_t length = 0;
+    nanoem_u8_t *bytes = nanoemUnicodeStringFactoryGetByteArrayEncoding(factory, string, &length, codec, &status);
+    bool result = status == NANOEM_STATUS_SUCCESS && length == strlen(expected) && memcmp(bytes, expected, length) == 0;
+    nanoemUnicodeStringFactoryDestroyByteArray(factory, bytes);
+    return result;
+}
+
+} /* namespace anonymous */
+
+TEST_CASE("unicode_icu_intern_equal_strings", "[nanoem]")
+{
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateICU(NULL);
+    nanoem_unicode_string_t *a = createString(factory, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8);
+    nanoem_unicode_string_t *b = createString(factory, kCenterSjis, NANOEM_CODEC_TYPE_SJIS);
+    nanoem_unicode_string_t *c = createString(factory, "center", NANOEM_CODEC_TYPE_UTF8);
+    CHECK(nanoemUnicodeStringGetData(a) == nanoemUnicodeStringGetData(b));
+    CHECK(nanoemUnicodeStringGetLength(a) == 4);
+    CHECK(nanoemUnicodeStringFactoryCompareString(factory, a, b) == 0);
+    CHECK(nanoemUnicodeStringGetData(a) != nanoemUnicodeStringGetData(c));
+    CHECK(nanoemUnicodeStringFactoryCompareString(factory, a, c) != 0);
+    CHECK(convertsTo(factory, b, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8));
+    CHECK(convertsTo(factory, a, kCenterSjis, NANOEM_CODEC_TYPE_SJIS));
+    /* the shared data must outlive one of the strings referring it */
+    nanoemUnicodeStringFactoryDestroyString(factory, a);
+    CHECK(convertsTo(factory, b, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8));
+    nanoemUnicodeStringFactoryDestroyString(factory, b);
+    nanoemUnicodeStringFactoryDestroyString(factory, c);
+    nanoemUnicodeStringFactoryDestroyICU(factory);
+}
+
+TEST_CASE("unicode_icu_release_and_reuse_atoms", "[nanoem]")
+{
+    static const int kNumStrings = 1024;
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateICU(NULL);
+    std::vector<nanoem_unicode_string_t *> strings(kNumStrings);
+    char buffer[32];
+    for (int i = 0; i < kNumStrings; i++) {
+        snprintf(buffer, sizeof(buffer), "name%d", i);
+        strings[i] = createString(factory, buffer, NANOEM_CODEC_TYPE_UTF8);
+    }
+    /* releasing every odd string frees its atom and shifts the colliding buckets */
+    for (int i = 1; i < kNumStrings; i += 2) {
+        nanoemUnicodeStringFactoryDestroyString(factory, strings[i]);
+        strings[i] = NULL;
+    }
+    for (int i = 0; i < kNumStrings; i += 2) {
+        snprintf(buffer, sizeof(buffer), "name%d", i);
+        nanoem_unicode_string_t *s = createString(factory, buffer, NANOEM_CODEC_TYPE_UTF8);
+        CHECK(nanoemUnicodeStringGetData(s) == nanoemUnicodeStringGetData(strings[i]));
+        nanoemUnicodeStringFactoryDestroyString(factory, s);
+    }
+    /* freed atoms are reused by the new strings */
+    for (int i = 1; i < kNumStrings; i += 2) {
+        snprintf(buffer, sizeof(buffer), "other%d", i);
+        strings[i] = createString(factory, buffer, NANOEM_CODEC_TYPE_UTF8);
+    }
+    for (int i = 0; i < kNumStrings; i++) {
+        snprintf(buffer, sizeof(buffer), (i % 2) != 0 ? "other%d" : "name%d", i);
+        CHECK(convertsTo(factory, strings[i], buffer, NANOEM_CODEC_TYPE_UTF8));
+        nanoemUnicodeStringFactoryDestroyString(factory, strings[i]);
+    }
+    nanoemUnicodeStringFactoryDestroyICU(factory);
+}
+
+TEST_CASE("unicode_icu_concurrent_conversions", "[nanoem]")
+{
+    static const int kNumThreads = 8;
+    static const int kNumIterations = 256;
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateICU(NULL);
+    nanoem_unicode_string_t *shared = createString(factory, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8);
+    std::vector<std::thread> threads;
+    std::vector<int> failures(kNumThreads);
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.push_back(std::thread([factory, shared, &failures, i]() {
+            char buffer[32];
+            for (int j = 0; j < kNumIterations; j++) {
+                nanoem_unicode_string_t *s = createString(factory, kCenterSjis, NANOEM_CODEC_TYPE_SJIS);
+                if (nanoemUnicodeStringGetData(s) != nanoemUnicodeStringGetData(shared) ||
+                    nanoemUnicodeStringFactoryCompareString(factory, s, shared) != 0 ||
+                    !convertsTo(factory, s, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8) ||
+                    !convertsTo(factory, s, kCenterSjis, NANOEM_CODEC_TYPE_SJIS)) {
+                    failures[i]++;
+                }
+                nanoemUnicodeStringFactoryDestroyString(factory, s);
+                snprintf(buffer, sizeof(buffer), "thread%d_%d", i, j % 16);
+                s = createString(factory, buffer, NANOEM_CODEC_TYPE_UTF8);
+                if (!convertsTo(factory, s, buffer, NANOEM_CODEC_TYPE_UTF8)) {
+                    failures[i]++;
+                }
+                nanoemUnicodeStringFactoryDestroyString(factory, s);
+            }
+        }));
+    }
+    for (std::vector<std::thread>::iterator it = threads.begin(), end = threads.end(); it != end; ++it) {
+        it->join();
+    }
+    for (int i = 0; i < kNumThreads; i++) {
+        CHECK(failures[i] == 0);
+    }
+    CHECK(convertsTo(factory, shared, kCenterUtf8, NANOEM_CODEC_TYPE_UTF8));
+    nanoemUnicodeStringFactoryDestroyString(factory, shared);
+    nanoemUnicodeStringFactoryDestroyICU(factory);
+}
+
+#endif /* NANOEM_ENABLE_ICU */
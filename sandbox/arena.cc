@@ -0,0 +1,134 @@
+/*
+   Copyright (c) 2015-2021 hkrn All rights reserved
+
+   This file is licensed under MIT license. for more details, see LICENSE.txt.
+ */
+
+#include "nanoem/nanoem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+NANOEM_DECL_API nanoem_unicode_string_factory_t *APIENTRY nanoemUnicodeStringFactoryCreateEXT(nanoem_status_t *status);
+NANOEM_DECL_API void APIENTRY nanoemUnicodeStringFactoryDestroyEXT(nanoem_unicode_string_factory_t *factory);
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct Result {
+    double m_load;
+    double m_destroy;
+    nanoem_status_t m_status;
+};
+
+static double
+elapsedMilliseconds(const Clock::time_point &from, const Clock::time_point &to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static bool
+isMotionPath(const char *path)
+{
+    const char *extension = strrchr(path, '.');
+    return extension && (strcmp(extension, ".vmd") == 0 || strcmp(extension, ".VMD") == 0);
+}
+
+static Result
+benchmarkModel(
+    nanoem_unicode_string_factory_t *factory, const nanoem_u8_t *data, size_t size, int iterations, bool arena)
+{
+    Result result = { 0, 0, NANOEM_STATUS_SUCCESS };
+    for (int i = 0; i < iterations && result.m_status == NANOEM_STATUS_SUCCESS; i++) {
+        nanoem_buffer_t *buffer = nanoemBufferCreate(data, size, &result.m_status);
+        const Clock::time_point start = Clock::now();
+        nanoem_model_t *model = nanoemModelCreate(factory, &result.m_status);
+        if (arena) {
+            nanoemModelEnableObjectArena(model, 0, &result.m_status);
+        }
+        nanoemModelLoadFromBuffer(model, buffer, &result.m_status);
+        const Clock::time_point loaded = Clock::now();
+        nanoemModelDestroy(model);
+        const Clock::time_point destroyed = Clock::now();
+        nanoemBufferDestroy(buffer);
+        result.m_load += elapsedMilliseconds(start, loaded);
+        result.m_destroy += elapsedMilliseconds(loaded, destroyed);
+    }
+    return result;
+}
+
+static Result
+benchmarkMotion(
+    nanoem_unicode_string_factory_t *factory, const nanoem_u8_t *data, size_t size, int iterations, bool arena)
+{
+    Result result = { 0, 0, NANOEM_STATUS_SUCCESS };
+    for (int i = 0; i < iterations && result.m_status == NANOEM_STATUS_SUCCESS; i++) {
+        nanoem_buffer_t *buffer = nanoemBufferCreate(data, size, &result.m_status);
+        const Clock::time_point start = Clock::now();
+        nanoem_motion_t *motion = nanoemMotionCreate(factory, &result.m_status);
+        if (arena) {
+            nanoemMotionEnableObjectArena(motion, 0, &result.m_status);
+        }
+        nanoemMotionLoadFromBuffer(motion, buffer, 0, &result.m_status);
+        const Clock::time_point loaded = Clock::now();
+        nanoemMotionDestroy(motion);
+        const Clock::time_point destroyed = Clock::now();
+        nanoemBufferDestroy(buffer);
+        result.m_load += elapsedMilliseconds(start, loaded);
+        result.m_destroy += elapsedMilliseconds(loaded, destroyed);
+    }
+    return result;
+}
+
+static void
+execute(nanoem_unicode_string_factory_t *factory, const char *input_path, int iterations)
+{
+    if (FILE *fp = fopen(input_path, "rb")) {
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        nanoem_u8_t *data = new nanoem_u8_t[size];
+        fread(data, size, 1, fp);
+        fclose(fp);
+        const bool motion = isMotionPath(input_path);
+        for (int i = 0; i < 2; i++) {
+            const bool arena = i != 0;
+            const Result result = motion ? benchmarkMotion(factory, data, size, iterations, arena)
+                                         : benchmarkModel(factory, data, size, iterations, arena);
+            fprintf(stdout, "%s: allocator=%s load=%.3fms destroy=%.3fms status=%d\n", input_path,
+                arena ? "arena" : "heap", result.m_load / iterations, result.m_destroy / iterations, result.m_status);
+        }
+        delete[] data;
+    }
+    else {
+        fprintf(stderr, "%s: cannot open\n", input_path);
+    }
+}
+
+} /* namespace anonymous */
+
+int
+main(int argc, char **argv)
+{
+    nanoem_status_t status = NANOEM_STATUS_SUCCESS;
+    nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
+    int offset = 1, iterations = 10;
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        iterations = atoi(argv[2]);
+        offset = 3;
+    }
+    if (argc > offset && iterations > 0) {
+        for (int i = offset; i < argc; i++) {
+            execute(factory, argv[i], iterations);
+        }
+    }
+    else {
+        fprintf(stderr, "Usage: %s [-n iterations] [model or motion]...\n", argv[0]);
+    }
+    nanoemUnicodeStringFactoryDestroyEXT(factory);
+    return 0;
+}
@@ -11,11 +11,40 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 NANOEM_DECL_API nanoem_unicode_string_factory_t *APIENTRY nanoemUnicodeStringFactoryCreateEXT(nanoem_status_t *status);
 NANOEM_DECL_API void APIENTRY nanoemUnicodeStringFactoryDestroyEXT(nanoem_unicode_string_factory_t *factory);
 
 namespace {
 
+static int g_numThreads = 0;
+
+static void
+dispatchParallelTasks(
+    void * /* user_data */, nanoem_model_parallel_range_t func, void *opaque, nanoem_rsize_t iterations, nanoem_rsize_t grain_size)
+{
+    std::atomic<nanoem_rsize_t> next(0);
+    std::vector<std::thread> threads;
+    auto worker = [&]() {
+        nanoem_rsize_t begin;
+        while ((begin = next.fetch_add(grain_size)) < iterations) {
+            const nanoem_rsize_t end = begin + grain_size;
+            func(opaque, begin, end < iterations ? end : iterations);
+        }
+    };
+    for (int i = 1; i < g_numThreads; i++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
 static void
 generateRainbowModel(nanoem_unicode_string_factory_t *factory)
 {
@@ -82,6 +111,9 @@ loadModel(nanoem_unicode_string_factory_t *factory, nanoem_u8_t *data, size_t si
 {
     nanoem_model_t *model = nanoemModelCreate(factory, status);
     nanoem_buffer_t *buffer = nanoemBufferCreate(data, size, status);
+    if (g_numThreads > 1) {
+        nanoemModelSetParallelDispatcher(model, dispatchParallelTasks, nullptr);
+    }
     nanoemModelLoadFromBuffer(model, buffer, status);
     {
         nanoem_mutable_model_t *new_model = nanoemMutableModelCreateAsReference(model, status);
@@ -127,10 +159,12 @@ loadModelFromFile(nanoem_unicode_string_factory_t *factory, const char *input_pa
         fseek(fp, 0, SEEK_SET);
         nanoem_u8_t *data = new nanoem_u8_t[size];
         fread(data, size, 1, fp);
+        const auto start = std::chrono::steady_clock::now();
         loadModel(factory, data, size, &status);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
         delete[] data;
         fclose(fp);
-        fprintf(stderr, "%s: %d\n", input_path, status);
+        fprintf(stderr, "%s: %d (%.3fms)\n", input_path, status, elapsed.count());
     }
 }
 
@@ -141,8 +175,14 @@ main(int argc, char **argv)
 {
     nanoem_status_t status = NANOEM_STATUS_SUCCESS;
     nanoem_unicode_string_factory_t *factory = nanoemUnicodeStringFactoryCreateEXT(&status);
-    if (argc > 1) {
-        const char *input_path = argv[1];
+    int offset = 1;
+    /* -j N loads vertices and morphs of the model with N threads */
+    if (argc > 2 && strcmp(argv[1], "-j") == 0) {
+        g_numThreads = atoi(argv[2]);
+        offset = 3;
+    }
+    if (argc > offset) {
+        const char *input_path = argv[offset];
         if (strstr(input_path, ".txt")) {
             if (FILE *fp = fopen(input_path, "r")) {
                 char buffer[1024];
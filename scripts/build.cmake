@@ -110,9 +110,24 @@ function(compile_bullet _cmake_build_type _generator _toolset_option _arch_optio
   set(_source_path ${CMAKE_CURRENT_SOURCE_DIR}/dependencies/bullet3)
   set(_build_path ${base_build_path}/bullet3/out/${_triple_path})
   file(MAKE_DIRECTORY ${_build_path})
+  # built-in profiler of bullet is not thread safe and physics islands are solved concurrently
+  set(_bullet_no_profile_flag "-DBT_NO_PROFILE=1")
+  set(_bullet_cmake_flags "")
+  set(_bullet_cxx_flags_found OFF)
+  foreach(_flag ${global_cmake_flags})
+    if(_flag MATCHES "^-DCMAKE_CXX_FLAGS='(.*)'$")
+      list(APPEND _bullet_cmake_flags "-DCMAKE_CXX_FLAGS='${CMAKE_MATCH_1} ${_bullet_no_profile_flag}'")
+      set(_bullet_cxx_flags_found ON)
+    else()
+      list(APPEND _bullet_cmake_flags "${_flag}")
+    endif()
+  endforeach()
+  if(NOT _bullet_cxx_flags_found)
+    list(APPEND _bullet_cmake_flags "-DCMAKE_CXX_FLAGS=${_bullet_no_profile_flag}")
+  endif()
   execute_process(COMMAND ${CMAKE_COMMAND} -E chdir ${_build_path}
                                            ${CMAKE_COMMAND}
-                                           ${global_cmake_flags}
+                                           ${_bullet_cmake_flags}
                                            -DBUILD_DEMOS=OFF
                                            -DBUILD_EXTRAS=OFF
                                            -DINSTALL_EXTRA_LIBS=OFF